@@ -0,0 +1,256 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "checkpoint.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER) || defined(__MINGW32__)
+#   define PLASK_CHECKPOINT_WINAPI
+#   include "utils/minimal_windows.h"
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace plask {
+
+namespace {
+
+    const char MAGIC[8] = {'P', 'L', 'A', 'S', 'K', 'C', 'K', 'P'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    /// Checkpoint file header
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteorder;
+        std::uint64_t count;        ///< Number of blocks
+        std::uint64_t directory;    ///< Position of the directory
+        char reserved[CHECKPOINT_ALIGNMENT - 32];
+    };
+    static_assert(sizeof(Header) == CHECKPOINT_ALIGNMENT, "wrong checkpoint header size");
+
+    const char ZEROS[CHECKPOINT_ALIGNMENT] = {};
+
+    template <typename T>
+    inline void put(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    const char* AXIS_NAMES[] = {"/axis0", "/axis1", "/axis2"};
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& filename):
+    filename(filename), tmpname(filename + ".part"),
+    file(tmpname, std::ios::binary | std::ios::out | std::ios::trunc)
+{
+    if (!file) throw Exception("cannot create checkpoint file '{0}'", tmpname);
+    Header header = {};
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    put(file, header);  // header is rewritten in close() when directory position is known
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (file.is_open()) {
+        file.close();
+        std::remove(tmpname.c_str());
+    }
+}
+
+void CheckpointWriter::writeBlock(const std::string& name, std::uint32_t type, std::size_t itemsize, std::size_t count,
+                                  const void* data) {
+    if (!file.is_open()) throw Exception("checkpoint '{0}' is already closed", filename);
+    if (entries.find(name) != entries.end())
+        throw Exception("checkpoint '{0}': duplicate block '{1}'", filename, name);
+    std::uint64_t offset = file.tellp();
+    if (std::size_t pad = offset % CHECKPOINT_ALIGNMENT) {
+        file.write(ZEROS, CHECKPOINT_ALIGNMENT - pad);
+        offset += CHECKPOINT_ALIGNMENT - pad;
+    }
+    file.write(reinterpret_cast<const char*>(data), itemsize * count);
+    if (!file) throw Exception("error writing checkpoint '{0}'", tmpname);
+    entries[name] = CheckpointEntry{type, std::uint32_t(itemsize), count, offset};
+}
+
+template <typename MeshT>
+static void writeRectangularMesh(CheckpointWriter& writer, const std::string& name, const MeshT& mesh) {
+    for (int i = 0; i != MeshT::DIM; ++i) {
+        const MeshAxis& axis = *mesh.axis[i];
+        DataVector<double> points(axis.size());
+        for (std::size_t j = 0; j != points.size(); ++j) points[j] = axis.at(j);
+        writer.write(name + AXIS_NAMES[i], points);
+    }
+    writer.writeValue(name + "/order", std::int32_t(mesh.getIterationOrder()));
+}
+
+void CheckpointWriter::writeMesh(const std::string& name, const RectangularMesh2D& mesh) {
+    writeRectangularMesh(*this, name, mesh);
+}
+
+void CheckpointWriter::writeMesh(const std::string& name, const RectangularMesh3D& mesh) {
+    writeRectangularMesh(*this, name, mesh);
+}
+
+void CheckpointWriter::close() {
+    if (!file.is_open()) return;
+
+    Header header = {};
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.byteorder = BYTE_ORDER_MARK;
+    header.count = entries.size();
+    header.directory = file.tellp();
+
+    for (const auto& item: entries) {
+        put(file, std::uint32_t(item.first.size()));
+        file.write(item.first.data(), item.first.size());
+        put(file, item.second);
+    }
+    file.seekp(0);
+    put(file, header);
+    file.close();
+    if (file.fail()) {
+        std::remove(tmpname.c_str());
+        throw Exception("error writing checkpoint '{0}'", tmpname);
+    }
+
+#ifdef PLASK_CHECKPOINT_WINAPI
+    if (!MoveFileExA(tmpname.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+    if (std::rename(tmpname.c_str(), filename.c_str()) != 0)
+#endif
+        throw Exception("cannot move checkpoint '{0}' to '{1}'", tmpname, filename);
+}
+
+
+/// Private memory mapping of the whole checkpoint file
+struct CheckpointReader::Mapping {
+    char* data;
+    std::size_t size;
+#ifdef PLASK_CHECKPOINT_WINAPI
+    HANDLE file, map;
+#endif
+
+    explicit Mapping(const std::string& filename): data(nullptr), size(0) {
+#ifdef PLASK_CHECKPOINT_WINAPI
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) throw Exception("cannot open checkpoint file '{0}'", filename);
+        LARGE_INTEGER filesize;
+        if (!GetFileSizeEx(file, &filesize)) { CloseHandle(file); throw Exception("cannot open checkpoint file '{0}'", filename); }
+        size = std::size_t(filesize.QuadPart);
+        if (size < sizeof(Header)) { CloseHandle(file); throw Exception("'{0}' is not a checkpoint file", filename); }
+        map = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (map) data = reinterpret_cast<char*>(MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0));
+        if (!data) {
+            if (map) CloseHandle(map);
+            CloseHandle(file);
+            throw Exception("cannot map checkpoint file '{0}'", filename);
+        }
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd == -1) throw Exception("cannot open checkpoint file '{0}'", filename);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) { ::close(fd); throw Exception("cannot open checkpoint file '{0}'", filename); }
+        size = std::size_t(st.st_size);
+        if (size < sizeof(Header)) { ::close(fd); throw Exception("'{0}' is not a checkpoint file", filename); }
+        // Private writable mapping: pages are copied only when the solver modifies them
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) throw Exception("cannot map checkpoint file '{0}'", filename);
+        data = reinterpret_cast<char*>(addr);
+#endif
+    }
+
+    ~Mapping() {
+#ifdef PLASK_CHECKPOINT_WINAPI
+        UnmapViewOfFile(data);
+        CloseHandle(map);
+        CloseHandle(file);
+#else
+        ::munmap(data, size);
+#endif
+    }
+};
+
+CheckpointReader::CheckpointReader(const std::string& filename): filename(filename), mapping(new Mapping(filename)) {
+    Header header;
+    std::memcpy(&header, mapping->data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw Exception("'{0}' is not a checkpoint file", filename);
+    if (header.version != VERSION)
+        throw Exception("checkpoint '{0}' has unsupported version {1}", filename, header.version);
+    if (header.byteorder != BYTE_ORDER_MARK)
+        throw Exception("checkpoint '{0}' was written on a machine with different byte order", filename);
+
+    const char* end = mapping->data + mapping->size;
+    if (header.directory > mapping->size) throw Exception("checkpoint '{0}' is damaged", filename);
+    const char* pos = mapping->data + header.directory;
+    for (std::uint64_t i = 0; i != header.count; ++i) {
+        std::uint32_t length;
+        CheckpointEntry entry;
+        if (end - pos < std::ptrdiff_t(sizeof(length))) throw Exception("checkpoint '{0}' is damaged", filename);
+        std::memcpy(&length, pos, sizeof(length));
+        pos += sizeof(length);
+        if (end - pos < std::ptrdiff_t(length + sizeof(entry))) throw Exception("checkpoint '{0}' is damaged", filename);
+        std::string name(pos, length);
+        pos += length;
+        std::memcpy(&entry, pos, sizeof(entry));
+        pos += sizeof(entry);
+        if (entry.offset % CHECKPOINT_ALIGNMENT != 0 || entry.offset > mapping->size ||
+            entry.count > (mapping->size - entry.offset) / std::max(entry.itemsize, std::uint32_t(1)))
+            throw Exception("checkpoint '{0}' is damaged", filename);
+        entries[name] = entry;
+    }
+}
+
+std::vector<std::string> CheckpointReader::getNames() const {
+    std::vector<std::string> result;
+    result.reserve(entries.size());
+    for (const auto& item: entries) result.push_back(item.first);
+    return result;
+}
+
+const CheckpointEntry& CheckpointReader::getEntry(const std::string& name, std::uint32_t type, std::size_t itemsize) const {
+    auto found = entries.find(name);
+    if (found == entries.end()) throw Exception("checkpoint '{0}' has no '{1}'", filename, name);
+    if (found->second.type != type || found->second.itemsize != itemsize)
+        throw DataError("checkpoint '{0}': '{1}' has different type than requested", filename, name);
+    return found->second;
+}
+
+char* CheckpointReader::getAddress(const CheckpointEntry& entry) const {
+    return mapping->data + entry.offset;
+}
+
+template <int DIM>
+shared_ptr<RectangularMesh<DIM>> CheckpointReader::readMesh(const std::string& name) const {
+    shared_ptr<MeshAxis> axes[DIM];
+    for (int i = 0; i != DIM; ++i) {
+        DataVector<const double> points = read<const double>(name + AXIS_NAMES[i]);
+        axes[i] = plask::make_shared<OrderedAxis>(std::vector<double>(points.begin(), points.end()), 0.);
+    }
+    auto mesh = plask::make_shared<RectangularMesh<DIM>>();
+    for (int i = 0; i != DIM; ++i) mesh->setAxis(i, axes[i], false);
+    mesh->setIterationOrder(typename RectangularMesh<DIM>::IterationOrder(readValue<std::int32_t>(name + "/order")));
+    return mesh;
+}
+
+template PLASK_API shared_ptr<RectangularMesh<2>> CheckpointReader::readMesh<2>(const std::string& name) const;
+template PLASK_API shared_ptr<RectangularMesh<3>> CheckpointReader::readMesh<3>(const std::string& name) const;
+
+}   // namespace plask
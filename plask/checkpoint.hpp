@@ -0,0 +1,234 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__CHECKPOINT_H
+#define PLASK__CHECKPOINT_H
+
+/** @file
+This file contains classes for writing and reading binary checkpoints of the solvers state.
+
+A checkpoint is a single file with named data blocks. Each block is aligned to @ref CHECKPOINT_ALIGNMENT bytes, so
+when the checkpoint is read, the file is memory-mapped and the blocks are given to DataVector without any copying.
+The mapping is private (copy-on-write), so the solvers can freely modify the data and the file remains intact.
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "data.hpp"
+#include "exceptions.hpp"
+#include "memory.hpp"
+#include "mesh/rectangular.hpp"
+#include "vec.hpp"
+#include "vector/tensor2.hpp"
+#include "vector/tensor3.hpp"
+
+namespace plask {
+
+/// Alignment of data blocks in checkpoint files
+constexpr std::size_t CHECKPOINT_ALIGNMENT = 64;
+
+/**
+ * Codes of the types, which can be stored in checkpoints.
+ *
+ * Only types with fixed binary layout are allowed, so that the data can be mapped back into memory.
+ */
+template <typename T> struct CheckpointType;
+
+#define PLASK_CHECKPOINT_TYPE(code, ...) \
+    template <> struct CheckpointType<__VA_ARGS__> { static constexpr std::uint32_t CODE = code; };
+
+PLASK_CHECKPOINT_TYPE(1, double)
+PLASK_CHECKPOINT_TYPE(2, dcomplex)
+PLASK_CHECKPOINT_TYPE(3, std::int32_t)
+PLASK_CHECKPOINT_TYPE(4, std::uint32_t)
+PLASK_CHECKPOINT_TYPE(5, std::int64_t)
+PLASK_CHECKPOINT_TYPE(6, std::uint64_t)
+PLASK_CHECKPOINT_TYPE(16, Vec<2, double>)
+PLASK_CHECKPOINT_TYPE(17, Vec<3, double>)
+PLASK_CHECKPOINT_TYPE(18, Vec<2, dcomplex>)
+PLASK_CHECKPOINT_TYPE(19, Vec<3, dcomplex>)
+PLASK_CHECKPOINT_TYPE(32, Tensor2<double>)
+PLASK_CHECKPOINT_TYPE(33, Tensor3<double>)
+PLASK_CHECKPOINT_TYPE(34, Tensor2<dcomplex>)
+PLASK_CHECKPOINT_TYPE(35, Tensor3<dcomplex>)
+
+#undef PLASK_CHECKPOINT_TYPE
+
+/// Information about single block in the checkpoint file
+struct CheckpointEntry {
+    std::uint32_t type;     ///< Code of the data type
+    std::uint32_t itemsize; ///< Size of single item
+    std::uint64_t count;    ///< Number of items
+    std::uint64_t offset;   ///< Position of the data in the file
+};
+
+/**
+ * Writer of the checkpoint files.
+ *
+ * Data blocks are written directly from the DataVector storage as they are added. The directory of blocks
+ * is written by @ref close. The file is first created with a temporary name and renamed when it is complete,
+ * so an existing checkpoint is never left damaged by an interrupted write.
+ */
+class PLASK_API CheckpointWriter {
+
+    std::string filename, tmpname;
+    std::ofstream file;
+    std::map<std::string, CheckpointEntry> entries;
+
+    void writeBlock(const std::string& name, std::uint32_t type, std::size_t itemsize, std::size_t count, const void* data);
+
+  public:
+
+    /**
+     * Create new checkpoint
+     * \param filename name of the checkpoint file
+     */
+    explicit CheckpointWriter(const std::string& filename);
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /// Close the file (if it has not been closed) and discard it if it is not complete
+    ~CheckpointWriter();
+
+    /// Get checkpoint file name
+    const std::string& getFilename() const { return filename; }
+
+    /**
+     * Write data block
+     * \param name name of the block
+     * \param data data to write
+     */
+    template <typename T>
+    void write(const std::string& name, const DataVector<T>& data) {
+        typedef typename std::remove_const<T>::type ItemT;
+        writeBlock(name, CheckpointType<ItemT>::CODE, sizeof(ItemT), data.size(), data.data());
+    }
+
+    /**
+     * Write single value
+     * \param name name of the value
+     * \param value value to write
+     */
+    template <typename T>
+    void writeValue(const std::string& name, const T& value) {
+        writeBlock(name, CheckpointType<T>::CODE, sizeof(T), 1, &value);
+    }
+
+    /**
+     * Write rectangular mesh as its axes points and iteration order
+     * \param name name of the mesh
+     * \param mesh mesh to write
+     */
+    void writeMesh(const std::string& name, const RectangularMesh2D& mesh);
+
+    /**
+     * Write rectangular mesh as its axes points and iteration order
+     * \param name name of the mesh
+     * \param mesh mesh to write
+     */
+    void writeMesh(const std::string& name, const RectangularMesh3D& mesh);
+
+    /// Write directory and move the file into its final place
+    void close();
+};
+
+/**
+ * Reader of the checkpoint files.
+ *
+ * The file is memory-mapped and the data blocks are returned as DataVectors referring directly to the mapped
+ * memory. The mapping is kept alive as long as there is any reader or DataVector using it.
+ */
+class PLASK_API CheckpointReader {
+
+    struct Mapping;
+
+    std::string filename;
+    shared_ptr<Mapping> mapping;
+    std::map<std::string, CheckpointEntry> entries;
+
+    const CheckpointEntry& getEntry(const std::string& name, std::uint32_t type, std::size_t itemsize) const;
+
+    char* getAddress(const CheckpointEntry& entry) const;
+
+  public:
+
+    /**
+     * Open existing checkpoint
+     * \param filename name of the checkpoint file
+     */
+    explicit CheckpointReader(const std::string& filename);
+
+    /// Get checkpoint file name
+    const std::string& getFilename() const { return filename; }
+
+    /**
+     * Check if there is a block with the given name
+     * \param name name of the block
+     */
+    bool has(const std::string& name) const { return entries.find(name) != entries.end(); }
+
+    /// Get names of all blocks in the checkpoint
+    std::vector<std::string> getNames() const;
+
+    /**
+     * Get data block without copying it
+     * \param name name of the block
+     * \return data vector with the checkpoint data, which can be freely modified
+     */
+    template <typename T>
+    DataVector<T> read(const std::string& name) const {
+        typedef typename std::remove_const<T>::type ItemT;
+        const CheckpointEntry& entry = getEntry(name, CheckpointType<ItemT>::CODE, sizeof(ItemT));
+        if (entry.count == 0) return DataVector<T>();
+        shared_ptr<Mapping> keep = mapping;
+        return DataVector<T>(reinterpret_cast<ItemT*>(getAddress(entry)), std::size_t(entry.count), [keep](void*) {});
+    }
+
+    /**
+     * Get single value
+     * \param name name of the value
+     */
+    template <typename T>
+    T readValue(const std::string& name) const {
+        const CheckpointEntry& entry = getEntry(name, CheckpointType<T>::CODE, sizeof(T));
+        if (entry.count != 1) throw Exception("checkpoint '{0}': '{1}' is not a single value", filename, name);
+        return *reinterpret_cast<const T*>(getAddress(entry));
+    }
+
+    /**
+     * Get single value or the default if it is missing
+     * \param name name of the value
+     * \param default_value value returned if there is no block with the given name
+     */
+    template <typename T>
+    T readValue(const std::string& name, const T& default_value) const {
+        if (!has(name)) return default_value;
+        return readValue<T>(name);
+    }
+
+    /**
+     * Read rectangular mesh stored with CheckpointWriter::writeMesh
+     * \param name name of the mesh
+     */
+    template <int DIM>
+    shared_ptr<RectangularMesh<DIM>> readMesh(const std::string& name) const;
+};
+
+}   // namespace plask
+
+#endif // PLASK__CHECKPOINT_H
@@ -15,6 +15,8 @@
 #define PLASK_COMMON_FEM_HPP
 
 #include "fem/cholesky_matrix.hpp"
+#include "fem/coloring.hpp"
+#include "fem/csr_matrix.hpp"
 #include "fem/gauss_matrix.hpp"
 #include "fem/iterative_matrix.hpp"
 #include "fem/fem_solver.hpp"
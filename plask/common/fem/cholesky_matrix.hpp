@@ -92,7 +92,7 @@ struct DpbMatrix : BandMatrix {
 
         solver->writelog(LOG_DETAIL, "Factorizing system");
 
-        dpbtrf(UPLO, int(rank), int(kd), data, int(ld + 1), info);
+        dpbtrf(UPLO, int(rank), int(kd), factorizationData(), int(ld + 1), info);
         if (info < 0)
             throw CriticalException("{0}: Argument {1} of `dpbtrf` has illegal value", solver->getId(), -info);
         else if (info > 0)
@@ -104,7 +104,7 @@ struct DpbMatrix : BandMatrix {
         solver->writelog(LOG_DETAIL, "Solving matrix system");
 
         int info = 0;
-        dpbtrs(UPLO, int(rank), int(kd), 1, data, int(ld + 1), B.data(), int(B.size()), info);
+        dpbtrs(UPLO, int(rank), int(kd), 1, factorizedData(), int(ld + 1), B.data(), int(B.size()), info);
         if (info < 0) throw CriticalException("{0}: Argument {1} of `dpbtrs` has illegal value", solver->getId(), -info);
 
         std::swap(B, X);
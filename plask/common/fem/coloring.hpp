@@ -0,0 +1,120 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2023 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK_COMMON_FEM_COLORING_HPP
+#define PLASK_COMMON_FEM_COLORING_HPP
+
+#include <atomic>
+
+#include <plask/plask.hpp>
+
+#include "matrix.hpp"
+
+namespace plask {
+
+/**
+ * Color of the rectangular element.
+ * Elements with the same color never share a node, as their indices along each axis differ by at least two.
+ */
+template <int DIM> struct FemElementColor;
+
+template <> struct FemElementColor<2> {
+    static constexpr size_t COUNT = 4;  ///< Number of colors
+    template <typename ElementT> size_t operator()(const ElementT& elem) const {
+        return (elem.getIndex0() & 1) | (elem.getIndex1() & 1) << 1;
+    }
+};
+
+template <> struct FemElementColor<3> {
+    static constexpr size_t COUNT = 8;  ///< Number of colors
+    template <typename ElementT> size_t operator()(const ElementT& elem) const {
+        return (elem.getIndex0() & 1) | (elem.getIndex1() & 1) << 1 | (elem.getIndex2() & 1) << 2;
+    }
+};
+
+/**
+ * Split elements of the rectangular mesh into groups (colors) with no common nodes
+ * \param mesh rectangular mesh (masked or not)
+ * \return indices of the elements in each color
+ */
+template <typename MeshT> std::vector<std::vector<size_t>> colorElements(const MeshT& mesh) {
+    FemElementColor<MeshT::DIM> color;
+    std::vector<std::vector<size_t>> colors(FemElementColor<MeshT::DIM>::COUNT);
+    auto elements = mesh.elements();
+    for (auto& indices : colors) indices.reserve(elements.size() / colors.size() + 1);
+    for (auto elem : elements) colors[color(elem)].push_back(elem.getIndex());
+    return colors;
+}
+
+/**
+ * Cached split of the mesh elements into colors.
+ * The colors are recomputed if a different mesh is given or the mesh has been changed since the last call.
+ * Masked meshes do not emit change signals when they are reset, so reset() must be called in such case.
+ */
+struct FemElementColoring {
+
+    /**
+     * Get indices of the elements in each color
+     * \param mesh rectangular mesh (masked or not)
+     * \return indices of the elements in each color
+     */
+    template <typename MeshT> const std::vector<std::vector<size_t>>& operator()(const MeshT& mesh) {
+        if (!meshChecker(&mesh) || colors.empty()) colors = colorElements(mesh);
+        return colors;
+    }
+
+    /// Drop the cached colors
+    void reset() { colors.clear(); }
+
+  private:
+    SameMeshChecker meshChecker;
+    std::vector<std::vector<size_t>> colors;
+};
+
+/**
+ * Call \p func for every element of the rectangular mesh, assembling the matrix in parallel.
+ * Elements are processed color by color. As elements of a single color do not share any nodes, the function
+ * may safely add their contributions to the matrix and load vector without any synchronization. However,
+ * all other shared data it modifies must be protected by the caller.
+ * If the matrix does not allow concurrent access, the elements are processed serially.
+ * \param mesh rectangular mesh (masked or not)
+ * \param matrix assembled matrix
+ * \param coloring cached colors of the mesh elements
+ * \param func function called for each element with the element as its argument
+ */
+template <typename MeshT, typename F>
+void assembleElements(const MeshT& mesh, const FemMatrix& matrix, FemElementColoring& coloring, F func) {
+    if (!matrix.isConcurrent()) {
+        for (auto elem : mesh.elements()) func(elem);
+        return;
+    }
+    std::exception_ptr error;
+    std::atomic<bool> failed(false);
+    for (const auto& indices : coloring(mesh)) {
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < indices.size(); ++i) {
+            if (failed.load(std::memory_order_relaxed)) continue;
+            try {
+                func(mesh.element(indices[i]));
+            } catch (...) {
+                #pragma omp critical
+                if (!failed.exchange(true)) error = std::current_exception();
+            }
+        }
+        if (failed) std::rethrow_exception(error);
+    }
+}
+
+}  // namespace plask
+
+#endif  // PLASK_COMMON_FEM_COLORING_HPP
@@ -0,0 +1,679 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2023 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK_COMMON_FEM_CSR_MATRIX_H
+#define PLASK_COMMON_FEM_CSR_MATRIX_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include "iterative_matrix.hpp"
+#include "matrix.hpp"
+
+// LAPACK routines used for the coarsest level of the multigrid
+#define dpotrf F77_GLOBAL(dpotrf, DPOTRF)
+F77SUB dpotrf(const char& uplo, const int& n, double* a, const int& lda, int& info);
+
+#define dpotrs F77_GLOBAL(dpotrs, DPOTRS)
+F77SUB dpotrs(const char& uplo, const int& n, const int& nrhs, const double* a, const int& lda, double* b, const int& ldb, int& info);
+
+namespace plask {
+
+/**
+ * Sparsity pattern of the symmetric CSR matrix.
+ *
+ * Both the lower and the upper triangle are present in the pattern, so the matrix-vector multiplication
+ * can be done in parallel row by row without any synchronization.
+ */
+struct CsrPattern {
+    std::vector<size_t> rows;  ///< Offsets of the rows in \c cols (size rank+1)
+    std::vector<int> cols;     ///< Column indices (sorted within each row)
+
+    CsrPattern() = default;
+
+    /**
+     * Build pattern from the mesh elements
+     * \param rank rank of the matrix
+     * \param elements range of the mesh elements
+     * \param nodes function filling the provided array with the indices of element degrees of freedom (at most 16)
+     *              and returning their number
+     */
+    template <typename ElementsT, typename NodesF> CsrPattern(size_t rank, const ElementsT& elements, NodesF nodes) {
+        std::vector<std::vector<int>> neighbors(rank);
+        for (size_t r = 0; r < rank; ++r) neighbors[r].push_back(int(r));
+        size_t idx[16];
+        for (auto elem : elements) {
+            size_t n = nodes(elem, idx);
+            assert(n <= 16);
+            for (size_t i = 0; i < n; ++i) {
+                auto& row = neighbors[idx[i]];
+                for (size_t j = 0; j < n; ++j) {
+                    int c = int(idx[j]);
+                    auto found = std::lower_bound(row.begin(), row.end(), c);
+                    if (found == row.end() || *found != c) row.insert(found, c);
+                }
+            }
+        }
+        setRows(neighbors);
+    }
+
+    /**
+     * Build band pattern
+     * \param rank rank of the matrix
+     * \param kd size of the band reduced by one
+     */
+    static CsrPattern band(size_t rank, size_t kd) {
+        CsrPattern result;
+        result.rows.resize(rank + 1);
+        result.rows[0] = 0;
+        for (size_t r = 0; r < rank; ++r) {
+            size_t start = (r > kd) ? r - kd : 0;
+            size_t end = (r + kd < rank) ? r + kd + 1 : rank;
+            for (size_t c = start; c < end; ++c) result.cols.push_back(int(c));
+            result.rows[r + 1] = result.cols.size();
+        }
+        return result;
+    }
+
+    /// Number of stored elements
+    size_t size() const { return cols.size(); }
+
+  private:
+    void setRows(const std::vector<std::vector<int>>& neighbors) {
+        rows.resize(neighbors.size() + 1);
+        rows[0] = 0;
+        for (size_t r = 0; r < neighbors.size(); ++r) rows[r + 1] = rows[r] + neighbors[r].size();
+        cols.resize(rows.back());
+        for (size_t r = 0; r < neighbors.size(); ++r) std::copy(neighbors[r].begin(), neighbors[r].end(), cols.begin() + rows[r]);
+    }
+};
+
+namespace detail {
+
+    /// Matrix in CSR format used at the levels of the multigrid hierarchy
+    struct AmgCsr {
+        size_t n = 0;  ///< Number of rows
+        size_t m = 0;  ///< Number of columns
+        std::vector<size_t> rows;
+        std::vector<int> cols;
+        std::vector<double> vals;
+
+        void mult(const double* x, double* y) const {
+            #pragma omp parallel for
+            for (openmp_size_t r = 0; r < n; ++r) {
+                double s = 0.;
+                for (size_t k = rows[r]; k < rows[r + 1]; ++k) s += vals[k] * x[cols[k]];
+                y[r] = s;
+            }
+        }
+    };
+
+    /**
+     * Smoothed-aggregation algebraic multigrid preconditioner.
+     * It is used as a symmetric V-cycle with damped Jacobi smoothing, so it can precondition the conjugate gradient.
+     */
+    struct AmgPreconditioner {
+        /// Maximum size of the coarsest level solved directly
+        static constexpr size_t COARSE_SIZE = 500;
+        /// Maximum number of the levels
+        static constexpr size_t MAX_LEVELS = 20;
+        /// Strength of connection threshold
+        static constexpr double THETA = 0.08;
+        /// Number of smoothing sweeps before and after coarse-grid correction
+        static constexpr int SWEEPS = 2;
+
+        struct Level {
+            AmgCsr A;                            ///< Level matrix
+            std::vector<double> dinv;            ///< Damped inverse of the diagonal (Jacobi smoother)
+            AmgCsr P;                            ///< Prolongation to this level from the next (coarser) one
+            AmgCsr R;                            ///< Restriction (transposed prolongation)
+            std::vector<double> x, b, r;         ///< Work vectors
+        };
+
+        std::vector<Level> levels;
+        std::vector<double> coarse;  ///< Cholesky factor of the coarsest matrix
+        bool coarse_direct = false;
+
+        /**
+         * Build the hierarchy
+         * \param n rank of the fine matrix
+         * \param rows, cols, vals fine matrix in CSR format (full symmetric pattern)
+         */
+        void build(size_t n, const size_t* rows, const int* cols, const double* vals) {
+            levels.clear();
+            levels.emplace_back();
+            AmgCsr& A0 = levels[0].A;
+            A0.n = A0.m = n;
+            A0.rows.assign(rows, rows + n + 1);
+            A0.cols.assign(cols, cols + rows[n]);
+            A0.vals.assign(vals, vals + rows[n]);
+
+            while (true) {
+                Level& level = levels.back();
+                setupSmoother(level);
+                if (level.A.n <= COARSE_SIZE || levels.size() >= MAX_LEVELS) break;
+                AmgCsr P;
+                if (!buildProlongation(level, P)) break;
+                AmgCsr R = transpose(P);
+                AmgCsr AP = multiply(level.A, P);
+                AmgCsr Ac = multiply(R, AP);
+                level.P = std::move(P);
+                level.R = std::move(R);
+                levels.emplace_back();
+                levels.back().A = std::move(Ac);
+            }
+            for (auto& level : levels) {
+                level.x.assign(level.A.n, 0.);
+                level.b.assign(level.A.n, 0.);
+                level.r.assign(level.A.n, 0.);
+            }
+            factorizeCoarse();
+        }
+
+        /// Apply the preconditioner: x = M⁻¹ b
+        void apply(const double* b, double* x) {
+            std::copy_n(b, levels[0].A.n, levels[0].b.begin());
+            cycle(0);
+            std::copy_n(levels[0].x.begin(), levels[0].A.n, x);
+        }
+
+        /// Number of levels
+        size_t size() const { return levels.size(); }
+
+      private:
+        static void setupSmoother(Level& level) {
+            const AmgCsr& A = level.A;
+            level.dinv.resize(A.n);
+            // Damping 4/3ρ(D⁻¹A) with the spectral radius estimated by the Gershgorin theorem
+            double rho = 0.;
+            for (size_t r = 0; r < A.n; ++r) {
+                double diag = 0., sum = 0.;
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k) {
+                    if (size_t(A.cols[k]) == r) diag = A.vals[k];
+                    sum += std::abs(A.vals[k]);
+                }
+                level.dinv[r] = (diag != 0.) ? 1. / diag : 0.;
+                if (diag != 0.) rho = std::max(rho, sum / std::abs(diag));
+            }
+            double omega = (rho > 0.) ? 4. / (3. * rho) : 2. / 3.;
+            for (double& d : level.dinv) d *= omega;
+        }
+
+        /**
+         * Aggregate strongly connected nodes and construct Jacobi-smoothed prolongation
+         * \return \c false if the coarsening does not reduce the problem size
+         */
+        static bool buildProlongation(const Level& level, AmgCsr& P) {
+            const AmgCsr& A = level.A;
+            const size_t n = A.n;
+
+            std::vector<double> diag(n, 0.);
+            for (size_t r = 0; r < n; ++r)
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k)
+                    if (size_t(A.cols[k]) == r) diag[r] = A.vals[k];
+
+            auto strong = [&](size_t r, size_t k) {
+                size_t c = A.cols[k];
+                return c != r && A.vals[k] * A.vals[k] > THETA * THETA * std::abs(diag[r] * diag[c]);
+            };
+
+            std::vector<int> aggregate(n, -1);
+            int nc = 0;
+
+            // Pass 1: nodes with all strong neighbors free form new aggregates
+            std::vector<char> isolated(n, 1);
+            for (size_t r = 0; r < n; ++r) {
+                bool free = true;
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k) {
+                    if (!strong(r, k)) continue;
+                    isolated[r] = 0;
+                    if (aggregate[A.cols[k]] != -1) { free = false; break; }
+                }
+                if (isolated[r] || !free || aggregate[r] != -1) continue;
+                aggregate[r] = nc;
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k)
+                    if (strong(r, k)) aggregate[A.cols[k]] = nc;
+                ++nc;
+            }
+            // Pass 2: attach remaining nodes to the neighboring aggregates
+            std::vector<int> attached(aggregate);
+            for (size_t r = 0; r < n; ++r) {
+                if (aggregate[r] != -1 || isolated[r]) continue;
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k) {
+                    if (strong(r, k) && aggregate[A.cols[k]] != -1) {
+                        attached[r] = aggregate[A.cols[k]];
+                        break;
+                    }
+                }
+            }
+            aggregate.swap(attached);
+            // Pass 3: whatever is left forms its own aggregates
+            for (size_t r = 0; r < n; ++r) {
+                if (aggregate[r] != -1 || isolated[r]) continue;
+                aggregate[r] = nc;
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k)
+                    if (strong(r, k) && aggregate[A.cols[k]] == -1) aggregate[A.cols[k]] = nc;
+                ++nc;
+            }
+
+            if (nc == 0 || size_t(nc) > 9 * n / 10) return false;
+
+            // Smoothed prolongation P = (I - ω D⁻¹ A) T, where T is the aggregation operator
+            P.n = n;
+            P.rows.assign(n + 1, 0);
+            std::vector<std::vector<std::pair<int, double>>> prow(n);
+            #pragma omp parallel for
+            for (openmp_size_t r = 0; r < n; ++r) {
+                auto& row = prow[r];
+                if (aggregate[r] != -1) row.emplace_back(aggregate[r], 1.);
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k) {
+                    int a = aggregate[A.cols[k]];
+                    if (a == -1) continue;
+                    double v = -level.dinv[r] * A.vals[k];
+                    auto found = std::find_if(row.begin(), row.end(), [a](const std::pair<int, double>& e) { return e.first == a; });
+                    if (found == row.end())
+                        row.emplace_back(a, v);
+                    else
+                        found->second += v;
+                }
+                std::sort(row.begin(), row.end());
+            }
+            for (size_t r = 0; r < n; ++r) P.rows[r + 1] = P.rows[r] + prow[r].size();
+            P.cols.resize(P.rows[n]);
+            P.vals.resize(P.rows[n]);
+            for (size_t r = 0; r < n; ++r) {
+                size_t k = P.rows[r];
+                for (const auto& e : prow[r]) {
+                    P.cols[k] = e.first;
+                    P.vals[k] = e.second;
+                    ++k;
+                }
+            }
+            P.m = size_t(nc);
+            return true;
+        }
+
+        static AmgCsr transpose(const AmgCsr& M) {
+            AmgCsr T;
+            size_t nc = M.m;
+            T.n = nc;
+            T.m = M.n;
+            T.rows.assign(nc + 1, 0);
+            for (int c : M.cols) ++T.rows[c + 1];
+            for (size_t r = 0; r < nc; ++r) T.rows[r + 1] += T.rows[r];
+            T.cols.resize(M.cols.size());
+            T.vals.resize(M.vals.size());
+            std::vector<size_t> pos(T.rows.begin(), T.rows.end() - 1);
+            for (size_t r = 0; r < M.n; ++r) {
+                for (size_t k = M.rows[r]; k < M.rows[r + 1]; ++k) {
+                    size_t p = pos[M.cols[k]]++;
+                    T.cols[p] = int(r);
+                    T.vals[p] = M.vals[k];
+                }
+            }
+            return T;
+        }
+
+        static AmgCsr multiply(const AmgCsr& A, const AmgCsr& B) {
+            AmgCsr C;
+            C.n = A.n;
+            C.m = B.m;
+            const size_t nc = B.m;
+            std::vector<std::vector<int>> ccols(A.n);
+            std::vector<std::vector<double>> cvals(A.n);
+#pragma omp parallel
+            {
+                std::vector<ptrdiff_t> marker(nc, -1);
+#pragma omp for
+                for (openmp_size_t r = 0; r < A.n; ++r) {
+                    auto& rc = ccols[r];
+                    auto& rv = cvals[r];
+                    for (size_t ka = A.rows[r]; ka < A.rows[r + 1]; ++ka) {
+                        size_t j = A.cols[ka];
+                        double a = A.vals[ka];
+                        for (size_t kb = B.rows[j]; kb < B.rows[j + 1]; ++kb) {
+                            int c = B.cols[kb];
+                            if (marker[c] < 0) {
+                                marker[c] = ptrdiff_t(rc.size());
+                                rc.push_back(c);
+                                rv.push_back(a * B.vals[kb]);
+                            } else {
+                                rv[marker[c]] += a * B.vals[kb];
+                            }
+                        }
+                    }
+                    for (int c : rc) marker[c] = -1;
+                    // sort row entries by column
+                    std::vector<size_t> order(rc.size());
+                    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+                    std::sort(order.begin(), order.end(), [&rc](size_t i, size_t j) { return rc[i] < rc[j]; });
+                    std::vector<int> sc(rc.size());
+                    std::vector<double> sv(rv.size());
+                    for (size_t i = 0; i < order.size(); ++i) {
+                        sc[i] = rc[order[i]];
+                        sv[i] = rv[order[i]];
+                    }
+                    rc.swap(sc);
+                    rv.swap(sv);
+                }
+            }
+            C.rows.assign(A.n + 1, 0);
+            for (size_t r = 0; r < A.n; ++r) C.rows[r + 1] = C.rows[r] + ccols[r].size();
+            C.cols.resize(C.rows[A.n]);
+            C.vals.resize(C.rows[A.n]);
+            for (size_t r = 0; r < A.n; ++r) {
+                std::copy(ccols[r].begin(), ccols[r].end(), C.cols.begin() + C.rows[r]);
+                std::copy(cvals[r].begin(), cvals[r].end(), C.vals.begin() + C.rows[r]);
+            }
+            return C;
+        }
+
+        /**
+         * Factorize the coarsest level with dense Cholesky.
+         * The coarsening may stop early, so larger coarsest levels are just smoothed instead.
+         */
+        void factorizeCoarse() {
+            const AmgCsr& A = levels.back().A;
+            if (A.n > COARSE_SIZE) {
+                std::vector<double>().swap(coarse);
+                coarse_direct = false;
+                return;
+            }
+            int n = int(A.n);
+            coarse.assign(A.n * A.n, 0.);
+            for (size_t r = 0; r < A.n; ++r)
+                for (size_t k = A.rows[r]; k < A.rows[r + 1]; ++k) coarse[r * A.n + A.cols[k]] = A.vals[k];
+            int info = 0;
+            if (n != 0) dpotrf('L', n, coarse.data(), n, info);
+            coarse_direct = (n != 0 && info == 0);
+        }
+
+        void smooth(Level& level, int sweeps) {
+            const AmgCsr& A = level.A;
+            for (int s = 0; s < sweeps; ++s) {
+                A.mult(level.x.data(), level.r.data());
+                #pragma omp parallel for
+                for (openmp_size_t i = 0; i < A.n; ++i) level.x[i] += level.dinv[i] * (level.b[i] - level.r[i]);
+            }
+        }
+
+        void cycle(size_t l) {
+            Level& level = levels[l];
+            const size_t n = level.A.n;
+            if (l + 1 == levels.size()) {
+                if (coarse_direct) {
+                    int info = 0;
+                    std::copy(level.b.begin(), level.b.end(), level.x.begin());
+                    dpotrs('L', int(n), 1, coarse.data(), int(n), level.x.data(), int(n), info);
+                } else {
+                    std::fill(level.x.begin(), level.x.end(), 0.);
+                    smooth(level, 4 * SWEEPS);
+                }
+                return;
+            }
+            std::fill(level.x.begin(), level.x.end(), 0.);
+            smooth(level, SWEEPS);
+            // residual restricted to the coarse level
+            level.A.mult(level.x.data(), level.r.data());
+            #pragma omp parallel for
+            for (openmp_size_t i = 0; i < n; ++i) level.r[i] = level.b[i] - level.r[i];
+            Level& next = levels[l + 1];
+            level.R.mult(level.r.data(), next.b.data());
+            cycle(l + 1);
+            // prolongate correction
+            level.P.mult(next.x.data(), level.r.data());
+            #pragma omp parallel for
+            for (openmp_size_t i = 0; i < n; ++i) level.x[i] += level.r[i];
+            smooth(level, SWEEPS);
+        }
+    };
+
+}  // namespace detail
+
+/**
+ * Symmetric sparse matrix stored in CSR format.
+ * The system is solved with the conjugate gradient method preconditioned with algebraic multigrid.
+ *
+ * Only the upper triangle is assembled by the solver. The lower one is mirrored before the solution.
+ */
+struct CsrMatrix : FemMatrix {
+    const std::vector<size_t> rows;  ///< Offsets of the rows in \c cols
+    const std::vector<int> cols;     ///< Column indices
+
+  protected:
+    std::vector<size_t> mirror;  ///< Index of the transposed element for each stored one
+
+    IterativeMatrixParams* params;
+
+    detail::AmgPreconditioner amg;
+
+    /// Is lower triangle consistent with the upper one? (atomic, as the matrix can be assembled concurrently)
+    std::atomic<bool> symmetric{true};
+    /// Is the preconditioner up to date?
+    std::atomic<bool> prepared{false};
+
+    uint64_t amg_fingerprint = 0;  ///< Fingerprint of the matrix for which the preconditioner was built
+
+    int fresh_iters = -1;  ///< Number of iterations with just built preconditioner
+    int last_iters = -1;   ///< Number of iterations in the last solution
+
+  public:
+    /**
+     * Create sparse matrix
+     * \param solver solver
+     * \param rank rank of the matrix
+     * \param pattern sparsity pattern
+     */
+    template <typename SolverT>
+    CsrMatrix(SolverT* solver, size_t rank, CsrPattern&& pattern)
+        : FemMatrix(solver, rank, pattern.size()),
+          rows(std::move(pattern.rows)),
+          cols(std::move(pattern.cols)),
+          mirror(size),
+          params(&solver->iter_params) {
+        assert(rows.size() == rank + 1);
+        #pragma omp parallel for
+        for (openmp_size_t r = 0; r < rank; ++r) {
+            for (size_t k = rows[r]; k < rows[r + 1]; ++k) mirror[k] = find(cols[k], r);
+        }
+    }
+
+    /**
+     * Return reference to array element. Always an element from the upper triangle is returned.
+     * \param r index of the element row
+     * \param c index of the element column
+     * \return reference to array element
+     **/
+    double& operator()(size_t r, size_t c) override {
+        if (r > c) std::swap(r, c);
+        // Flags are normally reset in clear() before the assembly. They are written here only if they are still set
+        // (i.e. the matrix is modified after solving), so the assembly threads do not bounce their cache line.
+        if (symmetric.load(std::memory_order_relaxed)) symmetric.store(false, std::memory_order_relaxed);
+        if (prepared.load(std::memory_order_relaxed)) prepared.store(false, std::memory_order_relaxed);
+        return data[find(r, c)];
+    }
+
+    void clear() override {
+        FemMatrix::clear();
+        symmetric = prepared = false;
+    }
+
+    /**
+     * Build the multigrid preconditioner.
+     * If \c reuse_tolerance is non-negative, the previous one is kept for unchanged matrix. If it is positive, the
+     * previous preconditioner is also kept for modified matrix as long as it does not double the number of iterations.
+     */
+    void factorize() override {
+        if (prepared) return;
+        if (reuse_tolerance >= 0. && amg.size() != 0 &&
+            (fingerprint() == amg_fingerprint || (reuse_tolerance > 0. && last_iters <= 2 * fresh_iters))) {
+            solver->writelog(LOG_DETAIL, "Reusing algebraic multigrid preconditioner");
+            prepared = true;
+            return;
+        }
+        solver->writelog(LOG_DETAIL, "Building algebraic multigrid preconditioner");
+        amg_fingerprint = fingerprint();
+        symmetrize();
+        amg.build(rank, rows.data(), cols.data(), data);
+        solver->writelog(LOG_DEBUG, "Multigrid preconditioner has {} levels", amg.size());
+        prepared = true;
+        fresh_iters = -1;
+    }
+
+    void solverhs(DataVector<double>& B, DataVector<double>& X) override {
+        factorize();
+
+        solver->writelog(LOG_DETAIL, "Iterating linear system");
+
+        assert(B.size() == rank);
+
+        DataVector<double> U;
+        if (X.data() == nullptr || X.data() == B.data())
+            U.reset(B.size(), 0.);
+        else
+            U = X;
+        assert(U.size() == B.size());
+
+        DataVector<double> R(rank), Z(rank), P(rank), Q(rank);
+
+        double bnorm = dot(B, B);
+        if (bnorm == 0.) bnorm = 1.;
+
+        mult(U, R);
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < rank; ++i) R[i] = B[i] - R[i];
+
+        double err = std::sqrt(dot(R, R) / bnorm);
+        int iter = 0;
+        double rz = 0.;
+
+        while (err > params->maxerr && iter < params->maxit) {
+            amg.apply(R.data(), Z.data());
+            double rz1 = dot(R, Z);
+            if (iter == 0) {
+                std::copy(Z.begin(), Z.end(), P.begin());
+            } else {
+                double beta = rz1 / rz;
+                #pragma omp parallel for
+                for (openmp_size_t i = 0; i < rank; ++i) P[i] = Z[i] + beta * P[i];
+            }
+            rz = rz1;
+            mult(P, Q);
+            double pq = dot(P, Q);
+            if (pq <= 0.) throw ComputationError(solver->getId(), "Stiffness matrix is not positive definite");
+            double alpha = rz / pq;
+            #pragma omp parallel for
+            for (openmp_size_t i = 0; i < rank; ++i) {
+                U[i] += alpha * P[i];
+                R[i] -= alpha * Q[i];
+            }
+            err = std::sqrt(dot(R, R) / bnorm);
+            ++iter;
+        }
+
+        params->iters = iter;
+        params->err = err;
+        last_iters = iter;
+        if (fresh_iters < 0) fresh_iters = std::max(iter, 1);
+
+        if (err > params->maxerr) {
+            params->converged = false;
+            switch (params->no_convergence_behavior) {
+                case IterativeMatrixParams::NO_CONVERGENCE_ERROR:
+                    throw ComputationError(solver->getId(), "Failed to converge in {} iterations (error {})", iter, err);
+                case IterativeMatrixParams::NO_CONVERGENCE_WARNING:
+                    solver->writelog(LOG_WARNING, "Failed to converge in {} iterations (error {})", iter, err);
+                    break;
+                case IterativeMatrixParams::NO_CONVERGENCE_CONTINUE:
+                    solver->writelog(LOG_DETAIL, "Did not converge yet in {} iterations (error {})", iter, err);
+                    break;
+            }
+        } else {
+            solver->writelog(LOG_DETAIL, "Converged after {} iterations (error {})", iter, err);
+            params->converged = true;
+        }
+
+        if (X.data() != U.data()) X = U;
+    }
+
+    void mult(const DataVector<const double>& vector, DataVector<double>& result) override {
+        symmetrize();
+        #pragma omp parallel for
+        for (openmp_size_t r = 0; r < rank; ++r) {
+            double s = 0.;
+            for (size_t k = rows[r]; k < rows[r + 1]; ++k) s += data[k] * vector[cols[k]];
+            result[r] = s;
+        }
+    }
+
+    void addmult(const DataVector<const double>& vector, DataVector<double>& result) override {
+        symmetrize();
+        #pragma omp parallel for
+        for (openmp_size_t r = 0; r < rank; ++r) {
+            double s = 0.;
+            for (size_t k = rows[r]; k < rows[r + 1]; ++k) s += data[k] * vector[cols[k]];
+            result[r] += s;
+        }
+    }
+
+    void setBC(DataVector<double>& B, size_t r, double val) override {
+        for (size_t k = rows[r]; k < rows[r + 1]; ++k) {
+            size_t c = cols[k];
+            if (c == r) {
+                data[k] = 1.;
+                continue;
+            }
+            size_t ku = (c > r) ? k : mirror[k];  // upper triangle element
+            B[c] -= data[ku] * val;
+            data[k] = data[mirror[k]] = 0.;
+        }
+        B[r] = val;
+        symmetric = prepared = false;
+    }
+
+    std::string describe() const override { return format("rank={}, nonzeros={}", rank, size); }
+
+  protected:
+    /// Find index of the element in the stored data
+    size_t find(size_t r, size_t c) const {
+        assert(r < rank && c < rank);
+        auto begin = cols.begin() + rows[r], end = cols.begin() + rows[r + 1];
+        auto found = std::lower_bound(begin, end, int(c));
+        assert(found != end && size_t(*found) == c);
+        return found - cols.begin();
+    }
+
+    /// Copy upper triangle to the lower one
+    void symmetrize() {
+        if (symmetric) return;
+        #pragma omp parallel for
+        for (openmp_size_t r = 0; r < rank; ++r) {
+            for (size_t k = rows[r]; k < rows[r + 1]; ++k)
+                if (size_t(cols[k]) < r) data[k] = data[mirror[k]];
+        }
+        symmetric = true;
+    }
+
+    double dot(const DataVector<double>& x, const DataVector<double>& y) const {
+        double s = 0.;
+#pragma omp parallel for reduction(+ : s)
+        for (openmp_size_t i = 0; i < rank; ++i) s += x[i] * y[i];
+        return s;
+    }
+};
+
+}  // namespace plask
+
+#endif  // PLASK_COMMON_FEM_CSR_MATRIX_H
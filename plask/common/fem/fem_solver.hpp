@@ -16,6 +16,8 @@
 
 #include <plask/plask.hpp>
 #include "cholesky_matrix.hpp"
+#include "coloring.hpp"
+#include "csr_matrix.hpp"
 #include "gauss_matrix.hpp"
 #include "iterative_matrix.hpp"
 
@@ -25,7 +27,35 @@ namespace plask {
 enum FemMatrixAlgorithm {
     ALGORITHM_CHOLESKY,  ///< Cholesky factorization
     ALGORITHM_GAUSS,     ///< Gauss elimination of asymmetric matrix (slower but safer as it uses pivoting)
-    ALGORITHM_ITERATIVE  ///< Conjugate gradient iterative solver
+    ALGORITHM_ITERATIVE, ///< Conjugate gradient iterative solver
+    ALGORITHM_SPARSE     ///< Conjugate gradient with algebraic multigrid preconditioner on native sparse matrix
+};
+
+/// Indices of the element nodes for CSR pattern
+template <int DIM> struct FemElementNodes;
+
+template <> struct FemElementNodes<2> {
+    template <typename ElementT> size_t operator()(const ElementT& elem, size_t* idx) const {
+        idx[0] = elem.getLoLoIndex();
+        idx[1] = elem.getUpLoIndex();
+        idx[2] = elem.getLoUpIndex();
+        idx[3] = elem.getUpUpIndex();
+        return 4;
+    }
+};
+
+template <> struct FemElementNodes<3> {
+    template <typename ElementT> size_t operator()(const ElementT& elem, size_t* idx) const {
+        idx[0] = elem.getLoLoLoIndex();
+        idx[1] = elem.getUpLoLoIndex();
+        idx[2] = elem.getLoUpLoIndex();
+        idx[3] = elem.getUpUpLoIndex();
+        idx[4] = elem.getLoLoUpIndex();
+        idx[5] = elem.getUpLoUpIndex();
+        idx[6] = elem.getLoUpUpIndex();
+        idx[7] = elem.getUpUpUpIndex();
+        return 8;
+    }
 };
 
 template <typename SpaceT, typename MeshT> struct FemSolverWithMesh : public SolverWithMesh<SpaceT, MeshT> {
@@ -33,6 +63,9 @@ template <typename SpaceT, typename MeshT> struct FemSolverWithMesh : public Sol
 
     IterativeMatrixParams iter_params;  ///< Parameters of iterative solver
 
+    /// Relative residual below which the previous matrix factorization is reused in subsequent loops (negative to disable)
+    double reuse_tolerance = -1.;
+
     FemSolverWithMesh(const std::string& name = "") : SolverWithMesh<SpaceT, MeshT>(name) {}
 
     bool parseFemConfiguration(XMLReader& reader, Manager& manager) {
@@ -41,7 +74,9 @@ template <typename SpaceT, typename MeshT> struct FemSolverWithMesh : public Sol
                             .value("cholesky", ALGORITHM_CHOLESKY)
                             .value("gauss", ALGORITHM_GAUSS)
                             .value("iterative", ALGORITHM_ITERATIVE)
+                            .value("sparse", ALGORITHM_SPARSE)
                             .get(algorithm);
+            reuse_tolerance = reader.getAttribute<double>("reuse-tolerance", reuse_tolerance);
 
             if (reader.requireTagOrEnd("iterative")) {
                 iter_params.accelerator = reader.enumAttribute<IterativeMatrixParams::Accelelator>("accelerator")
@@ -110,19 +145,32 @@ template <typename SpaceT, typename MeshT> struct FemSolverWithMesh : public Sol
         return false;
     }
 
-    inline FemMatrix* getMatrix();
+    /// Create matrix for the chosen algorithm
+    FemMatrix* getMatrix() {
+        FemMatrix* matrix = createMatrix();
+        matrix->reuse_tolerance = reuse_tolerance;
+        return matrix;
+    }
+
+  protected:
+    FemElementColoring elementColoring;  ///< Cached colors of the mesh elements for parallel assembly
+
+    inline FemMatrix* createMatrix();
 };
 
-template <typename SpaceT, typename MeshT> inline FemMatrix* FemSolverWithMesh<SpaceT, MeshT>::getMatrix() {
+template <typename SpaceT, typename MeshT> inline FemMatrix* FemSolverWithMesh<SpaceT, MeshT>::createMatrix() {
     switch (algorithm) {
         case ALGORITHM_CHOLESKY: return new DpbMatrix(this, this->mesh->size(), this->mesh->minorAxis()->size() + 1);
         case ALGORITHM_GAUSS: return new DgbMatrix(this, this->mesh->size(), this->mesh->minorAxis()->size() + 1);
         case ALGORITHM_ITERATIVE: return new SparseBandMatrix(this, this->mesh->size(), this->mesh->minorAxis()->size());
+        case ALGORITHM_SPARSE:
+            return new CsrMatrix(this, this->mesh->size(),
+                                 CsrPattern(this->mesh->size(), this->mesh->elements(), FemElementNodes<MeshT::DIM>()));
     }
     return nullptr;
 }
 
-template <> inline FemMatrix* FemSolverWithMesh<Geometry3D, RectangularMesh<3>>::getMatrix() {
+template <> inline FemMatrix* FemSolverWithMesh<Geometry3D, RectangularMesh<3>>::createMatrix() {
     size_t band = this->mesh->minorAxis()->size() * (this->mesh->mediumAxis()->size() + 1) + 1;
     switch (algorithm) {
         case ALGORITHM_CHOLESKY: return new DpbMatrix(this, this->mesh->size(), band);
@@ -130,6 +178,8 @@ template <> inline FemMatrix* FemSolverWithMesh<Geometry3D, RectangularMesh<3>>:
         case ALGORITHM_ITERATIVE:
             return new SparseBandMatrix(this, this->mesh->size(), mesh->mediumAxis()->size() * mesh->minorAxis()->size(),
                                         mesh->minorAxis()->size());
+        case ALGORITHM_SPARSE:
+            return new CsrMatrix(this, this->mesh->size(), CsrPattern(this->mesh->size(), this->mesh->elements(), FemElementNodes<3>()));
     }
     return nullptr;
 }
@@ -179,9 +229,16 @@ template <typename SpaceT, typename MeshT> struct FemSolverWithMaskedMesh : publ
         return FemSolverWithMesh<SpaceT, MeshT>::parseFemConfiguration(reader, manager);
     }
 
+    /// Check if the empty elements are included in the masked mesh
+    bool includesEmptyElements() const {
+        return empty_elements == EMPTY_ELEMENTS_INCLUDED ||
+               (this->algorithm == ALGORITHM_ITERATIVE && empty_elements == EMPTY_ELEMENTS_DEFAULT);
+    }
+
     void setupMaskedMesh() {
-        if (empty_elements == EMPTY_ELEMENTS_INCLUDED ||
-            (this->algorithm == ALGORITHM_ITERATIVE && empty_elements == EMPTY_ELEMENTS_DEFAULT)) {
+        this->elementColoring.reset();
+        reusableMatrix.reset();
+        if (includesEmptyElements()) {
             maskedMesh->selectAll(*this->mesh);
         } else {
             maskedMesh->reset(*this->mesh, *this->geometry, ~plask::Material::EMPTY);
@@ -190,12 +247,43 @@ template <typename SpaceT, typename MeshT> struct FemSolverWithMaskedMesh : publ
 
     void onInitialize() { setupMaskedMesh(); }
 
-    inline FemMatrix* getMatrix();
+    /// Create matrix for the chosen algorithm
+    FemMatrix* getMatrix() {
+        FemMatrix* matrix = createMatrix();
+        matrix->reuse_tolerance = this->reuse_tolerance;
+        return matrix;
+    }
+
+    /**
+     * Get matrix for the chosen algorithm, which is kept between computations if \c reuse_tolerance is non-negative.
+     * So its factorization can be reused in subsequent calls to \c compute (e.g. in the outer self-consistent loop).
+     * The matrix is dropped when the masked mesh is set up anew or the algorithm changes.
+     * Call releaseMatrix() after the computations.
+     */
+    FemMatrix& getReusableMatrix() {
+        if (!reusableMatrix || reusableMatrixAlgorithm != this->algorithm) {
+            reusableMatrix.reset(createMatrix());
+            reusableMatrixAlgorithm = this->algorithm;
+        }
+        reusableMatrix->reuse_tolerance = this->reuse_tolerance;
+        return *reusableMatrix;
+    }
+
+    /// Free the matrix obtained with getReusableMatrix(), unless its factorization is to be reused
+    void releaseMatrix() {
+        if (this->reuse_tolerance < 0.) reusableMatrix.reset();
+    }
+
+  protected:
+    std::unique_ptr<FemMatrix> reusableMatrix;      ///< Matrix kept between computations
+    FemMatrixAlgorithm reusableMatrixAlgorithm;     ///< Algorithm for which \c reusableMatrix has been created
+
+    inline FemMatrix* createMatrix();
 };
 
-template <typename SpaceT, typename MeshT> inline FemMatrix* FemSolverWithMaskedMesh<SpaceT, MeshT>::getMatrix() {
+template <typename SpaceT, typename MeshT> inline FemMatrix* FemSolverWithMaskedMesh<SpaceT, MeshT>::createMatrix() {
     size_t band;
-    if (empty_elements == EMPTY_ELEMENTS_INCLUDED || this->algorithm == ALGORITHM_ITERATIVE) {
+    if (empty_elements == EMPTY_ELEMENTS_INCLUDED || this->algorithm == ALGORITHM_ITERATIVE || this->algorithm == ALGORITHM_SPARSE) {
         band = this->mesh->minorAxis()->size() + 1;
     } else {
         band = 0;
@@ -212,13 +300,16 @@ template <typename SpaceT, typename MeshT> inline FemMatrix* FemSolverWithMasked
                 return new SparseBandMatrix(this, this->maskedMesh->size(), this->mesh->minorAxis()->size());
             else
                 return new SparseFreeMatrix(this, this->maskedMesh->size(), this->maskedMesh->elements().size() * 10);
+        case ALGORITHM_SPARSE:
+            return new CsrMatrix(this, this->maskedMesh->size(),
+                                 CsrPattern(this->maskedMesh->size(), this->maskedMesh->elements(), FemElementNodes<MeshT::DIM>()));
     }
     return nullptr;
 }
 
-template <> inline FemMatrix* FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>::getMatrix() {
+template <> inline FemMatrix* FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>::createMatrix() {
     size_t band;
-    if (empty_elements || algorithm == ALGORITHM_ITERATIVE) {
+    if (empty_elements || algorithm == ALGORITHM_ITERATIVE || algorithm == ALGORITHM_SPARSE) {
         band = this->mesh->minorAxis()->size() * (this->mesh->mediumAxis()->size() + 1) + 1;
     } else {
         band = 0;
@@ -236,6 +327,9 @@ template <> inline FemMatrix* FemSolverWithMaskedMesh<Geometry3D, RectangularMes
                                             mesh->minorAxis()->size());
             else
                 return new SparseFreeMatrix(this, this->maskedMesh->size(), this->maskedMesh->elements().size() * 36);
+        case ALGORITHM_SPARSE:
+            return new CsrMatrix(this, this->maskedMesh->size(),
+                                 CsrPattern(this->maskedMesh->size(), this->maskedMesh->elements(), FemElementNodes<3>()));
     }
     return nullptr;
 }
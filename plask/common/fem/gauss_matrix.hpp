@@ -29,10 +29,10 @@ F77SUB dgbmv(const char& trans,
              double* a,
              const int& lda,
              const double* x,
-             int incx,
+             const int& incx,
              const double& beta,
              double* y,
-             int incy);
+             const int& incy);
 
 // LAPACK routines to solve set of linear equations
 #define dgbtrf F77_GLOBAL(dgbtrf, DGBTRF)
@@ -96,7 +96,7 @@ struct DgbMatrix : BandMatrix {
         mirror();
 
         // Factorize matrix
-        dgbtrf(int(rank), int(rank), int(kd), int(kd), data, int(ld + 1), ipiv.get(), info);
+        dgbtrf(int(rank), int(rank), int(kd), int(kd), factorizationData(), int(ld + 1), ipiv.get(), info);
         if (info < 0) {
             throw CriticalException("{0}: Argument {1} of `dgbtrf` has illegal value", solver->getId(), -info);
         } else if (info > 0) {
@@ -108,7 +108,7 @@ struct DgbMatrix : BandMatrix {
         solver->writelog(LOG_DETAIL, "Solving matrix system");
 
         int info = 0;
-        dgbtrs('N', int(rank), int(kd), int(kd), 1, data, int(ld + 1), ipiv.get(), B.data(), int(B.size()), info);
+        dgbtrs('N', int(rank), int(kd), int(kd), 1, factorizedData(), int(ld + 1), ipiv.get(), B.data(), int(B.size()), info);
         if (info < 0) throw CriticalException("{0}: Argument {1} of `dgbtrs` has illegal value", solver->getId(), -info);
 
         std::swap(B, X);
@@ -121,7 +121,7 @@ struct DgbMatrix : BandMatrix {
      */
     void mult(const DataVector<const double>& vector, DataVector<double>& result) {
         mirror();
-        dgbmv('N', int(rank), int(rank), int(kd), int(kd), 1.0, data, int(ld) + 1, vector.data(), 1, 0.0, result.data(), 1);
+        dgbmv('N', int(rank), int(rank), int(kd), int(kd), 1.0, data + kd, int(ld) + 1, vector.data(), 1, 0.0, result.data(), 1);
     }
 
     /**
@@ -131,7 +131,7 @@ struct DgbMatrix : BandMatrix {
      */
     void addmult(const DataVector<const double>& vector, DataVector<double>& result) {
         mirror();
-        dgbmv('N', int(rank), int(rank), int(kd), int(kd), 1.0, data, int(ld) + 1, vector.data(), 1, 1.0, result.data(), 1);
+        dgbmv('N', int(rank), int(rank), int(kd), int(kd), 1.0, data + kd, int(ld) + 1, vector.data(), 1, 1.0, result.data(), 1);
     }
 
   private:
@@ -519,8 +519,10 @@ struct SparseFreeMatrix : SparseMatrix {
         return data[inz++];
     }
 
+    bool isConcurrent() const override { return false; }
+
     void clear() override {
-        std::fill_n(data, size, 0.);
+        parallel_fill_n(data, size, 0.);
         inz = rank;
     }
 
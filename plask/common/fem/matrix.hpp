@@ -24,6 +24,15 @@ struct FemMatrix {
     double* data;          ///< Pointer to data
     const Solver* solver;  ///< Solver owning the matrix
 
+    /**
+     * Relative residual, below which the previous factorization is reused for the modified matrix.
+     * Negative value means that the matrix is always factorized anew.
+     */
+    double reuse_tolerance = -1.;
+
+    /// Maximum number of iterative refinement steps done with the previous factorization
+    static constexpr int REFINEMENT_STEPS = 3;
+
     FemMatrix(const Solver* solver, size_t rank, size_t size)
         : rank(rank), size(size), data(aligned_malloc<double>(size)), solver(solver) {
         clear();
@@ -40,9 +49,12 @@ struct FemMatrix {
      **/
     virtual double& operator()(size_t r, size_t c) = 0;
 
+    /// Can distinct elements of the matrix be accessed concurrently from different threads?
+    virtual bool isConcurrent() const { return true; }
+
     /// Clear the matrix
     virtual void clear() {
-        std::fill_n(data, size, 0.);
+        parallel_fill_n(data, size, 0.);
     }
 
     /**
@@ -67,7 +79,20 @@ struct FemMatrix {
      * \param[inout] X initial estimate of the solution, on output contains the solution (may be interchanged with B)
      */
     void solve(DataVector<double>& B, DataVector<double>& X) {
+        uint64_t current = 0;
+        if (reuse_tolerance >= 0.) {
+            current = fingerprint();
+            if (canReuseFactorization()) {
+                if (current == factorized_fingerprint) {
+                    solver->writelog(LOG_DETAIL, "Matrix unchanged, reusing factorization");
+                    solverhs(B, X);
+                    return;
+                }
+                if (refine(B, X)) return;
+            }
+        }
         factorize();
+        factorized_fingerprint = current;
         solverhs(B, X);
     }
 
@@ -120,6 +145,59 @@ struct FemMatrix {
     virtual std::string describe() const {
         return format("rank={}, size={}", rank, size);
     }
+
+  protected:
+    uint64_t factorized_fingerprint = 0;  ///< Fingerprint of the matrix at the last factorization
+
+    /**
+     * Is there a previous factorization that can be reused?
+     * This is possible only if the factorized matrix is kept separately from the assembled one.
+     */
+    virtual bool canReuseFactorization() const { return false; }
+
+    /// Compute cheap fingerprint of the assembled matrix
+    uint64_t fingerprint() const {
+        const uint64_t* bits = reinterpret_cast<const uint64_t*>(data);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ bits[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    /**
+     * Try to solve the system using the previous factorization with iterative refinement
+     * \param B right hand side of the equation
+     * \param[out] X solution
+     * \return \c true if the refinement converged
+     */
+    bool refine(const DataVector<double>& B, DataVector<double>& X) {
+        double bnorm = 0.;
+        for (double b : B) bnorm += b * b;
+        if (bnorm == 0.) return false;
+        DataVector<double> U, D;
+        {
+            DataVector<double> F = B.copy();
+            solverhs(F, U);
+        }
+        for (int step = 0;; ++step) {
+            DataVector<double> R(rank);
+            for (size_t i = 0; i < rank; ++i) R[i] = -B[i];
+            addmult(U, R);
+            double rnorm = 0.;
+            for (double r : R) rnorm += r * r;
+            double err = std::sqrt(rnorm / bnorm);
+            if (err <= reuse_tolerance) {
+                solver->writelog(LOG_DETAIL, "Reused previous factorization ({} refinement steps, residual {:g})", step, err);
+                std::swap(X, U);
+                return true;
+            }
+            if (step == REFINEMENT_STEPS) {
+                solver->writelog(LOG_DEBUG, "Refinement with previous factorization failed (residual {:g})", err);
+                return false;
+            }
+            solverhs(R, D);
+            for (size_t i = 0; i < rank; ++i) U[i] -= D[i];
+        }
+    }
 };
 
 struct BandMatrix : FemMatrix {
@@ -129,6 +207,30 @@ struct BandMatrix : FemMatrix {
     BandMatrix(const Solver* solver, size_t rank, size_t kd, size_t ld)
         : FemMatrix(solver, rank, rank * (ld + 1)), ld(ld), kd(kd) {}
 
+  protected:
+    aligned_unique_ptr<double> factored;  ///< Separate copy of the factorized matrix (used if factorization is reused)
+
+    bool canReuseFactorization() const override { return bool(factored); }
+
+    /**
+     * Get data for factorization.
+     * If the factorization can be reused, the data is copied to a separate array first.
+     */
+    double* factorizationData() {
+        if (reuse_tolerance < 0.) {
+            factored.reset();
+            return data;
+        }
+        if (!factored) factored.reset(aligned_malloc<double>(size));
+        std::copy_n(data, size, factored.get());
+        return factored.get();
+    }
+
+    /// Get factorized data
+    double* factorizedData() { return factored ? factored.get() : data; }
+
+  public:
+
     void setBC(DataVector<double>& B, size_t r, double val) override {
         B[r] = val;
         (*this)(r, r) = 1.;
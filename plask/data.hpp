@@ -181,7 +181,7 @@ struct DataVector {
     DataVector(std::size_t size, const T& value): size_(size) {
         std::unique_ptr<typename std::remove_const<T>::type[], aligned_deleter<T>>
             data_non_const(aligned_malloc<VT>(size));
-        std::fill_n(data_non_const.get(), size, value);   // this may throw, but no memory leak than
+        parallel_fill_n(data_non_const.get(), size, value);   // this may throw, but no memory leak than
         gc_ = new Gc(1);
         data_ = data_non_const.release();
     }
@@ -395,7 +395,7 @@ struct DataVector {
     void reset(std::size_t size, const T& value) {
         std::unique_ptr<VT[], aligned_deleter<T>>
             data_non_const(aligned_malloc<VT>(size));
-        std::fill_n(data_non_const.get(), size, value);   // this may throw, than our data will not be changed
+        parallel_fill_n(data_non_const.get(), size, value);   // this may throw, than our data will not be changed
         dec_ref();
         gc_ = new Gc(1);    //this also may throw
         data_ = data_non_const.release();
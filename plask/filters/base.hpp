@@ -45,16 +45,21 @@ public:
      */
     boost::signals2::signal<void()> changed;
 
+    /**
+     * Signal called when the part of the output space, in which this source provides data, has been changed.
+     */
+    boost::signals2::signal<void()> regionsChanged;
+
     /*shared_ptr<OutputSpaceType> getDestinationSpace() const { return destinationSpace; }
 
     virtual void setDestinationSpace(shared_ptr<OutputSpaceType>) { this->destinationSpace = destinationSpace; }*/
 
-    /*
+    /**
      * Check if this source can provide value for given point.
      * @param p point, in outer space coordinates
      * @return @c true only if this can provide data in given point @p p
      */
-    //virtual bool canProvide(const Vec<OutputSpaceType::DIM, double>& p) const = 0;
+    virtual bool canProvide(const Vec<OutputSpaceType::DIM, double>&) const { return true; }
 
     /// Type of property value in output space
     typedef typename PropertyAt<PropertyT, OutputSpaceType>::ValueType ValueType;
@@ -107,16 +112,21 @@ public:
      */
     boost::signals2::signal<void()> changed;
 
+    /**
+     * Signal called when the part of the output space, in which this source provides data, has been changed.
+     */
+    boost::signals2::signal<void()> regionsChanged;
+
     /*shared_ptr<OutputSpaceType> getDestinationSpace() const { return destinationSpace; }
 
     virtual void setDestinationSpace(shared_ptr<OutputSpaceType>) { this->destinationSpace = destinationSpace; }*/
 
-    /*
+    /**
      * Check if this source can provide value for given point.
      * @param p point, in outer space coordinates
      * @return @c true only if this can provide data in given point @p p
      */
-    //virtual bool canProvide(const Vec<OutputSpaceType::DIM, double>& p) const = 0;
+    virtual bool canProvide(const Vec<OutputSpaceType::DIM, double>&) const { return true; }
 
     /// Type of property value in output space
     typedef typename PropertyAt<PropertyT, OutputSpaceType>::ValueType ValueType;
@@ -224,7 +234,10 @@ public:
 
     void inOrOutWasChanged(GeometryObject::Event& e) {
         if (e.hasFlag(GeometryObject::Event::EVENT_DELETE)) disconnect(); else
-        if (e.hasFlag(GeometryObject::Event::EVENT_RESIZE)) calcConnectionParameters();
+        if (e.hasFlag(GeometryObject::Event::EVENT_RESIZE)) {
+            calcConnectionParameters();
+            this->regionsChanged();
+        }
     }
 
     void connect(InputGeomObj& inputObj, OutputGeomObj& outputObj, const PathHints* path = nullptr) {
@@ -235,6 +248,7 @@ public:
         geomConnectionOut = outputObj.changedConnectMethod(this, &DataSourceWithReceiver::inOrOutWasChanged);
         geomConnectionIn = inputObj.changedConnectMethod(this, &DataSourceWithReceiver::inOrOutWasChanged);
         calcConnectionParameters();
+        this->regionsChanged();
     }
 };
 
@@ -289,6 +303,10 @@ struct InnerDataSource: public DataSourceWithReceiver<PropertyT, OutputSpaceType
         return regions.size();
     }
 
+    bool canProvide(const OutVec& p) const override {
+        return findRegionIndex(p) != regions.size();
+    }
+
     void calcConnectionParameters() override {
         regions.clear();
         std::vector<OutVec> pos = this->outputObj->getObjectPositions(*this->inputObj, this->getPath());
@@ -141,15 +141,7 @@ struct DataFromCyl2Dto3DSourceImpl<PropertyT, FIELD_PROPERTY, VariadicTemplateTy
         }
 
         plask::optional<ValueType> operator()(std::size_t index) {
-            Vec<3, double> p = dst_mesh->at(index);
-            std::size_t region_index = source.findRegionIndex(p,
-                        [&](const Region& r) {
-                            //check if p can be in cylinder inside r
-                            const Vec<3, double> v = p - r.inTranslation;  // r.inTranslation points to center of cylinder base
-                            const double distance_from_center_sqr = std::fma(v.rad_p(), v.rad_p(), v.rad_r() * v.rad_r());
-                            return this->source.r_sqr_begin <= distance_from_center_sqr && distance_from_center_sqr <= this->source.r_sqr_end;
-                        }
-            );
+            std::size_t region_index = source.findCylinderRegionIndex(dst_mesh->at(index));
             if (region_index == source.regions.size())
                 return plask::optional<ValueType>();
 
@@ -161,6 +153,26 @@ struct DataFromCyl2Dto3DSourceImpl<PropertyT, FIELD_PROPERTY, VariadicTemplateTy
 
     };
 
+    /**
+     * Find region which has @p p inside the cylinder obtained by revolution of the input object.
+     * @param p point (in outer space coordinates)
+     * @return index of the found region or number of regions if @p p is not inside any of them
+     */
+    std::size_t findCylinderRegionIndex(const Vec<3, double>& p) const {
+        return this->findRegionIndex(p,
+                    [&](const Region& r) {
+                        //check if p can be in cylinder inside r
+                        const Vec<3, double> v = p - r.inTranslation;  // r.inTranslation points to center of cylinder base
+                        const double distance_from_center_sqr = std::fma(v.rad_p(), v.rad_p(), v.rad_r() * v.rad_r());
+                        return this->r_sqr_begin <= distance_from_center_sqr && distance_from_center_sqr <= this->r_sqr_end;
+                    }
+        );
+    }
+
+    bool canProvide(const Vec<3, double>& p) const override {
+        return findCylinderRegionIndex(p) != this->regions.size();
+    }
+
     void calcConnectionParameters() override {
         InnerDataSource<PropertyT, Geometry3D, Geometry2DCylindrical, Geometry3D, Revolution>::calcConnectionParameters();
         auto child = this->inputObj->getChild();
@@ -219,15 +231,7 @@ struct DataFromCyl2Dto3DSourceImpl<PropertyT, MULTI_FIELD_PROPERTY, VariadicTemp
         }
 
         plask::optional<ValueType> operator()(std::size_t index) {
-            Vec<3, double> p = dst_mesh->at(index);
-            std::size_t region_index = source.findRegionIndex(p,
-                        [&](const Region& r) {
-                            //check if p can be in cylinder inside r
-                            const Vec<3, double> v = p - r.inTranslation;  // r.inTranslation points to center of cylinder base
-                            const double distance_from_center_sqr = std::fma(v.rad_p(), v.rad_p(), v.rad_r() * v.rad_r());
-                            return this->source.r_sqr_begin <= distance_from_center_sqr && distance_from_center_sqr <= this->source.r_sqr_end;
-                        }
-            );
+            std::size_t region_index = source.findCylinderRegionIndex(dst_mesh->at(index));
             if (region_index == source.regions.size())
                 return plask::optional<ValueType>();
 
@@ -239,6 +243,26 @@ struct DataFromCyl2Dto3DSourceImpl<PropertyT, MULTI_FIELD_PROPERTY, VariadicTemp
 
     };
 
+    /**
+     * Find region which has @p p inside the cylinder obtained by revolution of the input object.
+     * @param p point (in outer space coordinates)
+     * @return index of the found region or number of regions if @p p is not inside any of them
+     */
+    std::size_t findCylinderRegionIndex(const Vec<3, double>& p) const {
+        return this->findRegionIndex(p,
+                    [&](const Region& r) {
+                        //check if p can be in cylinder inside r
+                        const Vec<3, double> v = p - r.inTranslation;  // r.inTranslation points to center of cylinder base
+                        const double distance_from_center_sqr = std::fma(v.rad_p(), v.rad_p(), v.rad_r() * v.rad_r());
+                        return this->r_sqr_begin <= distance_from_center_sqr && distance_from_center_sqr <= this->r_sqr_end;
+                    }
+        );
+    }
+
+    bool canProvide(const Vec<3, double>& p) const override {
+        return findCylinderRegionIndex(p) != this->regions.size();
+    }
+
     void calcConnectionParameters() override {
         InnerDataSource<PropertyT, Geometry3D, Geometry2DCylindrical, Geometry3D, Revolution>::calcConnectionParameters();
         auto child = this->inputObj->getChild();
@@ -14,9 +14,14 @@
 #ifndef PLASK__FILTER_H
 #define PLASK__FILTER_H
 
+#include <atomic>
+#include <numeric>
+
 #include "translation.hpp"
 #include "change_space_size.hpp"
 #include "change_space_size_cyl.hpp"
+#include "../mesh/utils.hpp"
+#include "../parallel.hpp"
 
 namespace plask {
 
@@ -25,6 +30,66 @@ struct FilterCommonBase: public Solver {
     FilterCommonBase(Args&&... args): Solver(std::forward<Args>(args)...) {}
 };
 
+namespace detail {
+
+    /**
+     * Get all values of the filter data at once.
+     * Points are grouped by the source which can provide them and each source is asked for its data only once,
+     * for the sub-mesh of its points. Points which are not provided by any inner source are taken from the outer source.
+     * @param dst_mesh destination mesh
+     * @param regionMap index of the first inner source which can provide value in each point (null if there are no inner sources)
+     * @param count number of inner sources
+     * @param getData function returning data of the source with given index in given mesh (index @p count means the outer source)
+     * @return values in all points of @p dst_mesh
+     */
+    template <typename ValueType, int DIM, typename GetDataF>
+    DataVector<const ValueType> filterGetAll(const shared_ptr<const MeshD<DIM>>& dst_mesh,
+                                             const std::vector<std::uint32_t>* regionMap,
+                                             std::size_t count,
+                                             GetDataF getData) {
+        const std::size_t size = dst_mesh->size();
+        DataVector<ValueType> result(size);
+
+        // Indices of the points to take from each inner source and, at the end, from the outer one
+        std::vector<std::vector<std::size_t>> pending(count + 1);
+        if (regionMap) {
+            for (std::size_t i = 0; i < size; ++i) pending[(*regionMap)[i]].push_back(i);
+        } else {
+            pending[count].resize(size);
+            std::iota(pending[count].begin(), pending[count].end(), std::size_t(0));
+        }
+
+        std::exception_ptr error;
+        for (std::size_t source_index = 0; source_index <= count; ++source_index) {
+            const std::vector<std::size_t>& indices = pending[source_index];
+            if (indices.empty()) continue;
+            // the source is asked for the whole mesh only if it is to provide all the points
+            const bool whole = indices.size() == size;
+            std::function<plask::optional<ValueType>(std::size_t)> data =
+                getData(source_index, whole ? dst_mesh : plask::make_shared<IndexedSubMesh<DIM>>(dst_mesh, indices));
+            std::vector<plask::optional<ValueType>> values(indices.size());
+            #pragma omp parallel for
+            for (openmp_size_t k = 0; k < values.size(); ++k) {
+                if (error) continue;
+                try {
+                    values[k] = data(whole ? indices[k] : k);
+                } catch(...) {
+                    #pragma omp critical
+                    error = std::current_exception();
+                }
+            }
+            if (error) std::rethrow_exception(error);
+            // points not provided by this source are passed to the next one
+            for (std::size_t k = 0; k < values.size(); ++k) {
+                if (values[k]) result[indices[k]] = *values[k];
+                else if (source_index < count) pending[source_index+1].push_back(indices[k]);
+            }
+        }
+        return result;
+    }
+
+}   // namespace detail
+
 /// Don't use this directly, use FilterBase or Filter instead.
 template <typename PropertyT, PropertyType propertyType, typename OutputSpaceType, typename VariadicTemplateTypesHolder>
 struct FilterBaseImpl {
@@ -47,27 +112,55 @@ struct FilterBaseImpl< PropertyT, FIELD_PROPERTY, OutputSpaceType, VariadicTempl
 
     struct FilterLazyDataImpl: public LazyDataImpl<ValueType> {
 
-        DataSourceF outerSourceData;
+        /// Inner sources of the filter (shared with it, so the data stays valid when the filter is changed or deleted)
+        std::vector<shared_ptr<const DataSourceT>> innerSources;
 
-        std::vector<DataSourceF> innerSourcesData;
+        /// Outer source of the filter
+        shared_ptr<const DataSourceT> outerSource;
 
-        /*const FilterBaseImpl< PropertyT, FIELD_PROPERTY, OutputSpaceType, VariadicTemplateTypesHolder<ExtraArgs...> >& filter;*/
         shared_ptr<const MeshD<OutputSpaceType::DIM>> dst_mesh;
-        //std::tuple<ExtraArgs...> extra_args;
-        //InterpolationMethod method;
+        std::tuple<ExtraArgs...> extra_args;
+        InterpolationMethod method;
+
+        /// Index of the first inner source which can provide value in each point of dst_mesh (null if there are no inner sources)
+        shared_ptr<const std::vector<std::uint32_t>> regionMap;
+
+        /// Data of the outer source in the whole dst_mesh (obtained on the first call of at)
+        mutable DataSourceF outerSourceData;
+
+        /// Data of the inner sources in the whole dst_mesh (obtained on the first call of at)
+        mutable std::vector<DataSourceF> innerSourcesData;
+
+        /// True if innerSourcesData and outerSourceData are already obtained
+        mutable std::atomic<bool> haveSourcesData;
+
+        /// Lock guarding obtaining of innerSourcesData and outerSourceData
+        mutable OmpLock sourcesDataLock;
 
         FilterLazyDataImpl(
                 const FilterBaseImpl< PropertyT, FIELD_PROPERTY, OutputSpaceType, VariadicTemplateTypesHolder<ExtraArgs...> >& filter,
                 const shared_ptr<const MeshD<OutputSpaceType::DIM>>& dst_mesh, ExtraArgs... extra_args, InterpolationMethod method
                 )
-            : innerSourcesData(filter.innerSources.size()), /*filter(filter),*/ dst_mesh(dst_mesh)/*, extra_args(extra_args...), method(method)*/ {
-            for (std::size_t source_index = 0; source_index < filter.innerSources.size(); ++source_index)
-                innerSourcesData[source_index] = filter.innerSources[source_index]->operator()(dst_mesh, std::forward<ExtraArgs>(extra_args)..., method);
-            outerSourceData = filter.outerSource->operator()(dst_mesh, std::forward<ExtraArgs>(extra_args)..., method);
+            : innerSources(filter.innerSources.begin(), filter.innerSources.end()), outerSource(filter.outerSource),
+              dst_mesh(dst_mesh), extra_args(extra_args...), method(method), regionMap(filter.getRegionMap(dst_mesh)),
+              haveSourcesData(false) {}
+
+        /// Obtain data of all the sources in the whole dst_mesh, if this has not been done yet
+        void obtainSourcesData() const {
+            if (haveSourcesData.load(std::memory_order_acquire)) return;
+            OmpLockGuard<OmpLock> lock(sourcesDataLock);
+            if (haveSourcesData.load(std::memory_order_relaxed)) return;
+            innerSourcesData.resize(innerSources.size());
+            for (std::size_t source_index = 0; source_index < innerSources.size(); ++source_index)
+                innerSourcesData[source_index] = innerSources[source_index]->operator()(dst_mesh, extra_args, method);
+            outerSourceData = outerSource->operator()(dst_mesh, extra_args, method);
+            haveSourcesData.store(true, std::memory_order_release);
         }
 
         ValueType at(std::size_t point_index) const override {
-            for (std::size_t source_index = 0; source_index < innerSourcesData.size(); ++source_index) {
+            obtainSourcesData();
+            // inner sources before the one found in the region map can't provide the value, so they are skipped
+            for (std::size_t source_index = regionMap ? (*regionMap)[point_index] : 0; source_index < innerSourcesData.size(); ++source_index) {
                 //if (!innerSourcesData[source_index])
                 //    innerSourcesData[source_index] = filter.innerSources[source_index]->operator()(dst_mesh, extra_args, method);
                 plask::optional<ValueType> v = innerSourcesData[source_index](point_index);
@@ -77,14 +170,61 @@ struct FilterBaseImpl< PropertyT, FIELD_PROPERTY, OutputSpaceType, VariadicTempl
             return *outerSourceData(point_index);
         }
 
+        DataVector<const ValueType> getAll() const override {
+            return detail::filterGetAll<ValueType>(dst_mesh, regionMap.get(), innerSources.size(),
+                [this] (std::size_t source_index, const shared_ptr<const MeshD<OutputSpaceType::DIM>>& mesh) {
+                    const DataSourceT& source = source_index < innerSources.size() ? *innerSources[source_index] : *outerSource;
+                    return source(mesh, extra_args, method);
+                });
+        }
+
         std::size_t size() const override { return dst_mesh->size(); }
 
     };
 
 protected:
-    std::vector<DataSourceTPtr> innerSources;
+    // Sources are shared with the data provided by the filter
+    std::vector<shared_ptr<DataSourceT>> innerSources;
+
+    shared_ptr<DataSourceT> outerSource;
+
+    /// Destination mesh for which regionMap has been computed
+    mutable SameMeshChecker regionMapMesh;
 
-    DataSourceTPtr outerSource;
+    /// Index of the first inner source which can provide value in each point of the recently used destination mesh
+    mutable shared_ptr<const std::vector<std::uint32_t>> regionMap;
+
+    /// Lock guarding regionMap and regionMapMesh, as providers can be called from many threads
+    mutable OmpLock regionMapLock;
+
+    /**
+     * Get index of the first inner source which can provide value in each point of @p dst_mesh.
+     * The map is cached until the destination mesh, the sources, or their placement in the geometry change.
+     * @param dst_mesh destination mesh
+     * @return region map or null if there are no inner sources
+     */
+    shared_ptr<const std::vector<std::uint32_t>> getRegionMap(const shared_ptr<const MeshD<OutputSpaceType::DIM>>& dst_mesh) const {
+        if (innerSources.empty()) return shared_ptr<const std::vector<std::uint32_t>>();
+        OmpLockGuard<OmpLock> lock(regionMapLock);
+        if (regionMapMesh(dst_mesh.get()) && regionMap) return regionMap;
+        auto map = plask::make_shared<std::vector<std::uint32_t>>(dst_mesh->size());
+        const std::uint32_t count = std::uint32_t(innerSources.size());
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < map->size(); ++i) {
+            const auto p = dst_mesh->at(i);
+            std::uint32_t source_index = 0;
+            while (source_index < count && !innerSources[source_index]->canProvide(p)) ++source_index;
+            (*map)[i] = source_index;
+        }
+        regionMap = map;
+        return regionMap;
+    }
+
+    /// Drop the cached region map
+    void resetRegionMap() {
+        OmpLockGuard<OmpLock> lock(regionMapLock);
+        regionMap.reset();
+    }
 
     /// Output space in which the results are provided.
     shared_ptr<OutputSpaceType> geometry;
@@ -104,6 +244,7 @@ protected:
         decltype(innerSource->in)& res = innerSource->in;
         this->innerSources.push_back(std::move(innerSource));
         connect(*this->innerSources.back());
+        resetRegionMap();
         return res;
     }
 
@@ -124,6 +265,12 @@ public:
         setDefault(PropertyAt<PropertyT, OutputSpaceType>::getDefaultValue());
     }
 
+    ~FilterBaseImpl() {
+        // sources can outlive the filter in the provided data, so they must not notify it any more
+        disconnect(outerSource);
+        for (const auto& innerSource: innerSources) disconnect(innerSource);
+    }
+
     std::string getClassName() const override { return "Filter"; }
 
     /**
@@ -188,6 +335,7 @@ public:
     void appendInner(DataSourceTPtr&& innerSource) {
         this->innerSources.push_back(std::move(innerSource));
         connect(*this->innerSources.back());
+        resetRegionMap();
         out.fireChanged();
     }
 
@@ -230,15 +378,22 @@ private:
         out.fireChanged();
     }
 
+    void onSourceRegionsChange() {
+        resetRegionMap();
+        out.fireChanged();
+    }
+
     void connect(DataSourceT& in) {
         in.changed.connect(boost::bind(&FilterBaseImpl::onSourceChange, this/*, _1, _2*/));
+        in.regionsChanged.connect(boost::bind(&FilterBaseImpl::onSourceRegionsChange, this));
     }
 
     void disconnect(DataSourceT& in) {
         in.changed.disconnect(boost::bind(&FilterBaseImpl::onSourceChange, this/*, _1, _2*/));
+        in.regionsChanged.disconnect(boost::bind(&FilterBaseImpl::onSourceRegionsChange, this));
     }
 
-    void disconnect(DataSourceTPtr& in) {
+    void disconnect(const shared_ptr<DataSourceT>& in) {
         if (in) disconnect(*in);
     }
 };
@@ -259,30 +414,57 @@ struct FilterBaseImpl< PropertyT, MULTI_FIELD_PROPERTY, OutputSpaceType, Variadi
 
     struct FilterLazyDataImpl: public LazyDataImpl<ValueType> {
 
-        DataSourceF outerSourceData;
+        /// Inner sources of the filter (shared with it, so the data stays valid when the filter is changed or deleted)
+        std::vector<shared_ptr<const DataSourceT>> innerSources;
 
-        std::vector<DataSourceF> innerSourcesData;
+        /// Outer source of the filter
+        shared_ptr<const DataSourceT> outerSource;
 
-        /*const FilterBaseImpl< PropertyT, MULTI_FIELD_PROPERTY, OutputSpaceType, VariadicTemplateTypesHolder<ExtraArgs...> >& filter;*/
         shared_ptr<const MeshD<OutputSpaceType::DIM>> dst_mesh;
-        //std::tuple<ExtraArgs...> extra_args;
-        //InterpolationMethod method;
+        std::tuple<ExtraArgs...> extra_args;
+        InterpolationMethod method;
+
+        /// Index of the first inner source which can provide value in each point of dst_mesh (null if there are no inner sources)
+        shared_ptr<const std::vector<std::uint32_t>> regionMap;
 
         EnumType num;
 
+        /// Data of the outer source in the whole dst_mesh (obtained on the first call of at)
+        mutable DataSourceF outerSourceData;
+
+        /// Data of the inner sources in the whole dst_mesh (obtained on the first call of at)
+        mutable std::vector<DataSourceF> innerSourcesData;
+
+        /// True if innerSourcesData and outerSourceData are already obtained
+        mutable std::atomic<bool> haveSourcesData;
+
+        /// Lock guarding obtaining of innerSourcesData and outerSourceData
+        mutable OmpLock sourcesDataLock;
+
         FilterLazyDataImpl(
                 const FilterBaseImpl< PropertyT, MULTI_FIELD_PROPERTY, OutputSpaceType, VariadicTemplateTypesHolder<ExtraArgs...> >& filter,
                 EnumType num, const shared_ptr<const MeshD<OutputSpaceType::DIM>>& dst_mesh, ExtraArgs... extra_args, InterpolationMethod method
                 )
-            : innerSourcesData(filter.innerSources.size()), /*filter(filter),*/ dst_mesh(dst_mesh)/*, extra_args(extra_args...), method(method)*/, num(num)
-        {
-            for (std::size_t source_index = 0; source_index < filter.innerSources.size(); ++source_index)
-                innerSourcesData[source_index] = filter.innerSources[source_index]->operator()(num, dst_mesh, std::forward<ExtraArgs>(extra_args)..., method);
-            outerSourceData = filter.outerSource->operator()(num, dst_mesh, std::forward<ExtraArgs>(extra_args)..., method);
+            : innerSources(filter.innerSources.begin(), filter.innerSources.end()), outerSource(filter.outerSource),
+              dst_mesh(dst_mesh), extra_args(extra_args...), method(method), regionMap(filter.getRegionMap(dst_mesh)), num(num),
+              haveSourcesData(false) {}
+
+        /// Obtain data of all the sources in the whole dst_mesh, if this has not been done yet
+        void obtainSourcesData() const {
+            if (haveSourcesData.load(std::memory_order_acquire)) return;
+            OmpLockGuard<OmpLock> lock(sourcesDataLock);
+            if (haveSourcesData.load(std::memory_order_relaxed)) return;
+            innerSourcesData.resize(innerSources.size());
+            for (std::size_t source_index = 0; source_index < innerSources.size(); ++source_index)
+                innerSourcesData[source_index] = innerSources[source_index]->operator()(num, dst_mesh, extra_args, method);
+            outerSourceData = outerSource->operator()(num, dst_mesh, extra_args, method);
+            haveSourcesData.store(true, std::memory_order_release);
         }
 
         ValueType at(std::size_t point_index) const override {
-            for (std::size_t source_index = 0; source_index < innerSourcesData.size(); ++source_index) {
+            obtainSourcesData();
+            // inner sources before the one found in the region map can't provide the value, so they are skipped
+            for (std::size_t source_index = regionMap ? (*regionMap)[point_index] : 0; source_index < innerSourcesData.size(); ++source_index) {
                 //if (!innerSourcesData[source_index])
                 //    innerSourcesData[source_index] = filter.innerSources[source_index]->operator()(dst_mesh, extra_args, method);
                 plask::optional<ValueType> v = innerSourcesData[source_index](point_index);
@@ -292,14 +474,61 @@ struct FilterBaseImpl< PropertyT, MULTI_FIELD_PROPERTY, OutputSpaceType, Variadi
             return *outerSourceData(point_index);
         }
 
+        DataVector<const ValueType> getAll() const override {
+            return detail::filterGetAll<ValueType>(dst_mesh, regionMap.get(), innerSources.size(),
+                [this] (std::size_t source_index, const shared_ptr<const MeshD<OutputSpaceType::DIM>>& mesh) {
+                    const DataSourceT& source = source_index < innerSources.size() ? *innerSources[source_index] : *outerSource;
+                    return source(num, mesh, extra_args, method);
+                });
+        }
+
         std::size_t size() const override { return dst_mesh->size(); }
 
     };
 
 protected:
-    std::vector<DataSourceTPtr> innerSources;
+    // Sources are shared with the data provided by the filter
+    std::vector<shared_ptr<DataSourceT>> innerSources;
+
+    shared_ptr<DataSourceT> outerSource;
 
-    DataSourceTPtr outerSource;
+    /// Destination mesh for which regionMap has been computed
+    mutable SameMeshChecker regionMapMesh;
+
+    /// Index of the first inner source which can provide value in each point of the recently used destination mesh
+    mutable shared_ptr<const std::vector<std::uint32_t>> regionMap;
+
+    /// Lock guarding regionMap and regionMapMesh, as providers can be called from many threads
+    mutable OmpLock regionMapLock;
+
+    /**
+     * Get index of the first inner source which can provide value in each point of @p dst_mesh.
+     * The map is cached until the destination mesh, the sources, or their placement in the geometry change.
+     * @param dst_mesh destination mesh
+     * @return region map or null if there are no inner sources
+     */
+    shared_ptr<const std::vector<std::uint32_t>> getRegionMap(const shared_ptr<const MeshD<OutputSpaceType::DIM>>& dst_mesh) const {
+        if (innerSources.empty()) return shared_ptr<const std::vector<std::uint32_t>>();
+        OmpLockGuard<OmpLock> lock(regionMapLock);
+        if (regionMapMesh(dst_mesh.get()) && regionMap) return regionMap;
+        auto map = plask::make_shared<std::vector<std::uint32_t>>(dst_mesh->size());
+        const std::uint32_t count = std::uint32_t(innerSources.size());
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < map->size(); ++i) {
+            const auto p = dst_mesh->at(i);
+            std::uint32_t source_index = 0;
+            while (source_index < count && !innerSources[source_index]->canProvide(p)) ++source_index;
+            (*map)[i] = source_index;
+        }
+        regionMap = map;
+        return regionMap;
+    }
+
+    /// Drop the cached region map
+    void resetRegionMap() {
+        OmpLockGuard<OmpLock> lock(regionMapLock);
+        regionMap.reset();
+    }
 
     /// Output space in which the results are provided.
     shared_ptr<OutputSpaceType> geometry;
@@ -319,6 +548,7 @@ protected:
         decltype(innerSource->in)& res = innerSource->in;
         this->innerSources.push_back(std::move(innerSource));
         connect(*this->innerSources.back());
+        resetRegionMap();
         return res;
     }
 
@@ -347,6 +577,12 @@ public:
         setDefault(PropertyAt<PropertyT, OutputSpaceType>::getDefaultValue());
     }
 
+    ~FilterBaseImpl() {
+        // sources can outlive the filter in the provided data, so they must not notify it any more
+        disconnect(outerSource);
+        for (const auto& innerSource: innerSources) disconnect(innerSource);
+    }
+
     std::string getClassName() const override { return "Filter"; }
 
     /**
@@ -411,6 +647,7 @@ public:
     void appendInner(DataSourceTPtr&& innerSource) {
         this->innerSources.push_back(std::move(innerSource));
         connect(*this->innerSources.back());
+        resetRegionMap();
         out.fireChanged();
     }
 
@@ -453,15 +690,22 @@ private:
         out.fireChanged();
     }
 
+    void onSourceRegionsChange() {
+        resetRegionMap();
+        out.fireChanged();
+    }
+
     void connect(DataSourceT& in) {
         in.changed.connect(boost::bind(&FilterBaseImpl::onSourceChange, this/*, _1, _2*/));
+        in.regionsChanged.connect(boost::bind(&FilterBaseImpl::onSourceRegionsChange, this));
     }
 
     void disconnect(DataSourceT& in) {
         in.changed.disconnect(boost::bind(&FilterBaseImpl::onSourceChange, this/*, _1, _2*/));
+        in.regionsChanged.disconnect(boost::bind(&FilterBaseImpl::onSourceRegionsChange, this));
     }
 
-    void disconnect(DataSourceTPtr& in) {
+    void disconnect(const shared_ptr<DataSourceT>& in) {
         if (in) disconnect(*in);
     }
 };
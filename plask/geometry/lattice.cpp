@@ -440,6 +440,7 @@ void Lattice::refillContainer() {
             container->addUnsafe(this->_child, x * vec0 + p.first * vec1);
         }
     }
+    this->fireChanged(GeometryObject::Event::EVENT_RESIZE);
 }
 
 void Lattice::addPointsAlongToSet(std::set<double>& points,
@@ -272,7 +272,7 @@ struct PLASK_API Lattice : public GeometryObjectTransform<3> {
 
     // protected:
 
-    /// Use segments, vec0, vec1 to refill container.
+    /// Use segments, vec0, vec1 to refill container and notify the parents about the change.
     void refillContainer();
 };
 
@@ -175,7 +175,7 @@ template <int dim> struct PLASK_API GeometryObjectLeaf : public GeometryObjectD<
      */
     void setMaterial(shared_ptr<Material> new_material) {
         materialProvider.reset(new SolidMaterial(new_material));
-        this->fireChanged();
+        this->fireChanged(GeometryObject::Event::EVENT_MATERIAL);
     }
 
     /**
@@ -200,7 +200,7 @@ template <int dim> struct PLASK_API GeometryObjectLeaf : public GeometryObjectD<
      */
     void setMaterialTopBottomComposition(shared_ptr<MaterialsDB::MixedCompositionFactory> materialTopBottom) {
         setMaterialTopBottomCompositionFast(materialTopBottom);
-        this->fireChanged();
+        this->fireChanged(GeometryObject::Event::EVENT_MATERIAL);
     }
 
     /**
@@ -224,7 +224,7 @@ template <int dim> struct PLASK_API GeometryObjectLeaf : public GeometryObjectD<
      */
     void setMaterialProvider(MaterialProvider* provider) {
         setMaterialProviderFast(provider);
-        this->fireChanged();
+        this->fireChanged(GeometryObject::Event::EVENT_MATERIAL);
     }
 
     /**
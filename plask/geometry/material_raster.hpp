@@ -0,0 +1,254 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__GEOMETRY_MATERIAL_RASTER_H
+#define PLASK__GEOMETRY_MATERIAL_RASTER_H
+
+/** @file
+This file contains the raster of materials of the geometry at all points of a mesh.
+*/
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/signals2.hpp>
+
+#include "../material/material.hpp"
+#include "../mesh/mesh.hpp"
+#include "../parallel.hpp"
+
+namespace plask {
+
+/**
+ * Materials at all points of some mesh.
+ *
+ * Materials are stored as compact identifiers, which are indices in a small table of distinct materials. So solvers
+ * can look up materials of all their elements without traversing the geometry tree and without touching reference
+ * counters of the materials (which is costly when many threads do this).
+ *
+ * Rasters are obtained with GeometryD::getMaterialRaster, which caches them until the geometry or the mesh is changed.
+ */
+class PLASK_API MaterialRaster {
+  public:
+    /// Type of the material identifier
+    typedef std::uint16_t IdType;
+
+    /// Maximum number of distinct materials which can be identified
+    static constexpr std::size_t MAX_MATERIALS = std::size_t(std::numeric_limits<IdType>::max()) + 1;
+
+  private:
+    /// Table of distinct materials or materials at each point if there are too many of them
+    std::vector<shared_ptr<Material>> materials;
+
+    /// Material identifiers at each point (empty if there are too many distinct materials)
+    std::vector<IdType> ids;
+
+  public:
+    /**
+     * Resolve materials at all points
+     * \param size number of points
+     * \param getMaterial function returning the material at the point with the given index
+     */
+    template <typename MaterialGetter>
+    MaterialRaster(std::size_t size, MaterialGetter getMaterial) {
+        ids.reserve(size);
+        // Only pointers held in the table are stored here, so they cannot be reused by other materials
+        std::unordered_map<const Material*, IdType> known;
+        for (std::size_t i = 0; i != size; ++i) {
+            shared_ptr<Material> material = getMaterial(i);
+            auto found = known.find(material.get());
+            if (found != known.end()) {
+                ids.push_back(found->second);
+                continue;
+            }
+            // Materials with parameters varying in space (e.g. graded composition) are new objects at each point,
+            // however neighboring points often have the same parameters
+            if (i != 0 && *materials[ids.back()] == *material) {
+                ids.push_back(ids.back());
+                continue;
+            }
+            if (materials.size() == MAX_MATERIALS) {
+                // Too many distinct materials: store them separately for each point
+                std::vector<shared_ptr<Material>> all;
+                all.reserve(size);
+                for (IdType id: ids) all.push_back(materials[id]);
+                all.push_back(std::move(material));
+                for (++i; i != size; ++i) all.push_back(getMaterial(i));
+                materials.swap(all);
+                ids.clear();
+                ids.shrink_to_fit();
+                return;
+            }
+            known[material.get()] = IdType(materials.size());
+            ids.push_back(IdType(materials.size()));
+            materials.push_back(std::move(material));
+        }
+    }
+
+    /// Get number of points
+    std::size_t size() const { return isCompact() ? ids.size() : materials.size(); }
+
+    /**
+     * Check if the materials are stored as identifiers.
+     *
+     * This is \c false only if there are more than \ref MAX_MATERIALS distinct materials, in which case
+     * \ref getId and \ref getMaterials cannot be used.
+     */
+    bool isCompact() const { return !ids.empty() || materials.empty(); }
+
+    /**
+     * Get material at the given point
+     * \param index index of the point in the mesh
+     * \return material at this point
+     */
+    const shared_ptr<Material>& operator[](std::size_t index) const {
+        return isCompact() ? materials[ids[index]] : materials[index];
+    }
+
+    /**
+     * Get identifier of the material at the given point.
+     *
+     * Points with the same identifier have the same material.
+     * \param index index of the point in the mesh
+     * \return index of the material in the table returned by \ref getMaterials
+     */
+    IdType getId(std::size_t index) const {
+        assert(isCompact());
+        return ids[index];
+    }
+
+    /// Get table of distinct materials
+    const std::vector<shared_ptr<Material>>& getMaterials() const {
+        assert(isCompact());
+        return materials;
+    }
+};
+
+/**
+ * Cache of material rasters for the recently used meshes.
+ *
+ * Raster is dropped when its mesh is changed or deleted. The owner of the cache is responsible for clearing it
+ * when the materials in the geometry change.
+ */
+template <int dim>
+class MaterialRasterCache {
+
+    struct Entry {
+        const MeshD<dim>* mesh;
+        boost::signals2::connection connection;
+        shared_ptr<const MaterialRaster> raster;
+    };
+
+    std::vector<Entry> entries;
+
+    /// Default material for which the rasters were created
+    shared_ptr<Material> defaultMaterial;
+
+    OmpLock lock;
+
+    void onMeshChanged(const MeshD<dim>* mesh) {
+        OmpLockGuard<OmpLock> guard(lock);
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (entry->mesh == mesh) {
+                entry->connection.disconnect();
+                entries.erase(entry);
+                return;
+            }
+        }
+    }
+
+    void removeAll() {
+        for (auto& entry: entries) entry.connection.disconnect();
+        entries.clear();
+        defaultMaterial.reset();
+    }
+
+  public:
+    /// Maximum number of cached rasters
+    static constexpr std::size_t SIZE = 8;
+
+    MaterialRasterCache() = default;
+    MaterialRasterCache(const MaterialRasterCache&) {}
+    MaterialRasterCache& operator=(const MaterialRasterCache&) { clear(); return *this; }
+
+    ~MaterialRasterCache() { removeAll(); }
+
+    /// Remove all cached rasters
+    void clear() {
+        OmpLockGuard<OmpLock> guard(lock);
+        removeAll();
+    }
+
+    /**
+     * Update all cached rasters after the materials have been changed in some regions.
+     * Materials are looked up in the geometry only at the points inside the changed regions.
+     * \param boxes regions in which the materials have changed
+     * \param getMaterial function returning the material at the given point
+     */
+    template <typename BoxT, typename MaterialGetter>
+    void update(const std::vector<BoxT>& boxes, MaterialGetter getMaterial) {
+        OmpLockGuard<OmpLock> guard(lock);
+        for (auto& entry: entries) {
+            const MeshD<dim>* meshptr = entry.mesh;
+            shared_ptr<const MaterialRaster> old = entry.raster;
+            entry.raster = plask::make_shared<const MaterialRaster>(meshptr->size(), [&](std::size_t i) {
+                auto p = meshptr->at(i);
+                for (const auto& box: boxes)
+                    if (box.contains(p)) return getMaterial(p);
+                return (*old)[i];
+            });
+        }
+    }
+
+    /**
+     * Get cached raster or create a new one
+     * \param mesh mesh to get raster for
+     * \param default_material current default material of the geometry
+     * \param getMaterial function returning the material at the given point
+     */
+    template <typename MaterialGetter>
+    shared_ptr<const MaterialRaster> get(const shared_ptr<const MeshD<dim>>& mesh,
+                                         const shared_ptr<Material>& default_material,
+                                         MaterialGetter getMaterial) {
+        OmpLockGuard<OmpLock> guard(lock);
+        if (default_material != defaultMaterial) {
+            removeAll();
+            defaultMaterial = default_material;
+        }
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (entry->mesh == mesh.get()) {
+                // move to the front, so the least recently used raster is dropped first
+                std::rotate(entries.begin(), entry, entry + 1);
+                return entries.front().raster;
+            }
+        }
+        const MeshD<dim>* meshptr = mesh.get();
+        auto raster = plask::make_shared<const MaterialRaster>(
+            meshptr->size(), [&](std::size_t i) { return getMaterial(meshptr->at(i)); });
+        if (entries.size() == SIZE) {
+            entries.back().connection.disconnect();
+            entries.pop_back();
+        }
+        entries.insert(entries.begin(), Entry{meshptr,
+            const_cast<MeshD<dim>*>(meshptr)->changed.connect(
+                [this, meshptr](const Mesh::Event&) { this->onMeshChanged(meshptr); }, boost::signals2::at_front),
+            raster});
+        return raster;
+    }
+};
+
+}   // namespace plask
+
+#endif // PLASK__GEOMETRY_MATERIAL_RASTER_H
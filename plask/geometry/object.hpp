@@ -112,8 +112,9 @@ struct PLASK_API GeometryObject : public enable_shared_from_this<GeometryObject>
             EVENT_EDGES =
                 1 << 6,  ///< edges was changed (only Geometries/calculation spaces emit events with this flags)
             EVENT_STEPS = 1 << 7,        ///< step refining was changed
-            EVENT_USER_DEFINED = 1 << 8  ///< user-defined flags could have ids: EVENT_USER_DEFINED,
+            EVENT_USER_DEFINED = 1 << 8, ///< user-defined flags could have ids: EVENT_USER_DEFINED,
                                          ///< EVENT_USER_DEFINED<<1, EVENT_USER_DEFINED<<2, ...
+            EVENT_MATERIAL = 1u << 31    ///< material was changed (the highest bit, to keep the user-defined range)
         };
 
         /**
@@ -181,6 +182,20 @@ struct PLASK_API GeometryObject : public enable_shared_from_this<GeometryObject>
          */
         bool hasChangedEdges() const { return hasFlag(EVENT_EDGES); }
 
+        /**
+         * Check if only the material of the original source was changed, i.e. EVENT_MATERIAL flag is set and no flag
+         * indicating change of the shape, position, children, edges, or steps is set.
+         *
+         * Such change does not move any object, so solvers can keep their meshes and all data not depending on the
+         * materials in the region of the original source.
+         * @return @c true only if the event describes change of the material only
+         */
+        bool isMaterialOnly() const {
+            return hasFlag(EVENT_MATERIAL) &&
+                   !hasAnyFlag(EVENT_DELETE | EVENT_RESIZE | EVENT_CHILDREN_INSERT | EVENT_CHILDREN_REMOVE |
+                               EVENT_CHILDREN_GENERIC | EVENT_EDGES | EVENT_STEPS);
+        }
+
         /**
          * Get original source of event which can differ from source if event was delegated.
          * @return original source of event
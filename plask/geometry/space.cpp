@@ -109,6 +109,14 @@ void GeometryD<dim>::onChildChanged(const GeometryObject::Event &evt) {
     fireChanged(evt.originalSource(), dim == 2 ? evt.flagsForParentWithChildrenWasChangedInformation() : evt.flagsForParent());
 }
 
+template <int dim>
+std::vector<typename Primitive<dim>::Box> GeometryD<dim>::getChangedBoundingBoxes(const GeometryObject::Event& evt) const {
+    auto child = getChildUnsafe();
+    if (!child) return std::vector<typename Primitive<dim>::Box>();
+    if (evt.isMaterialOnly()) return child->getObjectBoundingBoxes(*evt.originalSource());
+    return std::vector<typename Primitive<dim>::Box>{child->getBoundingBox()};
+}
+
 template <int dim>
 void GeometryD<dim>::disconnectOnChildChanged() {
     connection_with_child.disconnect();
@@ -117,6 +125,7 @@ void GeometryD<dim>::disconnectOnChildChanged() {
 template <int dim>
 void GeometryD<dim>::initNewChild() {
     disconnectOnChildChanged(); //disconnect old child, if any
+    clearCaches();
     auto c3d = getObject3D();
     if (c3d) {
         if (c3d) connection_with_child = c3d->changedConnectMethod(this, &GeometryD<dim>::onChildChanged);
@@ -15,11 +15,14 @@
 #define PLASK__CALCULATION_SPACE_H
 
 #include "edge.hpp"
+#include "material_raster.hpp"
+#include "spatial_index.hpp"
 #include "transform_space_cartesian.hpp"
 #include "transform_space_cylindric.hpp"
 
 #include "../axes.hpp"
 
+#include <atomic>
 #include <boost/signals2.hpp>
 #include "../optional.hpp"
 #include "../utils/event.hpp"
@@ -203,6 +206,58 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
     /// Connection object with child. It is necessary since disconnectOnChileChanged doesn't work
     boost::signals2::connection connection_with_child;
 
+    /// Connection of onChanged with own changed signal
+    boost::signals2::connection connection_with_self;
+
+    /// Materials rasters for recently used meshes
+    mutable MaterialRasterCache<dim> materialRasters;
+
+    /// Spatial index of the whole tree, built when it is needed first
+    mutable std::unique_ptr<const GeometryTreeIndex<dim>> treeIndex;
+
+    /// Pointer to \c treeIndex published for the readers, so they do not need to lock or copy shared pointers
+    mutable std::atomic<const GeometryTreeIndex<dim>*> treeIndexPtr{nullptr};
+
+    /// Lock for building the spatial index
+    mutable OmpLock treeIndexLock;
+
+    /// Clear materials rasters and the spatial index
+    void clearCaches() {
+        materialRasters.clear();
+        OmpLockGuard<OmpLock> lock(treeIndexLock);
+        // The index is dropped only when the tree is changed, which must not happen during the lookups anyway
+        treeIndexPtr.store(nullptr, std::memory_order_release);
+        treeIndex.reset();
+    }
+
+    /**
+     * Clear caches when anything in the geometry is changed.
+     * If only materials change, the spatial index is still valid and the rasters are updated in the changed regions.
+     */
+    void onChanged(const GeometryObject::Event& evt) {
+        if (evt.isMaterialOnly())
+            materialRasters.update(getChangedBoundingBoxes(evt),
+                                   [this](const Vec<dim, double>& p) { return this->getMaterial(p); });
+        else
+            clearCaches();
+    }
+
+    /**
+     * Get spatial index of the current child, building it if necessary.
+     * The index is dropped on every change of the tree (including the change of the child), so it is always current.
+     * For small trees it has no hierarchy and its lookups go directly to the child.
+     */
+    const GeometryTreeIndex<dim>& getTreeIndex() const {
+        const GeometryTreeIndex<dim>* index = treeIndexPtr.load(std::memory_order_acquire);
+        if (index) return *index;
+        OmpLockGuard<OmpLock> lock(treeIndexLock);
+        if (!treeIndex) {
+            treeIndex.reset(new GeometryTreeIndex<dim>(getChild()));
+            treeIndexPtr.store(treeIndex.get(), std::memory_order_release);
+        }
+        return *treeIndex;
+    }
+
   public:
     enum { DIM = dim };
 
@@ -214,7 +269,7 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
      * @return default material in each point for which geometry return nullptr or material from geometry
      */
     shared_ptr<Material> getMaterialOrDefault(const Vec<dim, double>& p) const {
-        auto real_mat = getChild()->getMaterial(p);
+        auto real_mat = getTreeIndex().getMaterial(p);
         return real_mat ? real_mat : defaultMaterial;
     }
 
@@ -238,7 +293,25 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
      */
     void initNewChild();
 
-    virtual ~GeometryD() { disconnectOnChildChanged(); }
+    GeometryD() { connection_with_self = this->changedConnectMethod(this, &GeometryD<dim>::onChanged); }
+
+    GeometryD(const GeometryD& to_copy)
+        : Geometry(to_copy), connection_with_child(to_copy.connection_with_child), cachedBoundingBox(to_copy.cachedBoundingBox) {
+        connection_with_self = this->changedConnectMethod(this, &GeometryD<dim>::onChanged);
+    }
+
+    GeometryD& operator=(const GeometryD& to_copy) {
+        Geometry::operator=(to_copy);
+        connection_with_child = to_copy.connection_with_child;
+        cachedBoundingBox = to_copy.cachedBoundingBox;
+        clearCaches();
+        return *this;
+    }
+
+    virtual ~GeometryD() {
+        disconnectOnChildChanged();
+        connection_with_self.disconnect();
+    }
 
   public:
     int getDimensionsCount() const override;
@@ -256,6 +329,19 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
      */
     virtual shared_ptr<Material> getMaterial(const Vec<dim, double>& p) const;
 
+    /**
+     * Get materials at all points of the @p mesh.
+     *
+     * This is much faster than calling getMaterial for each point separately, if the materials are needed repeatedly,
+     * as the raster is cached and returned for subsequent calls with the same mesh, until the geometry, the mesh, or
+     * the default material is changed. Use it with meshes, which are kept by solvers (e.g. their element meshes).
+     * @param mesh mesh with points to get materials at
+     * @return materials at all points of the mesh
+     */
+    shared_ptr<const MaterialRaster> getMaterialRaster(const shared_ptr<const MeshD<dim>>& mesh) const {
+        return materialRasters.get(mesh, defaultMaterial, [this](const Vec<dim, double>& p) { return this->getMaterial(p); });
+    }
+
     /**
      * Get child geometry.
      *
@@ -486,6 +572,17 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
         return getChild()->getObjectBoundingBoxes(*object, path);
     }
 
+    /**
+     * Calculate bounding boxes (relative to child of this) of the region affected by the change described by \p evt.
+     *
+     * If only the material was changed (see GeometryObject::Event::isMaterialOnly), these are the bounding boxes of all
+     * instances of the original source of the event. Otherwise, the change could move other objects as well, so the
+     * bounding box of the whole child is returned.
+     * @param evt event received from this geometry
+     * @return bounding boxes of the changed region (empty if there is no child)
+     */
+    std::vector<typename Primitive<dim>::Box> getChangedBoundingBoxes(const GeometryObject::Event& evt) const;
+
     /**
      * Get all objects with a specified role with this object as root.
      * \param role role to search objects with
@@ -502,9 +599,16 @@ template <int dim> class PLASK_API GeometryD : public Geometry {
      * @return all paths, starting from child of this, last one is on top and overlies rest
      */
     GeometryObject::Subtree getPathsAt(const CoordsType& point, bool all = false) const {
-        return getChild()->getPathsAt(wrapEdges(point), all);
+        return getTreeIndex().getPathsAt(wrapEdges(point), all);
     }
 
+    /**
+     * Check if there is any object at given @p point.
+     * @param point point in local coordinates
+     * @return @c true only if some object lies at @p point
+     */
+    bool contains(const CoordsType& point) const { return getTreeIndex().contains(wrapEdges(point)); }
+
     // std::vector<shared_ptr<const GeometryObjectD<DIMS>>> extract(const Predicate& predicate, const PathHints* path =
     // 0) const {
     //     return getChild()->extract(predicate, path);
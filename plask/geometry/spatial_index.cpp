@@ -13,6 +13,13 @@
  */
 #include "spatial_index.hpp"
 
+#include <boost/container/small_vector.hpp>
+
+#include "clip.hpp"
+#include "lattice.hpp"
+#include "mirror.hpp"
+#include "translation_container.hpp"
+
 namespace plask {
 
 
@@ -232,14 +239,14 @@ inline SpatialIndexNode<DIMS>* buildCacheR(std::vector< GeometryObjectBBox<DIMS>
     double bestOffset;
     int bestDir;
     int bestValue = std::numeric_limits<int>::max();  //we will minimalize this value
-    for (int dim = DIMS; dim < DIMS; ++dim)
+    for (int dim = 0; dim < DIMS; ++dim)
         calcOptimalSplitOffset(input[dim*2 + 1], input[dim*2 + 2], dim, bestDir, bestOffset, bestValue);
     if (bestValue == std::numeric_limits<int>::max())   //there are no enought good split point
         return new LeafCacheNode<DIMS>(input[0]);                //so we will not split more
     SpatialIndexNode<DIMS> *lo, *hi;
     {
     std::vector< GeometryObjectBBox<DIMS> > input_over_offset[1 + DIMS * 2];
-    for (int dim = DIMS; dim < 1 + DIMS * 2; ++dim)
+    for (int dim = 0; dim < 1 + DIMS * 2; ++dim)
         inPlaceSplit<DIMS>(input[dim], input_over_offset[dim], bestDir, bestOffset);
     hi = buildCacheR(input_over_offset, max_depth-1);
     }   //here input_over_offset is deleted
@@ -278,5 +285,281 @@ template PLASK_API std::unique_ptr<SpatialIndexNode<2>> buildSpatialIndex(const
 template PLASK_API std::unique_ptr<SpatialIndexNode<3>> buildSpatialIndex(const std::vector< shared_ptr<Translation<3>> >& children);
 
 
+template <int DIMS>
+GeometryTreeIndex<DIMS>::GeometryTreeIndex(const shared_ptr<const GeometryObjectD<DIMS>>& root): root(root) {
+    if (!root) return;
+    std::vector<Step> trail;
+    std::vector<std::uint32_t> ancestors;
+    flatten(root, trail, ancestors);
+    if (items.size() < MIN_ITEMS) return;
+    order.resize(items.size());
+    for (std::uint32_t i = 0; i != order.size(); ++i) order[i] = i;
+    nodes.reserve(2 * (items.size() / LEAF_ITEMS) + 1);
+    buildNode(0, std::uint32_t(order.size()));
+}
+
+/**
+ * Get children of the container, which are placed with translations, so they can be indexed directly
+ * @param object object to check
+ * @return children of the container or @c nullptr if @p object is not a translation container nor a lattice
+ */
+template <int DIMS>
+inline const std::vector<shared_ptr<Translation<DIMS>>>* getTranslatedChildren(const GeometryObjectD<DIMS>* object) {
+    if (auto container = dynamic_cast<const TranslationContainer<DIMS>*>(object)) return &container->getChildrenVector();
+    return nullptr;
+}
+
+template <>
+inline const std::vector<shared_ptr<Translation<3>>>* getTranslatedChildren<3>(const GeometryObjectD<3>* object) {
+    if (auto container = dynamic_cast<const TranslationContainer<3>*>(object)) return &container->getChildrenVector();
+    if (auto lattice = dynamic_cast<const Lattice*>(object)) return &lattice->container->getChildrenVector();
+    return nullptr;
+}
+
+template <int DIMS>
+void GeometryTreeIndex<DIMS>::flatten(const shared_ptr<const GeometryObjectD<DIMS>>& object, std::vector<Step>& trail,
+                                      std::vector<std::uint32_t>& ancestors) {
+    // Containers and transformations are added to the ancestors of the items and their children are visited in order,
+    // so the items later in the list are the ones, which are checked first by the tree.
+    if (auto children = getTranslatedChildren<DIMS>(object.get())) {
+        ancestors.push_back(std::uint32_t(objects.size()));
+        objects.push_back(object);
+        for (const auto& child: *children) flatten(child, trail, ancestors);
+        ancestors.pop_back();
+        return;
+    }
+
+    if (auto transform = dynamic_pointer_cast<const GeometryObjectTransform<DIMS>>(object)) {
+        Step step;
+        step.axis = 0;
+        step.intersection = nullptr;
+        if (auto translation = dynamic_pointer_cast<const Translation<DIMS>>(object)) {
+            step.kind = Step::TRANSLATE;
+            step.translation = translation->translation;
+        } else if (auto flip = dynamic_pointer_cast<const Flip<DIMS>>(object)) {
+            step.kind = Step::FLIP;
+            step.axis = flip->flipDir;
+        } else if (auto mirror = dynamic_pointer_cast<const Mirror<DIMS>>(object)) {
+            step.kind = Step::MIRROR;
+            step.axis = mirror->flipDir;
+        } else if (auto clip = dynamic_pointer_cast<const Clip<DIMS>>(object)) {
+            step.kind = Step::CLIP;
+            step.box = clip->clipBox;
+        } else if (auto intersection = dynamic_pointer_cast<const Intersection<DIMS>>(object)) {
+            step.kind = Step::INTERSECT;
+            step.intersection = intersection.get();
+        } else {
+            addItem(object, trail, ancestors);
+            return;
+        }
+        if (!transform->hasChild()) return;
+        ancestors.push_back(std::uint32_t(objects.size()));
+        objects.push_back(object);
+        trail.push_back(step);
+        flatten(transform->getChild(), trail, ancestors);
+        trail.pop_back();
+        ancestors.pop_back();
+        return;
+    }
+
+    addItem(object, trail, ancestors);
+}
+
+template <int DIMS>
+void GeometryTreeIndex<DIMS>::addItem(const shared_ptr<const GeometryObjectD<DIMS>>& object, const std::vector<Step>& trail,
+                                      const std::vector<std::uint32_t>& ancestors) {
+    // Bounding box in the root coordinates is found by applying the transformations in reverse order
+    Box box = object->getBoundingBox();
+    for (auto step = trail.rbegin(); step != trail.rend() && box.isValid(); ++step) {
+        switch (step->kind) {
+            case Step::TRANSLATE: box.translate(step->translation); break;
+            case Step::FLIP: box = box.flipped(step->axis); break;
+            case Step::MIRROR: box = box.extension(box.flipped(step->axis)); break;
+            case Step::CLIP: box = box.intersection(step->box); break;
+            case Step::INTERSECT:
+                if (step->intersection->envelope) box = box.intersection(step->intersection->envelope->getBoundingBox());
+                break;
+        }
+    }
+    if (!box.isValid()) return;  // this object is never visible
+    // Enlarge the box a little, so rounding errors in the transformations do not skip the object at its boundary
+    for (int i = 0; i != DIMS; ++i) {
+        box.lower[i] -= 1e-9 * std::max(1., std::abs(box.lower[i]));
+        box.upper[i] += 1e-9 * std::max(1., std::abs(box.upper[i]));
+    }
+
+    Item item;
+    item.object = object.get();
+    item.stepsBegin = std::uint32_t(steps.size());
+    steps.insert(steps.end(), trail.begin(), trail.end());
+    item.stepsEnd = std::uint32_t(steps.size());
+    item.pathBegin = std::uint32_t(path.size());
+    path.insert(path.end(), ancestors.begin(), ancestors.end());
+    item.pathEnd = std::uint32_t(path.size());
+    item.box = box;
+    objects.push_back(object);
+    items.push_back(item);
+}
+
+template <int DIMS>
+std::uint32_t GeometryTreeIndex<DIMS>::buildNode(std::uint32_t begin, std::uint32_t end) {
+    std::uint32_t index = std::uint32_t(nodes.size());
+    nodes.emplace_back();
+    Box box = items[order[begin]].box;
+    for (std::uint32_t i = begin + 1; i != end; ++i) box.makeInclude(items[order[i]].box);
+    nodes[index].box = box;
+
+    if (end - begin <= LEAF_ITEMS) {
+        nodes[index].start = begin;
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    // Split at the median of the box centers along the longest extent of the centers
+    auto center = [this](std::uint32_t i, int dir) {
+        double c = 0.5 * (items[i].box.lower[dir] + items[i].box.upper[dir]);
+        return std::isfinite(c) ? c : 0.;
+    };
+    int dir = 0;
+    double extent = -1.;
+    for (int d = 0; d != DIMS; ++d) {
+        double lo = std::numeric_limits<double>::max(), hi = std::numeric_limits<double>::lowest();
+        for (std::uint32_t i = begin; i != end; ++i) {
+            double c = center(order[i], d);
+            lo = std::min(lo, c);
+            hi = std::max(hi, c);
+        }
+        if (hi - lo > extent) {
+            extent = hi - lo;
+            dir = d;
+        }
+    }
+    std::uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&](std::uint32_t a, std::uint32_t b) { return center(a, dir) < center(b, dir); });
+
+    buildNode(begin, mid);  // always at index + 1
+    std::uint32_t second = buildNode(mid, end);
+    nodes[index].start = second;
+    nodes[index].count = 0;
+    return index;
+}
+
+template <int DIMS>
+template <typename CandidatesT>
+void GeometryTreeIndex<DIMS>::findCandidates(const DVec& p, CandidatesT& candidates) const {
+    std::uint32_t stack[64];
+    std::size_t top = 0;
+    stack[top++] = 0;
+    while (top != 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!node.box.contains(p)) continue;
+        if (node.count != 0) {
+            for (std::uint32_t i = node.start, end = node.start + node.count; i != end; ++i)
+                if (items[order[i]].box.contains(p)) candidates.push_back(order[i]);
+        } else {
+            assert(top + 2 <= 64);
+            stack[top++] = node.start;
+            stack[top++] = std::uint32_t(&node - nodes.data()) + 1;
+        }
+    }
+    // Objects later in the tree are checked first, as the containers do
+    std::sort(candidates.begin(), candidates.end(), std::greater<std::uint32_t>());
+}
+
+template <int DIMS>
+bool GeometryTreeIndex<DIMS>::toItemCoords(const Item& item, DVec& p) const {
+    for (std::uint32_t s = item.stepsBegin; s != item.stepsEnd; ++s) {
+        const Step& step = steps[s];
+        switch (step.kind) {
+            case Step::TRANSLATE: p -= step.translation; break;
+            case Step::FLIP: p = p.flipped(step.axis); break;
+            case Step::MIRROR: if (p[step.axis] < 0) p = p.flipped(step.axis); break;
+            case Step::CLIP: if (!step.box.contains(p)) return false; break;
+            case Step::INTERSECT: if (!step.intersection->inEnvelope(p)) return false; break;
+        }
+    }
+    return true;
+}
+
+template <int DIMS>
+shared_ptr<Material> GeometryTreeIndex<DIMS>::getMaterial(const DVec& p) const {
+    if (!hasHierarchy()) return root ? root->getMaterial(p) : shared_ptr<Material>();
+    boost::container::small_vector<std::uint32_t, 16> candidates;
+    findCandidates(p, candidates);
+    for (std::uint32_t i: candidates) {
+        DVec local = p;
+        if (!toItemCoords(items[i], local)) continue;
+        if (shared_ptr<Material> material = items[i].object->getMaterial(local)) return material;
+    }
+    return shared_ptr<Material>();
+}
+
+template <int DIMS>
+bool GeometryTreeIndex<DIMS>::contains(const DVec& p) const {
+    if (!hasHierarchy()) return root && root->contains(p);
+    boost::container::small_vector<std::uint32_t, 16> candidates;
+    findCandidates(p, candidates);
+    for (std::uint32_t i: candidates) {
+        DVec local = p;
+        if (toItemCoords(items[i], local) && items[i].object->contains(local)) return true;
+    }
+    return false;
+}
+
+template <int DIMS>
+GeometryObject::Subtree GeometryTreeIndex<DIMS>::getPathsAt(const DVec& p, bool all) const {
+    if (!hasHierarchy()) return root ? root->getPathsAt(p, all) : GeometryObject::Subtree();
+    boost::container::small_vector<std::uint32_t, 16> candidates;
+    findCandidates(p, candidates);
+
+    GeometryObject::Subtree result;
+    // Nodes of the result corresponding to the ancestors of the recently added item
+    std::vector<GeometryObject::Subtree*> chain;
+    std::vector<std::uint32_t> chainIds;
+    for (std::uint32_t i: candidates) {
+        const Item& item = items[i];
+        DVec local = p;
+        if (!toItemCoords(item, local)) continue;
+        GeometryObject::Subtree found = item.object->getPathsAt(local, all);
+        if (found.empty()) continue;
+
+        if (!all) {
+            for (std::uint32_t a = item.pathEnd; a != item.pathBegin; --a)
+                found = GeometryObject::Subtree(objects[path[a-1]], std::vector<GeometryObject::Subtree>{std::move(found)});
+            return found;
+        }
+
+        // Attach the found paths to the result, sharing the nodes of the common ancestors with the previous items
+        std::size_t common = 0;
+        while (common != chain.size() && item.pathBegin + common != item.pathEnd &&
+               chainIds[common] == path[item.pathBegin + common])
+            ++common;
+        chain.resize(common);
+        chainIds.resize(common);
+        for (std::uint32_t a = item.pathBegin + std::uint32_t(common); a != item.pathEnd; ++a) {
+            GeometryObject::Subtree* node;
+            if (chain.empty()) {
+                result = GeometryObject::Subtree(objects[path[a]]);
+                node = &result;
+            } else {
+                chain.back()->children.emplace_back(objects[path[a]]);
+                node = &chain.back()->children.back();
+            }
+            chain.push_back(node);
+            chainIds.push_back(path[a]);
+        }
+        if (chain.empty())
+            result = std::move(found);
+        else
+            chain.back()->children.push_back(std::move(found));
+    }
+    return result;
+}
+
+template class PLASK_API GeometryTreeIndex<2>;
+template class PLASK_API GeometryTreeIndex<3>;
+
+
 }   // namespace plask
 
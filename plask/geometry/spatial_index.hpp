@@ -14,6 +14,10 @@
 #ifndef PLASK__GEOMETRY_SPATIAL_INDEX_H
 #define PLASK__GEOMETRY_SPATIAL_INDEX_H
 
+#include <cstdint>
+#include <vector>
+
+#include "intersection.hpp"
 #include "transform.hpp"
 
 namespace plask {
@@ -52,6 +56,124 @@ PLASK_API_EXTERN_TEMPLATE_STRUCT(SpatialIndexNode<3>)
 extern template PLASK_API std::unique_ptr<SpatialIndexNode<2>> buildSpatialIndex(const std::vector< shared_ptr<Translation<2>> >& children);
 extern template PLASK_API std::unique_ptr<SpatialIndexNode<3>> buildSpatialIndex(const std::vector< shared_ptr<Translation<3>> >& children);
 
+/**
+ * Spatial index of the whole geometry tree.
+ *
+ * The tree is flattened into a list of items. Each item is an object together with the sequence of transformations
+ * (translations, flips, mirrors, clips and intersections) leading to it from the root. The items are organized in
+ * a bounding volume hierarchy stored in a flat array, so the items at any point are found in logarithmic time.
+ * Translation containers and lattices are flattened, while leafs, stacks (which already find their children by
+ * binary search) and objects of any other type are kept as single items.
+ *
+ * The transformations are applied to the point in the same order as the tree does, so the results are exactly
+ * the same as obtained by traversing the tree. The index must be rebuilt when anything in the tree is changed.
+ */
+template <int DIMS>
+class PLASK_API GeometryTreeIndex {
+
+  public:
+
+    typedef typename Primitive<DIMS>::DVec DVec;
+    typedef typename Primitive<DIMS>::Box Box;
+
+    /// Minimal number of items for which the hierarchy is built. For fewer items the tree is just traversed.
+    static constexpr std::size_t MIN_ITEMS = 16;
+
+  private:
+
+    /// Maximal number of items in the leaf of the hierarchy
+    static constexpr std::uint32_t LEAF_ITEMS = 4;
+
+    /// Single transformation of the point on a way from the root to the item
+    struct Step {
+        enum Kind { TRANSLATE, FLIP, MIRROR, CLIP, INTERSECT };
+        Kind kind;
+        int axis;                                   ///< Axis for FLIP and MIRROR
+        DVec translation;                           ///< Translation for TRANSLATE
+        Box box;                                    ///< Clipping box for CLIP
+        const Intersection<DIMS>* intersection;     ///< Intersection object for INTERSECT
+    };
+
+    /// Flattened object
+    struct Item {
+        const GeometryObjectD<DIMS>* object;
+        std::uint32_t stepsBegin, stepsEnd;         ///< Range of the item transformations in steps
+        std::uint32_t pathBegin, pathEnd;           ///< Range of the item ancestors in path
+        Box box;                                    ///< Bounding box in the root coordinates
+    };
+
+    /// Node of the hierarchy: a leaf refers to \c count items in order starting at \c start, otherwise its
+    /// children are the next node and the node at index \c start
+    struct Node {
+        Box box;
+        std::uint32_t start, count;
+    };
+
+    /// Root of the tree
+    shared_ptr<const GeometryObjectD<DIMS>> root;
+
+    /// All visited objects (ancestors and items), which are referred by index in path
+    std::vector<shared_ptr<const GeometryObject>> objects;
+
+    std::vector<Step> steps;
+    std::vector<std::uint32_t> path;
+    std::vector<Item> items;
+    std::vector<std::uint32_t> order;
+    std::vector<Node> nodes;
+
+    void flatten(const shared_ptr<const GeometryObjectD<DIMS>>& object, std::vector<Step>& trail, std::vector<std::uint32_t>& ancestors);
+
+    void addItem(const shared_ptr<const GeometryObjectD<DIMS>>& object, const std::vector<Step>& trail, const std::vector<std::uint32_t>& ancestors);
+
+    std::uint32_t buildNode(std::uint32_t begin, std::uint32_t end);
+
+    template <typename CandidatesT>
+    void findCandidates(const DVec& p, CandidatesT& candidates) const;
+
+    bool toItemCoords(const Item& item, DVec& p) const;
+
+  public:
+
+    /**
+     * Build index of the tree
+     * \param root root of the tree
+     */
+    explicit GeometryTreeIndex(const shared_ptr<const GeometryObjectD<DIMS>>& root);
+
+    /// Get root of the indexed tree
+    const shared_ptr<const GeometryObjectD<DIMS>>& getRoot() const { return root; }
+
+    /// Get number of the flattened items
+    std::size_t size() const { return items.size(); }
+
+    /// \return \c true if the hierarchy has been built, or \c false if the tree is traversed directly
+    bool hasHierarchy() const { return !nodes.empty(); }
+
+    /**
+     * Get material at the given point
+     * \param p point in the root coordinates
+     * \return material or \c nullptr if there is no object at \p p
+     */
+    shared_ptr<Material> getMaterial(const DVec& p) const;
+
+    /**
+     * Check if there is any object at the given point
+     * \param p point in the root coordinates
+     */
+    bool contains(const DVec& p) const;
+
+    /**
+     * Find all paths to objects at the given point.
+     * \param p point in the root coordinates
+     * \param all if \c true then return all paths if branches overlap the point
+     * \return the same subtree as returned by the root GeometryObject::getPathsAt
+     */
+    GeometryObject::Subtree getPathsAt(const DVec& p, bool all = false) const;
+};
+
+PLASK_API_EXTERN_TEMPLATE_CLASS(GeometryTreeIndex<2>)
+PLASK_API_EXTERN_TEMPLATE_CLASS(GeometryTreeIndex<3>)
+
 }   // plask
 
 #endif // PLASK__GEOMETRY_SPATIAL_INDEX_H
@@ -11,7 +11,9 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU General Public License for more details.
  */
+#include <atomic>
 #include <fstream>
+#include <list>
 #include <boost/algorithm/string.hpp>
 
 #include "manager.hpp"
@@ -23,6 +25,7 @@
 #include "utils/dynlib/manager.hpp"
 
 #include "utils/system.hpp"
+#include "parallel.hpp"
 
 namespace plask {
 
@@ -308,6 +311,104 @@ void Manager::loadScript(XMLReader& reader)
     return src ? const_cast<MaterialsDB&>(src->materialsDB) : MaterialsDB::getDefault();
 }*/
 
+namespace {
+
+    /// Geometry and grids stored in the cache of parsed sections
+    struct CachedSections {
+        std::string key;
+        Manager::Map<PathHints> pathHints;
+        std::vector<shared_ptr<Geometry>> roots;
+        Manager::Map<shared_ptr<GeometryObject>> geometrics;
+        Manager::Map<shared_ptr<MeshBase>> meshes;
+
+        /// Flag set when any of the cached objects or meshes is changed
+        shared_ptr<std::atomic<bool>> changed;
+        std::vector<boost::signals2::connection> connections;
+
+        CachedSections(const std::string& key): key(key), changed(plask::make_shared<std::atomic<bool>>(false)) {}
+
+        CachedSections(const CachedSections&) = delete;
+        CachedSections& operator=(const CachedSections&) = delete;
+
+        ~CachedSections() {
+            for (auto& connection: connections) connection.disconnect();
+        }
+
+        void watch(const shared_ptr<GeometryObject>& object) {
+            auto flag = changed;
+            connections.push_back(object->changed.connect([flag](GeometryObject::Event&) { *flag = true; }));
+        }
+
+        void watch(const shared_ptr<MeshBase>& mesh) {
+            auto flag = changed;
+            if (auto m = dynamic_pointer_cast<Mesh>(mesh))
+                connections.push_back(m->changed.connect([flag](Mesh::Event&) { *flag = true; }));
+            else if (auto generator = dynamic_pointer_cast<MeshGenerator>(mesh))
+                connections.push_back(generator->changed.connect([flag](MeshGenerator::Event&) { *flag = true; }));
+        }
+    };
+
+    struct SectionsCache {
+        /// Maximum number of cached files (the least recently used ones are dropped first)
+        static constexpr std::size_t SIZE = 4;
+
+        /// Cached sections, the most recently used first
+        std::list<CachedSections> entries;
+
+        OmpLock lock;
+    };
+
+    // The cache object is never destroyed, as at the program exit it may hold objects which cannot be deleted any more
+    // (e.g. custom materials defined in Python); its entries are freed with Manager::clearSectionsCache before that
+    SectionsCache& sectionsCache() {
+        static SectionsCache* cache = new SectionsCache;
+        return *cache;
+    }
+}
+
+bool Manager::restoreCachedSections(const std::string& key) {
+    SectionsCache& cache = sectionsCache();
+    OmpLockGuard<OmpLock> guard(cache.lock);
+    for (auto entry = cache.entries.begin(); entry != cache.entries.end(); ++entry) {
+        if (entry->key != key) continue;
+        if (*entry->changed) {
+            cache.entries.erase(entry);
+            return false;
+        }
+        cache.entries.splice(cache.entries.begin(), cache.entries, entry);
+        pathHints = entry->pathHints;
+        roots = entry->roots;
+        geometrics = entry->geometrics;
+        meshes = entry->meshes;
+        writelog(LOG_DETAIL, "Geometry and grids taken from the cache");
+        return true;
+    }
+    return false;
+}
+
+void Manager::storeCachedSections(const std::string& key) const {
+    SectionsCache& cache = sectionsCache();
+    OmpLockGuard<OmpLock> guard(cache.lock);
+    cache.entries.remove_if([&](const CachedSections& entry) { return entry.key == key || *entry.changed; });
+    cache.entries.emplace_front(key);
+    CachedSections& entry = cache.entries.front();
+    entry.pathHints = pathHints;
+    entry.roots = roots;
+    entry.geometrics = geometrics;
+    entry.meshes = meshes;
+    // Changes of any object are propagated to its parents, so it is enough to watch the roots and named objects
+    for (const auto& root: roots) entry.watch(root);
+    for (const auto& object: geometrics) entry.watch(object.second);
+    for (const auto& mesh: meshes) entry.watch(mesh.second);
+    if (cache.entries.size() > SectionsCache::SIZE) cache.entries.pop_back();
+}
+
+void Manager::clearSectionsCache() {
+    SectionsCache& cache = sectionsCache();
+    OmpLockGuard<OmpLock> guard(cache.lock);
+    cache.entries.clear();
+}
+
 void Manager::load(XMLReader& reader,
                    const LoadFunCallbackT& load_from,
                    const std::function<bool(const std::string& section_name)>& section_filter)
@@ -350,6 +451,17 @@ void Manager::load(XMLReader& reader,
             if (!reader.requireTagOrEnd()) return;
         }
 
+        // Geometry and grids can be taken from the cache of parsed sections, if the manager is empty
+        std::string cache_key;
+        if (!draft && roots.empty() && geometrics.empty() && meshes.empty() && pathHints.empty() &&
+            section_filter(TAG_NAME_GEOMETRY) && section_filter(TAG_NAME_GRIDS))
+            cache_key = getSectionsCacheKey();
+        const bool cached = !cache_key.empty() && restoreCachedSections(cache_key);
+        auto storeInCache = [&]() {
+            if (!cache_key.empty() && !cached) storeCachedSections(cache_key);
+            cache_key.clear();
+        };
+
         if (reader.getNodeName() == TAG_NAME_MATERIALS) {
             next = 2;
             if (section_filter(TAG_NAME_MATERIALS)) {
@@ -361,25 +473,32 @@ void Manager::load(XMLReader& reader,
 
         if (reader.getNodeName() == TAG_NAME_GEOMETRY) {
             next = 3;
-            if (section_filter(TAG_NAME_GEOMETRY)) {
-                if (!tryLoadFromExternal(reader, load_from)) {
+            if (section_filter(TAG_NAME_GEOMETRY) && !cached) {
+                if (tryLoadFromExternal(reader, load_from))
+                    cache_key.clear();  // external file may change, so it is not cached
+                else {
                     GeometryReader greader(*this, reader);
                     loadGeometry(greader);
                 }
             } else
                 reader.gotoEndOfCurrentTag();
-            if (!reader.requireTagOrEnd()) return;
+            if (!reader.requireTagOrEnd()) { storeInCache(); return; }
         }
 
         if (reader.getNodeName() == TAG_NAME_GRIDS) {
             next = 4;
-            if (section_filter(TAG_NAME_GRIDS)) {
-                if (!tryLoadFromExternal(reader, load_from)) loadGrids(reader);
+            if (section_filter(TAG_NAME_GRIDS) && !cached) {
+                if (tryLoadFromExternal(reader, load_from))
+                    cache_key.clear();
+                else
+                    loadGrids(reader);
             } else
                 reader.gotoEndOfCurrentTag();
-            if (!reader.requireTagOrEnd()) return;
+            if (!reader.requireTagOrEnd()) { storeInCache(); return; }
         }
 
+        storeInCache();
+
         if (reader.getNodeName() == TAG_NAME_SOLVERS) {
             next = 5;
             if (section_filter(TAG_NAME_SOLVERS)) {
@@ -157,8 +157,42 @@ private:
      */
     virtual void loadMaterial(XMLReader& reader);
 
+    /**
+     * Get key identifying the loaded geometry and grids in the cache of parsed sections.
+     *
+     * It is called after the defines are loaded. Geometry and grids loaded before with the same key are taken from
+     * the cache instead of being parsed again, so the key must cover the contents of these sections and the values
+     * of all the defines used in them. The default implementation returns an empty string, which disables the cache.
+     * @return cache key or empty string if the sections should not be cached
+     */
+    virtual std::string getSectionsCacheKey() const { return std::string(); }
+
+  private:
+
+    /**
+     * Take geometry and grids from the cache of parsed sections.
+     * @param key cache key
+     * @return @c true if the sections have been found in the cache
+     */
+    bool restoreCachedSections(const std::string& key);
+
+    /**
+     * Store loaded geometry and grids in the cache of parsed sections.
+     * @param key cache key
+     */
+    void storeCachedSections(const std::string& key) const;
+
   public:
 
+    /**
+     * Remove all parsed sections from the cache.
+     *
+     * Cached geometry objects and meshes are shared by all the managers, which took them from the cache. The cache
+     * entry is dropped as soon as any of its objects or meshes is changed, so such changes do not affect subsequent
+     * loads, but the managers loaded before share the changes.
+     */
+    static void clearSectionsCache();
+
     static constexpr const char* TAG_NAME_ROOT = "plask";           ///< name of root XML tag
     static constexpr const char* TAG_NAME_DEFINES = "defines";      ///< name of XML tag of section with const definitions
     static constexpr const char* TAG_NAME_MATERIALS = "materials";  ///< name of XML tag of section with materials
@@ -0,0 +1,248 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2023 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include <boost/tokenizer.hpp>
+
+#include "cached_material.hpp"
+
+namespace plask {
+
+namespace {
+    inline bool isAccurate(double approx, double exact, double tolerance) {
+        return std::abs(approx - exact) <= tolerance * std::abs(exact);
+    }
+
+    inline bool isAccurate(const dcomplex& approx, const dcomplex& exact, double tolerance) {
+        return std::abs(approx - exact) <= tolerance * std::abs(exact);
+    }
+
+    inline bool isAccurate(const Tensor2<double>& approx, const Tensor2<double>& exact, double tolerance) {
+        return isAccurate(approx.c00, exact.c00, tolerance) && isAccurate(approx.c11, exact.c11, tolerance);
+    }
+
+    // Tensor3 is symmetric, so c01 holds both off-diagonal components (there is no separate c10)
+    inline bool isAccurate(const Tensor3<dcomplex>& approx, const Tensor3<dcomplex>& exact, double tolerance) {
+        return isAccurate(approx.c00, exact.c00, tolerance) && isAccurate(approx.c11, exact.c11, tolerance) &&
+               isAccurate(approx.c22, exact.c22, tolerance) && isAccurate(approx.c01, exact.c01, tolerance);
+    }
+}
+
+CachedMaterial::Settings::Settings(unsigned parameters, double Tmin, double Tmax, double Tstep, double tolerance,
+                                   size_t maxkeys):
+    parameters(parameters), Tmin(Tmin), Tmax(Tmax), Tstep(Tstep), tolerance(tolerance), maxkeys(maxkeys)
+{
+    if (!(Tstep > 0.)) throw BadInput("CachedMaterial", "temperature step must be positive");
+    if (!(Tmax > Tmin)) throw BadInput("CachedMaterial", "maximum temperature must be larger than the minimum one");
+    if (!(tolerance >= 0.)) throw BadInput("CachedMaterial", "tolerance must not be negative");
+}
+
+unsigned CachedMaterial::parseParameters(const std::string& names) {
+    static const std::map<std::string, unsigned> PARAMETERS = {
+        {"Eg", PARAM_EG}, {"CB", PARAM_CB}, {"VB", PARAM_VB}, {"eps", PARAM_EPS}, {"Ni", PARAM_NI},
+        {"mob", PARAM_MOB}, {"cond", PARAM_COND}, {"A", PARAM_A}, {"B", PARAM_B}, {"C", PARAM_C}, {"D", PARAM_D},
+        {"thermk", PARAM_THERMK}, {"dens", PARAM_DENS}, {"cp", PARAM_CP}, {"nr", PARAM_NR}, {"absp", PARAM_ABSP},
+        {"Nr", PARAM_NR_COMPLEX}, {"mobe", PARAM_MOBE}, {"mobh", PARAM_MOBH}, {"taue", PARAM_TAUE},
+        {"tauh", PARAM_TAUH}, {"Ce", PARAM_CE}, {"Ch", PARAM_CH}, {"NR", PARAM_NR_TENSOR}
+    };
+    unsigned result = 0;
+    for (auto name: boost::tokenizer<boost::char_separator<char>>(names, boost::char_separator<char>(" ,"))) {
+        auto found = PARAMETERS.find(name);
+        if (found == PARAMETERS.end())
+            throw BadInput("CachedMaterial", "parameter '{}' cannot be tabulated", name);
+        result |= found->second;
+    }
+    return result;
+}
+
+CachedMaterial::CachedMaterial(const shared_ptr<Material>& base, const Settings& settings):
+    MaterialWithBase(base), settings(settings), count(size_t(std::ceil((settings.Tmax - settings.Tmin) / settings.Tstep)))
+{}
+
+void CachedMaterial::invalidate() {
+    OmpLockGuard<OmpLock> guard(cache_lock);
+    Eg_.clear(); CB_.clear(); VB_.clear();
+    eps_.clear(); Ni_.clear(); A_.clear(); B_.clear(); C_.clear(); D_.clear(); dens_.clear(); cp_.clear();
+    taue_.clear(); tauh_.clear(); Ce_.clear(); Ch_.clear();
+    mob_.clear(); cond_.clear(); mobe_.clear(); mobh_.clear();
+    thermk_.clear();
+    nr_.clear(); absp_.clear();
+    Nr_.clear(); NR_.clear();
+}
+
+template <typename KeyT, typename ValueT>
+shared_ptr<CachedMaterial::Table<ValueT>> CachedMaterial::table(Tables<KeyT, ValueT>& tables, KeyT key) const {
+    OmpLockGuard<OmpLock> guard(cache_lock);
+    auto found = tables.find(key);
+    if (found != tables.end()) return found->second;
+    if (tables.size() >= settings.maxkeys) return nullptr;
+    // The returned copy keeps the table alive even if invalidate() removes it while the caller reads it
+    return tables.emplace(key, plask::make_shared<Table<ValueT>>(count)).first->second;
+}
+
+template <typename KeyT, typename ValueT, typename F>
+ValueT CachedMaterial::tabulated(Tables<KeyT, ValueT>& tables, KeyT key, double T, F func) const {
+    double t = (T - settings.Tmin) / settings.Tstep;
+    if (!(t >= 0.) || t >= double(count)) return func(T);
+    size_t i = size_t(t);
+
+    shared_ptr<Table<ValueT>> ptab = table(tables, key);
+    if (!ptab) return func(T);
+    Table<ValueT>& tab = *ptab;
+    char state = tab.states[i].load(std::memory_order_acquire);
+
+    if (state == Table<ValueT>::UNKNOWN) {
+        // Base material lock must be always acquired first, as the solvers may call us while holding it
+        OmpLockGuard<OmpNestLock> base_lock = base->lock();
+        OmpLockGuard<OmpLock> guard(cache_lock);
+        state = tab.states[i].load(std::memory_order_relaxed);
+        if (state == Table<ValueT>::UNKNOWN) {
+            double T0 = settings.Tmin + double(i) * settings.Tstep;
+            for (size_t j = i; j != i+2; ++j) {
+                if (!tab.known[j]) {
+                    tab.values[j] = func(settings.Tmin + double(j) * settings.Tstep);
+                    tab.known[j] = true;
+                }
+            }
+            ValueT middle = func(T0 + 0.5 * settings.Tstep);
+            state = isAccurate(0.5 * (tab.values[i] + tab.values[i+1]), middle, settings.tolerance) ?
+                        Table<ValueT>::TABULATED : Table<ValueT>::DIRECT;
+            tab.states[i].store(state, std::memory_order_release);
+        }
+    }
+
+    if (state == Table<ValueT>::DIRECT) return func(T);
+    double f = t - double(i);
+    return (1. - f) * tab.values[i] + f * tab.values[i+1];
+}
+
+double CachedMaterial::Eg(double T, double e, char point) const {
+    if (!(settings.parameters & PARAM_EG) || e != 0.) return base->Eg(T, e, point);
+    return tabulated(Eg_, point, T, [&](double t) { return base->Eg(t, 0., point); });
+}
+
+double CachedMaterial::CB(double T, double e, char point) const {
+    if (!(settings.parameters & PARAM_CB) || e != 0.) return base->CB(T, e, point);
+    return tabulated(CB_, point, T, [&](double t) { return base->CB(t, 0., point); });
+}
+
+double CachedMaterial::VB(double T, double e, char point, char hole) const {
+    if (!(settings.parameters & PARAM_VB) || e != 0.) return base->VB(T, e, point, hole);
+    return tabulated(VB_, std::make_pair(point, hole), T, [&](double t) { return base->VB(t, 0., point, hole); });
+}
+
+double CachedMaterial::eps(double T) const {
+    if (!(settings.parameters & PARAM_EPS)) return base->eps(T);
+    return tabulated(eps_, char(0), T, [&](double t) { return base->eps(t); });
+}
+
+double CachedMaterial::Ni(double T) const {
+    if (!(settings.parameters & PARAM_NI)) return base->Ni(T);
+    return tabulated(Ni_, char(0), T, [&](double t) { return base->Ni(t); });
+}
+
+Tensor2<double> CachedMaterial::mob(double T) const {
+    if (!(settings.parameters & PARAM_MOB)) return base->mob(T);
+    return tabulated(mob_, char(0), T, [&](double t) { return base->mob(t); });
+}
+
+Tensor2<double> CachedMaterial::cond(double T) const {
+    if (!(settings.parameters & PARAM_COND)) return base->cond(T);
+    return tabulated(cond_, char(0), T, [&](double t) { return base->cond(t); });
+}
+
+double CachedMaterial::A(double T) const {
+    if (!(settings.parameters & PARAM_A)) return base->A(T);
+    return tabulated(A_, char(0), T, [&](double t) { return base->A(t); });
+}
+
+double CachedMaterial::B(double T) const {
+    if (!(settings.parameters & PARAM_B)) return base->B(T);
+    return tabulated(B_, char(0), T, [&](double t) { return base->B(t); });
+}
+
+double CachedMaterial::C(double T) const {
+    if (!(settings.parameters & PARAM_C)) return base->C(T);
+    return tabulated(C_, char(0), T, [&](double t) { return base->C(t); });
+}
+
+double CachedMaterial::D(double T) const {
+    if (!(settings.parameters & PARAM_D)) return base->D(T);
+    return tabulated(D_, char(0), T, [&](double t) { return base->D(t); });
+}
+
+Tensor2<double> CachedMaterial::thermk(double T, double h) const {
+    if (!(settings.parameters & PARAM_THERMK) || isnan(h)) return base->thermk(T, h);
+    return tabulated(thermk_, h, T, [&](double t) { return base->thermk(t, h); });
+}
+
+double CachedMaterial::dens(double T) const {
+    if (!(settings.parameters & PARAM_DENS)) return base->dens(T);
+    return tabulated(dens_, char(0), T, [&](double t) { return base->dens(t); });
+}
+
+double CachedMaterial::cp(double T) const {
+    if (!(settings.parameters & PARAM_CP)) return base->cp(T);
+    return tabulated(cp_, char(0), T, [&](double t) { return base->cp(t); });
+}
+
+double CachedMaterial::nr(double lam, double T, double n) const {
+    if (!(settings.parameters & PARAM_NR) || n != 0. || isnan(lam)) return base->nr(lam, T, n);
+    return tabulated(nr_, lam, T, [&](double t) { return base->nr(lam, t, 0.); });
+}
+
+double CachedMaterial::absp(double lam, double T) const {
+    if (!(settings.parameters & PARAM_ABSP) || isnan(lam)) return base->absp(lam, T);
+    return tabulated(absp_, lam, T, [&](double t) { return base->absp(lam, t); });
+}
+
+dcomplex CachedMaterial::Nr(double lam, double T, double n) const {
+    if (!(settings.parameters & PARAM_NR_COMPLEX) || n != 0. || isnan(lam)) return base->Nr(lam, T, n);
+    return tabulated(Nr_, lam, T, [&](double t) { return base->Nr(lam, t, 0.); });
+}
+
+Tensor3<dcomplex> CachedMaterial::NR(double lam, double T, double n) const {
+    if (!(settings.parameters & PARAM_NR_TENSOR) || n != 0. || isnan(lam)) return base->NR(lam, T, n);
+    return tabulated(NR_, lam, T, [&](double t) { return base->NR(lam, t, 0.); });
+}
+
+Tensor2<double> CachedMaterial::mobe(double T) const {
+    if (!(settings.parameters & PARAM_MOBE)) return base->mobe(T);
+    return tabulated(mobe_, char(0), T, [&](double t) { return base->mobe(t); });
+}
+
+Tensor2<double> CachedMaterial::mobh(double T) const {
+    if (!(settings.parameters & PARAM_MOBH)) return base->mobh(T);
+    return tabulated(mobh_, char(0), T, [&](double t) { return base->mobh(t); });
+}
+
+double CachedMaterial::taue(double T) const {
+    if (!(settings.parameters & PARAM_TAUE)) return base->taue(T);
+    return tabulated(taue_, char(0), T, [&](double t) { return base->taue(t); });
+}
+
+double CachedMaterial::tauh(double T) const {
+    if (!(settings.parameters & PARAM_TAUH)) return base->tauh(T);
+    return tabulated(tauh_, char(0), T, [&](double t) { return base->tauh(t); });
+}
+
+double CachedMaterial::Ce(double T) const {
+    if (!(settings.parameters & PARAM_CE)) return base->Ce(T);
+    return tabulated(Ce_, char(0), T, [&](double t) { return base->Ce(t); });
+}
+
+double CachedMaterial::Ch(double T) const {
+    if (!(settings.parameters & PARAM_CH)) return base->Ch(T);
+    return tabulated(Ch_, char(0), T, [&](double t) { return base->Ch(t); });
+}
+
+}   // namespace plask
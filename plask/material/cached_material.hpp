@@ -0,0 +1,237 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2023 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__CACHED_MATERIAL_H
+#define PLASK__CACHED_MATERIAL_H
+
+/**
+ * \file
+ * Here is a definition of a material wrapper, which tabulates temperature dependence of parameters of its base material
+ */
+
+#include <atomic>
+#include <map>
+
+#include "material.hpp"
+#include "../parallel.hpp"
+
+namespace plask {
+
+/**
+ * Material wrapper, which tabulates selected parameters of its base material in temperature.
+ *
+ * Parameter values are computed lazily in the nodes of a regular temperature grid and linearly interpolated
+ * between them. When the interval is tabulated for the first time, the interpolated value in its middle is compared
+ * with the one given by the base material. If the relative difference exceeds the tolerance, the base material is
+ * called directly for all temperatures in this interval. Temperatures outside of the grid are always passed to
+ * the base material.
+ *
+ * Parameters depending on other arguments than temperature are tabulated separately for each distinct value
+ * of these arguments (e.g. for each wavelength). To bound the memory usage, only the first Settings::maxkeys
+ * distinct values are tabulated for each parameter and for the other ones the base material is called directly.
+ * Strain dependent parameters are tabulated only for zero strain and refractive indices only for zero carriers
+ * concentration.
+ */
+class PLASK_API CachedMaterial: public MaterialWithBase {
+
+  public:
+
+    /// Parameters which can be tabulated
+    enum Parameter: unsigned {
+        PARAM_EG = 1u << 0,
+        PARAM_CB = 1u << 1,
+        PARAM_VB = 1u << 2,
+        PARAM_EPS = 1u << 3,
+        PARAM_NI = 1u << 4,
+        PARAM_MOB = 1u << 5,
+        PARAM_COND = 1u << 6,
+        PARAM_A = 1u << 7,
+        PARAM_B = 1u << 8,
+        PARAM_C = 1u << 9,
+        PARAM_D = 1u << 10,
+        PARAM_THERMK = 1u << 11,
+        PARAM_DENS = 1u << 12,
+        PARAM_CP = 1u << 13,
+        PARAM_NR = 1u << 14,
+        PARAM_ABSP = 1u << 15,
+        PARAM_NR_COMPLEX = 1u << 16,
+        PARAM_MOBE = 1u << 17,
+        PARAM_MOBH = 1u << 18,
+        PARAM_TAUE = 1u << 19,
+        PARAM_TAUH = 1u << 20,
+        PARAM_CE = 1u << 21,
+        PARAM_CH = 1u << 22,
+        PARAM_NR_TENSOR = 1u << 23
+    };
+
+    /// Tabulation settings
+    struct Settings {
+        unsigned parameters;    ///< Tabulated parameters (bitwise or of Parameter values)
+        double Tmin;            ///< Lowest tabulated temperature [K]
+        double Tmax;            ///< Highest tabulated temperature [K]
+        double Tstep;           ///< Temperature step [K]
+        double tolerance;       ///< Maximum relative interpolation error in the middle of a tabulated interval
+        size_t maxkeys;         ///< Maximum number of tabulated values of other arguments (e.g. wavelengths) per parameter
+
+        Settings(unsigned parameters, double Tmin = 200., double Tmax = 1000., double Tstep = 1., double tolerance = 1e-4,
+                 size_t maxkeys = 16);
+
+        bool operator==(const Settings& other) const {
+            return parameters == other.parameters && Tmin == other.Tmin && Tmax == other.Tmax &&
+                   Tstep == other.Tstep && tolerance == other.tolerance && maxkeys == other.maxkeys;
+        }
+    };
+
+    /**
+     * Parse tabulated parameters
+     * \param names parameter names (as the names of Material methods) separated by spaces or commas
+     * \return bitwise or of the parameters
+     */
+    static unsigned parseParameters(const std::string& names);
+
+  private:
+
+    /**
+     * Values of a single parameter in the temperature grid, for fixed other arguments
+     */
+    template <typename ValueT> struct Table {
+        /// State of each interval
+        enum: char { UNKNOWN = 0, TABULATED = 1, DIRECT = 2 };
+        std::vector<ValueT> values;
+        std::vector<bool> known;    ///< Flags indicating computed nodes (accessed only under the lock)
+        std::unique_ptr<std::atomic<char>[]> states;
+        Table(size_t n): values(n+1), known(n+1, false), states(new std::atomic<char>[n]) {
+            for (size_t i = 0; i != n; ++i) states[i].store(UNKNOWN, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * Tables of a single parameter for distinct values of its other arguments.
+     * Parameters depending only on temperature use a single table with zero key.
+     * Tables are shared, so the ones dropped by invalidate() stay alive until other threads finish using them.
+     */
+    template <typename KeyT, typename ValueT> using Tables = std::map<KeyT, shared_ptr<Table<ValueT>>>;
+
+    Settings settings;
+    size_t count;   ///< Number of temperature intervals
+
+    mutable OmpLock cache_lock;
+
+    mutable Tables<char, double> Eg_, CB_;
+    mutable Tables<std::pair<char,char>, double> VB_;
+    mutable Tables<char, double> eps_, Ni_, A_, B_, C_, D_, dens_, cp_, taue_, tauh_, Ce_, Ch_;
+    mutable Tables<char, Tensor2<double>> mob_, cond_, mobe_, mobh_;
+    mutable Tables<double, Tensor2<double>> thermk_;
+    mutable Tables<double, double> nr_, absp_;
+    mutable Tables<double, dcomplex> Nr_;
+    mutable Tables<double, Tensor3<dcomplex>> NR_;
+
+    /// Get the table for given key or \c nullptr if there are already Settings::maxkeys other tables
+    template <typename KeyT, typename ValueT>
+    shared_ptr<Table<ValueT>> table(Tables<KeyT, ValueT>& tables, KeyT key) const;
+
+    template <typename KeyT, typename ValueT, typename F>
+    ValueT tabulated(Tables<KeyT, ValueT>& tables, KeyT key, double T, F func) const;
+
+  public:
+
+    /**
+     * Create tabulating wrapper
+     * \param base base material
+     * \param settings tabulation settings
+     */
+    CachedMaterial(const shared_ptr<Material>& base, const Settings& settings);
+
+    /// Tabulation settings
+    const Settings& getSettings() const { return settings; }
+
+    /**
+     * Drop all tabulated values.
+     * This must be called if the parameters of the base material changed. It is safe to call it while
+     * the material parameters are being read by other threads, however such concurrent reads may still return
+     * the values tabulated before.
+     */
+    void invalidate();
+
+    OmpLockGuard<OmpNestLock> lock() const override { return base->lock(); }
+
+    bool isEqual(const Material& other) const override {
+        const CachedMaterial& cother = static_cast<const CachedMaterial&>(other);
+        return *base == *cother.base && settings == cother.settings;
+    }
+
+    std::string name() const override { return base->name(); }
+    std::string str() const override { return base->str(); }
+    Composition composition() const override { return base->composition(); }
+    double doping() const override { return base->doping(); }
+    Material::Kind kind() const override { return base->kind(); }
+    Material::ConductivityType condtype() const override { return base->condtype(); }
+
+    double lattC(double T, char x) const override { return base->lattC(T, x); }
+    double Eg(double T, double e=0., char point='*') const override;
+    double CB(double T, double e=0., char point='*') const override;
+    double VB(double T, double e=0., char point='*', char hole='H') const override;
+    double Dso(double T, double e=0.) const override { return base->Dso(T, e); }
+    double Mso(double T, double e=0.) const override { return base->Mso(T, e); }
+    Tensor2<double> Me(double T, double e=0., char point='*') const override { return base->Me(T, e, point); }
+    Tensor2<double> Mhh(double T, double e=0.) const override { return base->Mhh(T, e); }
+    Tensor2<double> Mlh(double T, double e=0.) const override { return base->Mlh(T, e); }
+    Tensor2<double> Mh(double T, double e=0.) const override { return base->Mh(T, e); }
+    double y1() const override { return base->y1(); }
+    double y2() const override { return base->y2(); }
+    double y3() const override { return base->y3(); }
+    double ac(double T) const override { return base->ac(T); }
+    double av(double T) const override { return base->av(T); }
+    double b(double T) const override { return base->b(T); }
+    double d(double T) const override { return base->d(T); }
+    double c11(double T) const override { return base->c11(T); }
+    double c12(double T) const override { return base->c12(T); }
+    double c44(double T) const override { return base->c44(T); }
+    double eps(double T) const override;
+    double chi(double T, double e=0., char point='*') const override { return base->chi(T, e, point); }
+    double Ni(double T) const override;
+    double Nf(double T) const override { return base->Nf(T); }
+    double EactD(double T) const override { return base->EactD(T); }
+    double EactA(double T) const override { return base->EactA(T); }
+    Tensor2<double> mob(double T) const override;
+    Tensor2<double> cond(double T) const override;
+    double A(double T) const override;
+    double B(double T) const override;
+    double C(double T) const override;
+    double D(double T) const override;
+    Tensor2<double> thermk(double T, double h=INFINITY) const override;
+    double dens(double T) const override;
+    double cp(double T) const override;
+    double nr(double lam, double T, double n = 0) const override;
+    double absp(double lam, double T) const override;
+    dcomplex Nr(double lam, double T, double n = 0) const override;
+    Tensor3<dcomplex> NR(double lam, double T, double n = 0) const override;
+    Tensor2<double> mobe(double T) const override;
+    Tensor2<double> mobh(double T) const override;
+    double taue(double T) const override;
+    double tauh(double T) const override;
+    double Ce(double T) const override;
+    double Ch(double T) const override;
+    double e13(double T) const override { return base->e13(T); }
+    double e15(double T) const override { return base->e15(T); }
+    double e33(double T) const override { return base->e33(T); }
+    double c13(double T) const override { return base->c13(T); }
+    double c33(double T) const override { return base->c33(T); }
+    double Psp(double T) const override { return base->Psp(T); }
+    double Na() const override { return base->Na(); }
+    double Nd() const override { return base->Nd(); }
+};
+
+}   // namespace plask
+
+#endif // PLASK__CACHED_MATERIAL_H
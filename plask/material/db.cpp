@@ -20,6 +20,7 @@
 #include "../log/log.hpp"
 
 #include <boost/filesystem.hpp>
+#include <algorithm>
 
 namespace plask {
 
@@ -196,6 +197,29 @@ bool MaterialsDB::ProxyMaterialConstructor::isAlloy() const {
 }
 
 
+MaterialsDB::CachedMaterialConstructor::CachedMaterialConstructor(const shared_ptr<const MaterialConstructor>& constructor,
+                                                                  const CachedMaterial::Settings& settings):
+    MaterialsDB::MaterialConstructor(constructor->materialName), constructor(constructor), settings(settings)
+{}
+
+shared_ptr<Material> MaterialsDB::CachedMaterialConstructor::operator()(const Material::Composition& comp, double dop) const {
+    auto material = plask::make_shared<CachedMaterial>((*constructor)(comp, dop), settings);
+    OmpLockGuard<OmpLock> lock(materials_lock);
+    if (materials.size() == materials.capacity())
+        materials.erase(std::remove_if(materials.begin(), materials.end(),
+                                       [](const weak_ptr<CachedMaterial>& item) { return item.expired(); }),
+                        materials.end());
+    materials.push_back(material);
+    return material;
+}
+
+void MaterialsDB::CachedMaterialConstructor::invalidate() const {
+    OmpLockGuard<OmpLock> lock(materials_lock);
+    for (const auto& item: materials)
+        if (auto material = item.lock()) material->invalidate();
+}
+
+
 shared_ptr<const MaterialsDB::MaterialConstructor> MaterialsDB::getConstructor(const std::string& db_Key, const Material::Composition& composition, bool allow_alloy_without_composition) const {
     auto it = constructors.find(db_Key);
     if (it == constructors.end()) {
@@ -325,6 +349,25 @@ void MaterialsDB::addAlloy(shared_ptr<MaterialConstructor> constructor) {
     constructors[alloyDbKey(constructor->materialName)] = constructor;
 }
 
+void MaterialsDB::cache(const std::string& name, const CachedMaterial::Settings& settings) {
+    auto it = constructors.find(name);
+    if (it == constructors.end()) it = constructors.find(alloyDbKey(name));
+    if (it == constructors.end()) throw NoSuchMaterial(name);
+    shared_ptr<const MaterialConstructor> constructor = it->second;
+    if (auto cached = dynamic_pointer_cast<const CachedMaterialConstructor>(constructor))
+        constructor = cached->constructor;
+    if (settings.parameters == 0)
+        it->second = constructor;
+    else
+        it->second = plask::make_shared<CachedMaterialConstructor>(constructor, settings);
+}
+
+void MaterialsDB::invalidateCached() const {
+    for (const auto& item: constructors)
+        if (auto cached = dynamic_pointer_cast<const CachedMaterialConstructor>(item.second))
+            cached->invalidate();
+}
+
 void MaterialsDB::removeSimple(const std::string& name) {
     constructors.erase(name);
 }
@@ -17,6 +17,7 @@
 #include <functional>
 #include "material.hpp"
 #include "const_material.hpp"
+#include "cached_material.hpp"
 
 #include <boost/iterator/transform_iterator.hpp>
 #include "../utils/system.hpp"
@@ -440,6 +441,31 @@ public:
         bool isAlloy() const override;
     };
 
+    /**
+     * Material constructor that wraps materials created by other constructor in CachedMaterial.
+     */
+    class PLASK_API CachedMaterialConstructor: public MaterialConstructor {
+        mutable OmpLock materials_lock;
+        mutable std::vector<weak_ptr<CachedMaterial>> materials;
+
+      public:
+        /// Wrapped constructor
+        shared_ptr<const MaterialConstructor> constructor;
+
+        /// Tabulation settings
+        CachedMaterial::Settings settings;
+
+        CachedMaterialConstructor(const shared_ptr<const MaterialConstructor>& constructor,
+                                  const CachedMaterial::Settings& settings);
+
+        shared_ptr<Material> operator()(const Material::Composition& comp, double dop) const override;
+
+        bool isAlloy() const override { return constructor->isAlloy(); }
+
+        /// Drop tabulated values of all existing materials created by this constructor
+        void invalidate() const;
+    };
+
     /**
      * Create material object.
      * @param composition complete objects composition
@@ -569,6 +595,24 @@ public:
     template <typename MaterialType>
     void add() { add<MaterialType>(MaterialType::NAME); }
 
+    /**
+     * Tabulate parameters of the materials with given name.
+     *
+     * The material constructor is wrapped, so all materials created by it later are CachedMaterial.
+     * Calling this method again for the same material replaces the settings. If no parameters are given,
+     * the original constructor is restored.
+     * @param name material name, in format name[:dopant]
+     * @param settings tabulation settings
+     * @throw NoSuchMaterial if database doesn't know material with name @p name
+     */
+    void cache(const std::string& name, const CachedMaterial::Settings& settings);
+
+    /**
+     * Drop tabulated parameters of all existing cached materials.
+     * This must be called after the parameters of the base materials are changed.
+     */
+    void invalidateCached() const;
+
     /**
      * Remove simple material (which not require composition parsing) from DB.
      * @param name material name, in format name[:dopant]
@@ -222,6 +222,22 @@ Tensor3<dcomplex> Material::NR(double lam, double T, double n) const {
     return Nr(lam, T, n);
 }
 
+DataVector<Tensor3<dcomplex>> Material::batchNR(double lam, const DataVector<const double>& T,
+                                                const DataVector<const double>& n) const {
+    assert(T.size() == n.size());
+    DataVector<Tensor3<dcomplex>> result(T.size());
+    OmpLockGuard<OmpNestLock> guard = lock();
+    for (size_t i = 0; i != T.size(); ++i) result[i] = NR(lam, T[i], n[i]);
+    return result;
+}
+
+DataVector<Tensor3<dcomplex>> Material::spectralNR(const DataVector<const double>& lam, double T, double n) const {
+    DataVector<Tensor3<dcomplex>> result(lam.size());
+    OmpLockGuard<OmpNestLock> guard = lock();
+    for (size_t i = 0; i != lam.size(); ++i) result[i] = NR(lam[i], T, n);
+    return result;
+}
+
 bool Material::operator ==(const Material &other) const {
     return typeid(*this) == typeid(other) && this->isEqual(other);
 }
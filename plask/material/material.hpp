@@ -33,6 +33,7 @@ This file contains base classes for materials and material database class.
 #include "../vector/tensor2.hpp"
 #include "../vector/tensor3.hpp"
 #include "../parallel.hpp"
+#include "../data.hpp"
 #include "../optional.hpp"
 
 #define RETURN_MATERIAL_NAN(param) \
@@ -732,6 +733,29 @@ struct PLASK_API Material {
      */
     virtual Tensor3<dcomplex> NR(double lam, double T, double n = 0) const;
 
+    /**
+     * Get anisotropic refractive index tensors NR (-) for multiple temperatures and carriers concentrations.
+     * Default implementation calls NR for each point, keeping the material locked for the whole batch.
+     * Materials, for which the lock is costly, should call this method rather than NR for each point separately.
+     * @param lam Wavelength (nm)
+     * @param T temperatures (K)
+     * @param n injected carriers concentrations (1/cm), must have the same size as @p T
+     * @return refractive index tensors NR(-) at each point
+     */
+    virtual DataVector<Tensor3<dcomplex>> batchNR(double lam, const DataVector<const double>& T,
+                                                  const DataVector<const double>& n) const;
+
+    /**
+     * Get anisotropic refractive index tensors NR (-) for multiple wavelengths.
+     * Default implementation calls NR for each wavelength, keeping the material locked for the whole batch.
+     * Materials with dispersion formulas, which can be evaluated faster for the whole spectrum, may override it.
+     * @param lam wavelengths (nm)
+     * @param T temperature (K)
+     * @param n injected carriers concentration (1/cm)
+     * @return refractive index tensors NR(-) at each wavelength
+     */
+    virtual DataVector<Tensor3<dcomplex>> spectralNR(const DataVector<const double>& lam, double T, double n = 0) const;
+
     // #330:
 
     /**
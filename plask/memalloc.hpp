@@ -14,38 +14,64 @@
 #ifndef PLASK__MEMALLOC_H
 #define PLASK__MEMALLOC_H
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
+
+#include <plask/config.hpp>
 
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
 #include <malloc.h>
 #endif
 
+#if defined(PLASK_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <utility>
 #include <limits>
 #include <new>
 
+#include "utils/openmp.hpp"
+
+/// Alignment (in bytes) of all memory allocated with aligned_malloc. It must be a power of two not less than 16.
+#ifndef PLASK_MEMORY_ALIGNMENT
+#   define PLASK_MEMORY_ALIGNMENT 64
+#endif
+
 namespace plask {
 
-#if (defined(__GLIBC__) && ((__GLIBC__>=2 && __GLIBC_MINOR__ >= 8) || __GLIBC__>2) && defined(__LP64__)) || \
-    defined(__APPLE__) || defined(_WIN64) || (defined(__FreeBSD__) && !defined(__arm__) && !defined(__mips__))
-#   define PLASK_MALLOC_ALIGNED 1
-#else
-#   define PLASK_MALLOC_ALIGNED 0
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+#   define PLASK_MALLOC_ALIGNED_WIN 1
+#elif defined(__unix__) || defined(__APPLE__)
+#   define PLASK_MALLOC_ALIGNED_POSIX 1
 #endif
 
+static_assert(PLASK_MEMORY_ALIGNMENT >= 16 && (PLASK_MEMORY_ALIGNMENT & (PLASK_MEMORY_ALIGNMENT-1)) == 0,
+              "PLASK_MEMORY_ALIGNMENT must be a power of two not less than 16");
+
+/// Size (in bytes) of the buffers for which transparent huge pages are requested (if enabled).
+constexpr std::size_t HUGE_PAGE_MIN_SIZE = std::size_t(2) << 20;
+
+/// Size (in bytes) of the buffers which are initialized in parallel by parallel_fill_n.
+constexpr std::size_t PARALLEL_FILL_MIN_SIZE = std::size_t(1) << 20;
 
-#if !PLASK_MALLOC_ALIGNED && !defined(_MSC_VER)
 namespace detail {
 
+#if !defined(PLASK_MALLOC_ALIGNED_WIN) && !defined(PLASK_MALLOC_ALIGNED_POSIX)
+
     /**
-     * \internal Like malloc, but the returned pointer is guaranteed to be 16-byte aligned.
+     * \internal Like malloc, but the returned pointer is guaranteed to be PLASK_MEMORY_ALIGNMENT-byte aligned.
      */
     inline void* custom_aligned_malloc(std::size_t size)
     {
-        void *original = std::malloc(size+16);
+        void *original = std::malloc(size+PLASK_MEMORY_ALIGNMENT);
         if (original == 0) return 0;
-        void *aligned = reinterpret_cast<void*>((reinterpret_cast<size_t>(original) & ~(size_t(15))) + 16);
+        void *aligned = reinterpret_cast<void*>((reinterpret_cast<size_t>(original) & ~(size_t(PLASK_MEMORY_ALIGNMENT-1))) + PLASK_MEMORY_ALIGNMENT);
         *(reinterpret_cast<void**>(aligned) - 1) = original;
         return aligned;
     }
@@ -65,32 +91,54 @@ namespace detail {
     {
         if (ptr == 0) return custom_aligned_malloc(size);
         void *original = *(reinterpret_cast<void**>(ptr) - 1);
-        original = std::realloc(original,size+16);
+        std::ptrdiff_t old_offset = reinterpret_cast<char*>(ptr) - reinterpret_cast<char*>(original);
+        original = std::realloc(original, size+PLASK_MEMORY_ALIGNMENT);
         if (original == 0) return 0;
-        void *aligned = reinterpret_cast<void*>((reinterpret_cast<size_t>(original) & ~(size_t(15))) + 16);
+        void *aligned = reinterpret_cast<void*>((reinterpret_cast<size_t>(original) & ~(size_t(PLASK_MEMORY_ALIGNMENT-1))) + PLASK_MEMORY_ALIGNMENT);
+        void *previous = reinterpret_cast<char*>(original) + old_offset;
+        if (aligned != previous) std::memmove(aligned, previous, size);    // realloc may have changed the offset to alignment
         *(reinterpret_cast<void**>(aligned) - 1) = original;
         return aligned;
     }
 
-}
 #endif
 
+    /**
+     * \internal Advise the kernel to back a large buffer with transparent huge pages.
+     * It does nothing unless PLASK_HUGE_PAGES is enabled, or if the system does not support it.
+     */
+    inline void advise_huge_pages(void* ptr, std::size_t size)
+    {
+#if defined(PLASK_HUGE_PAGES) && defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (!ptr || size < HUGE_PAGE_MIN_SIZE) return;
+        static const std::uintptr_t page = std::uintptr_t(sysconf(_SC_PAGESIZE));
+        std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(ptr) + page - 1) & ~(page - 1),   // madvise requires page aligned range
+                       end = (reinterpret_cast<std::uintptr_t>(ptr) + size) & ~(page - 1);
+        if (begin < end) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);    // this is only a hint, so errors are ignored
+#else
+        (void) ptr; (void) size;
+#endif
+    }
+
+}
+
 /**
- * Allocate \a size bytes. The returned pointer is guaranteed to have 16 bytes alignment.
+ * Allocate \a size bytes. The returned pointer is guaranteed to have PLASK_MEMORY_ALIGNMENT (64 by default) bytes alignment.
  * \param size number of bytes to allocate
  * \throws std::bad_alloc on allocation failure
  */
 inline void* aligned_malloc(std::size_t size)
 {
     void *result;
-#if PLASK_MALLOC_ALIGNED
-    result = std::malloc(size);
-#elif defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
-    result = _aligned_malloc(size, 16);
+#if defined(PLASK_MALLOC_ALIGNED_POSIX)
+    if (posix_memalign(&result, PLASK_MEMORY_ALIGNMENT, size) != 0) result = 0;
+#elif defined(PLASK_MALLOC_ALIGNED_WIN)
+    result = _aligned_malloc(size, PLASK_MEMORY_ALIGNMENT);
 #else
     result = detail::custom_aligned_malloc(size);
 #endif
     if(!result && size) throw std::bad_alloc();
+    detail::advise_huge_pages(result, size);
     return result;
 }
 
@@ -101,9 +149,9 @@ inline void* aligned_malloc(std::size_t size)
 inline void aligned_free(void *ptr)
 {
     if (!ptr) return;
-#if PLASK_MALLOC_ALIGNED
+#if defined(PLASK_MALLOC_ALIGNED_POSIX)
     std::free(ptr);
-#elif defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+#elif defined(PLASK_MALLOC_ALIGNED_WIN)
     _aligned_free(ptr);
 #else
     detail::custom_aligned_free(ptr);
@@ -121,17 +169,49 @@ inline void* aligned_realloc(void *ptr, std::size_t new_size, std::size_t old_si
 {
     (void) old_size;    // don't warn about unused old_size
     void *result;
-#if PLASK_MALLOC_ALIGNED
-    result = std::realloc(ptr,new_size);
-#elif defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
-    result = _aligned_realloc(ptr,new_size,16);
+#if defined(PLASK_MALLOC_ALIGNED_POSIX)
+    result = std::realloc(ptr, new_size);
+    if (result && reinterpret_cast<std::uintptr_t>(result) % PLASK_MEMORY_ALIGNMENT != 0) {
+        // realloc guarantees only the alignment of malloc, so the data must be moved to aligned memory
+        void *aligned;
+        if (posix_memalign(&aligned, PLASK_MEMORY_ALIGNMENT, new_size) != 0) {
+            std::free(result);
+            throw std::bad_alloc();
+        }
+        std::memcpy(aligned, result, new_size);
+        std::free(result);
+        result = aligned;
+    }
+#elif defined(PLASK_MALLOC_ALIGNED_WIN)
+    result = _aligned_realloc(ptr, new_size, PLASK_MEMORY_ALIGNMENT);
 #else
-    result = detail::custom_aligned_realloc(ptr,new_size,old_size);
+    result = detail::custom_aligned_realloc(ptr, new_size, old_size);
 #endif
     if (!result && new_size) throw std::bad_alloc();
+    detail::advise_huge_pages(result, new_size);
     return result;
 }
 
+/**
+ * Fill @p num elements starting from @p ptr with @p value.
+ *
+ * Large buffers are filled by all OpenMP threads, each writing the same contiguous part as a static schedule
+ * would give it. Filling a freshly allocated buffer in this way places its memory pages on the NUMA nodes of
+ * the threads which use them (first-touch policy).
+ * \param ptr pointer to the first element
+ * \param num number of elements to fill
+ * \param value value to fill with
+ */
+template <typename T>
+inline void parallel_fill_n(T* ptr, std::size_t num, const T& value) {
+    if (!std::is_nothrow_copy_assignable<T>::value || num * sizeof(T) < PARALLEL_FILL_MIN_SIZE) {
+        std::fill_n(ptr, num, value);
+        return;
+    }
+    #pragma omp parallel for schedule(static)
+    for (openmp_size_t i = 0; i < openmp_size_t(num); ++i) ptr[i] = value;
+}
+
 /**
  * Create new data with aligned allocation.
  * \tparam T object type
@@ -228,7 +308,7 @@ inline void aligned_delete_array(std::size_t num, T* ptr) {
 }
 
 /**
- * STL compatible allocator to use with with 16 byte aligned types
+ * STL compatible allocator to use with with PLASK_MEMORY_ALIGNMENT byte aligned types
  */
 template<class T>
 struct aligned_allocator {
@@ -81,6 +81,19 @@ std::size_t TranslatedMesh<DIM>::size() const {
 template struct PLASK_API TranslatedMesh<2>;
 template struct PLASK_API TranslatedMesh<3>;
 
+template <int DIM>
+typename IndexedSubMesh<DIM>::DVec IndexedSubMesh<DIM>::at(std::size_t index) const {
+    return sourceMesh->at(indices[index]);
+}
+
+template <int DIM>
+std::size_t IndexedSubMesh<DIM>::size() const {
+    return indices.size();
+}
+
+template struct PLASK_API IndexedSubMesh<2>;
+template struct PLASK_API IndexedSubMesh<3>;
+
 
 
 }   // namespace plask
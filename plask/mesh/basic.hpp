@@ -19,6 +19,8 @@ This file contains some basic meshes.
 @see @ref meshes
 */
 
+#include <vector>
+
 #include "mesh.hpp"
 
 namespace plask {
@@ -85,6 +87,31 @@ struct PLASK_API TranslatedMesh: public MeshD<DIM> {
 PLASK_API_EXTERN_TEMPLATE_STRUCT(TranslatedMesh<2>)
 PLASK_API_EXTERN_TEMPLATE_STRUCT(TranslatedMesh<3>)
 
+/**
+ * Mesh which consists of the selected points of another mesh.
+ */
+template <int DIM>
+struct PLASK_API IndexedSubMesh: public MeshD<DIM> {
+
+    typedef Vec<DIM, double> DVec;
+
+    const shared_ptr<const MeshD<DIM>> sourceMesh;
+
+    /// Indices of the points of the source mesh included in this mesh
+    const std::vector<std::size_t> indices;
+
+    IndexedSubMesh(const shared_ptr<const MeshD<DIM>>& sourceMesh, std::vector<std::size_t> indices)
+        : sourceMesh(sourceMesh), indices(std::move(indices)) {}
+
+    DVec at(std::size_t index) const override;
+
+    std::size_t size() const override;
+
+};
+
+PLASK_API_EXTERN_TEMPLATE_STRUCT(IndexedSubMesh<2>)
+PLASK_API_EXTERN_TEMPLATE_STRUCT(IndexedSubMesh<3>)
+
 //TODO return special type for rectangular meshes
 template <int DIM>
 inline shared_ptr<TranslatedMesh<DIM>> translate(const shared_ptr<const MeshD<DIM>>& sourceMesh, const Vec<DIM, double>& translation) {
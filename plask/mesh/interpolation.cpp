@@ -27,4 +27,70 @@ const char* interpolationMethodNames[__ILLEGAL_INTERPOLATION_METHOD__+1] = {
     "ILLEGAL"
 };
 
+namespace {
+
+    /// Cached plan for a pair of meshes (null until the meshes are interpolated for the second time)
+    struct InterpolationPlanEntry {
+        shared_ptr<const InterpolationPlan> plan;
+    };
+
+    /// Lock guarding all the cached interpolation plans
+    OmpLock interpolation_plans_lock;
+
+    /**
+     * Strategy of removing from cache which removes key always when it is changed.
+     * Unlike CacheRemoveOnEachChange it holds @ref interpolation_plans_lock while modifying the cache map, as the mesh
+     * change signals may be emitted concurrently with the cache lookup in other threads.
+     */
+    template <typename Key, typename ValuePtr>
+    struct CacheRemoveOnEachChangeLocked: public CacheRemoveStrategyBase<Key, ValuePtr> {
+
+        /// Remove source of event from cache map.
+        void onEvent(typename Key::Event& evt) {
+            OmpLockGuard<OmpLock> lock(interpolation_plans_lock);
+            auto* src = evt.source();
+            src->changedDisconnectMethod(this, &CacheRemoveOnEachChangeLocked::onEvent);
+            this->map.erase(src);
+        }
+    };
+
+    /// Interpolation plans from a single source mesh, indexed by the destination mesh
+    struct InterpolationPlans {
+        StrongCache<Mesh, InterpolationPlanEntry, CacheRemoveOnEachChangeLocked> entries;
+    };
+
+    /// Interpolation plans indexed by the source mesh
+    StrongCache<Mesh, InterpolationPlans, CacheRemoveOnEachChangeLocked> interpolation_plans;
+
+    inline Mesh* key(const Mesh& mesh) { return const_cast<Mesh*>(&mesh); }
+
+    shared_ptr<InterpolationPlanEntry> getInterpolationPlanEntry(const Mesh& src_mesh, const Mesh& dst_mesh, bool& found) {
+        shared_ptr<InterpolationPlans> plans = interpolation_plans.get(key(src_mesh));
+        if (!plans) plans = interpolation_plans(key(src_mesh), new InterpolationPlans);
+        shared_ptr<InterpolationPlanEntry> entry = plans->entries.get(key(dst_mesh));
+        found = bool(entry);
+        if (!found) entry = plans->entries(key(dst_mesh), new InterpolationPlanEntry);
+        return entry;
+    }
+}
+
+constexpr std::size_t InterpolationPlan::INVALID_INDEX;
+
+bool InterpolationPlan::cached(const Mesh& src_mesh, const Mesh& dst_mesh, const InterpolationFlags& flags,
+                               shared_ptr<const InterpolationPlan>& plan) {
+    OmpLockGuard<OmpLock> lock(interpolation_plans_lock);
+    bool found;
+    auto entry = getInterpolationPlanEntry(src_mesh, dst_mesh, found);
+    if (entry->plan && entry->plan->flags == flags && entry->plan->src_size == src_mesh.size() &&
+        entry->plan->size() == dst_mesh.size())
+        plan = entry->plan;
+    return found;
+}
+
+void InterpolationPlan::store(const Mesh& src_mesh, const Mesh& dst_mesh, const shared_ptr<const InterpolationPlan>& plan) {
+    OmpLockGuard<OmpLock> lock(interpolation_plans_lock);
+    bool found;
+    getInterpolationPlanEntry(src_mesh, dst_mesh, found)->plan = plan;
+}
+
 }   // namespace plask
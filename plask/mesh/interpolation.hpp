@@ -210,6 +210,14 @@ public:
     InterpolationFlags(shared_ptr<const Geometry3D> geometry): InterpolationFlags(geometry, Symmetry::POSITIVE, Symmetry::POSITIVE, Symmetry::POSITIVE) {}
     InterpolationFlags(shared_ptr<Geometry3D> geometry): InterpolationFlags(geometry, Symmetry::POSITIVE, Symmetry::POSITIVE, Symmetry::POSITIVE) {}
 
+    bool operator==(const InterpolationFlags& other) const {
+        for (int i = 0; i != 3; ++i)
+            if (sym[i] != other.sym[i] || lo[i] != other.lo[i] || hi[i] != other.hi[i]) return false;
+        return per == other.per;
+    }
+
+    bool operator!=(const InterpolationFlags& other) const { return !(*this == other); }
+
     unsigned char symmetric(int axis) const { return sym[axis]; }
 
     bool periodic(int axis) const { return (per & (1 << axis)) != 0; }
@@ -269,22 +277,46 @@ public:
         else return val;
     }
 
-    template <int dim, typename DataT>
-    DataT postprocess(Vec<dim> pos, DataT data) const {
+    /**
+     * Get axes along which the interpolated data must be reflected in postprocessing
+     * @param pos unwrapped point in which the data is interpolated
+     * @return bit mask of the axes
+     */
+    template <int dim>
+    unsigned char reflectedAxes(Vec<dim> pos) const {
+        unsigned char axes = 0;
         for (int i = 0; i != dim; ++i) {
             if (sym[i]) {
                 if (periodic(i)) {
                     double d = hi[i] - lo[i];
                     pos[i] = std::fmod(pos[i], 2.*d);
-                    if (pos[i] > d || (pos[i] < 0. && pos[i] > -d)) data = reflect(i, data);
+                    if (pos[i] > d || (pos[i] < 0. && pos[i] > -d)) axes |= 1 << i;
                 } else {
-                    if (lo[i] >= 0.) { if (pos[i] < 0.) data = reflect(i, data); }
-                    else { if (pos[i] > 0.) data = reflect(i, data); }
+                    if (lo[i] >= 0.) { if (pos[i] < 0.) axes |= 1 << i; }
+                    else { if (pos[i] > 0.) axes |= 1 << i; }
                 }
             }
         }
+        return axes;
+    }
+
+    /**
+     * Reflect data along given axes
+     * @param axes bit mask of the axes
+     * @param data data to reflect
+     * @return reflected data
+     */
+    template <typename DataT>
+    DataT reflectAxes(unsigned char axes, DataT data) const {
+        for (int i = 0; axes; ++i, axes >>= 1)
+            if (axes & 1) data = reflect(i, data);
         return data;
     }
+
+    template <int dim, typename DataT>
+    DataT postprocess(Vec<dim> pos, DataT data) const {
+        return reflectAxes(reflectedAxes(pos), data);
+    }
 };
 
 /**
@@ -465,6 +497,257 @@ struct NearestNeighborInterpolatedLazyDataImpl: public InterpolatedLazyDataImpl<
 
 };
 
+/**
+ * Symbolic value recording how linear interpolation combines the source data.
+ *
+ * It holds a linear combination of the source nodes. Interpolating a container of such values (see
+ * LinearInterpolationProbe::Source) with @c interpolateLinear method of the source mesh gives the nodes and weights
+ * used for the requested point.
+ */
+struct LinearInterpolationProbe {
+    /// Maximum number of terms (as in trilinear interpolation)
+    static constexpr unsigned MAX_TERMS = 8;
+
+    /// Value of @c count marking the probe as NaN (point outside of the source mesh)
+    static constexpr unsigned INVALID = ~0u;
+
+    std::size_t indices[MAX_TERMS];         ///< Indices of the source nodes
+    double weights[MAX_TERMS];              ///< Weights of the source nodes
+    unsigned char reflections[MAX_TERMS];   ///< Axes along which the source values are reflected (bit mask)
+    unsigned count;                         ///< Number of terms
+
+    /// Container of probes, for which i-th element represents i-th source node
+    struct Source {
+        LinearInterpolationProbe operator[](std::size_t index) const { return LinearInterpolationProbe(index); }
+    };
+
+    LinearInterpolationProbe(): count(0) {}
+
+    explicit LinearInterpolationProbe(std::size_t index): count(1) {
+        indices[0] = index; weights[0] = 1.; reflections[0] = 0;
+    }
+
+    bool valid() const { return count != INVALID; }
+
+    /// Make the probe NaN
+    void invalidate() { count = INVALID; }
+
+    /// Reflect the value along axis @p ax
+    void reflect(int ax) {
+        if (valid()) for (unsigned i = 0; i != count; ++i) reflections[i] ^= (unsigned char)(1 << ax);
+    }
+
+    friend LinearInterpolationProbe operator+(LinearInterpolationProbe a, const LinearInterpolationProbe& b) { a.add(b, 1.); return a; }
+    friend LinearInterpolationProbe operator-(LinearInterpolationProbe a, const LinearInterpolationProbe& b) { a.add(b, -1.); return a; }
+    friend LinearInterpolationProbe operator-(LinearInterpolationProbe a) { a.scale(-1.); return a; }
+    friend LinearInterpolationProbe operator*(LinearInterpolationProbe a, double f) { a.scale(f); return a; }
+    friend LinearInterpolationProbe operator*(double f, LinearInterpolationProbe a) { a.scale(f); return a; }
+    friend LinearInterpolationProbe operator/(LinearInterpolationProbe a, double f) { a.scale(1. / f); return a; }
+
+  private:
+
+    void add(const LinearInterpolationProbe& other, double factor) {
+        if (!valid()) return;
+        if (!other.valid()) { invalidate(); return; }
+        for (unsigned j = 0; j != other.count; ++j) {
+            unsigned i = 0;
+            while (i != count && (indices[i] != other.indices[j] || reflections[i] != other.reflections[j])) ++i;
+            if (i == count) {
+                assert(count < MAX_TERMS);
+                indices[i] = other.indices[j]; weights[i] = 0.; reflections[i] = other.reflections[j];
+                ++count;
+            }
+            weights[i] += factor * other.weights[j];
+        }
+    }
+
+    void scale(double f) {
+        if (valid()) for (unsigned i = 0; i != count; ++i) weights[i] *= f;
+    }
+};
+
+template <>
+struct NaNImpl<LinearInterpolationProbe> {
+    static LinearInterpolationProbe get() { LinearInterpolationProbe probe; probe.invalidate(); return probe; }
+};
+
+template <>
+inline LinearInterpolationProbe InterpolationFlags::reflect<LinearInterpolationProbe>(int ax, LinearInterpolationProbe val) const {
+    val.reflect(ax);
+    return val;
+}
+
+/**
+ * Precomputed linear interpolation between two meshes.
+ *
+ * For each destination point it stores indices of the source nodes and their weights, so interpolation reduces to
+ * a weighted sum of the gathered source values. The plan does not depend on the data, so it can be reused for
+ * every new data vector defined on the same source mesh.
+ */
+struct PLASK_API InterpolationPlan {
+
+    /// Index marking the destination points outside of the source mesh
+    static constexpr std::size_t INVALID_INDEX = std::numeric_limits<std::size_t>::max();
+
+    const unsigned corners;                 ///< Number of source nodes for each destination point
+    const InterpolationFlags flags;         ///< Interpolation flags used to compute the plan
+    const std::size_t src_size;             ///< Number of the source mesh nodes when the plan was computed
+    std::vector<std::size_t> indices;       ///< Indices of the source nodes (@c corners per destination point)
+    std::vector<double> weights;            ///< Weights of the source nodes (@c corners per destination point)
+    std::vector<unsigned char> reflections; ///< Axes along which the source values are reflected (empty if there is no symmetry)
+
+    /**
+     * Compute the plan for linear interpolation
+     * @param src_mesh source mesh, it must have @c interpolateLinear method
+     * @param dst_mesh destination mesh
+     * @param flags interpolation flags
+     */
+    template <typename SrcMeshT>
+    InterpolationPlan(const SrcMeshT& src_mesh, const MeshD<SrcMeshT::DIM>& dst_mesh, const InterpolationFlags& flags):
+        corners(1 << SrcMeshT::DIM), flags(flags), src_size(src_mesh.size()), indices(corners * dst_mesh.size()), weights(corners * dst_mesh.size()) {
+        if (flags.symmetric(0) || flags.symmetric(1) || flags.symmetric(2)) reflections.assign(indices.size(), 0);
+        const LinearInterpolationProbe::Source source;
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < dst_mesh.size(); ++i) {
+            LinearInterpolationProbe probe = src_mesh.interpolateLinear(source, dst_mesh.at(i), flags);
+            std::size_t* idx = indices.data() + corners * i;
+            double* wgh = weights.data() + corners * i;
+            if (!probe.valid()) {
+                std::fill_n(idx, corners, INVALID_INDEX);
+                std::fill_n(wgh, corners, 0.);
+                continue;
+            }
+            assert(probe.count != 0 && probe.count <= corners);
+            for (unsigned k = 0; k != corners; ++k) {
+                bool term = k < probe.count;
+                idx[k] = probe.indices[term ? k : 0];
+                wgh[k] = term ? probe.weights[k] : 0.;
+                if (!reflections.empty()) reflections[corners * i + k] = term ? probe.reflections[k] : 0;
+            }
+        }
+    }
+
+    /// Number of destination points
+    std::size_t size() const { return indices.size() / corners; }
+
+    /**
+     * Interpolate source data in a single destination point
+     * @param data source data
+     * @param index index of the destination point
+     * @return interpolated value
+     */
+    template <typename SrcT>
+    typename std::remove_const<SrcT>::type interpolate(const DataVector<const SrcT>& data, std::size_t index) const {
+        const std::size_t* idx = indices.data() + corners * index;
+        const double* wgh = weights.data() + corners * index;
+        if (idx[0] == INVALID_INDEX) return NaN<SrcT>();
+        if (reflections.empty()) {
+            typename std::remove_const<SrcT>::type result = data[idx[0]] * wgh[0];
+            for (unsigned k = 1; k != corners; ++k) result = result + data[idx[k]] * wgh[k];
+            return result;
+        }
+        const unsigned char* rfl = reflections.data() + corners * index;
+        typename std::remove_const<SrcT>::type result = flags.reflectAxes(rfl[0], data[idx[0]]) * wgh[0];
+        for (unsigned k = 1; k != corners; ++k) result = result + flags.reflectAxes(rfl[k], data[idx[k]]) * wgh[k];
+        return result;
+    }
+
+    /**
+     * Interpolate source data in all destination points
+     * @param data source data
+     * @param[out] result interpolated values, must have size of the destination mesh
+     */
+    template <typename SrcT, typename DstT>
+    void interpolate(const DataVector<const SrcT>& data, DataVector<DstT>& result) const {
+        assert(result.size() == size());
+        #pragma omp parallel for
+        for (openmp_size_t i = 0; i < result.size(); ++i) result[i] = interpolate(data, i);
+    }
+
+    /**
+     * Get the cached plan for linear interpolation between the meshes.
+     * Plans are computed only when a pair of meshes is interpolated for the second time, so one-off interpolations do
+     * not pay for them. They are kept until any of the meshes is changed or deleted. A cached plan is also ignored
+     * if the size of any of the meshes does not match it.
+     * @param src_mesh source mesh, it must have @c interpolateLinear method
+     * @param dst_mesh destination mesh
+     * @param flags interpolation flags
+     * @return interpolation plan or null pointer if the plan should not be used
+     */
+    template <typename SrcMeshT>
+    static shared_ptr<const InterpolationPlan> get(const shared_ptr<const SrcMeshT>& src_mesh,
+                                                   const shared_ptr<const MeshD<SrcMeshT::DIM>>& dst_mesh,
+                                                   const InterpolationFlags& flags) {
+        shared_ptr<const InterpolationPlan> plan;
+        if (!cached(*src_mesh, *dst_mesh, flags, plan)) return plan;
+        if (!plan) {
+            plan = make_shared<const InterpolationPlan>(*src_mesh, *dst_mesh, flags);
+            store(*src_mesh, *dst_mesh, plan);
+        }
+        return plan;
+    }
+
+  private:
+
+    /**
+     * Look for the plan in cache
+     * @param[out] plan cached plan or null pointer if it must be computed
+     * @return @c false if the meshes are interpolated for the first time and the plan should not be used
+     */
+    static bool cached(const Mesh& src_mesh, const Mesh& dst_mesh, const InterpolationFlags& flags,
+                       shared_ptr<const InterpolationPlan>& plan);
+
+    /// Store the plan in cache
+    static void store(const Mesh& src_mesh, const Mesh& dst_mesh, const shared_ptr<const InterpolationPlan>& plan);
+};
+
+/**
+ * Implementation of LazyDataImpl which applies precomputed InterpolationPlan to source data.
+ */
+template <typename DstT, typename SrcT = DstT>
+struct PlannedInterpolatedLazyDataImpl: public LazyDataImpl<DstT> {
+
+    shared_ptr<const InterpolationPlan> plan;
+    DataVector<const SrcT> src_vec;
+
+    PlannedInterpolatedLazyDataImpl(const shared_ptr<const InterpolationPlan>& plan, const DataVector<const SrcT>& src_vec):
+        plan(plan), src_vec(src_vec) {
+        if (src_vec.size() != plan->src_size)
+            throw BadMesh("interpolate", "Interpolation plan size ({1}) and values size ({0}) do not match",
+                          src_vec.size(), plan->src_size);
+    }
+
+    std::size_t size() const override { return plan->size(); }
+
+    DstT at(std::size_t index) const override {
+        return plan->interpolate(src_vec, index);
+    }
+
+    DataVector<const DstT> getAll() const override {
+        DataVector<DstT> result(plan->size());
+        plan->interpolate(src_vec, result);
+        return result;
+    }
+};
+
+/**
+ * Create lazy data for linear interpolation, using cached interpolation plan if the meshes are interpolated repeatedly.
+ * @param src_mesh source mesh, it must have @c interpolateLinear method
+ * @param src_vec source data
+ * @param dst_mesh destination mesh
+ * @param flags interpolation flags
+ * @return lazy data implementation
+ */
+template <typename DstT, typename SrcMeshType, typename SrcT>
+LazyDataImpl<DstT>* linearInterpolatedLazyData(const shared_ptr<const SrcMeshType>& src_mesh,
+                                               const DataVector<const SrcT>& src_vec,
+                                               const shared_ptr<const MeshD<SrcMeshType::DIM>>& dst_mesh,
+                                               const InterpolationFlags& flags) {
+    if (auto plan = InterpolationPlan::get(src_mesh, dst_mesh, flags))
+        return new PlannedInterpolatedLazyDataImpl<DstT, SrcT>(plan, src_vec);
+    return new LinearInterpolatedLazyDataImpl<DstT, SrcMeshType, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+}
+
 
 
 } // namespace plask
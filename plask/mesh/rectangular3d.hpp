@@ -206,7 +206,7 @@ struct InterpolationAlgorithm<RectangularMesh3D, SrcT, DstT, INTERPOLATION_LINEA
                                       const shared_ptr<const MeshD<3>>& dst_mesh, const InterpolationFlags& flags) {
         if (src_mesh->axis[0]->size() == 0 || src_mesh->axis[1]->size() == 0 || src_mesh->axis[2]->size() == 0)
             throw BadMesh("interpolate", "Source mesh empty");
-        return new LinearInterpolatedLazyDataImpl<DstT, RectilinearMesh3D, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+        return linearInterpolatedLazyData<DstT>(src_mesh, src_vec, dst_mesh, flags);
     }
 };
 
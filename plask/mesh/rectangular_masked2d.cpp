@@ -18,6 +18,7 @@ namespace plask {
 void RectangularMaskedMesh2D::reset(const RectangularMaskedMesh2D::Predicate &predicate) {
     RectangularMaskedMeshBase<2>::reset();
     initNodesAndElements(predicate);
+    this->fireResized();
 }
 
 RectangularMaskedMesh2D::RectangularMaskedMesh2D(const RectangularMesh<2> &rectangularMesh, const RectangularMaskedMesh2D::Predicate &predicate, bool clone_axes)
@@ -71,7 +72,7 @@ bool RectangularMaskedMesh2D::prepareInterpolation(const Vec<2> &point, Vec<2> &
     ensureHasElements();
     for (char i1 = 0; i1 < 2; ++i1) {
         for (char i0 = 0; i0 < 2; ++i0) {
-            if (elementSet.includes(fullMesh.getElementIndexFromLowIndexes(index0_lo, index1_lo))) {
+            if (elementIndexOf(fullMesh.getElementIndexFromLowIndexes(index0_lo, index1_lo)) != NOT_INCLUDED) {
                 index0_hi = index0_lo + 1; index1_hi = index1_lo + 1;
                 return true;
             }
@@ -167,7 +167,7 @@ struct PLASK_API RectangularMaskedMesh2D: public RectangularMaskedMeshBase<2> {
          * \return this mesh index, from 0 to size()-1, or NOT_INCLUDED
          */
         inline std::size_t index(std::size_t axis0_index, std::size_t axis1_index) const {
-            return originalMesh->elementSet.indexOf(fullMesh.index(axis0_index, axis1_index));
+            return originalMesh->elementIndexOf(fullMesh.index(axis0_index, axis1_index));
         }
 
 
@@ -263,6 +263,7 @@ struct PLASK_API RectangularMaskedMesh2D: public RectangularMaskedMeshBase<2> {
 
     /**
      * Change a selection of elements used to once pointed by a given @p predicate.
+     * Fires the changed signal, so everything cached for this mesh (e.g. interpolation plans) is dropped.
      * @param predicate predicate which returns either @c true for accepting element or @c false for rejecting it
      */
     void reset(const Predicate& predicate);
@@ -384,7 +385,7 @@ struct PLASK_API RectangularMaskedMesh2D: public RectangularMaskedMeshBase<2> {
      * @return this mesh index, from 0 to size()-1, or NOT_INCLUDED
      */
     inline std::size_t index(std::size_t axis0_index, std::size_t axis1_index) const {
-        return nodeSet.indexOf(fullMesh.index(axis0_index, axis1_index));
+        return nodeIndexOf(fullMesh.index(axis0_index, axis1_index));
     }
 
     using RectangularMaskedMeshBase<2>::index;
@@ -412,10 +413,11 @@ struct PLASK_API RectangularMaskedMesh2D: public RectangularMaskedMeshBase<2> {
 
     /**
      * Return a mesh that enables iterating over middle points of the selected rectangles.
-     * @return new rectilinear masked mesh with points in the middles of original, selected rectangles
+     * The same mesh is returned until this mesh is reset.
+     * @return rectilinear masked mesh with points in the middles of original, selected rectangles
      */
     shared_ptr<RectangularMaskedMesh2D::ElementMesh> getElementMesh() const {
-        return make_shared<RectangularMaskedMesh2D::ElementMesh>(this);
+        return elementMesh.get<RectangularMaskedMesh2D::ElementMesh>(this);
     }
 
   private:
@@ -499,7 +501,7 @@ struct PLASK_API RectangularMaskedMesh2D: public RectangularMaskedMeshBase<2> {
      * @return index of the element, from 0 to getElementsCount()-1
      */
     std::size_t getElementIndexFromLowIndexes(std::size_t axis0_index, std::size_t axis1_index) const {
-        return ensureHasElements().indexOf(fullMesh.getElementIndexFromLowIndexes(axis0_index, axis1_index));
+        return elementIndexOf(fullMesh.getElementIndexFromLowIndexes(axis0_index, axis1_index));
     }
 
     /**
@@ -651,7 +653,7 @@ struct InterpolationAlgorithm<RectangularMaskedMesh2D, SrcT, DstT, INTERPOLATION
     static LazyData<DstT> interpolate(const shared_ptr<const RectangularMaskedMesh2D>& src_mesh, const DataVector<const SrcT>& src_vec,
                                       const shared_ptr<const MeshD<2>>& dst_mesh, const InterpolationFlags& flags) {
         if (src_mesh->empty()) throw BadMesh("interpolate", "Source mesh empty");
-        return new LinearInterpolatedLazyDataImpl<DstT, RectangularMaskedMesh2D, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+        return linearInterpolatedLazyData<DstT>(src_mesh, src_vec, dst_mesh, flags);
     }
 };
 
@@ -670,7 +672,7 @@ struct InterpolationAlgorithm<RectangularMaskedMesh2D::ElementMesh, SrcT, DstT,
     static LazyData<DstT> interpolate(const shared_ptr<const RectangularMaskedMesh2D::ElementMesh>& src_mesh, const DataVector<const SrcT>& src_vec,
                                       const shared_ptr<const MeshD<2>>& dst_mesh, const InterpolationFlags& flags) {
         if (src_mesh->empty()) throw BadMesh("interpolate", "Source mesh empty");
-        return new LinearInterpolatedLazyDataImpl<DstT, RectangularMaskedMesh2D::ElementMesh, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+        return linearInterpolatedLazyData<DstT>(src_mesh, src_vec, dst_mesh, flags);
     }
 };
 
@@ -18,6 +18,7 @@ namespace plask {
 void RectangularMaskedMesh3D::reset(const RectangularMaskedMesh3D::Predicate &predicate) {
     RectangularMaskedMeshBase<3>::reset();
     initNodesAndElements(predicate);
+    this->fireResized();
 }
 
 RectangularMaskedMesh3D::RectangularMaskedMesh3D(const RectangularMesh<3> &rectangularMesh, const RectangularMaskedMesh3D::Predicate &predicate, bool clone_axes)
@@ -89,7 +90,7 @@ bool RectangularMaskedMesh3D::prepareInterpolation(const Vec<3> &point, Vec<3> &
     for (char i2 = 0; i2 < 2; ++i2) {
         for (char i1 = 0; i1 < 2; ++i1) {
             for (char i0 = 0; i0 < 2; ++i0) {
-                if (elementSet.includes(fullMesh.getElementIndexFromLowIndexes(index0_lo, index1_lo, index2_lo))) {
+                if (elementIndexOf(fullMesh.getElementIndexFromLowIndexes(index0_lo, index1_lo, index2_lo)) != NOT_INCLUDED) {
                     index0_hi = index0_lo + 1; index1_hi = index1_lo + 1; index2_hi = index2_lo + 1;
                     return true;
                 }
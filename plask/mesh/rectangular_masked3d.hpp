@@ -257,7 +257,7 @@ struct PLASK_API RectangularMaskedMesh3D: public RectangularMaskedMeshBase<3> {
          * \return this mesh index, from 0 to size()-1, or NOT_INCLUDED
          */
         inline std::size_t index(std::size_t axis0_index, std::size_t axis1_index, std::size_t axis2_index) const {
-            return originalMesh->elementSet.indexOf(fullMesh.index(axis0_index, axis1_index, axis2_index));
+            return originalMesh->elementIndexOf(fullMesh.index(axis0_index, axis1_index, axis2_index));
         }
 
         bool prepareInterpolation(const Vec<3>& point, Vec<3>& wrapped_point,
@@ -361,6 +361,7 @@ struct PLASK_API RectangularMaskedMesh3D: public RectangularMaskedMeshBase<3> {
 
     /**
      * Change a selection of elements used to once pointed by a given @p predicate.
+     * Fires the changed signal, so everything cached for this mesh (e.g. interpolation plans) is dropped.
      * @param predicate predicate which returns either @c true for accepting element or @c false for rejecting it
      */
     void reset(const Predicate& predicate);
@@ -483,7 +484,7 @@ struct PLASK_API RectangularMaskedMesh3D: public RectangularMaskedMeshBase<3> {
      * @return this mesh index, from 0 to size()-1, or NOT_INCLUDED
      */
     inline std::size_t index(std::size_t axis0_index, std::size_t axis1_index, std::size_t axis2_index) const {
-        return nodeSet.indexOf(fullMesh.index(axis0_index, axis1_index, axis2_index));
+        return nodeIndexOf(fullMesh.index(axis0_index, axis1_index, axis2_index));
     }
 
     using RectangularMaskedMeshBase<3>::index;
@@ -513,10 +514,11 @@ struct PLASK_API RectangularMaskedMesh3D: public RectangularMaskedMeshBase<3> {
 
     /**
      * Return a mesh that enables iterating over middle points of the selected rectangles.
-     * @return new rectilinear masked mesh with points in the middles of original, selected rectangles
+     * The same mesh is returned until this mesh is reset.
+     * @return rectilinear masked mesh with points in the middles of original, selected rectangles
      */
     shared_ptr<RectangularMaskedMesh3D::ElementMesh> getElementMesh() const {
-        return make_shared<RectangularMaskedMesh3D::ElementMesh>(this);
+        return elementMesh.get<RectangularMaskedMesh3D::ElementMesh>(this);
     }
 
   private:
@@ -610,7 +612,7 @@ struct PLASK_API RectangularMaskedMesh3D: public RectangularMaskedMeshBase<3> {
      * @return index of the element, from 0 to getElementsCount()-1
      */
     std::size_t getElementIndexFromLowIndexes(std::size_t axis0_index, std::size_t axis1_index, std::size_t axis2_index) const {
-        return ensureHasElements().indexOf(fullMesh.getElementIndexFromLowIndexes(axis0_index, axis1_index, axis2_index));
+        return elementIndexOf(fullMesh.getElementIndexFromLowIndexes(axis0_index, axis1_index, axis2_index));
     }
 
     /**
@@ -790,7 +792,7 @@ struct InterpolationAlgorithm<RectangularMaskedMesh3D, SrcT, DstT, INTERPOLATION
     static LazyData<DstT> interpolate(const shared_ptr<const RectangularMaskedMesh3D>& src_mesh, const DataVector<const SrcT>& src_vec,
                                       const shared_ptr<const MeshD<3>>& dst_mesh, const InterpolationFlags& flags) {
         if (src_mesh->empty()) throw BadMesh("interpolate", "Source mesh empty");
-        return new LinearInterpolatedLazyDataImpl<DstT, RectangularMaskedMesh3D, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+        return linearInterpolatedLazyData<DstT>(src_mesh, src_vec, dst_mesh, flags);
     }
 };
 
@@ -809,7 +811,7 @@ struct InterpolationAlgorithm<RectangularMaskedMesh3D::ElementMesh, SrcT, DstT,
     static LazyData<DstT> interpolate(const shared_ptr<const RectangularMaskedMesh3D::ElementMesh>& src_mesh, const DataVector<const SrcT>& src_vec,
                                       const shared_ptr<const MeshD<3>>& dst_mesh, const InterpolationFlags& flags) {
         if (src_mesh->empty()) throw BadMesh("interpolate", "Source mesh empty");
-        return new LinearInterpolatedLazyDataImpl<DstT, RectangularMaskedMesh3D::ElementMesh, SrcT>(src_mesh, src_vec, dst_mesh, flags);
+        return linearInterpolatedLazyData<DstT>(src_mesh, src_vec, dst_mesh, flags);
     }
 };
 
@@ -14,7 +14,9 @@
 #ifndef PLASK__RECTANGULAR_MASKED_COMMON_H
 #define PLASK__RECTANGULAR_MASKED_COMMON_H
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 #include "rectangular.hpp"
 #include "../utils/numbers_set.hpp"
@@ -42,9 +44,14 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
 
   protected:
 
-    //typedef CompressedSetOfNumbers<std::uint32_t> Set;
     typedef CompressedSetOfNumbers<std::size_t> Set;
 
+    /// Dense index table mapping numbers of the wrapped mesh to indexes in the set (or NOT_INCLUDED_DENSE).
+    typedef std::vector<std::uint32_t> DenseIndex;
+
+    /// Value in DenseIndex of numbers not included in the set.
+    enum: std::uint32_t { NOT_INCLUDED_DENSE = std::numeric_limits<std::uint32_t>::max() };
+
     /// Numbers of rectangularMesh indexes which are in the corners of the elements enabled.
     Set nodeSet;
 
@@ -206,6 +213,37 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
 
     };  // ElementMeshBase
 
+    /**
+     * Lazily created mesh of elements.
+     *
+     * The same element mesh is returned for subsequent calls, so interpolation plans between it and other meshes
+     * can be reused. As the element mesh refers to the mesh owning it, it is never copied with its owner.
+     */
+    struct ElementMeshCache {
+
+        ElementMeshCache() = default;
+        ElementMeshCache(const ElementMeshCache&) {}
+        ElementMeshCache& operator=(const ElementMeshCache&) { reset(); return *this; }
+
+        template <typename ElementMeshType, typename MaskedMeshType>
+        shared_ptr<ElementMeshType> get(const MaskedMeshType* owner) const {
+            shared_ptr<MeshD<DIM>> result = atomic_load(&mesh);
+            if (!result) {
+                result = make_shared<ElementMeshType>(owner);
+                atomic_store(&mesh, result);
+            }
+            return static_pointer_cast<ElementMeshType>(result);
+        }
+
+        void reset() { atomic_store(&mesh, shared_ptr<MeshD<DIM>>()); }
+
+      private:
+        mutable shared_ptr<MeshD<DIM>> mesh;
+    };
+
+    /// Mesh of elements returned by getElementMesh
+    ElementMeshCache elementMesh;
+
     void resetBoundyIndex() {
         for (int d = 0; d < DIM; ++d) { // prepare for finding indexes by subclass constructor:
             boundaryIndex[d].lo = this->fullMesh.axis[d]->size()-1;
@@ -218,9 +256,19 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
     void reset() {
         nodeSet.clear();
         elementSet.clear();
+        elementMesh.reset();
+        resetDenseIndexes();
         resetBoundyIndex();
     }
 
+    /// Drop dense index tables, so they are rebuilt on demand.
+    void resetDenseIndexes() {
+        nodeDenseIndex.clear();
+        elementDenseIndex.clear();
+        nodeDenseIndexInitialized.store(false, std::memory_order_relaxed);
+        elementDenseIndexInitialized.store(false, std::memory_order_relaxed);
+    }
+
   public:
 
     /// Returned by some methods to signalize that element or node (with given index(es)) is not included in the mesh.
@@ -307,8 +355,11 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
 
     /**
      * Select all elements of wrapped mesh.
+     * Fires the changed signal, as the mesh can be reused with different wrapped mesh or selection.
      */
     void selectAll() {
+        elementMesh.reset();
+        resetDenseIndexes();
         this->nodeSet.assignRange(fullMesh.size());
         this->elementSet.assignRange(fullMesh.getElementsCount());
         elementSetInitialized = true;
@@ -317,6 +368,7 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
             boundaryIndex[d].up = fullMesh.axis[d]->size()-1;
         }
         boundaryIndexInitialized = true;
+        this->fireResized();
     }
 
     /**
@@ -325,7 +377,7 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
      * @return this mesh index, from 0 to size()-1, or NOT_INCLUDED
      */
     inline std::size_t index(const Vec<DIM, std::size_t>& indexes) const {
-        return nodeSet.indexOf(fullMesh.index(indexes));
+        return nodeIndexOf(fullMesh.index(indexes));
     }
 
     /**
@@ -403,7 +455,7 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
      * @return index of the element, from 0 to getElementsCount()-1
      */
     std::size_t getElementIndexFromLowIndex(std::size_t mesh_index_of_el_bottom_left) const {
-        return ensureHasElements().indexOf(fullMesh.getElementIndexFromLowIndex(nodeSet.at(mesh_index_of_el_bottom_left)));
+        return elementIndexOf(fullMesh.getElementIndexFromLowIndex(nodeSet.at(mesh_index_of_el_bottom_left)));
     }
 
     /**
@@ -412,7 +464,7 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
      * @return mesh index
      */
     std::size_t getElementMeshLowIndex(std::size_t element_index) const {
-        return nodeSet.indexOf(fullMesh.getElementMeshLowIndex(ensureHasElements().at(element_index)));
+        return nodeIndexOf(fullMesh.getElementMeshLowIndex(ensureHasElements().at(element_index)));
     }
 
     /**
@@ -481,6 +533,28 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
     /// Whether boundatyIndex is initialized.
     bool boundaryIndexInitialized;
 
+    /**
+     * Minimal fraction of the wrapped mesh nodes (or elements) which must be selected to build the dense index table.
+     *
+     * Below it the binary search over the set segments is used, as the table would take more memory than it saves time.
+     */
+    constexpr static double DENSE_INDEX_MIN_FILL = 0.5;
+
+    /// Dense index of nodes (empty if it is not used).
+    DenseIndex nodeDenseIndex;
+
+    /// Dense index of elements (empty if it is not used).
+    DenseIndex elementDenseIndex;
+
+    /**
+     * Whether nodeDenseIndex is initialized (it can still be empty if it is not profitable).
+     * It is set with release semantics after the table is filled, so readers which see it set also see the table.
+     */
+    DontCopyThisField<std::atomic<bool>> nodeDenseIndexInitialized{};
+
+    /// Whether elementDenseIndex is initialized (it can still be empty if it is not profitable), set as above.
+    DontCopyThisField<std::atomic<bool>> elementDenseIndexInitialized{};
+
   private:
 
     /*bool restVerticesIncluded(const RectangularMesh2D::Element& el) const {
@@ -628,7 +702,69 @@ struct RectangularMaskedMeshBase: public RectangularMeshBase<DIM> {
         boundaryIndexInitialized = true;
     }
 
+    /**
+     * Fill dense index table of the @p set if it is profitable, i.e. the set is dense enough and has more than one segment.
+     * @param[out] table table to fill, left empty if it is not profitable
+     * @param set set to index
+     * @param full_size number of nodes or elements in the wrapped mesh
+     */
+    static void fillDenseIndex(DenseIndex& table, const Set& set, std::size_t full_size) {
+        table.clear();
+        if (set.segments.size() <= 1 || full_size >= NOT_INCLUDED_DENSE || double(set.size()) < DENSE_INDEX_MIN_FILL * double(full_size))
+            return;
+        table.assign(full_size, NOT_INCLUDED_DENSE);
+        std::uint32_t index = 0;
+        set.forEachSegment([&table, &index] (std::size_t b, std::size_t e) {
+            for (; b != e; ++b) table[b] = index++;
+        });
+    }
+
+    void calculateNodeDenseIndex() {
+        boost::lock_guard<boost::mutex> lock((boost::mutex&)writeMutex);
+        if (nodeDenseIndexInitialized.load(std::memory_order_relaxed)) return;  // another thread has initilized the table just when we waited for mutex
+        fillDenseIndex(nodeDenseIndex, nodeSet, fullMesh.size());
+        nodeDenseIndexInitialized.store(true, std::memory_order_release);
+    }
+
+    void calculateElementDenseIndex() {
+        ensureHasElements();    // must be called before locking, as it locks writeMutex itself
+        boost::lock_guard<boost::mutex> lock((boost::mutex&)writeMutex);
+        if (elementDenseIndexInitialized.load(std::memory_order_relaxed)) return;  // another thread has initilized the table just when we waited for mutex
+        fillDenseIndex(elementDenseIndex, elementSet, fullMesh.getElementsCount());
+        elementDenseIndexInitialized.store(true, std::memory_order_release);
+    }
+
   protected:
+    /**
+     * Get index of the node with given index in the wrapped mesh.
+     *
+     * It uses dense index table (constant time) if the mesh is dense enough, or binary search over nodeSet otherwise.
+     * @param number index of the node in the wrapped mesh
+     * @return index of the node in this mesh or NOT_INCLUDED
+     */
+    std::size_t nodeIndexOf(std::size_t number) const {
+        if (!nodeDenseIndexInitialized.load(std::memory_order_acquire)) const_cast<RectangularMaskedMeshBase<DIM>*>(this)->calculateNodeDenseIndex();
+        if (nodeDenseIndex.empty()) return nodeSet.indexOf(number);
+        if (number >= nodeDenseIndex.size()) return NOT_INCLUDED;
+        const std::uint32_t result = nodeDenseIndex[number];
+        return (result == NOT_INCLUDED_DENSE) ? std::size_t(NOT_INCLUDED) : std::size_t(result);
+    }
+
+    /**
+     * Get index of the element with given index in the wrapped mesh.
+     *
+     * It uses dense index table (constant time) if the mesh is dense enough, or binary search over elementSet otherwise.
+     * @param number index of the element in the wrapped mesh
+     * @return index of the element in this mesh or NOT_INCLUDED
+     */
+    std::size_t elementIndexOf(std::size_t number) const {
+        if (!elementDenseIndexInitialized.load(std::memory_order_acquire)) const_cast<RectangularMaskedMeshBase<DIM>*>(this)->calculateElementDenseIndex();
+        if (elementDenseIndex.empty()) return elementSet.indexOf(number);
+        if (number >= elementDenseIndex.size()) return NOT_INCLUDED;
+        const std::uint32_t result = elementDenseIndex[number];
+        return (result == NOT_INCLUDED_DENSE) ? std::size_t(NOT_INCLUDED) : std::size_t(result);
+    }
+
     /**
      * Ensure that elementSet is calculated (calculate it if it is not).
      * @return this->elementSet
@@ -82,6 +82,9 @@ public:
      */
     SameMeshChecker(): mesh(nullptr) {}
 
+    /// Disconnect from the recently given mesh, so its changes are no longer reported to the destroyed checker.
+    ~SameMeshChecker() { connection_with_mesh.disconnect(); }
+
 };
 
 
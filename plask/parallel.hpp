@@ -22,7 +22,11 @@ namespace plask {
 
 #if defined(OPENMP_FOUND) || defined(DOXYGEN)
 
-    /// OMP nest lock class.
+    /**
+     * OMP nest lock class.
+     * Its locking methods are virtual, so derived locks can do some additional work (e.g. acquire Python GIL)
+     * when guarded with OmpLockGuard<OmpNestLock>.
+     */
     class OmpNestLock {
 
         omp_nest_lock_t lck;
@@ -40,13 +44,17 @@ namespace plask {
         }
 
         /// Destroy the
-        ~OmpNestLock() {
+        virtual ~OmpNestLock() {
             omp_destroy_nest_lock(&lck);
         }
 
-        void lock() { omp_set_nest_lock(&lck); }
+        virtual void lock() { omp_set_nest_lock(&lck); }
 
-        void unlock() { omp_unset_nest_lock(&lck); }
+        virtual void unlock() { omp_unset_nest_lock(&lck); }
+
+        /// Try to lock the lock without waiting
+        /// \return \c true if the lock has been acquired
+        bool try_lock() { return omp_test_nest_lock(&lck) != 0; }
     };
 
     /// OMP lock class.
@@ -77,6 +85,36 @@ namespace plask {
     };
 
 
+#else
+
+    // Empty placeholder
+    struct OmpNestLock {
+        OmpNestLock() = default;
+        virtual ~OmpNestLock() = default;
+        OmpNestLock(const OmpNestLock&) = delete;
+        OmpNestLock& operator=(const OmpNestLock&) = delete;
+        OmpNestLock(OmpNestLock&&) = delete;
+        OmpNestLock& operator=(OmpNestLock&&) = delete;
+
+        virtual void lock() {}
+        virtual void unlock() {}
+        bool try_lock() { return true; }
+    };
+
+    // Empty placeholder
+    struct OmpLock {
+        OmpLock() = default;
+        OmpLock(const OmpLock&) = delete;
+        OmpLock& operator=(const OmpLock&) = delete;
+        OmpLock(OmpNestLock&&) = delete;
+        OmpLock& operator=(OmpLock&&) = delete;
+
+        void lock() {}
+        void unlock() {}
+    };
+
+#endif
+
     /**
      * Template of OMP lock guard class.
      * @tpatam LockType type of lock, either OmpLock or OmpNestLock
@@ -119,46 +157,6 @@ namespace plask {
         }
     };
 
-#else
-
-    // Empty placeholder
-    struct OmpNestLock {
-        OmpNestLock() = default;
-        OmpNestLock(const OmpNestLock&) = delete;
-        OmpNestLock& operator=(const OmpNestLock&) = delete;
-        OmpNestLock(OmpNestLock&&) = delete;
-        OmpNestLock& operator=(OmpNestLock&&) = delete;
-
-        void lock() {}
-        void unlock() {}
-    };
-
-    // Empty placeholder
-    struct OmpLock {
-        OmpLock() = default;
-        OmpLock(const OmpLock&) = delete;
-        OmpLock& operator=(const OmpLock&) = delete;
-        OmpLock(OmpNestLock&&) = delete;
-        OmpLock& operator=(OmpLock&&) = delete;
-
-        void lock() {}
-        void unlock() {}
-    };
-
-    // Empty placeholder
-    template <typename LockType>
-    struct OmpLockGuard {
-        OmpLockGuard() {}
-        OmpLockGuard(const LockType&) {}
-        ~OmpLockGuard() {}
-        OmpLockGuard(OmpLockGuard<LockType>&&) = default;
-        OmpLockGuard& operator=(OmpLockGuard<LockType>&&) = default;
-        OmpLockGuard(const OmpLockGuard<LockType>&) = delete;
-        OmpLockGuard& operator=(const OmpLockGuard<LockType>&) = delete;
-    };
-
-#endif
-
 
 } // namespace plask
 
@@ -818,14 +818,15 @@ private:
 
     /**
      * This method is called when the geometry is changed.
-     * It calls invalidate(); and regenerateMesh();
+     * It calls invalidate(); and regenerateMesh(); If only a material was changed, the mesh is not regenerated,
+     * as no object has been moved.
      *
      * Typically, you should call SolverWithMesh::onGeometryChange(const Geometry::Event&) when you overwrite this method.
      * @param evt information about geometry changes
      */
-    void onGeometryChange(const Geometry::Event& PLASK_UNUSED(evt)) override {
+    void onGeometryChange(const Geometry::Event& evt) override {
         this->invalidate();
-        this->regenerateMesh();
+        if (!evt.isMaterialOnly()) this->regenerateMesh();
     }
 
 	/**
@@ -0,0 +1,184 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "sweep.hpp"
+
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+namespace plask {
+
+namespace {
+
+    const char MAGIC[8] = {'P', 'L', 'A', 'S', 'K', 'S', 'W', 'P'};
+    constexpr std::uint32_t VERSION = 2;
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+
+    template <typename T>
+    inline void put(std::string& buffer, const T& value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline void putString(std::string& buffer, const std::string& value) {
+        put(buffer, std::uint32_t(value.size()));
+        buffer.append(value);
+    }
+
+    std::string paramsStr(const SweepRecord::Params& params) {
+        std::string result;
+        for (const auto& param: params) {
+            if (!result.empty()) result += ", ";
+            result += param.first + "=" + param.second;
+        }
+        return result;
+    }
+
+    /// Sequential reader of the file contents, which never reads past the end
+    struct Cursor {
+        const char* pos;
+        const char* end;
+
+        template <typename T>
+        bool get(T& value) {
+            if (std::size_t(end - pos) < sizeof(T)) return false;
+            std::memcpy(&value, pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        bool getString(std::string& value) {
+            std::uint32_t length;
+            if (!get(length) || std::size_t(end - pos) < length) return false;
+            value.assign(pos, length);
+            pos += length;
+            return true;
+        }
+    };
+
+    bool parseRecord(Cursor& cursor, SweepRecord& record) {
+        std::uint32_t count;
+        if (!cursor.get(record.run) || !cursor.get(record.status) || !cursor.get(count)) return false;
+        record.params.resize(count);
+        for (auto& param: record.params)
+            if (!cursor.getString(param.first) || !cursor.getString(param.second)) return false;
+        if (!cursor.get(count)) return false;
+        for (std::uint32_t i = 0; i != count; ++i) {
+            std::string name;
+            std::uint64_t size;
+            if (!cursor.getString(name)) return false;
+            if (!cursor.get(size) || std::size_t(cursor.end - cursor.pos) / sizeof(double) < size) return false;
+            DataVector<double> data(size);
+            if (size != 0) std::memcpy(data.data(), cursor.pos, size * sizeof(double));
+            cursor.pos += size * sizeof(double);
+            record.values[name] = data;
+        }
+        return cursor.pos == cursor.end;
+    }
+}
+
+std::vector<SweepRecord> readSweepResults(const std::string& filename, std::uint64_t* valid_size) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw Exception("cannot open sweep results file '{0}'", filename);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<SweepRecord> records;
+    if (contents.empty()) {
+        if (valid_size) *valid_size = 0;
+        return records;
+    }
+
+    Cursor cursor{contents.data(), contents.data() + contents.size()};
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version, byteorder;
+    if (!cursor.get(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !cursor.get(version) ||
+        !cursor.get(byteorder))
+        throw Exception("'{0}' is not a sweep results file", filename);
+    if (version != VERSION) throw Exception("sweep results file '{0}' has unsupported version {1}", filename, version);
+    if (byteorder != BYTE_ORDER_MARK)
+        throw Exception("sweep results file '{0}' was written on a machine with different byte order", filename);
+
+    const char* valid = cursor.pos;
+    std::uint64_t size;
+    while (cursor.get(size) && std::uint64_t(cursor.end - cursor.pos) >= size) {
+        Cursor record_cursor{cursor.pos, cursor.pos + size};
+        SweepRecord record;
+        if (!parseRecord(record_cursor, record))
+            throw Exception("sweep results file '{0}' is damaged", filename);
+        records.push_back(std::move(record));
+        cursor.pos += size;
+        valid = cursor.pos;
+    }
+    if (valid_size) *valid_size = std::uint64_t(valid - contents.data());
+    return records;
+}
+
+SweepWriter::SweepWriter(const std::string& filename): filename(filename) {
+    std::uint64_t valid_size = 0;
+    if (boost::filesystem::exists(filename)) {
+        for (SweepRecord& record: readSweepResults(filename, &valid_size)) done[record.run] = std::move(record.params);
+        // Drop an incomplete record of the interrupted sweep
+        if (valid_size != boost::filesystem::file_size(filename)) boost::filesystem::resize_file(filename, valid_size);
+    }
+    file.open(filename, std::ios::binary | std::ios::out | std::ios::app);
+    if (!file) throw Exception("cannot open sweep results file '{0}'", filename);
+    if (valid_size == 0) {
+        std::string header;
+        header.append(MAGIC, sizeof(MAGIC));
+        put(header, VERSION);
+        put(header, BYTE_ORDER_MARK);
+        assert(header.size() == HEADER_SIZE);
+        file.write(header.data(), header.size());
+        file.flush();
+        if (!file) throw Exception("error writing sweep results file '{0}'", filename);
+    }
+}
+
+void SweepWriter::append(const SweepRecord& record) {
+    if (isDone(record.run)) throw Exception("sweep results file '{0}': duplicate run {1}", filename, record.run);
+    // The whole record is prepared first, so it is written at once
+    std::string buffer;
+    put(buffer, std::uint64_t(0));
+    put(buffer, record.run);
+    put(buffer, record.status);
+    put(buffer, std::uint32_t(record.params.size()));
+    for (const auto& param: record.params) {
+        putString(buffer, param.first);
+        putString(buffer, param.second);
+    }
+    put(buffer, std::uint32_t(record.values.size()));
+    for (const auto& item: record.values) {
+        putString(buffer, item.first);
+        put(buffer, std::uint64_t(item.second.size()));
+        buffer.append(reinterpret_cast<const char*>(item.second.data()), item.second.size() * sizeof(double));
+    }
+    std::uint64_t size = buffer.size() - sizeof(std::uint64_t);
+    std::memcpy(&buffer[0], &size, sizeof(size));
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    if (!file) throw Exception("error writing sweep results file '{0}'", filename);
+    done[record.run] = record.params;
+}
+
+bool SweepWriter::isDone(std::uint64_t run, const SweepRecord::Params& params) const {
+    auto found = done.find(run);
+    if (found == done.end()) return false;
+    if (found->second != params)
+        throw Exception("sweep results file '{0}': run {1} was computed for different parameters ({2}) than now ({3}); "
+                        "the parameters file has been modified, so remove the results file to run the sweep anew",
+                        filename, run, paramsStr(found->second), paramsStr(params));
+    return true;
+}
+
+}   // namespace plask
@@ -0,0 +1,113 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__SWEEP_H
+#define PLASK__SWEEP_H
+
+/** @file
+This file contains the results file of parameter sweeps.
+
+Results file is a header followed by records of subsequent runs. Each record is prefixed with its size, so records are
+appended to the file as soon as the runs finish and an incomplete record left by an interrupted sweep is easily
+detected and dropped. A sweep is resumed by skipping the runs which already have their records in the file. Each record
+contains the parameters of its run, so the results are never attributed to parameters changed in the meantime.
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "data.hpp"
+#include "exceptions.hpp"
+
+namespace plask {
+
+/// Results of a single run of the sweep
+struct PLASK_API SweepRecord {
+    /// Names and values of the defines
+    typedef std::vector<std::pair<std::string, std::string>> Params;
+
+    std::uint64_t run;      ///< Index of the run
+    std::int32_t status;    ///< Exit status of the run (0 if it succeeded)
+    Params params;          ///< Defines of the run
+
+    /// Named results: scalars are stored as single-item vectors, fields as flattened arrays
+    std::map<std::string, DataVector<const double>> values;
+
+    explicit SweepRecord(std::uint64_t run = 0, std::int32_t status = 0): run(run), status(status) {}
+};
+
+/**
+ * Read all complete records from the sweep results file
+ * \param filename name of the results file
+ * \param[out] valid_size if not \c nullptr, size of the file part containing the header and the complete records
+ * \return records in the order they were appended
+ */
+PLASK_API std::vector<SweepRecord> readSweepResults(const std::string& filename, std::uint64_t* valid_size = nullptr);
+
+/**
+ * Writer of the sweep results file.
+ *
+ * If the file exists, any incomplete record at its end is removed and new records are appended after the existing
+ * ones. Each record is flushed immediately, so the results are not lost if the sweep is interrupted.
+ */
+class PLASK_API SweepWriter {
+
+    std::string filename;
+    std::ofstream file;
+    std::map<std::uint64_t, SweepRecord::Params> done;
+
+  public:
+
+    /**
+     * Open or create the results file
+     * \param filename name of the results file
+     */
+    explicit SweepWriter(const std::string& filename);
+
+    SweepWriter(const SweepWriter&) = delete;
+    SweepWriter& operator=(const SweepWriter&) = delete;
+
+    /// Get results file name
+    const std::string& getFilename() const { return filename; }
+
+    /// Get indices of the runs which already have their records in the file together with their parameters
+    const std::map<std::uint64_t, SweepRecord::Params>& getDone() const { return done; }
+
+    /**
+     * Check if the run has its record in the file
+     * \param run index of the run
+     */
+    bool isDone(std::uint64_t run) const { return done.find(run) != done.end(); }
+
+    /**
+     * Check if the run has its record in the file and the record was computed with the given parameters
+     * \param run index of the run
+     * \param params current parameters of the run
+     * \throw Exception if the record of the run has different parameters (i.e. the parameters file was modified)
+     */
+    bool isDone(std::uint64_t run, const SweepRecord::Params& params) const;
+
+    /**
+     * Append record to the file
+     * \param record record to write
+     */
+    void append(const SweepRecord& record);
+};
+
+}   // namespace plask
+
+#endif // PLASK__SWEEP_H
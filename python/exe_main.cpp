@@ -22,6 +22,18 @@
 // #  include <windows.h>	// in exe_common.h
 #endif
 
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+#    define PLASK_SWEEP_SUPPORTED
+#    include <signal.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#    include <cerrno>
+#    include <cstring>
+#    include <map>
+#    include <thread>
+#    include "plask/sweep.hpp"
+#endif
+
 //******************************************************************************
 #define PLASK_MODULE PyInit__plask
 extern "C" PyObject* PLASK_MODULE(void);
@@ -44,7 +56,8 @@ static FileType filetype = FILE_ANY;
 
 namespace plask { namespace python {
 PLASK_PYTHON_API std::string getPythonExceptionMessage();
-PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py::object filter = py::object());
+PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py::object filter = py::object(),
+                              bool cache = false);
 PLASK_PYTHON_API void createPythonLogger();
 PLASK_PYTHON_API void setLoggingColor(std::string color);
 PLASK_PYTHON_API void setCurrentAxes(const AxisNames& axes);
@@ -235,12 +248,30 @@ int handlePythonException(const char* scriptname = nullptr) {
     return plask::python::printPythonException(type, value, traceback, scriptname);
 }
 
+//******************************************************************************
+// Flush Python buffers of the standard streams
+static void flushStreams() {
+    try {
+        py::object(py::handle<>(py::borrowed(PySys_GetObject("stderr")))).attr("flush")();
+    } catch (const py::error_already_set&) {
+        PyErr_Clear();
+    }
+    try {
+        py::object(py::handle<>(py::borrowed(PySys_GetObject("stdout")))).attr("flush")();
+    } catch (const py::error_already_set&) {
+        PyErr_Clear();
+    }
+}
+
 //******************************************************************************
 // Finalize Python interpreter
 void endPlask() {
     // PyEval_RestoreThread(mainTS);
     fixMatplotlibBug();
 
+    // Cached geometry may hold Python objects, so it must be freed while the interpreter is still alive
+    plask::Manager::clearSectionsCache();
+
     // Py_Finalize is not supported by Boost, however we should call atexit hooks
     // Py_Finalize();
     try {
@@ -250,19 +281,295 @@ void endPlask() {
         handlePythonException();
     }
     finalizeMPI();
+    flushStreams();
+}
 
-    // Flush buffers
+//******************************************************************************
+// Evaluate command-line definitions
+static py::dict evalDefinitions(const std::deque<std::string>& defs, bool verbose = true) {
+    py::dict& xplGLobals = plask::python::getXplGlobals();
+    py::dict locals;
+    for (const std::string& def : defs) {
+        auto keyval = plask::splitString2(def, '=');
+        if (keyval.first == "self") throw plask::python::ValueError("Definition name 'self' is reserved");
+        try {
+            locals[keyval.first] = (plask::python::py_eval(keyval.second, xplGLobals, locals));
+        } catch (py::error_already_set&) {
+            if (verbose)
+                plask::writelog(plask::LOG_WARNING, "Cannot parse command-line definition '{}' (storing it as string): {}",
+                                keyval.first, plask::python::getPythonExceptionMessage());
+            PyErr_Clear();
+            locals[keyval.first] = keyval.second;
+        }
+        if (verbose) plask::writelog(plask::LOG_IMPORTANT, "{} = {}", keyval.first, keyval.second);
+    }
+    return locals;
+}
+
+// Load XPL file into a new manager (geometry and grids are cached only if \p cache is true)
+static plask::shared_ptr<plask::python::PythonManager> loadXplFile(const system_string& filename, bool realfile,
+                                                                   const py::dict& locals, bool cache = false) {
+    py::dict& xplGLobals = plask::python::getXplGlobals();
+    auto manager = plask::make_shared<plask::python::PythonManager>();
+    py::object omanager(manager);
+    (*globals)["__manager__"] = omanager;
+    // We export some dictionaries that may be useful in XPL parts (like Python geometry)
+    xplGLobals["PTH"] = omanager.attr("pth");
+    xplGLobals["GEO"] = omanager.attr("geo");
+    xplGLobals["MSH"] = omanager.attr("msh");
+    if (realfile)
+        plask::python::loadXpl(omanager, system_str_to_pyobject(filename), locals, py::object(), cache);
+    else {
+        py::object sys = py::import("sys");
+        plask::python::loadXpl(omanager, sys.attr("stdin").attr("buffer"), locals);
+    }
+    return manager;
+}
+
+// Load XPL file and run its script
+static void runXplFile(const system_string& filename, bool realfile, const std::deque<std::string>& defs,
+                       bool cache = false) {
+    auto manager = loadXplFile(filename, realfile, evalDefinitions(defs), cache);
+    py::object omanager(manager);
+
+    if (manager->scriptline)
+        manager->script = "#coding: utf8\n" + std::string(manager->scriptline - 1, '\n') + manager->script;
+    PyDict_Update(globals->ptr(), manager->defs.ptr());
+    plask::python::PythonManager::export_dict(omanager, *globals);
+
+    // Set default axes if all loaded geometries share the same
+    plask::optional<plask::AxisNames> axes;
+    for (const auto& geometry : manager->roots) {
+        if (!axes)
+            axes.reset(geometry->axisNames);
+        else if (geometry->axisNames != *axes) {
+            axes.reset();
+            break;
+        }
+    }
+    if (axes) plask::python::setCurrentAxes(*axes);
+
+    PyObject* result = NULL;
+    PyObject* code = system_Py_CompileString(manager->script.c_str(), filename.c_str(), Py_file_input);
+    if (code) result = PyEval_EvalCode(code, globals->ptr(), globals->ptr());
+    Py_XDECREF(code);
+    if (!result)
+        py::throw_error_already_set();
+    else
+        Py_DECREF(result);
+}
+
+#ifdef PLASK_SWEEP_SUPPORTED
+//******************************************************************************
+// Parameter sweeps: each row of the CSV file is run in a separate process forked from the one, in which the XPL
+// file has already been loaded once (so the solvers and materials are not loaded again)
+
+// Read names of the defines and their values in subsequent runs
+static void readSweepParameters(const system_string& sweepfile, std::vector<std::string>& names,
+                                std::vector<std::vector<std::string>>& runs) {
+    py::object file = py::import("io").attr("open")(system_str_to_pyobject(sweepfile), "r", -1, "utf8", py::object(), "");
+    py::list rows(py::import("csv").attr("reader")(file));
+    file.attr("close")();
+    for (py::ssize_t i = 0, n = py::len(rows); i != n; ++i) {
+        std::vector<std::string> row;
+        py::stl_input_iterator<std::string> begin(rows[i]), end;
+        for (auto item = begin; item != end; ++item) row.push_back(boost::trim_copy(*item));
+        if (row.empty() || (row.size() == 1 && row[0].empty()) || (!row[0].empty() && row[0][0] == '#')) continue;
+        if (names.empty()) {
+            for (const std::string& name : row)
+                if (name.empty()) throw plask::Exception("{}: empty parameter name", system_to_utf8(sweepfile));
+            names = std::move(row);
+        } else if (row.size() != names.size()) {
+            throw plask::Exception("{}, row {}: expected {} values, got {}", system_to_utf8(sweepfile), i + 1, names.size(),
+                                   row.size());
+        } else
+            runs.push_back(std::move(row));
+    }
+    if (names.empty()) throw plask::Exception("{}: no parameters specified", system_to_utf8(sweepfile));
+}
+
+// Execute a single run in the worker process and store its results in the part file
+static int runSweepWorker(const system_string& filename, const std::deque<std::string>& defs, std::uint64_t run,
+                          unsigned threads, const std::string& partname) {
+#if PY_VERSION_HEX >= 0x03070000
+    PyOS_AfterFork_Child();
+#else
+    PyOS_AfterFork();
+#endif
+    signal(SIGINT, SIG_DFL);  // interrupted run must not be recorded as failed
+
+    std::string scriptname = system_to_utf8(filename);
+    int exitcode = 0;
     try {
-        py::object(py::handle<>(PySys_GetObject("stderr"))).attr("flush")();
-    } catch (py::error_already_set) {
-        PyErr_Clear();
+        if (threads) py::import("plask._plask").attr("_set_thread_count")(threads);
+        runXplFile(filename, true, defs, true);  // geometry and grids are taken from the cache filled before fork
+    } catch (py::error_already_set&) {
+        exitcode = handlePythonException(scriptname.c_str());
+    } catch (plask::python::XMLExceptionWithCause& err) {
+        err.print(scriptname.c_str());
+        exitcode = 2;
+    } catch (plask::XMLException& err) {
+        plask::writelog(plask::LOG_CRITICAL_ERROR, "{}, {}", scriptname, err.what());
+        exitcode = 2;
+    } catch (std::exception& err) {
+        plask::writelog(plask::LOG_CRITICAL_ERROR, "{}: {}", scriptname, err.what());
+        exitcode = 3;
     }
+
     try {
-        py::object(py::handle<>(PySys_GetObject("stdout"))).attr("flush")();
-    } catch (py::error_already_set) {
+        plask::SweepRecord record(run, exitcode);
+        py::list items = py::dict(py::import("plask.sweep").attr("results")).items();
+        for (py::ssize_t i = 0, n = py::len(items); i != n; ++i) {
+            std::string name = py::extract<std::string>(items[i][0]);
+            py::object bytes = items[i][1].attr("tobytes")();
+            char* data;
+            Py_ssize_t size;
+            if (PyBytes_AsStringAndSize(bytes.ptr(), &data, &size) != 0) py::throw_error_already_set();
+            plask::DataVector<double> values(std::size_t(size) / sizeof(double));
+            std::memcpy(values.data(), data, values.size() * sizeof(double));
+            record.values[name] = values;
+        }
+        plask::SweepWriter(partname).append(record);
+    } catch (py::error_already_set&) {
+        handlePythonException(scriptname.c_str());
+        if (!exitcode) exitcode = 3;
+    } catch (std::exception& err) {
+        plask::writelog(plask::LOG_CRITICAL_ERROR, "{}: cannot store sweep results: {}", scriptname, err.what());
+        if (!exitcode) exitcode = 3;
+    }
+
+    endPlask();
+    std::fflush(nullptr);
+    return exitcode;
+}
+
+// Run all the sweep runs, which are not in the results file yet
+static int runSweep(const system_string& filename, const system_string& sweepfile, unsigned jobs,
+                    const std::deque<std::string>& defs) {
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string>> runs;
+    readSweepParameters(sweepfile, names, runs);
+
+    boost::filesystem::path resultspath(sweepfile);
+    resultspath.replace_extension(".sweep");
+    plask::SweepWriter writer(resultspath.string());
+
+    auto getParams = [&](std::uint64_t run) {
+        plask::SweepRecord::Params result;
+        for (std::size_t i = 0; i != names.size(); ++i) result.emplace_back(names[i], runs[run][i]);
+        return result;
+    };
+
+    // Records made for other parameters (e.g. if the CSV rows were modified) stop the sweep
+    std::vector<std::uint64_t> pending;
+    for (std::uint64_t run = 0; run != runs.size(); ++run)
+        if (!writer.isDone(run, getParams(run))) pending.push_back(run);
+    plask::writelog(plask::LOG_INFO, "Sweep of {} runs ({} already finished), results are stored in '{}'", runs.size(),
+                    runs.size() - pending.size(), writer.getFilename());
+    if (pending.empty()) return 0;
+
+    auto getDefs = [&](std::uint64_t run) {
+        std::deque<std::string> result = defs;
+        for (std::size_t i = 0; i != names.size(); ++i) result.push_back(names[i] + "=" + runs[run][i]);
+        return result;
+    };
+    auto getPartName = [&](std::uint64_t run) { return writer.getFilename() + "." + boost::lexical_cast<std::string>(run) + ".part"; };
+
+    // Load the file once, so the solvers and materials are already loaded in the workers. Errors are reported by
+    // the workers, as they can be specific for the parameters of the first run.
+    try {
+        loadXplFile(filename, true, evalDefinitions(getDefs(pending.front()), false), true);
+    } catch (py::error_already_set&) {
+        plask::writelog(plask::LOG_WARNING, "{}: preloading failed: {}", system_to_utf8(filename),
+                        plask::python::getPythonExceptionMessage());
         PyErr_Clear();
+    } catch (std::exception& err) {
+        plask::writelog(plask::LOG_WARNING, "{}: preloading failed: {}", system_to_utf8(filename), err.what());
     }
+    (*globals)["__manager__"] = py::object();
+
+    unsigned threads = 0;
+    if (jobs > 1) threads = std::max(std::thread::hardware_concurrency() / jobs, 1u);
+
+    std::map<pid_t, std::uint64_t> workers;
+    std::size_t next = 0, finished = 0, failed = 0;
+    while (next != pending.size() || !workers.empty()) {
+        while (next != pending.size() && workers.size() < jobs) {
+            std::uint64_t run = pending[next++];
+            std::string partname = getPartName(run);
+            boost::filesystem::remove(partname);  // left by the interrupted sweep
+            flushStreams();
+            std::fflush(nullptr);
+#if PY_VERSION_HEX >= 0x03070000
+            PyOS_BeforeFork();
+#endif
+            pid_t pid = fork();
+            if (pid == 0) _exit(runSweepWorker(filename, getDefs(run), run, threads, partname));
+            int error = errno;
+#if PY_VERSION_HEX >= 0x03070000
+            PyOS_AfterFork_Parent();
+#endif
+            if (pid < 0) throw plask::Exception("cannot start sweep worker: {}", std::strerror(error));
+            workers[pid] = run;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            int error = errno;
+            if (error == EINTR && PyErr_CheckSignals() == 0) continue;
+            for (const auto& worker : workers) kill(worker.first, SIGTERM);
+            for (const auto& worker : workers) {
+                waitpid(worker.first, nullptr, 0);
+                boost::filesystem::remove(getPartName(worker.second));
+            }
+            if (PyErr_Occurred()) throw py::error_already_set();
+            throw plask::Exception("cannot wait for sweep workers: {}", std::strerror(error));
+        }
+        auto worker = workers.find(pid);
+        if (worker == workers.end()) continue;
+        std::uint64_t run = worker->second;
+        workers.erase(worker);
+
+        std::string partname = getPartName(run);
+        plask::SweepRecord record(run, WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status));
+        bool stored = false;
+        if (boost::filesystem::exists(partname)) {
+            std::vector<plask::SweepRecord> records = plask::readSweepResults(partname);
+            if (records.size() == 1 && records.front().run == run) {
+                record = std::move(records.front());
+                stored = true;
+            }
+            boost::filesystem::remove(partname);
+        }
+        if (!stored && WIFSIGNALED(status)) {
+            int signal = WTERMSIG(status);
+            if (signal == SIGINT || signal == SIGTERM || signal == SIGKILL || signal == SIGHUP) {
+                // Do not store the record, so the run is repeated when the sweep is resumed
+                plask::writelog(plask::LOG_WARNING, "Sweep run {} was interrupted", run);
+                continue;
+            }
+        }
+        record.params = getParams(run);
+        writer.append(record);
+        ++finished;
+        if (record.status != 0) {
+            ++failed;
+            plask::writelog(plask::LOG_ERROR, "Sweep run {} failed with status {} ({}/{})", run, record.status, finished,
+                            pending.size());
+        } else
+            plask::writelog(plask::LOG_INFO, "Sweep run {} finished ({}/{})", run, finished, pending.size());
+    }
+
+    plask::Manager::clearSectionsCache();
+
+    if (failed) {
+        plask::writelog(plask::LOG_ERROR, "{} of {} sweep runs failed", failed, pending.size());
+        return 1;
+    }
+    return 0;
 }
+#endif
 
 //******************************************************************************
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
@@ -301,6 +608,7 @@ int
 #endif
                 "-h, --help     print this help message and exit\n"
                 "-i             force interactive shell\n"
+                "-j jobs        number of runs of the parameter sweep executed concurrently\n"
                 "-l arg         force logging level (error, error_detail, warning, important,\n"
                 "               info, result, data, detail, debug) or force colored (ansi) or\n"
                 "               monochromatic (mono) log\n"
@@ -308,6 +616,9 @@ int
                 "-p             treat provided file as Python script regardless of its\n"
                 "               extension (cannot be used together with -x)\n"
                 "-s             print hardware system ID for licensing and exit\n"
+                "-sweep params  run XPL file for each row of the CSV file 'params', which header\n"
+                "               contains names of the defines; results are appended to the file\n"
+                "               with extension .sweep and interrupted sweep is resumed\n"
                 "-u             use unbuffered binary stdout and stderr\n"
                 "-V, --version  print the PLaSK version number and exit\n"
                 "-x             treat provided file as XPL regardless of its\n"
@@ -339,6 +650,9 @@ int
 
     std::deque<std::string> defs;
 
+    const system_char* sweepfile = nullptr;
+    unsigned jobs = 1;
+
     while (argc > 1) {
         system_string arg = argv[1];
         if (arg == CSTR(-i)) {
@@ -482,6 +796,43 @@ int
             defs.push_back(system_to_utf8(def));
             argc -= drop;
             argv += drop;
+        } else if (arg == CSTR(-sweep)) {
+#ifdef PLASK_SWEEP_SUPPORTED
+            if (argc > 2) {
+                sweepfile = argv[2];
+            } else {
+                fprintf(stderr, "No parameters file specified for the -sweep option\n");
+                return 4;
+            }
+            argc -= 2;
+            argv += 2;
+#else
+            fprintf(stderr, "Parameter sweeps are not supported on this system\n");
+            return 4;
+#endif
+        } else if (arg.substr(0, 2) == CSTR(-j)) {
+            const system_char* count;
+            int drop = 1;
+            if (arg.length() > 2)
+                count = argv[1] + 2;
+            else if (argc > 2) {
+                count = argv[2];
+                ++drop;
+            } else {
+                fprintf(stderr, "No number of jobs specified for the -j option\n");
+                return 4;
+            }
+            try {
+                jobs = boost::lexical_cast<unsigned>(count);
+            } catch (boost::bad_lexical_cast&) {
+                jobs = 0;
+            }
+            if (jobs == 0) {
+                fprintf(stderr, "Bad number of jobs specified\n");
+                return 4;
+            }
+            argc -= drop;
+            argv += drop;
         } else if (arg.find(system_char('=')) != std::string::npos) {
             defs.push_back(system_to_utf8(argv[1]));
             --argc;
@@ -494,6 +845,11 @@ int
             break;
     }
 
+    if (sweepfile && (command || runmodule || force_interactive || argc < 2)) {
+        fprintf(stderr, "Parameter sweep can only be run for XPL file\n");
+        return 4;
+    }
+
     // Set the Python logger
     if (python_logger)
         plask::python::createPythonLogger();
@@ -662,61 +1018,18 @@ int
             plask::python::setXplFilename(system_to_utf8(filename));
 
             if (filetype == FILE_XML) {
-                py::dict locals;
-                for (std::string& def : defs) {
-                    auto keyval = plask::splitString2(def, '=');
-                    if (keyval.first == "self") throw plask::python::ValueError("Definition name 'self' is reserved");
-                    try {
-                        locals[keyval.first] = (plask::python::py_eval(keyval.second, xplGLobals, locals));
-                    } catch (py::error_already_set&) {
-                        plask::writelog(plask::LOG_WARNING, "Cannot parse command-line definition '{}' (storing it as string): {}",
-                                        keyval.first, plask::python::getPythonExceptionMessage());
-                        PyErr_Clear();
-                        locals[keyval.first] = keyval.second;
-                    }
-                    plask::writelog(plask::LOG_IMPORTANT, "{} = {}", keyval.first, keyval.second);
-                }
-
-                auto manager = plask::make_shared<plask::python::PythonManager>();
-                py::object omanager(manager);
-                (*globals)["__manager__"] = omanager;
-                // We export some dictionaries that may be useful in XPL parts (like Python geometry)
-                xplGLobals["PTH"] = omanager.attr("pth");
-                xplGLobals["GEO"] = omanager.attr("geo");
-                xplGLobals["MSH"] = omanager.attr("msh");
-                if (realfile)
-                    plask::python::loadXpl(omanager, system_str_to_pyobject(filename), locals);
-                else {
-                    py::object sys = py::import("sys");
-                    plask::python::loadXpl(omanager, sys.attr("stdin").attr("buffer"), locals);
-                }
-                if (manager->scriptline)
-                    manager->script = "#coding: utf8\n" + std::string(manager->scriptline - 1, '\n') + manager->script;
-                PyDict_Update(globals->ptr(), manager->defs.ptr());
-                plask::python::PythonManager::export_dict(omanager, *globals);
-
-                // Set default axes if all loaded geometries share the same
-                plask::optional<plask::AxisNames> axes;
-                for (const auto& geometry : manager->roots) {
-                    if (!axes)
-                        axes.reset(geometry->axisNames);
-                    else if (geometry->axisNames != *axes) {
-                        axes.reset();
-                        break;
-                    }
+                if (sweepfile) {
+#ifdef PLASK_SWEEP_SUPPORTED
+                    if (!realfile) throw std::invalid_argument("Parameter sweep cannot be run for XPL read from <stdin>");
+                    int exitcode = runSweep(filename, sweepfile, jobs, defs);
+                    endPlask();
+                    return exitcode;
+#endif
                 }
-                if (axes) plask::python::setCurrentAxes(*axes);
-
-                PyObject* result = NULL;
-                PyObject* code = system_Py_CompileString(manager->script.c_str(), filename.c_str(), Py_file_input);
-                if (code) result = PyEval_EvalCode(code, globals->ptr(), globals->ptr());
-                Py_XDECREF(code);
-                if (!result)
-                    py::throw_error_already_set();
-                else
-                    Py_DECREF(result);
+                runXplFile(filename, realfile, defs);
 
             } else {
+                if (sweepfile) throw std::invalid_argument("Parameter sweep can only be run for XPL file");
                 if (!defs.empty()) {
                     PyErr_SetString(PyExc_RuntimeError, "Command-line defines can only be specified when running XPL file");
                     throw py::error_already_set();
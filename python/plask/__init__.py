@@ -476,6 +476,8 @@ del get_material_field
 import plask.phys
 wl = phys.wl
 
+import plask.concurrent
+
 ## ##  ## ##
 
 for JOBID in 'PLASK_JOBID', 'JOB_ID', 'SLURM_JOB_ID', 'SLURM_JOBID', 'PBS_JOBID', 'LSB_JOBID', 'LOAD_STEP_ID':
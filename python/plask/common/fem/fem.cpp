@@ -109,7 +109,8 @@ void registerFemCommon() {
     py_enum<FemMatrixAlgorithm>()
         .value("CHOLESKY", ALGORITHM_CHOLESKY)
         .value("GAUSS", ALGORITHM_GAUSS)
-        .value("ITERATIVE", ALGORITHM_ITERATIVE);
+        .value("ITERATIVE", ALGORITHM_ITERATIVE)
+        .value("SPARSE", ALGORITHM_SPARSE);
 
     py_enum<EmptyElementsHandling>()
         .value("DEFAULT", EMPTY_ELEMENTS_DEFAULT)
@@ -30,6 +30,11 @@ void registerFemCommon();
 
 template <typename SolverT> inline static void registerFemSolver(SolverT& solver) {
     solver.def_readwrite("algorithm", &SolverT::Class::algorithm, "Chosen matrix factorization algorithm");
+    solver.def_readwrite("reuse_tolerance", &SolverT::Class::reuse_tolerance,
+                         "Relative residual below which the previous matrix factorization is reused\n\n"
+                         "If this value is non-negative, the factorized matrix is stored separately and in\n"
+                         "subsequent loops it is used with iterative refinement, as long as the residual stays\n"
+                         "below this tolerance. Negative value disables the reuse.");
     solver.add_property("iterative", py::make_function(&__get_iter_params<SolverT>, py::return_internal_reference<>()),
                         "Iterative matrix parameters (see :py:class:`~plask.IterativeParams`)");
 }
@@ -0,0 +1,86 @@
+# This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+# Copyright (c) 2022 Lodz University of Technology
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+"""Concurrent execution of independent computations.
+
+Long native computations started from Python (solver ``compute`` and ``find_mode`` methods, determinant maps,
+and provider calls) release the global interpreter lock, so independent solvers can work simultaneously
+in separate Python threads. This module provides an executor running such computations in a pool of threads,
+with the available processor cores divided between them. It is useful for parameter sweeps, where each point
+is computed with its own set of solvers::
+
+    def compute_threshold(aperture):
+        solvers = create_solvers(aperture)
+        ...
+        return threshold
+
+    with plask.concurrent.Executor() as executor:
+        thresholds = list(executor.map(compute_threshold, apertures))
+
+Each task must use its own solver instances, as a single solver must never be used by two tasks at the same time.
+Python callbacks (custom materials and providers, logging) are run one at a time, so their heavy use limits
+the speedup.
+"""
+
+import os as _os
+from concurrent import futures as _futures
+
+import plask as _plask
+
+
+def _cpu_count():
+    try:
+        return len(_os.sched_getaffinity(0))
+    except AttributeError:
+        return _os.cpu_count() or 1
+
+
+class Executor(_futures.ThreadPoolExecutor):
+    """
+    Executor running independent computations in parallel threads.
+
+    This is a :class:`concurrent.futures.ThreadPoolExecutor`, which additionally limits the number of threads
+    used by native parallel computations started by each task, so the tasks do not compete for processor cores.
+
+    Args:
+        max_workers (int): Maximum number of tasks running simultaneously. By default it is the number of
+            available processor cores.
+        threads (int): Number of threads used by native computations of each task. By default the available
+            processor cores are divided evenly between the tasks.
+    """
+
+    def __init__(self, max_workers=None, threads=None):
+        cores = _cpu_count()
+        if max_workers is None:
+            max_workers = cores
+        if threads is None:
+            threads = max(cores // max_workers, 1)
+        self.threads = threads
+        super().__init__(max_workers, thread_name_prefix='plask', initializer=_plask._plask._set_thread_count,
+                         initargs=(threads,))
+
+
+def map(fn, *iterables, max_workers=None, threads=None):
+    """
+    Compute function for all the items of iterables concurrently.
+
+    This is a shortcut for creating :class:`Executor` and calling its :meth:`~Executor.map` method.
+    Unlike the builtin :func:`map`, it returns list of results, after all of them are computed.
+
+    Args:
+        fn (callable): Function to compute. It should create its own solvers.
+        iterables: Iterables with function arguments.
+        max_workers (int): Maximum number of tasks running simultaneously.
+        threads (int): Number of threads used by native computations of each task.
+    """
+    with Executor(max_workers, threads) as executor:
+        return list(executor.map(fn, *iterables))
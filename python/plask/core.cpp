@@ -11,7 +11,11 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU General Public License for more details.
  */
+#include <atomic>
 #include <complex>
+#include <map>
+#include <thread>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 
@@ -86,7 +90,114 @@ PLASK_PYTHON_API py::object py_eval(std::string string, py::object global, py::o
 
 
 // Parallel locking
-PLASK_PYTHON_API OmpNestLock python_omp_lock;
+PLASK_PYTHON_API PythonLock python_omp_lock;
+
+/// Active ReleaseGIL objects by their identifiers
+static std::map<unsigned long, ReleaseGIL*> active_releases;
+static unsigned long last_release_id = 0;
+static OmpLock active_releases_lock;
+
+/// Identifier of the ReleaseGIL object the current thread works for (it may be already destroyed)
+static thread_local unsigned long current_release = 0;
+
+/// GIL states for nested locks of python_omp_lock in the current thread
+struct GILState {
+    ReleaseGIL* release;        ///< Object the thread works for (null if unknown)
+    bool acquired;              ///< True if the GIL was acquired by the lock
+    PyGILState_STATE state;
+    GILState(ReleaseGIL* release, bool acquired, PyGILState_STATE state = PyGILState_UNLOCKED):
+        release(release), acquired(acquired), state(state) {}
+};
+static thread_local std::vector<GILState> gil_states;
+
+/// True if the current owner of python_omp_lock needs the GIL to proceed
+static std::atomic<bool> owner_needs_gil(false);
+
+/// Return ReleaseGIL object the current thread works for or nullptr if it is not known
+static ReleaseGIL* currentRelease() {
+    if (current_release == 0) return nullptr;
+    OmpLockGuard<OmpLock> lock(active_releases_lock);
+    auto found = active_releases.find(current_release);
+    return (found == active_releases.end()) ? nullptr : found->second;
+}
+
+void PythonLock::lock() {
+    if (PyGILState_Check()) {
+        // Keep the GIL only if the lock owner does not need it. Otherwise, it would never release the lock.
+        // If the owner needs the GIL, it cannot release the lock before we release the GIL, so the check is not racy.
+        while (!try_lock()) {
+            if (owner_needs_gil.load()) {
+                PyThreadState* state = PyEval_SaveThread();
+                OmpNestLock::lock();
+                owner_needs_gil = true;
+                PyEval_RestoreThread(state);
+                break;
+            }
+            std::this_thread::yield();
+        }
+        owner_needs_gil = true;
+        gil_states.emplace_back(nullptr, false);
+    } else {
+        // The GIL must be acquired regardless of which computation the thread works for, as other Python threads may
+        // run in the meantime. Native calls running Python callbacks in other threads release the GIL (see ReleaseGIL),
+        // so its holder does not wait for this thread. The release is known only for threads marked by ReleaseGIL and
+        // it is used only to pass Python errors to the releasing thread.
+        ReleaseGIL* release = currentRelease();
+        OmpNestLock::lock();
+        owner_needs_gil = true;
+        gil_states.emplace_back(release, true, PyGILState_Ensure());
+    }
+}
+
+void PythonLock::unlock() {
+    GILState state = gil_states.back();
+    gil_states.pop_back();
+    if (state.release) {
+        // Thread state of this thread may be destroyed, so move the error to the object that released the GIL.
+        // Only the first error is kept, as the following ones are usually its consequences.
+        if (PyErr_Occurred()) {
+            if (!state.release->error_type)
+                PyErr_Fetch(&state.release->error_type, &state.release->error_value, &state.release->error_traceback);
+            else
+                PyErr_Clear();
+        }
+    }
+    if (gil_states.empty()) owner_needs_gil = false;
+    if (state.acquired) PyGILState_Release(state.state);
+    OmpNestLock::unlock();
+}
+
+ReleaseGIL::ReleaseGIL(): previous(current_release) {
+    {
+        OmpLockGuard<OmpLock> lock(active_releases_lock);
+        id = ++last_release_id;
+        active_releases[id] = this;
+    }
+    // OpenMP runtimes reuse the same threads for subsequent parallel regions started by this thread,
+    // so mark them as working for this object
+    unsigned long team_release = id;
+    #pragma omp parallel
+    current_release = team_release;
+    state = PyEval_SaveThread();
+}
+
+ReleaseGIL::~ReleaseGIL() {
+    PyEval_RestoreThread(state);
+    current_release = previous;
+    {
+        OmpLockGuard<OmpLock> lock(active_releases_lock);
+        active_releases.erase(id);
+    }
+    if (error_type) {
+        if (!PyErr_Occurred()) {
+            PyErr_Restore(error_type, error_value, error_traceback);
+        } else {
+            Py_XDECREF(error_type);
+            Py_XDECREF(error_value);
+            Py_XDECREF(error_traceback);
+        }
+    }
+}
 
 // Config
 PLASK_PYTHON_API AxisNames current_axes = AxisNames::axisNamesRegister.get("ltv");
@@ -486,6 +597,12 @@ struct SolverWrap: public Solver, Overriden<Solver> {
 };
 
 
+/// Initialize solver with the GIL released, as materials (possibly defined in Python) are often evaluated in parallel
+static bool Solver_initialize(plask::Solver& self) {
+    ReleaseGIL nogil;
+    return self.initCalculation();
+}
+
 /// Custom wrapper for XMLError
 template <>
 void register_exception<plask::XMLException>(PyObject* py_exc) {
@@ -499,6 +616,14 @@ void register_exception<plask::XMLException>(PyObject* py_exc) {
 }
 
 
+static void setThreadCount(int count) {
+    if (count < 1) throw ValueError("thread count must be positive");
+#   ifdef OPENMP_FOUND
+        omp_set_num_threads(count);
+#   endif
+}
+
+
 }} // namespace plask::python
 
 
@@ -640,7 +765,7 @@ BOOST_PYTHON_MODULE(_plask)
                       u8"Solvers usually get initialized at the beginning of the computations.\n"
                       u8"You can clean the initialization state and free the memory by calling\n"
                       u8"the :meth:`invalidate` method.")
-        .def("initialize", &plask::Solver::initCalculation,
+        .def("initialize", &Solver_initialize,
              u8"Initialize solver.\n\n"
              u8"This method manually initialized the solver and sets :attr:`initialized` to\n"
              u8"*True*. Normally calling it is not necessary, as each solver automatically\n"
@@ -722,6 +847,9 @@ BOOST_PYTHON_MODULE(_plask)
         py::def("_print_stack", &printStack, "Print C stack (for debug purposes_");
 #   endif
 
+    py::def("_set_thread_count", &setThreadCount, py::arg("count"),
+            "Set number of threads used by native parallel computations started in the current thread");
+
     // Converters
     // DoubleFromComplex();
 
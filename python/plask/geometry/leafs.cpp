@@ -113,7 +113,7 @@ template <int dim> void setLeafMaterialFast(shared_ptr<GeometryObjectLeaf<dim>>
 
 template <int dim> void setLeafMaterial(shared_ptr<GeometryObjectLeaf<dim>> self, py::object omaterial) {
     setLeafMaterialFast(self, omaterial);
-    self->fireChanged();
+    self->fireChanged(GeometryObject::Event::EVENT_MATERIAL);
 }
 
 // Rectangle constructor wraps
@@ -285,6 +285,8 @@ PyObject* GeometryObjectIncludesPoints(const shared_ptr<GeometryObjectD<dim>>& s
 
     auto boxes = self->getObjectBoundingBoxes(obj, pth);
 
+    // Release the GIL, so the worker threads can acquire it for meshes defined in Python
+    ReleaseGIL nogil;
 #pragma omp parallel for
     for (plask::openmp_size_t i = 0; i < mesh.size(); ++i) {
         auto p = mesh[i];
@@ -130,6 +130,8 @@ PyObject* SpaceObjectIncludesPoints(const S& self, const GeometryObject& obj, co
 
     auto boxes = self.getObjectBoundingBoxes(obj, pth);
 
+    // Release the GIL, so the worker threads can acquire it for meshes defined in Python
+    ReleaseGIL nogil;
     #pragma omp parallel for
     for (plask::openmp_size_t i = 0; i < mesh.size(); ++i) {
         auto p = self.wrapEdges(mesh[i]);
@@ -165,7 +165,7 @@ void XMLExceptionWithCause::setPythonException() {
 /**
  * Load data from XML
  */
-PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py::object filter=py::object())
+PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py::object filter=py::object(), bool cache=false)
 {
     PythonManager* manager = py::extract<PythonManager*>(self);
 
@@ -173,15 +173,31 @@ PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py
 
     boost::filesystem::path filename;
 
+    struct CacheSourceGuard {
+        PythonManager* manager;
+        CacheSourceGuard(PythonManager* manager): manager(manager) {}
+        ~CacheSourceGuard() { manager->cacheSource.clear(); }
+    };
+    CacheSourceGuard cache_guard(manager);
+
     std::string str;
     try {
         str = py::extract<std::string>(src);
         if (str.find('<') == std::string::npos && str.find('>') == std::string::npos) { // str is not XML (a filename probably)
             boost::filesystem::path filename_tmp = pyobject_to_path(src);
-            source.reset(new XMLReader::StreamDataSource(new std::ifstream(filename_tmp.string())));
+            if (cache) {
+                // The whole file is needed for the cache key
+                std::ifstream file(filename_tmp.string(), std::ios::binary);
+                if (!file) throw IOError(u8"cannot open file '{}'", filename_tmp.string());
+                manager->cacheSource.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                source.reset(new XMLReader::StreamDataSource(new std::istringstream(manager->cacheSource)));
+            } else
+                source.reset(new XMLReader::StreamDataSource(new std::ifstream(filename_tmp.string())));
             filename = std::move(filename_tmp);
-        } else
+        } else {
+            if (cache) manager->cacheSource = str;
             source.reset(new XMLReader::StreamDataSource(new std::istringstream(str)));
+        }
     } catch (py::error_already_set&) {
         PyErr_Clear();
         if (!PyObject_HasAttrString(src.ptr(),"read")) throw TypeError("argument is neither string nor a proper file-like object");
@@ -229,9 +245,10 @@ PLASK_PYTHON_API void loadXpl(py::object self, py::object src, py::dict vars, py
     manager->validatePositions();
 }
 
-PLASK_PYTHON_API void PythonManager_load(py::object self, py::object src, py::dict defs, py::object filter=py::object()) {
+PLASK_PYTHON_API void PythonManager_load(py::object self, py::object src, py::dict defs, py::object filter=py::object(),
+                                         bool cache=false) {
     try {
-        loadXpl(self, src, defs, filter);
+        loadXpl(self, src, defs, filter, cache);
     } catch (XMLExceptionWithCause& err) {
         err.throwPythonException();
     }
@@ -274,6 +291,50 @@ void PythonManager::loadDefines(XMLReader& reader)
 }
 
 
+std::string PythonManager::getSectionsCacheKey() const
+{
+    if (cacheSource.empty()) return std::string();
+
+    // Geometry and grids can only depend on the file part preceding the solvers and on the defines used there
+    std::string::size_type begin = cacheSource.find("</defines>");
+    if (begin == std::string::npos) begin = 0;
+    std::string::size_type end = cacheSource.size();
+    for (const char* tag: {"<solvers", "<connects", "<script"}) end = std::min(end, cacheSource.find(tag, begin));
+    std::string key = cacheSource.substr(begin, end - begin);
+
+    std::set<std::string> names;
+    for (std::string::size_type i = begin; i < end;) {
+        unsigned char c = cacheSource[i];  // bytes of non-ASCII UTF-8 characters are negative as plain char
+        if (std::isalpha(c) || c == '_') {
+            std::string::size_type j = i + 1;
+            while (j < end && (std::isalnum(static_cast<unsigned char>(cacheSource[j])) || cacheSource[j] == '_')) ++j;
+            names.insert(cacheSource.substr(i, j - i));
+            i = j;
+        } else
+            ++i;
+    }
+
+    key.push_back('\0');
+    try {
+        // Iterate the keys in a fixed order, as the dict order depends on the order of the definitions
+        py::list keys = defs.keys();
+        keys.sort();
+        for (py::stl_input_iterator<std::string> name(keys), names_end; name != names_end; ++name) {
+            if (*name == "self" || names.find(*name) == names.end()) continue;
+            std::string value = py::extract<std::string>(py::str(defs[*name].attr("__repr__")()));
+            key += *name;
+            key.push_back('=');
+            key += value;
+            key.push_back('\n');
+        }
+    } catch (py::error_already_set&) {
+        PyErr_Clear();
+        return std::string();
+    }
+    return key;
+}
+
+
 shared_ptr<Solver> PythonManager::loadSolver(const std::string& category, const std::string& lib, const std::string& solver_name, const std::string& name)
 {
     std::string module_name = (category == "local")? lib : category + "." + lib;
@@ -715,8 +776,16 @@ void register_manager() {
              u8"        :xml:tag:`<defines>` section of the XPL file.\n"
              u8"    sections (list): List of section to read.\n"
              u8"        If this parameter is given, only the listed sections of the XPL file are\n"
-             u8"        read and the other ones are skipped.\n",
-             (py::arg("source"), py::arg("defs")=py::dict(), py::arg("sections")=py::object()))
+             u8"        read and the other ones are skipped.\n"
+             u8"    cache (bool): If *True*, the parsed geometry and grids are stored in a cache\n"
+             u8"        and taken from it when the same file is loaded again with the same values\n"
+             u8"        of the defines used in these sections. Geometry objects and meshes taken\n"
+             u8"        from the cache are shared with the managers loaded before, as long as\n"
+             u8"        they are not modified. Only a few most recently loaded files are kept\n"
+             u8"        in the cache; use :meth:`clear_cache` to free it earlier.\n",
+             (py::arg("source"), py::arg("defs")=py::dict(), py::arg("sections")=py::object(), py::arg("cache")=false))
+        .def("clear_cache", &Manager::clearSectionsCache, u8"Remove all the parsed sections from the cache.")
+        .staticmethod("clear_cache")
         .def_readonly("defs", &PythonManager::defs,
                        u8"Local defines.\n\n"
                        u8"This is a combination of the values specified in the :xml:tag:`<defines>`\n"
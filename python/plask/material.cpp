@@ -231,6 +231,7 @@ class PythonMaterial: public MaterialWithBase, Overriden<Material>
     double Eg(double T, double e, char point) const override {
         try { return call_override<double>("Eg", cache->Eg, T, e, point); }
         catch (NotImplemented&) {
+            OmpLockGuard<OmpNestLock> lock(python_omp_lock);  // overriden() accesses Python objects
             if ((cache->VB || overriden("VB")) && (cache->CB || overriden("CB"))) {
                 try {
                     return call_override<double>("CB", cache->CB, T, e, point) -
@@ -244,6 +245,7 @@ class PythonMaterial: public MaterialWithBase, Overriden<Material>
     double CB(double T, double e, char point) const override {
         try { return call_override<double>("CB", cache->CB, T, e, point); }
         catch (NotImplemented&) {
+            OmpLockGuard<OmpNestLock> lock(python_omp_lock);  // overriden() accesses Python objects
             if (cache->VB || cache->Eg || overriden("VB") || overriden("Eg")) {
                 try { return VB(T, e, point, 'H') + Eg(T, e, point); }
                 catch (NotImplemented&) {}
@@ -254,6 +256,7 @@ class PythonMaterial: public MaterialWithBase, Overriden<Material>
     double VB(double T, double e, char point, char hole) const override {
         try { return call_override<double>("VB", cache->VB, T, e, point, hole); }
         catch (NotImplemented&) {
+            OmpLockGuard<OmpNestLock> lock(python_omp_lock);  // overriden() accesses Python objects
             if (cache->CB || overriden("CB")) {
                 try { return call_override<double>("CB", cache->CB, T, e, point) - Eg(T, e, point); }
                 catch (NotImplemented&) {}
@@ -800,6 +803,11 @@ shared_ptr<Material> MaterialsDB_const(py::tuple args, py::dict kwargs) {
     return plask::make_shared<ConstMaterial>(base, params);
 }
 
+void MaterialsDB_cache(MaterialsDB& DB, const std::string& name, const std::string& params, double Tmin, double Tmax,
+                       double Tstep, double tolerance, size_t maxkeys) {
+    DB.cache(name, CachedMaterial::Settings(CachedMaterial::parseParameters(params), Tmin, Tmax, Tstep, tolerance, maxkeys));
+}
+
 py::dict Material__completeComposition(const Material& self, py::dict src) {
     py::list keys = src.keys();
     Material::Composition comp;
@@ -1112,6 +1120,28 @@ void initMaterials() {
         .def("material_with_params", py::raw_function(&MaterialsDB_const),
              u8"Get material with constant parameters specified as kwargs\n\n"
              u8":rtype: Material\n")
+        .def("cache", &MaterialsDB_cache,
+             (py::arg("name"), py::arg("params"), py::arg("Tmin")=200., py::arg("Tmax")=1000., py::arg("Tstep")=1.,
+              py::arg("tolerance")=1e-4, py::arg("maxkeys")=16),
+             u8"Tabulate temperature dependence of material parameters.\n\n"
+             u8"All materials with the given name created afterwards compute the selected parameters\n"
+             u8"only in the nodes of a regular temperature grid and interpolate them linearly.\n\n"
+             u8"Args:\n"
+             u8"    name (str): material name without doping amount and composition.\n"
+             u8"                (e.g. 'GaAs:Si', 'AlGaAs').\n"
+             u8"    params (str): space or comma separated names of the tabulated parameters\n"
+             u8"                  (e.g. 'thermk cond'). Empty string disables tabulation.\n"
+             u8"    Tmin (float): Lowest tabulated temperature (K).\n"
+             u8"    Tmax (float): Highest tabulated temperature (K).\n"
+             u8"    Tstep (float): Temperature step (K).\n"
+             u8"    tolerance (float): Maximum relative interpolation error. Parameters in temperature\n"
+             u8"                       intervals, in which it is exceeded, are not tabulated.\n"
+             u8"    maxkeys (int): Maximum number of distinct values of other arguments (e.g. wavelengths)\n"
+             u8"                   for which each parameter is tabulated. For other values the base\n"
+             u8"                   material is called directly.\n")
+        .def("invalidate_cache", &MaterialsDB::invalidateCached,
+             u8"Drop tabulated parameters of all existing cached materials.\n\n"
+             u8"This must be called after the parameters of the base materials are changed.\n")
         ;
 
     {
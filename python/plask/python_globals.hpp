@@ -346,7 +346,56 @@ std::map<TK,TV> dict_to_map(const py::object& obj) {
 // ----------------------------------------------------------------------------------------------------------------------
 // Parallel locking
 
-extern PLASK_PYTHON_API OmpNestLock python_omp_lock;
+/**
+ * Lock guarding access to Python from native threads.
+ *
+ * Apart from serializing Python calls, the lock acquires the GIL in every thread that does not hold it. So native
+ * methods that run Python callbacks (e.g. Python materials or logging) in OpenMP threads must release the GIL
+ * (see ReleaseGIL and METHOD_RELEASING_GIL), as otherwise their threads would wait for it forever. In practice this
+ * applies to any Python entry point that may start a parallel region. Other Python threads can run while the GIL
+ * is released.
+ * A thread holding the GIL waits for this lock without releasing the GIL only if the current lock owner does not need it.
+ */
+class PLASK_PYTHON_API PythonLock: public OmpNestLock {
+  public:
+    void lock() override;
+    void unlock() override;
+};
+
+extern PLASK_PYTHON_API PythonLock python_omp_lock;
+
+/**
+ * Release the GIL for the lifetime of this object.
+ *
+ * This should wrap long native computations, so other Python threads can run in parallel. All Python callbacks made
+ * during the computation (materials, providers, logging) must be guarded with \ref python_omp_lock, which acquires
+ * the GIL back. Python errors raised in such callbacks are restored in the releasing thread on destruction.
+ *
+ * The OpenMP threads of the releasing thread are marked as working for this object on construction, so their Python
+ * errors are kept here and not mixed with errors of other computations running concurrently. The marks are used only
+ * for the errors: unmarked threads (e.g. in larger or nested thread teams) still acquire the GIL, but their Python
+ * errors are not passed to the releasing thread.
+ */
+class PLASK_PYTHON_API ReleaseGIL {
+    PyThreadState* state;
+
+    /// Unique identifier of this object (identifiers are not reused, unlike addresses)
+    unsigned long id;
+
+    /// Identifier of the object the current thread worked for before
+    unsigned long previous;
+
+    /// Python error raised in a callback (accessed only with the GIL held)
+    PyObject *error_type = nullptr, *error_value = nullptr, *error_traceback = nullptr;
+
+    friend class PythonLock;
+
+  public:
+    ReleaseGIL();
+    ~ReleaseGIL();
+    ReleaseGIL(const ReleaseGIL&) = delete;
+    ReleaseGIL& operator=(const ReleaseGIL&) = delete;
+};
 
 // ----------------------------------------------------------------------------------------------------------------------
 // Virtual functions overriding
@@ -67,6 +67,9 @@ struct PLASK_PYTHON_API PythonManager: public Manager {
     /// Locals read from &lt;defines&gt; section and supplied by user
     py::dict defs;
 
+    /// Contents of the loaded file, if its geometry and grids should be cached (empty otherwise)
+    std::string cacheSource;
+
     PythonManager(bool draft=false): Manager(draft) {}
 
     shared_ptr<Solver> loadSolver(const std::string& category, const std::string& lib, const std::string& solver_name, const std::string& name) override;
@@ -84,6 +87,10 @@ struct PLASK_PYTHON_API PythonManager: public Manager {
     static void export_dict(py::object self, py::object dict);
 
     void loadScript(XMLReader& reader) override;
+
+  protected:
+
+    std::string getSectionsCacheKey() const override;
 };
 
 }} // namespace plask::python
@@ -563,19 +563,28 @@ PythonDataVector<T, dim> PLASK_PYTHON_API dataInterpolate(const PythonDataVector
                                                           const py::object& geometry = py::object());
 
 template <typename T> struct PythonLazyDataImpl : public LazyDataImpl<T> {
-    py::object object;
+    /// Python data (optional, so it can be released in the destructor with the GIL held)
+    plask::optional<py::object> object;
     size_t len;
 
-    PythonLazyDataImpl(const py::object& object, size_t len) : object(object), len(len) {
+    PythonLazyDataImpl(const py::object& object, size_t len) : len(len) {
+        OmpLockGuard<OmpNestLock> lock(python_omp_lock);
         if (PyObject_HasAttrString(object.ptr(), "__len__")) {
             if (py::len(object) != py::ssize_t(len))
                 throw ValueError(u8"Sizes of data ({}) and mesh ({}) do not match", py::len(object), len);
         }
+        this->object = object;
+    }
+
+    /// The data may be dropped by native code running without the GIL (e.g. provider called with released GIL)
+    ~PythonLazyDataImpl() {
+        OmpLockGuard<OmpNestLock> lock(python_omp_lock);
+        object.reset();
     }
 
     T at(std::size_t index) const override {
         OmpLockGuard<OmpNestLock> lock(python_omp_lock);
-        return py::extract<T>(object[index]);
+        return py::extract<T>((*object)[index]);
     }
 
     std::size_t size() const override { return len; }
@@ -927,7 +936,12 @@ struct RegisterProviderImpl<ProviderT, FIELD_PROPERTY, VariadicTemplateTypesHold
                                                          const ExtraParams&... params,
                                                          InterpolationMethod method) {
         if (!mesh) throw TypeError(u8"You must provide proper mesh to {0} provider", self.name());
-        return PythonDataVector<const ValueT, DIMS>(self(mesh, params..., method), mesh);
+        DataVector<const ValueT> data;
+        {
+            ReleaseGIL nogil;
+            data = self(mesh, params..., method);
+        }
+        return PythonDataVector<const ValueT, DIMS>(std::move(data), mesh);
     }
     RegisterProviderImpl()
         : RegisterProviderBase<ProviderT>(spaceSuffix<typename ProviderT::SpaceType>(),
@@ -958,14 +972,24 @@ struct RegisterProviderImpl<ProviderT, MULTI_FIELD_PROPERTY, VariadicTemplateTyp
         int n = int(num);
         if (n < 0) num = EnumType(self.size() + n);
         if (n < 0 || std::size_t(n) >= self.size()) throw NoValue(format("{0} [{1}]", self.name(), num).c_str());
-        return PythonDataVector<const ValueT, DIMS>(self(num, mesh, params..., method), mesh);
+        DataVector<const ValueT> data;
+        {
+            ReleaseGIL nogil;
+            data = self(num, mesh, params..., method);
+        }
+        return PythonDataVector<const ValueT, DIMS>(std::move(data), mesh);
     }
     static PythonDataVector<const ValueT, DIMS> __call__0(ProviderT& self,
                                                           const shared_ptr<MeshD<DIMS>>& mesh,
                                                           const ExtraParams&... params,
                                                           InterpolationMethod method) {
         if (!mesh) throw TypeError(u8"You must provide proper mesh to {0} provider", self.name());
-        return PythonDataVector<const ValueT, DIMS>(self(EnumType(0), mesh, params..., method), mesh);
+        DataVector<const ValueT> data;
+        {
+            ReleaseGIL nogil;
+            data = self(EnumType(0), mesh, params..., method);
+        }
+        return PythonDataVector<const ValueT, DIMS>(std::move(data), mesh);
     }
     RegisterProviderImpl()
         : RegisterProviderBase<ProviderT>(spaceSuffix<typename ProviderT::SpaceType>(),
@@ -356,6 +356,22 @@ struct ExportSolver : public py::class_<SolverT, shared_ptr<SolverT>, py::bases<
 
 };
 
+namespace detail {
+
+    /// Wrapper of a solver method, which releases the GIL for the time of its execution
+    template <typename Class, typename Method> struct MethodReleasingGIL;
+
+    template <typename Class, typename R, typename Base, typename... Args>
+    struct MethodReleasingGIL<Class, R (Base::*)(Args...)> {
+        template <R (Base::*method)(Args...)>
+        static R call(Class& self, Args... args) {
+            ReleaseGIL nogil;
+            return (self.*method)(args...);
+        }
+    };
+
+} // namespace detail
+
 // Here are some useful defines.
 // Note that if you use them to define methods, properties etc, you should also use MODULE
 #define CLASS(cls, name, help) typedef cls __Class__; \
@@ -363,6 +379,10 @@ struct ExportSolver : public py::class_<SolverT, shared_ptr<SolverT>, py::bases<
         name "(name=\"\")\n\n" help, \
         py::init<std::string>(py::arg("name")=""));
 #define METHOD(name, method, help, ...) solver.def(BOOST_PP_STRINGIZE(name), &__Class__::method, help, (py::arg("arg1") , ## __VA_ARGS__))
+// Use this for long computations, so other Python threads can run in the meantime
+#define METHOD_RELEASING_GIL(name, method, help, ...) solver.def(BOOST_PP_STRINGIZE(name), \
+        &::plask::python::detail::MethodReleasingGIL<__Class__, decltype(&__Class__::method)>::template call<&__Class__::method>, \
+        help, (py::arg("arg1") , ## __VA_ARGS__))
 #define RO_PROPERTY(name, get, help) solver.add_property(BOOST_PP_STRINGIZE(name), &__Class__::get, help)
 #define RW_PROPERTY(name, get, set, help) solver.add_property(BOOST_PP_STRINGIZE(name), &__Class__::get, &__Class__::set, help)
 #define RO_FIELD(name, help) solver.def_readonly(BOOST_PP_STRINGIZE(name), &__Class__::name, help)
@@ -105,6 +105,8 @@ py::object PARALLEL_UFUNC(F f, py::object input, const char* name, const char* a
         npy_intp* innersizeptr = NpyIter_GetInnerLoopSizePtr(iter);
         char** dataptrarray = NpyIter_GetDataPtrArray(iter);
         std::exception_ptr error;
+        // Release the GIL, so the worker threads can acquire it for Python callbacks
+        std::unique_ptr<ReleaseGIL> nogil(new ReleaseGIL);
 #ifndef _MSC_VER
 #    pragma omp parallel
 #endif
@@ -146,6 +148,7 @@ py::object PARALLEL_UFUNC(F f, py::object input, const char* name, const char* a
 #    pragma omp taskwait
 #endif
         }
+        nogil.reset();
         if (error) {
             Py_XDECREF(inarr);
             std::rethrow_exception(error);
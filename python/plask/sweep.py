@@ -0,0 +1,125 @@
+# This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+# Copyright (c) 2022 Lodz University of Technology
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+"""Results of parameter sweeps.
+
+XPL file can be run for many sets of parameters with the ``-sweep`` option of the ``plask`` command::
+
+    plask -sweep params.csv -j 4 file.xpl
+
+The first row of the CSV file contains names of the defines and each subsequent row is a single run, in which
+the defines have the values given in this row. The file is first loaded once, so that the solvers and materials
+are imported only once. The runs are executed in separate processes forked from this prepared one (``-j`` gives
+the number of concurrent runs). Each run parses the file again with its own defines, but the geometry and grids
+are taken from the cache when they do not depend on the swept defines. Each run stores its results with
+:func:`result`::
+
+    plask.sweep.result('threshold', threshold)
+    plask.sweep.result('temperature', THERMAL.outTemperature(mesh))
+
+The results are appended to the file ``params.sweep`` as soon as each run finishes. If the sweep is interrupted,
+running the same command again computes only the missing runs. Each result contains the defines of its run, so if
+the parameters file has been modified in the meantime, the sweep is stopped with an error instead. The results file
+can be read with :func:`read`.
+"""
+
+import struct as _struct
+from collections import namedtuple as _namedtuple
+
+import numpy as _numpy
+
+#: Results stored in the current run.
+results = {}
+
+
+def result(name, value):
+    """
+    Store result of the current sweep run.
+
+    Args:
+        name (str): Name of the result.
+        value: Real number, array, or data returned by a provider. Multi-dimensional values are flattened.
+    """
+    value = _numpy.asarray(value)
+    if _numpy.iscomplexobj(value):
+        raise TypeError("sweep result '{}' must be real (store its real and imaginary parts separately)".format(name))
+    results[str(name)] = _numpy.ascontiguousarray(value, dtype=float).ravel()
+
+
+Run = _namedtuple('Run', ('run', 'status', 'params', 'values'))
+Run.__doc__ = """
+Results of a single sweep run.
+
+Attributes:
+    run (int): Index of the run (i.e. the row of the parameters file, not counting the header).
+    status (int): Exit status of the run, which is 0 if the run succeeded.
+    params (dict): Defines of the run (strings as given in the parameters file).
+    values (dict): Stored results. Scalars are floats and other values are one-dimensional arrays.
+"""
+
+
+def _read_string(contents, pos):
+    length, = _struct.unpack_from('=I', contents, pos)
+    pos += 4
+    return contents[pos:pos+length].decode('utf8'), pos + length
+
+
+def read(filename):
+    """
+    Read sweep results file.
+
+    Args:
+        filename (str): Name of the results file.
+
+    Returns:
+        list of :class:`Run`: Results of the finished runs sorted by their indices.
+    """
+    with open(filename, 'rb') as file:
+        contents = file.read()
+    if not contents:
+        return []
+    if contents[:8] != b'PLASKSWP':
+        raise ValueError("'{}' is not a sweep results file".format(filename))
+    version, byteorder = _struct.unpack_from('=II', contents, 8)
+    if version != 2:
+        raise ValueError("sweep results file '{}' has unsupported version {}".format(filename, version))
+    if byteorder != 0x01020304:
+        raise ValueError("sweep results file '{}' was written on a machine with different byte order".format(filename))
+    runs = []
+    pos = 16
+    while pos + 8 <= len(contents):
+        size, = _struct.unpack_from('=Q', contents, pos)
+        pos += 8
+        end = pos + size
+        if end > len(contents):
+            break  # incomplete record of the interrupted run
+        run, status, count = _struct.unpack_from('=QiI', contents, pos)
+        pos += 16
+        params = {}
+        for _ in range(count):
+            name, pos = _read_string(contents, pos)
+            params[name], pos = _read_string(contents, pos)
+        count, = _struct.unpack_from('=I', contents, pos)
+        pos += 4
+        values = {}
+        for _ in range(count):
+            name, pos = _read_string(contents, pos)
+            n, = _struct.unpack_from('=Q', contents, pos)
+            pos += 8
+            data = _numpy.frombuffer(contents, float, n, pos).copy()
+            pos += 8 * n
+            values[name] = float(data[0]) if n == 1 else data
+        if pos != end:
+            raise ValueError("sweep results file '{}' is damaged".format(filename))
+        runs.append(Run(run, status, params, values))
+    runs.sort(key=lambda r: r.run)
+    return runs
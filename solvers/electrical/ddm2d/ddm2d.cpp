@@ -301,7 +301,7 @@ void DriftDiffusionModel2DSolver<Geometry2DType>::setMatrix(FemMatrix& A, DataVe
     B.fill(0.);
 
     // Set stiffness matrix and load vector
-    for (auto e: this->mesh->elements()) {
+    assembleElements(*this->mesh, A, this->elementColoring, [&](const RectangularMesh<2>::Element& e) {
 
         size_t i = e.getIndex();
 
@@ -317,6 +317,7 @@ void DriftDiffusionModel2DSolver<Geometry2DType>::setMatrix(FemMatrix& A, DataVe
 
         Vec <2,double> midpoint = e.getMidpoint();
         auto material = this->geometry->getMaterial(midpoint);
+        OmpLockGuard<OmpNestLock> lock = material->lock();
 
         double T;//(300.); //TODO
         // average temperature on the element
@@ -500,6 +501,8 @@ void DriftDiffusionModel2DSolver<Geometry2DType>::setMatrix(FemMatrix& A, DataVe
             }
         }
 
+        lock = OmpLockGuard<OmpNestLock>();  // material is no longer needed
+
         // set symmetric matrix components
         double k44, k33, k22, k11, k43, k21, k42, k31, k32, k41;
         double g44, g33, g22, g11, g43, g21, g42, g31, g32, g41;
@@ -561,7 +564,7 @@ void DriftDiffusionModel2DSolver<Geometry2DType>::setMatrix(FemMatrix& A, DataVe
         B[lorghtno] -= k21*v1 + k22*v2 + k32*v3 + k42*v4 + ff;
         B[uprghtno] -= k31*v1 + k32*v2 + k33*v3 + k43*v4 + ff;
         B[upleftno] -= k41*v1 + k42*v2 + k43*v3 + k44*v4 + ff;
-    }
+    });
 
     // boundary conditions of the first kind
     A.applyBC(bvoltage, B);
@@ -951,7 +954,6 @@ double DriftDiffusionModel2DSolver<Geometry2DType>::findEnergyLevels() {
 	this->writelog(LOG_INFO, "Finding energy levels..");
 
 	hh2m = 0.5 * phys::hb_eV * phys::hb_J * 1e9 * 1e9 / phys::me; /// hb*hb/(2m), unit: eV*nm*nm, 10^9 is introduced to change m into nm
-	Eshift = 20.; /// bands have to be up-shifted - we want only positive values of energy levels; unit: (eV)
 
 	double kx = 0., ky = 0.; /// TODO
 
@@ -963,126 +965,44 @@ double DriftDiffusionModel2DSolver<Geometry2DType>::findEnergyLevels() {
 
 	if (potentialWell_el)
 	{
-		double dzdz1 = 1. / (dz*dz*1e6); /// 1/(dz*dz), unit: (1/nm^2)
-		double dz1 = 1. / (dz*1e3); /// 1/(dz), unit: (1/nm)
-
-		this->writelog(LOG_DETAIL, "Creating matrix for electrons..\n");
+		this->writelog(LOG_DETAIL, "Creating Hamiltonian for electrons..");
 
-		int K = 1; /// the order of the small matrix for central-node for CB
-		int N = nn * K; /// the order of the matrix for CB
-
-		this->writelog(LOG_DETAIL, "\tsize of the matrix for CB: {0} x {1}", N, N);
-
-		Eigen::MatrixXcd Hc(N, N); /// N - Hc size
-		/// setting Hc = zeros
-		std::complex<double> Hc_zero(0., 0.);
-		for (size_t i=1; i<=N; ++i)
-			for (size_t j=1; j <= N; ++j)
-				Hc(i-1, j-1) = Hc_zero;
+		/// band profiles: materials are taken once per element (nn+1 elements around nn nodes)
+		/// and potentials are interpolated once for all nodes
+		std::vector<double> CBelem(nn+1), invMe(nn+1);
+		for (int e = 0; e <= nn; ++e)
+		{
+			Vec<2, double> point; /// centre of the element
+			point[0] = meshActMid->axis[0]->at(0); // TODO not only for 0
+			point[1] = meshActMid->axis[1]->at(e);
+			shared_ptr<Material> material = this->geometry->getMaterial(point);
+			CBelem[e] = material->CB(T, 0., '*');
+			invMe[e] = 1. / material->Me(T).c00; // TODO or sth else than c00?
+		}
+		auto potentials = getPotentials(meshAct, INTERPOLATION_LINEAR);
 
-		for (size_t i=1; i<=nn; ++i) /// nn - number of nodes
+		std::vector<double> CBel(nn); /// CB in nodes
+		for (int i = 0; i < nn; ++i)
 		{
-			Vec<2, double> point_LE; /// centre of the left element
-            point_LE[0] = meshActMid->axis[0]->at(0); // TODO not only for 0
-            point_LE[1] = meshActMid->axis[1]->at(i-1);
-
-			Vec<2, double> point_RI; /// centre of the right element
-            point_RI[0] = meshActMid->axis[0]->at(0); // TODO not only for 0
-            point_RI[1] = meshActMid->axis[1]->at(i);
-
-			shared_ptr<Material> m_LE = this->geometry->getMaterial(point_LE);
-			shared_ptr<Material> m_RI = this->geometry->getMaterial(point_RI);
-
-			double CBel = 0.5 * (m_LE->CB(T, 0.,'*') + m_RI->CB(T, 0., '*')) - (getPotentials(meshAct, INTERPOLATION_LINEAR)).at(i);
-			this->writelog(LOG_DETAIL, "\tCBel for kp, node: {0}, CBel: {1}", i, CBel);
-
-			//this->writelog(LOG_DETAIL, "creating Hc matrix, central node: {0}, materials: {1} and {2}", i, m_le->name(), m_ri->name());
-
-			std::complex<double> Hc_11_LE(0., 0.), Hc_11_CE(0., 0.), Hc_11_RI(0., 0.); /// left/central/right 1x1 local matrix
-			{
-				double y0_LE = 1. / m_LE->Me(T).c00; // TODO or sth else than c00?
-				double y0_RI = 1. / m_RI->Me(T).c00; // TODO or sth else than c00?
-				double y0_CE = 0.5 * (y0_LE + y0_RI);
-
-				/// 11
-				double beta_11_LE = - y0_LE * hh2m;
-				double beta_11_RI = - y0_RI * hh2m;
-				double alpha_11_CE = y0_CE * hh2m * (kx * kx + ky * ky);
-				double Ec0_11_CE = CBel + Eshift; // TODO CBel[i] must be CB from elem + Psi fo elem and then calc average for node
-				double v_11_CE = Ec0_11_CE;
-				double s_11_CE = 0.;
-				/*if (strain) // TODO
-				{
-					double s_11_LE = 2. * vE[e_LE].ac() * (1. - vE[e_LE].c12() / vE[e_LE].c11()) * vE[e_LE].gEps(); /// [001]
-					double s_11_RI = 2. * vE[e_RI].ac() * (1. - vE[e_RI].c12() / vE[e_RI].c11()) * vE[e_RI].gEps(); /// [001]
-					s_11_CE = 0.5 * (s_11_LE + s_11_RI);
-				}*/
-
-				if (i>1)
-				{
-					Hc_11_LE.real(beta_11_LE * dzdz1); /// Re - real part., Im - imag part.
-					Hc(i - 1, i - 2) = Hc_11_LE;
-					//this->writelog(LOG_DETAIL, "Hc_11_LE: {0}", Hc_11_LE());
-				}
-				{
-					Hc_11_CE.real(alpha_11_CE - beta_11_LE * dzdz1 - beta_11_RI * dzdz1 + v_11_CE + s_11_CE);
-					Hc(i - 1, i - 1) = Hc_11_CE;
-					//this->writelog(LOG_DETAIL, "Hc_11_CE: {0}", Hc_11_CE());
-				}
-				if (i<nn)
-				{
-					Hc_11_RI.real(beta_11_RI * dzdz1);
-					Hc(i - 1, i) = Hc_11_RI;
-					//this->writelog(LOG_DETAIL, "Hc_11_RI: {0}", Hc_11_RI());
-				}
-			}
+			CBel[i] = 0.5 * (CBelem[i] + CBelem[i+1]) - potentials[i+1];
+			this->writelog(LOG_DEBUG, "\tCBel for kp, node: {0}, CBel: {1}", i+1, CBel[i]);
 		}
-		this->writelog(LOG_INFO, "Done.");
 
-		this->writelog(LOG_INFO, "Finding energy levels and wave functions for electrons..");
-		Eigen::ComplexEigenSolver<Eigen::MatrixXcd> ces;
-		ces.compute(Hc);
-		int nEigVal = ces.eigenvalues().rows();
-		this->writelog(LOG_INFO, "number of eigenvalues (Hc): {0}", nEigVal);
-		if (nEigVal<1)
-			return 1; /// no energy levels for electrons
-		this->writelog(LOG_INFO, "Done.");
+		KpSchrodinger1D kp;
+		kp.assemble(CBel, invMe, hh2m, dz*1e3, kx*kx + ky*ky);
+		this->writelog(LOG_DETAIL, "\tsize of the matrix for CB: {0} x {0} (tridiagonal)", kp.size());
 
-		{
-			this->writelog(LOG_INFO, "Analyzing the solutions..");
-			lev_el.clear(); /// lev_el - vector with energy levels for electrons
-			n_lev_el = 0; /// n_lev_el - number of energy levels of electrons
-			for (size_t i = 1; i < nEigVal; ++i)
-			{
-				if ((ces.eigenvalues()[i].real() - Eshift > CBelMin) && (ces.eigenvalues()[i].real() - Eshift < CBelMax))
-				{
-					std::vector<double> sum(K, 0.); /// we have to find out if this level corresponds to el
-					for (size_t j = 1; j < nn*1; j += 1) /// "1" in both cases because only el are considered here
-					{
-						sum[0] += (pow(ces.eigenvectors().col(i)[j].real(), 2.) + pow(ces.eigenvectors().col(i)[j].imag(), 2.));
-					}
-					std::string carrier;
-					if (sum[0])
-					{
-						carrier = "el";
-						lev_el.push_back(ces.eigenvalues()[i].real() - Eshift);
-						n_lev_el++;
-					}
-				}
-			}
-			this->writelog(LOG_INFO, "Done.");
+		this->writelog(LOG_INFO, "Finding energy levels for electrons..");
+		kp.findLevels(CBelMin, CBelMax);
 
-			this->writelog(LOG_INFO, "Sorting electron energy levels..");
-			std::sort(lev_el.begin(), lev_el.end()); /// sorting electron energy levels
-			for (size_t i = 0; i < n_lev_el; ++i)
-			{
-				this->writelog(LOG_INFO, "energy level for electron {0}: {1} eV", i, lev_el[i]);
-			}
-			this->writelog(LOG_INFO, "Done.");
+		lev_el = kp.levels; /// lev_el - vector with energy levels for electrons
+		n_lev_el = int(lev_el.size()); /// n_lev_el - number of energy levels of electrons
+		std::sort(lev_el.begin(), lev_el.end()); /// sorting electron energy levels
+		for (int i = 0; i < n_lev_el; ++i)
+		{
+			this->writelog(LOG_INFO, "energy level for electron {0}: {1} eV", i, lev_el[i]);
 		}
 
-		Hc.resize(0, 0);
-
 		// TODO: hh and lh
 	}
 
@@ -20,10 +20,8 @@
 #include <plask/common/fem.hpp>
 #include <plask/plask.hpp>
 
-PLASK_NO_CONVERSION_WARNING_BEGIN
-#include <Eigen/Eigen>
-PLASK_NO_WARNING_END
 #include "fd.hpp"
+#include "kp.hpp"
 
 namespace plask { namespace electrical { namespace drift_diffusion {
 
@@ -365,7 +363,6 @@ struct PLASK_SOLVER_API DriftDiffusionModel2DSolver : public FemSolverWithMesh<G
     int n_lev_el;                /// number of energy levels of electrons
     double CBelMin, CBelMax;     /// min./max. conduction bands edges for claddings (the same for both claddings); unit: eV
     double T;                    /// temperature; unit: K
-    double Eshift;               /// bands have to be up-shifted - we want only positive values of energy levels; unit: eV
 
   public:
     double maxerr;  ///< Maximum relative current density correction accepted as convergence
@@ -0,0 +1,63 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "kp.hpp"
+
+#define dstebz F77_GLOBAL(dstebz, DSTEBZ)
+F77SUB dstebz(const char& range, const char& order, const int& n, const double& vl, const double& vu, const int& il,
+              const int& iu, const double& abstol, const double* d, const double* e, int& m, int& nsplit, double* w,
+              int* iblock, int* isplit, double* work, int* iwork, int& info);
+
+namespace plask { namespace electrical { namespace drift_diffusion {
+
+void KpSchrodinger1D::assemble(const std::vector<double>& band,
+                               const std::vector<double>& invmass,
+                               double hh2m,
+                               double dz,
+                               double k2) {
+    const size_t n = band.size();
+    if (invmass.size() != n + 1) throw BadInput("k.p", "Inverse mass profile must have one value more than the band profile");
+
+    const double dzdz1 = 1. / (dz * dz);
+
+    diag.resize(n);
+    offdiag.resize(n ? n - 1 : 0);
+    levels.clear();
+
+    for (size_t i = 0; i != n; ++i) {
+        const double yl = invmass[i], yr = invmass[i + 1];
+        diag[i] = hh2m * (yl + yr) * dzdz1 + 0.5 * hh2m * (yl + yr) * k2 + band[i];
+        if (i != n - 1) offdiag[i] = -hh2m * yr * dzdz1;
+    }
+}
+
+size_t KpSchrodinger1D::findLevels(double emin, double emax) {
+    const int n = int(diag.size());
+    levels.clear();
+    if (n == 0 || !(emin < emax)) return 0;
+
+    std::vector<double> w(n), work(4 * n);
+    std::vector<int> iwork(3 * n), iblock(n), isplit(n);
+
+    int m, nsplit, info;
+    dstebz('V', 'B', n, emin, emax, 0, 0, 0., diag.data(), offdiag.data(), m, nsplit, w.data(), iblock.data(), isplit.data(),
+           work.data(), iwork.data(), info);
+    if (info < 0) throw CriticalException("k.p: Argument {0} of dstebz has illegal value", -info);
+    if (info > 0) throw ComputationError("k.p", "Bisection failed to converge for some energy levels");
+
+    w.resize(m);
+    levels = std::move(w);
+    return m;
+}
+
+}}}  // namespace plask::electrical::drift_diffusion
@@ -0,0 +1,60 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__SOLVER_DRIFT_DIFFUSION_KP_H
+#define PLASK__SOLVER_DRIFT_DIFFUSION_KP_H
+
+#include <plask/plask.hpp>
+
+namespace plask { namespace electrical { namespace drift_diffusion {
+
+/**
+ * One-band k·p Schrödinger equation on a uniform one-dimensional mesh.
+ *
+ * The finite-difference Hamiltonian is real, symmetric and tridiagonal, so only its diagonal and
+ * off-diagonal are stored. Energy levels are found by bisection with Sturm sequence counts (LAPACK
+ * \c dstebz) restricted to the requested energy window, which takes O(N) operations per level.
+ */
+class PLASK_SOLVER_API KpSchrodinger1D {
+    std::vector<double> diag;     ///< Hamiltonian diagonal [eV]
+    std::vector<double> offdiag;  ///< Hamiltonian off-diagonal [eV]
+
+  public:
+    /// Found energy levels [eV], ascending within each split-off block of the Hamiltonian
+    std::vector<double> levels;
+
+    /**
+     * Assemble the Hamiltonian from precomputed band profiles.
+     * Node \a i lies between elements \a i and \a i+1, so \a invmass must have one value more than \a band.
+     * \param band band edge in mesh nodes [eV]
+     * \param invmass inverse effective mass in mesh elements [1/m₀]
+     * \param hh2m ħ²/2m₀ [eV·nm²]
+     * \param dz mesh step [nm]
+     * \param k2 squared in-plane wavevector [1/nm²]
+     */
+    void assemble(const std::vector<double>& band, const std::vector<double>& invmass, double hh2m, double dz, double k2 = 0.);
+
+    /// Get size of the Hamiltonian
+    size_t size() const { return diag.size(); }
+
+    /**
+     * Find energy levels in the window (\a emin, \a emax]
+     * \param emin,emax energy window [eV]
+     * \return number of found levels
+     */
+    size_t findLevels(double emin, double emax);
+};
+
+}}}  // namespace plask::electrical::drift_diffusion
+
+#endif  // PLASK__SOLVER_DRIFT_DIFFUSION_KP_H
@@ -31,9 +31,9 @@ inline static void register_drift_diffusion_solver(const char* name, const char*
         u8"Finite element drift-diffusion electrical solver for 2D {1} geometry."
 
         , name, geoname).c_str(), py::init<std::string>(py::arg("name")=""));
-    METHOD(compute, compute, u8"Run drift-diffusion calculations", py::arg("loops")=0);
+    METHOD_RELEASING_GIL(compute, compute, u8"Run drift-diffusion calculations", py::arg("loops")=0);
     METHOD(get_total_current, getTotalCurrent, u8"Get total current flowing through active region (mA)", py::arg("nact")=0);
-    METHOD(find_energy_levels, findEnergyLevels, u8"Run energy levels calculations - TEST");
+    METHOD_RELEASING_GIL(find_energy_levels, findEnergyLevels, u8"Run energy levels calculations - TEST");
     //METHOD(integrate_current, integrateCurrent, u8"Integrate vertical total current at certain level (mA)", py::arg("vindex"), py::arg("onlyactive")=false);
     /*RO_PROPERTY(err, getErr, u8"Maximum estimated error");*/
     RECEIVER(inTemperature, u8"");
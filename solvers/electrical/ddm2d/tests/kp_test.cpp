@@ -0,0 +1,106 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "k.p test"
+#include <boost/test/unit_test.hpp>
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
+#include "../kp.hpp"
+
+using namespace plask;
+using namespace plask::electrical::drift_diffusion;
+
+// Infinite square well of the width L: nodes inside the well, walls just outside the first and the last node
+struct SquareWellFixture {
+    const double L = 10.;    // well width [nm]
+    const double dz = 0.1;   // mesh step [nm]
+    const double V = 0.2;    // band edge in the well [eV]
+    const double mass = 0.067;  // effective mass [m₀]
+
+    const double hh2m = 0.5 * phys::hb_eV * phys::hb_J * 1e9 * 1e9 / phys::me;
+    const size_t n = size_t(std::round(L / dz)) - 1;
+
+    KpSchrodinger1D kp;
+
+    SquareWellFixture() {}
+
+    void assemble(double k2 = 0.) {
+        kp.assemble(std::vector<double>(n, V), std::vector<double>(n + 1, 1. / mass), hh2m, dz, k2);
+    }
+
+    // Analytic level of the well
+    double analytic(size_t level, double k2 = 0.) const {
+        double kz = double(level) * PI / L;
+        return V + hh2m / mass * (kz * kz + k2);
+    }
+
+    // Exact eigenvalue of the three-point discretization
+    double discrete(size_t level, double k2 = 0.) const {
+        return V + hh2m / mass * (2. / (dz * dz) * (1. - std::cos(double(level) * PI / double(n + 1))) + k2);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(kp)
+
+BOOST_FIXTURE_TEST_CASE(square_well, SquareWellFixture) {
+    assemble();
+    BOOST_CHECK_EQUAL(kp.size(), n);
+
+    size_t found = kp.findLevels(V, V + 1.);
+    BOOST_REQUIRE_GT(found, 3);
+    std::vector<double> levels = kp.levels;
+    std::sort(levels.begin(), levels.end());
+    for (size_t i = 0; i != found; ++i) BOOST_CHECK_CLOSE(levels[i], discrete(i + 1), 1e-8);
+    BOOST_CHECK_LE(discrete(found), V + 1.);
+    BOOST_CHECK_GT(discrete(found + 1), V + 1.);
+    for (size_t i = 0; i != 3; ++i) BOOST_CHECK_CLOSE(levels[i], analytic(i + 1), 0.5);
+}
+
+BOOST_FIXTURE_TEST_CASE(energy_window, SquareWellFixture) {
+    assemble();
+    // Window (E₂, E₄] contains the third and the fourth level only
+    double e2 = analytic(2), e4 = discrete(4);
+    BOOST_REQUIRE_EQUAL(kp.findLevels(0.5 * (discrete(2) + e2), e4 + 1e-9), 2);
+    std::vector<double> levels = kp.levels;
+    std::sort(levels.begin(), levels.end());
+    BOOST_CHECK_CLOSE(levels[0], discrete(3), 1e-8);
+    BOOST_CHECK_CLOSE(levels[1], discrete(4), 1e-8);
+
+    BOOST_CHECK_EQUAL(kp.findLevels(0., V), 0);
+    BOOST_CHECK(kp.levels.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(in_plane_wavevector, SquareWellFixture) {
+    const double k2 = 0.01;
+    assemble(k2);
+    BOOST_REQUIRE_GT(kp.findLevels(V, V + 0.5), 1);
+    std::vector<double> levels = kp.levels;
+    std::sort(levels.begin(), levels.end());
+    BOOST_CHECK_CLOSE(levels[0], discrete(1, k2), 1e-8);
+    BOOST_CHECK_CLOSE(levels[1], discrete(2, k2), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(wrong_mass_profile) {
+    KpSchrodinger1D kp;
+    BOOST_CHECK_THROW(kp.assemble(std::vector<double>(10, 0.), std::vector<double>(10, 1.), 0.0381, 0.1), BadInput);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
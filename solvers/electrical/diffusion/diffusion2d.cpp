@@ -392,6 +392,7 @@ template <typename Geometry2DType> double Diffusion2DSolver<Geometry2DType>::com
         case ALGORITHM_CHOLESKY: K.reset(new DpbMatrix(this, N, 3)); break;
         case ALGORITHM_GAUSS: K.reset(new DgbMatrix(this, N, 3)); break;
         case ALGORITHM_ITERATIVE: K.reset(new SparseBandMatrix(this, N, {0, 1, 2, 3})); break;
+        case ALGORITHM_SPARSE: K.reset(new CsrMatrix(this, N, CsrPattern::band(N, 3))); break;
     }
 
     while (true) {
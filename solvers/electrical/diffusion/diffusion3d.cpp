@@ -290,6 +290,17 @@ double Diffusion3DSolver::compute(unsigned loops, bool shb, size_t act) {
         case ALGORITHM_CHOLESKY: K.reset(new DpbMatrix(this, N, 3 * nm + 5)); break;
         case ALGORITHM_GAUSS: K.reset(new DgbMatrix(this, N, 3 * nm + 5)); break;
         case ALGORITHM_ITERATIVE: K.reset(new SparseFreeMatrix(this, N, 78 * ne)); break;
+        case ALGORITHM_SPARSE:
+            K.reset(new CsrMatrix(this, N,
+                                  CsrPattern(N, active.mesh2->lateralMesh->elements(),
+                                             [](const RectangularMaskedMesh2D::Element& element, size_t* idx) -> size_t {
+                                                 const ElementParams3D e(element);
+                                                 const size_t nodes[4] = {e.n00, e.n01, e.n10, e.n11};
+                                                 for (size_t i = 0; i < 4; ++i)
+                                                     for (size_t k = 0; k < 3; ++k) idx[3 * i + k] = 3 * nodes[i] + k;
+                                                 return 12;
+                                             })));
+            break;
     }
 
     while (true) {
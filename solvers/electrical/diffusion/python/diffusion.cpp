@@ -14,10 +14,12 @@ using namespace plask::electrical::diffusion;
 template <typename SolverT>
 static double DiffusionSolver_compute(SolverT* solver, unsigned loops, bool shb, const py::object& pact) {
     if (pact.is_none()) {
+        ReleaseGIL nogil;
         return solver->compute(loops, shb);
     } else {
         int act = py::extract<int>(pact);
         if (act < 0) act = solver->activeRegionsCount() + act;
+        ReleaseGIL nogil;
         return solver->compute(loops, shb, act);
     }
 }
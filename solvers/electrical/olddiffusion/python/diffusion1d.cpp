@@ -37,9 +37,9 @@ BOOST_PYTHON_MODULE(olddiffusion)
 {
     {CLASS(DiffusionFem2DSolver<Geometry2DCylindrical>, "OldDiffusionCyl", u8"Calculates carrier pairs concentration in active region using FEM in one-dimensional cylindrical space")
 
-        METHOD(compute_initial, compute_initial, u8"Perform the initial computation");
-        METHOD(compute_threshold, compute_threshold, u8"Perform the threshold computation");
-        METHOD(compute_overthreshold, compute_overthreshold, u8"Perform the overthreshold computation");
+        METHOD_RELEASING_GIL(compute_initial, compute_initial, u8"Perform the initial computation");
+        METHOD_RELEASING_GIL(compute_threshold, compute_threshold, u8"Perform the threshold computation");
+        METHOD_RELEASING_GIL(compute_overthreshold, compute_overthreshold, u8"Perform the overthreshold computation");
         solver.def_readwrite("initial", &__Class__::do_initial, u8"True if we start from initial computations");
         solver.def_readwrite("fem_method", &__Class__::fem_method, u8"Finite-element method (linear of parabolic)");
         solver.add_property("current_mesh", DiffusionSolver_current_mesh<Geometry2DCylindrical>, u8"Horizontal adaptive mesh)");
@@ -78,9 +78,9 @@ BOOST_PYTHON_MODULE(olddiffusion)
      }
      {CLASS(DiffusionFem2DSolver<Geometry2DCartesian>, "OldDiffusion2D", u8"Calculates carrier pairs concentration in active region using FEM in one-dimensional cartesian space")
 
-        METHOD(compute_initial, compute_initial, u8"Perform the initial computation");
-        METHOD(compute_threshold, compute_threshold, u8"Perform the threshold computation");
-        METHOD(compute_overthreshold, compute_overthreshold, u8"Perform the overthreshold computation");
+        METHOD_RELEASING_GIL(compute_initial, compute_initial, u8"Perform the initial computation");
+        METHOD_RELEASING_GIL(compute_threshold, compute_threshold, u8"Perform the threshold computation");
+        METHOD_RELEASING_GIL(compute_overthreshold, compute_overthreshold, u8"Perform the overthreshold computation");
         solver.def_readwrite("initial", &__Class__::do_initial, u8"True if we start from initial computations");
         solver.def_readwrite("fem_method", &__Class__::fem_method, u8"Finite-element method (linear of parabolic)");
         solver.add_property("current_mesh", DiffusionSolver_current_mesh<Geometry2DCartesian>, u8"Horizontal adaptive mesh)");
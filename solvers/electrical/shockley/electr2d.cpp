@@ -11,6 +11,8 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU General Public License for more details.
  */
+#include <plask/checkpoint.hpp>
+
 #include "electr2d.hpp"
 
 namespace plask { namespace electrical { namespace shockley {
@@ -331,6 +333,7 @@ void ElectricalFem2DSolver<Geometry2DType>::setMatrix(
 template <typename Geometry2DType> LazyData<double> ElectricalFem2DSolver<Geometry2DType>::loadConductivities() {
     auto midmesh = this->maskedMesh->getElementMesh();
     auto temperature = inTemperature(midmesh);
+    auto materials = this->geometry->getMaterialRaster(midmesh);
 
     for (auto e : this->maskedMesh->elements()) {
         size_t i = e.getIndex();
@@ -346,7 +349,7 @@ template <typename Geometry2DType> LazyData<double> ElectricalFem2DSolver<Geomet
         } else if (roles.find("n-contact") != roles.end()) {
             conds[i] = Tensor2<double>(ncond, ncond);
         } else
-            conds[i] = this->geometry->getMaterial(midpoint)->cond(temperature[i]);
+            conds[i] = (*materials)[i]->cond(temperature[i]);
     }
 
     return temperature;
@@ -372,8 +375,7 @@ template <typename Geometry2DType> double ElectricalFem2DSolver<Geometry2DType>:
 
     unsigned loop = 0;
 
-    std::unique_ptr<FemMatrix> pA(this->getMatrix());
-    FemMatrix& A = *pA.get();
+    FemMatrix& A = this->getReusableMatrix();
 
     double err = 0.;
     toterr = 0.;
@@ -430,6 +432,8 @@ template <typename Geometry2DType> double ElectricalFem2DSolver<Geometry2DType>:
 
     } while ((!this->iter_params.converged || err > maxerr) && (loops == 0 || loop < loops));
 
+    this->releaseMatrix();
+
     saveConductivities();
 
     outVoltage.fireChanged();
@@ -439,10 +443,48 @@ template <typename Geometry2DType> double ElectricalFem2DSolver<Geometry2DType>:
     return toterr;
 }
 
+template <typename Geometry2DType> void ElectricalFem2DSolver<Geometry2DType>::saveCheckpoint(const std::string& filename) const {
+    if (!potentials) throw NoValue(Voltage::NAME);
+    this->writelog(LOG_INFO, "Saving checkpoint to '{}'", filename);
+    CheckpointWriter checkpoint(filename);
+    checkpoint.writeMesh("mesh", *this->mesh);
+    checkpoint.write("potentials", potentials);
+    checkpoint.write("currents", currents);
+    checkpoint.write("junction_conductivity", junction_conductivity);
+    checkpoint.writeValue("loopno", std::int64_t(loopno));
+    checkpoint.writeValue("toterr", toterr);
+    checkpoint.close();
+}
+
+template <typename Geometry2DType> void ElectricalFem2DSolver<Geometry2DType>::loadCheckpoint(const std::string& filename) {
+    this->writelog(LOG_INFO, "Loading checkpoint from '{}'", filename);
+    CheckpointReader checkpoint(filename);
+    this->initCalculation();
+    if (*checkpoint.readMesh<2>("mesh") != *this->mesh)
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different mesh", filename);
+    DataVector<double> pots = checkpoint.read<double>("potentials");
+    DataVector<Vec<2, double>> curs = checkpoint.read<Vec<2, double>>("currents");
+    DataVector<Tensor2<double>> junc = checkpoint.read<Tensor2<double>>("junction_conductivity");
+    if (pots.size() != this->maskedMesh->size() || curs.size() != this->maskedMesh->getElementsCount() ||
+        junc.size() != junction_conductivity.size())
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different geometry", filename);
+    potentials = pots;
+    currents = curs;
+    junction_conductivity = junc;
+    loopno = int(checkpoint.readValue<std::int64_t>("loopno"));
+    toterr = checkpoint.readValue<double>("toterr");
+    loadConductivities();
+    heats.reset();
+    outVoltage.fireChanged();
+    outCurrentDensity.fireChanged();
+    outHeat.fireChanged();
+}
+
 template <typename Geometry2DType> void ElectricalFem2DSolver<Geometry2DType>::saveHeatDensities() {
     this->writelog(LOG_DETAIL, "Computing heat densities");
 
     heats.reset(this->maskedMesh->getElementsCount());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
 
     for (auto e : this->maskedMesh->elements()) {
         size_t i = e.getIndex();
@@ -451,7 +493,7 @@ template <typename Geometry2DType> void ElectricalFem2DSolver<Geometry2DType>::s
         size_t upleftno = e.getLoUpIndex();
         size_t uprghtno = e.getUpUpIndex();
         auto midpoint = e.getMidpoint();
-        if (this->geometry->getMaterial(midpoint)->kind() == Material::EMPTY || this->geometry->hasRoleAt("noheat", midpoint))
+        if ((*materials)[i]->kind() == Material::EMPTY || this->geometry->hasRoleAt("noheat", midpoint))
             heats[i] = 0.;
         else {
             double dvx = 0.5e6 * (-potentials[loleftno] + potentials[lorghtno] - potentials[upleftno] + potentials[uprghtno]) /
@@ -574,6 +616,7 @@ const LazyData<Tensor2<double>> ElectricalFem2DSolver<Geometry2DType>::getConduc
 template <> double ElectricalFem2DSolver<Geometry2DCartesian>::getTotalEnergy() {
     double W = 0.;
     auto T = inTemperature(this->maskedMesh->getElementMesh());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
     for (auto e : this->maskedMesh->elements()) {
         size_t ll = e.getLoLoIndex();
         size_t lu = e.getUpLoIndex();
@@ -583,7 +626,7 @@ template <> double ElectricalFem2DSolver<Geometry2DCartesian>::getTotalEnergy()
                      (e.getUpper0() - e.getLower0());  // [grad(dV)] = V/m
         double dvy = 0.5e6 * (-potentials[ll] - potentials[lu] + potentials[ul] + potentials[uu]) /
                      (e.getUpper1() - e.getLower1());  // [grad(dV)] = V/m
-        double w = this->geometry->getMaterial(e.getMidpoint())->eps(T[e.getIndex()]) * (dvx * dvx + dvy * dvy);
+        double w = (*materials)[e.getIndex()]->eps(T[e.getIndex()]) * (dvx * dvx + dvy * dvy);
         double width = e.getUpper0() - e.getLower0();
         double height = e.getUpper1() - e.getLower1();
         W += width * height * w;
@@ -595,6 +638,7 @@ template <> double ElectricalFem2DSolver<Geometry2DCartesian>::getTotalEnergy()
 template <> double ElectricalFem2DSolver<Geometry2DCylindrical>::getTotalEnergy() {
     double W = 0.;
     auto T = inTemperature(this->maskedMesh->getElementMesh());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
     for (auto e : this->maskedMesh->elements()) {
         size_t ll = e.getLoLoIndex();
         size_t lu = e.getUpLoIndex();
@@ -605,7 +649,7 @@ template <> double ElectricalFem2DSolver<Geometry2DCylindrical>::getTotalEnergy(
                      (e.getUpper0() - e.getLower0());  // [grad(dV)] = V/m
         double dvy = 0.5e6 * (-potentials[ll] - potentials[lu] + potentials[ul] + potentials[uu]) /
                      (e.getUpper1() - e.getLower1());  // [grad(dV)] = V/m
-        double w = this->geometry->getMaterial(midpoint)->eps(T[e.getIndex()]) * (dvx * dvx + dvy * dvy);
+        double w = (*materials)[e.getIndex()]->eps(T[e.getIndex()]) * (dvx * dvx + dvy * dvy);
         double width = e.getUpper0() - e.getLower0();
         double height = e.getUpper1() - e.getLower1();
         W += width * height * midpoint.rad_r() * w;
@@ -182,6 +182,19 @@ struct PLASK_SOLVER_API ElectricalFem2DSolver : public FemSolverWithMaskedMesh<G
      **/
     double compute(unsigned loops = 1);
 
+    /**
+     * Save computed potentials, current densities and junction conductivities to the checkpoint file
+     * \param filename name of the checkpoint file
+     */
+    void saveCheckpoint(const std::string& filename) const;
+
+    /**
+     * Restore computed potentials, current densities and junction conductivities from the checkpoint file.
+     * The data are mapped from the file directly, so the calculations can be quickly resumed.
+     * \param filename name of the checkpoint file
+     */
+    void loadCheckpoint(const std::string& filename);
+
     /**
      * Integrate vertical total current at certain level.
      * \param vindex vertical index of the element mesh to perform integration at
@@ -249,6 +262,7 @@ struct PLASK_SOLVER_API ElectricalFem2DSolver : public FemSolverWithMaskedMesh<G
     /// Set junction effective conductivity to previously read data
     void setCondJunc(const DataVector<Tensor2<double>>& cond) {
         size_t condsize = 0;
+        for (const auto& act : active) condsize += act.right - act.left;
         condsize = max(condsize, size_t(1));
         if (!this->mesh || cond.size() != condsize)
             throw BadInput(this->getId(), "Provided junction conductivity vector has wrong size");
@@ -12,6 +12,7 @@
  * GNU General Public License for more details.
  */
 #include <type_traits>
+#include <plask/checkpoint.hpp>
 
 #include "electr3d.hpp"
 
@@ -203,6 +204,7 @@ void ElectricalFem3DSolver::onInvalidate() {
 LazyData<double> ElectricalFem3DSolver::loadConductivity() {
     auto midmesh = (this->maskedMesh)->getElementMesh();
     auto temperature = inTemperature(midmesh);
+    auto materials = this->geometry->getMaterialRaster(midmesh);
 
     for (auto e : this->maskedMesh->elements()) {
         size_t i = e.getIndex();
@@ -218,7 +220,7 @@ LazyData<double> ElectricalFem3DSolver::loadConductivity() {
         } else if (roles.find("n-contact") != roles.end()) {
             conds[i] = Tensor2<double>(ncond, ncond);
         } else
-            conds[i] = this->geometry->getMaterial(midpoint)->cond(temperature[i]);
+            conds[i] = (*materials)[i]->cond(temperature[i]);
     }
 
     return temperature;
@@ -278,7 +280,7 @@ void ElectricalFem3DSolver::setMatrix(FemMatrix& A,
     B.fill(0.);
 
     // Set stiffness matrix and load vector
-    for (auto elem : maskedMesh->elements()) {
+    assembleElements(*maskedMesh, A, elementColoring, [&](const RectangularMaskedMesh3D::Element& elem) {
         size_t index = elem.getIndex();
 
         // nodes numbers for the current element
@@ -297,10 +299,6 @@ void ElectricalFem3DSolver::setMatrix(FemMatrix& A,
         double dy = elem.getUpper1() - elem.getLower1();
         double dz = elem.getUpper2() - elem.getLower2();
 
-        // point and material in the middle of the element
-        Vec<3> middle = elem.getMidpoint();
-        auto material = geometry->getMaterial(middle);
-
         // average voltage on the element
         double temp = 0.;
         for (int i = 0; i < 8; ++i) temp += potential[idx[i]];
@@ -339,7 +337,7 @@ void ElectricalFem3DSolver::setMatrix(FemMatrix& A,
 
         for (int i = 0; i < 8; ++i)
             for (int j = 0; j <= i; ++j) A(idx[i], idx[j]) += K[i][j];
-    }
+    });
 
     A.applyBC(bvoltage, B);
 
@@ -365,8 +363,7 @@ double ElectricalFem3DSolver::compute(unsigned loops) {
     double err = 0.;
     toterr = 0.;
 
-    std::unique_ptr<FemMatrix> pA(this->getMatrix());
-    FemMatrix& A = *pA.get();
+    FemMatrix& A = this->getReusableMatrix();
 
 #ifndef NDEBUG
     if (!potential.unique()) this->writelog(LOG_DEBUG, "Potentials data held by something else...");
@@ -432,6 +429,8 @@ double ElectricalFem3DSolver::compute(unsigned loops) {
 
     } while ((!iter_params.converged || err > maxerr) && (loops == 0 || loop < loops));
 
+    this->releaseMatrix();
+
     saveConductivity();
 
     outVoltage.fireChanged();
@@ -441,10 +440,48 @@ double ElectricalFem3DSolver::compute(unsigned loops) {
     return toterr;
 }
 
+void ElectricalFem3DSolver::saveCheckpoint(const std::string& filename) const {
+    if (!potential) throw NoValue(Voltage::NAME);
+    this->writelog(LOG_INFO, "Saving checkpoint to '{}'", filename);
+    CheckpointWriter checkpoint(filename);
+    checkpoint.writeMesh("mesh", *this->mesh);
+    checkpoint.write("potentials", potential);
+    checkpoint.write("currents", current);
+    checkpoint.write("junction_conductivity", junction_conductivity);
+    checkpoint.writeValue("loopno", std::int64_t(loopno));
+    checkpoint.writeValue("toterr", toterr);
+    checkpoint.close();
+}
+
+void ElectricalFem3DSolver::loadCheckpoint(const std::string& filename) {
+    this->writelog(LOG_INFO, "Loading checkpoint from '{}'", filename);
+    CheckpointReader checkpoint(filename);
+    this->initCalculation();
+    if (*checkpoint.readMesh<3>("mesh") != *this->mesh)
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different mesh", filename);
+    DataVector<double> pots = checkpoint.read<double>("potentials");
+    DataVector<Vec<3, double>> curs = checkpoint.read<Vec<3, double>>("currents");
+    DataVector<Tensor2<double>> junc = checkpoint.read<Tensor2<double>>("junction_conductivity");
+    if (pots.size() != this->maskedMesh->size() || curs.size() != this->maskedMesh->getElementsCount() ||
+        junc.size() != junction_conductivity.size())
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different geometry", filename);
+    potential = pots;
+    current = curs;
+    junction_conductivity = junc;
+    loopno = int(checkpoint.readValue<std::int64_t>("loopno"));
+    toterr = checkpoint.readValue<double>("toterr");
+    loadConductivity();
+    heat.reset();
+    outVoltage.fireChanged();
+    outCurrentDensity.fireChanged();
+    outHeat.fireChanged();
+}
+
 void ElectricalFem3DSolver::saveHeatDensity() {
     this->writelog(LOG_DETAIL, "Computing heat densities");
 
     heat.reset(maskedMesh->getElementsCount());
+    auto materials = geometry->getMaterialRaster(maskedMesh->getElementMesh());
 
     for (auto el : maskedMesh->elements()) {
         size_t i = el.getIndex();
@@ -469,7 +506,7 @@ void ElectricalFem3DSolver::saveHeatDensity() {
                       potential[uul] + potential[uuu]) /
                      (el.getUpper2() - el.getLower2());  // 1e6 - from µm to m
         auto midpoint = el.getMidpoint();
-        if (geometry->getMaterial(midpoint)->kind() == Material::EMPTY || geometry->hasRoleAt("noheat", midpoint))
+        if ((*materials)[i]->kind() == Material::EMPTY || geometry->hasRoleAt("noheat", midpoint))
             heat[i] = 0.;
         else {
             heat[i] = conds[i].c00 * dvx * dvx + conds[i].c00 * dvy * dvy + conds[i].c11 * dvz * dvz;
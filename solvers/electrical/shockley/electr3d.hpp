@@ -210,6 +210,19 @@ struct PLASK_SOLVER_API ElectricalFem3DSolver : public FemSolverWithMaskedMesh<G
      **/
     double compute(unsigned loops = 1);
 
+    /**
+     * Save computed potentials, current densities and junction conductivities to the checkpoint file
+     * \param filename name of the checkpoint file
+     */
+    void saveCheckpoint(const std::string& filename) const;
+
+    /**
+     * Restore computed potentials, current densities and junction conductivities from the checkpoint file.
+     * The data are mapped from the file directly, so the calculations can be quickly resumed.
+     * \param filename name of the checkpoint file
+     */
+    void loadCheckpoint(const std::string& filename);
+
     /**
      * Integrate vertical total current at certain level.
      * \param vindex vertical index of the element mesh to perform integration at
@@ -101,10 +101,18 @@ template <typename GeometryT> struct Shockley : BetaSolver<GeometryT> {
     }
 
     Tensor2<double> activeCond(size_t n, double U, double jy, double T) override {
-        double beta = (n < beta_function.size() && !beta_function[n].is_none()) ? py::extract<double>(beta_function[n](T))
-                                                                                : BetaSolver<GeometryT>::getBeta(n);
-        double js = (n < js_function.size() && !js_function[n].is_none()) ? py::extract<double>(js_function[n](T))
-                                                                          : BetaSolver<GeometryT>::getJs(n);
+        double beta, js;
+        const bool beta_callable = n < beta_function.size() && !beta_function[n].is_none(),
+                   js_callable = n < js_function.size() && !js_function[n].is_none();
+        if (beta_callable || js_callable) {
+            // compute() runs without the GIL, so it must be taken back before calling Python functions
+            OmpLockGuard<OmpNestLock> lock(python_omp_lock);
+            beta = beta_callable ? py::extract<double>(beta_function[n](T)) : BetaSolver<GeometryT>::getBeta(n);
+            js = js_callable ? py::extract<double>(js_function[n](T)) : BetaSolver<GeometryT>::getJs(n);
+        } else {
+            beta = BetaSolver<GeometryT>::getBeta(n);
+            js = BetaSolver<GeometryT>::getJs(n);
+        }
         jy = abs(jy);
         return Tensor2<double>(0., 10. * jy * beta * this->active[n].height / log(1e7 * jy / js + 1.));
     }
@@ -171,6 +179,7 @@ struct PythonCondSolver : public std::conditional<std::is_same<GeometryT, Geomet
     Tensor2<double> activeCond(size_t n, double U, double jy, double T) override {
         if (n >= this->active.size() || n >= cond_function.size() || cond_function[n].is_none())
             throw IndexError("no conductivity for active region {}", n);
+        OmpLockGuard<OmpNestLock> lock(python_omp_lock);
         py::object cond = cond_function[n](U, jy, T);
         py::extract<double> double_cond(cond);
         if (double_cond.check()) return Tensor2<double>(0., double_cond());
@@ -200,8 +209,20 @@ inline static ExportSolver<__Class__> register_electrical_solver(const char* nam
                                           name, geoname)
                                        .c_str(),
                                    py::init<std::string>(py::arg("name") = ""));
-    METHOD(compute, compute, u8"Run electrical calculations", py::arg("loops") = 0);
+    METHOD_RELEASING_GIL(compute, compute, u8"Run electrical calculations", py::arg("loops") = 0);
     METHOD(get_total_current, getTotalCurrent, u8"Get total current flowing through active region (mA)", py::arg("nact") = 0);
+    METHOD(save_checkpoint, saveCheckpoint,
+           u8"Save computed potentials, current densities and junction conductivities to the checkpoint file.\n\n"
+           u8"Args:\n"
+           u8"    filename (str): Name of the checkpoint file.\n",
+           py::arg("filename"));
+    METHOD(load_checkpoint, loadCheckpoint,
+           u8"Restore computed potentials, current densities and junction conductivities from the checkpoint file.\n\n"
+           u8"The solver must have the same geometry and mesh as the one used to save the checkpoint.\n"
+           u8"The data is memory-mapped from the file, so resuming the calculations is instant.\n\n"
+           u8"Args:\n"
+           u8"    filename (str): Name of the checkpoint file.\n",
+           py::arg("filename"));
     RO_PROPERTY(err, getErr, u8"Maximum estimated error");
     RECEIVER(inTemperature, u8"");
     PROVIDER(outVoltage, u8"");
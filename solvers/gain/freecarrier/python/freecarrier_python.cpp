@@ -141,14 +141,18 @@ static py::object FreeCarrierGainSpectrum__call__(typename SolverT::GainSpectrum
 
         std::exception_ptr error;
 
+        {
+            // Release the GIL, so the worker threads can acquire it for Python materials and providers
+            ReleaseGIL nogil;
 #pragma omp parallel for
-        for (npy_intp i = 0; i < size; ++i) {
-            if (!error) try {
-                    outdata[i] = self.getGain(indata[i * instride]);
-                } catch (...) {
+            for (npy_intp i = 0; i < size; ++i) {
+                if (!error) try {
+                        outdata[i] = self.getGain(indata[i * instride]);
+                    } catch (...) {
 #pragma omp critical
-                    error = std::current_exception();
-                }
+                        error = std::current_exception();
+                    }
+            }
         }
         if (error) {
             Py_XDECREF(inarr);
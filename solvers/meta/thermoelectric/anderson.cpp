@@ -0,0 +1,127 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "anderson.hpp"
+
+namespace plask { namespace meta { namespace thermoelectric {
+
+namespace {
+
+    /// Relative Tikhonov regularization of the normal equations, which keeps nearly dependent history solvable
+    constexpr double REGULARIZATION = 1e-12;
+
+    inline double dot(const DataVector<double>& a, const DataVector<const double>& b) {
+        double result = 0.;
+        for (std::size_t i = 0; i != a.size(); ++i) result += a[i] * b[i];
+        return result;
+    }
+
+    /**
+     * Solve symmetric positive definite system in place using Cholesky decomposition
+     * \param[in,out] A matrix (row-major), overwritten with its decomposition
+     * \param[in,out] b right-hand side, overwritten with the solution
+     * \param m size of the system
+     * \return \c false if the matrix is not positive definite
+     */
+    bool choleskySolve(std::vector<double>& A, std::vector<double>& b, std::size_t m) {
+        for (std::size_t j = 0; j != m; ++j) {
+            double d = A[j*m+j];
+            for (std::size_t k = 0; k != j; ++k) d -= A[j*m+k] * A[j*m+k];
+            if (!(d > 0.)) return false;
+            d = std::sqrt(d);
+            A[j*m+j] = d;
+            for (std::size_t i = j+1; i != m; ++i) {
+                double s = A[i*m+j];
+                for (std::size_t k = 0; k != j; ++k) s -= A[i*m+k] * A[j*m+k];
+                A[i*m+j] = s / d;
+            }
+        }
+        for (std::size_t i = 0; i != m; ++i) {
+            for (std::size_t k = 0; k != i; ++k) b[i] -= A[i*m+k] * b[k];
+            b[i] /= A[i*m+i];
+        }
+        for (std::size_t i = m; i-- != 0;) {
+            for (std::size_t k = i+1; k != m; ++k) b[i] -= A[k*m+i] * b[k];
+            b[i] /= A[i*m+i];
+        }
+        return true;
+    }
+}
+
+void AndersonMixer::reset() {
+    dx.clear();
+    df.clear();
+    last_x.reset();
+    last_f.reset();
+}
+
+DataVector<double> AndersonMixer::operator()(const DataVector<const double>& x, const DataVector<const double>& g) {
+    assert(x.size() == g.size());
+    const std::size_t n = x.size();
+
+    if (last_x && last_x.size() != n) reset();
+
+    DataVector<double> f(n);
+    for (std::size_t i = 0; i != n; ++i) f[i] = g[i] - x[i];
+
+    if (depth != 0 && last_x) {
+        DataVector<double> dxi(n), dfi(n);
+        for (std::size_t i = 0; i != n; ++i) {
+            dxi[i] = x[i] - last_x[i];
+            dfi[i] = f[i] - last_f[i];
+        }
+        dx.push_back(std::move(dxi));
+        df.push_back(std::move(dfi));
+    }
+    while (dx.size() > depth) {
+        dx.pop_front();
+        df.pop_front();
+    }
+    last_x = x.copy();
+    last_f = f;
+
+    DataVector<double> result(n);
+    for (std::size_t i = 0; i != n; ++i) result[i] = x[i] + mixing * f[i];
+
+    // Find coefficients minimizing |f - dF γ| from the normal equations. If they cannot be solved, the oldest
+    // history entries are dropped until they can.
+    std::vector<double> gamma;
+    while (!dx.empty()) {
+        const std::size_t m = dx.size();
+        std::vector<double> A(m*m);
+        gamma.resize(m);
+        double trace = 0.;
+        for (std::size_t j = 0; j != m; ++j) {
+            for (std::size_t k = 0; k <= j; ++k) A[j*m+k] = A[k*m+j] = dot(df[j], df[k]);
+            gamma[j] = dot(df[j], f);
+            trace += A[j*m+j];
+        }
+        if (trace == 0.) { gamma.clear(); break; }
+        for (std::size_t j = 0; j != m; ++j) A[j*m+j] += REGULARIZATION * trace;
+        if (choleskySolve(A, gamma, m)) break;
+        dx.pop_front();
+        df.pop_front();
+        gamma.clear();
+    }
+
+    for (std::size_t j = 0; j != gamma.size(); ++j) {
+        const DataVector<double>& dxj = dx[j];
+        const DataVector<double>& dfj = df[j];
+        const double gj = gamma[j];
+        for (std::size_t i = 0; i != n; ++i) result[i] -= gj * (dxj[i] + mixing * dfj[i]);
+    }
+
+    return result;
+}
+
+}}} // namespace plask::meta::thermoelectric
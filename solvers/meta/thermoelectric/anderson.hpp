@@ -0,0 +1,62 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__SOLVER__META_THERMOELECTRIC_ANDERSON_H
+#define PLASK__SOLVER__META_THERMOELECTRIC_ANDERSON_H
+
+#include <deque>
+
+#include <plask/plask.hpp>
+
+namespace plask { namespace meta { namespace thermoelectric {
+
+/**
+ * Anderson (DIIS) acceleration of the fixed-point iteration \f$ x = G(x) \f$.
+ *
+ * The mixer keeps differences of the last few iterates and residuals \f$ f = G(x) - x \f$. The next iterate is
+ * extrapolated from them, so that the linearized residual is minimal in the least-squares sense. With zero depth
+ * this reduces to the simple (possibly damped) substitution.
+ */
+struct PLASK_SOLVER_API AndersonMixer {
+
+    unsigned depth;     ///< Number of previous iterations used for extrapolation
+    double mixing;      ///< Fraction of the residual added to the extrapolated iterate
+
+    AndersonMixer(unsigned depth = 5, double mixing = 1.): depth(depth), mixing(mixing) {}
+
+    /// Forget all previous iterations
+    void reset();
+
+    /**
+     * Compute the next iterate
+     * \param x current iterate
+     * \param g value of the map \f$ G(x) \f$
+     * \return next iterate
+     */
+    DataVector<double> operator()(const DataVector<const double>& x, const DataVector<const double>& g);
+
+    /// Get number of previous iterations used in the last extrapolation
+    std::size_t size() const { return dx.size(); }
+
+  private:
+
+    std::deque<DataVector<double>> dx;  ///< Differences of the subsequent iterates
+    std::deque<DataVector<double>> df;  ///< Differences of the subsequent residuals
+
+    DataVector<double> last_x;          ///< Previous iterate
+    DataVector<double> last_f;          ///< Previous residual
+};
+
+}}} // namespace plask::meta::thermoelectric
+
+#endif // PLASK__SOLVER__META_THERMOELECTRIC_ANDERSON_H
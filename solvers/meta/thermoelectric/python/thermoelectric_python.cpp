@@ -0,0 +1,84 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include <plask/python.hpp>
+
+using namespace plask;
+using namespace plask::python;
+
+#include "../thermoelectric.hpp"
+using namespace plask::meta::thermoelectric;
+
+template <typename SolverT>
+static void ThermoElectric_setThermal(SolverT& self, const shared_ptr<Solver>& solver) {
+    auto thermal = dynamic_pointer_cast<typename SolverT::ThermalSolverType>(solver);
+    if (solver && !thermal) throw TypeError("thermal solver of wrong type");
+    self.setThermal(thermal);
+}
+
+template <typename SolverT>
+static void ThermoElectric_setElectrical(SolverT& self, const shared_ptr<Solver>& solver) {
+    auto electrical = dynamic_pointer_cast<typename SolverT::ElectricalSolverType>(solver);
+    if (solver && !electrical) throw TypeError("electrical solver of wrong type");
+    self.setElectrical(electrical);
+}
+
+template <typename __Class__>
+inline static void register_thermoelectric_solver(const char* name, const char* thermal, const char* electrical) {
+    ExportSolver<__Class__> solver(name,
+                                   format(u8"{0}(name=\"\")\n\n"
+                                          u8"Thermo-electric driver for {1} and {2} solvers.\n\n"
+                                          u8"This solver performs self-consistent thermo-electrical computations with the given\n"
+                                          u8"thermal and electrical solvers. Temperature updates are accelerated with the Anderson\n"
+                                          u8"mixing, which usually reduces the number of iterations several times in comparison\n"
+                                          u8"with the simple substitution.",
+                                          name, thermal, electrical)
+                                       .c_str(),
+                                   py::init<std::string>(py::arg("name") = ""));
+    solver.add_property("thermal",
+                        py::make_function(&__Class__::getThermal, py::return_value_policy<py::return_by_value>()),
+                        &ThermoElectric_setThermal<__Class__>,
+                        format(u8"Thermal solver (:class:`thermal.static.{}`).", thermal).c_str());
+    solver.add_property("electrical",
+                        py::make_function(&__Class__::getElectrical, py::return_value_policy<py::return_by_value>()),
+                        &ThermoElectric_setElectrical<__Class__>,
+                        format(u8"Electrical solver (:class:`electrical.shockley.{}` or similar).", electrical).c_str());
+    METHOD_RELEASING_GIL(compute, compute,
+                         u8"Run self-consistent thermo-electric calculations.\n\n"
+                         u8"Electrical and thermal solvers are run alternately, until both of them converge\n"
+                         u8"to the values specified in their ``maxerr`` property.\n\n"
+                         u8"Args:\n"
+                         u8"    loops (int): Maximum number of iterations (0 means no limit).\n\n"
+                         u8"Returns:\n"
+                         u8"    float: Maximum temperature update in the last iteration [K].\n",
+                         py::arg("loops") = 0);
+    RW_FIELD(tfreq, u8"Number of electrical iterations per single thermal step.");
+    RW_PROPERTY(depth, getDepth, setDepth, u8"Number of previous iterations used for the Anderson acceleration (0 disables it).");
+    RW_PROPERTY(mixing, getMixing, setMixing, u8"Fraction of the temperature and junction conductivity update applied in each iteration.");
+    RO_PROPERTY(terr, getTemperatureErr, u8"Maximum temperature update in the last iteration [K].");
+    RO_PROPERTY(verr, getCurrentErr, u8"Maximum current density correction in the last iteration [%].");
+    RO_PROPERTY(iterations, getIterations, u8"Number of iterations performed in the last computations.");
+}
+
+/**
+ * Initialization of your solver class to Python
+ *
+ * The \a solver_name should be changed to match the name of the directory with our solver
+ * (the one where you have put CMakeLists.txt). It will be visible from user interface under this name.
+ */
+BOOST_PYTHON_MODULE(thermoelectric)
+{
+    register_thermoelectric_solver<ThermoElectric2DSolver>("ThermoElectricDriver2D", "Static2D", "Shockley2D");
+    register_thermoelectric_solver<ThermoElectricCylSolver>("ThermoElectricDriverCyl", "StaticCyl", "ShockleyCyl");
+    register_thermoelectric_solver<ThermoElectric3DSolver>("ThermoElectricDriver3D", "Static3D", "Shockley3D");
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "thermoelectric.hpp"
+
+namespace plask { namespace meta { namespace thermoelectric {
+
+namespace {
+
+    /// Find solver of the given type referenced by the tag attribute
+    template <typename SolverT>
+    shared_ptr<SolverT> readSolver(XMLReader& source, Manager& manager, const std::string& attr) {
+        std::string name = source.requireAttribute(attr);
+        auto found = manager.solvers.find(name);
+        if (found == manager.solvers.end())
+            throw XMLBadAttrException(source, attr, name, "the name of a previously defined solver");
+        shared_ptr<SolverT> solver = dynamic_pointer_cast<SolverT>(found->second);
+        if (!solver)
+            throw XMLBadAttrException(source, attr, name, "a solver of proper type");
+        return solver;
+    }
+}
+
+template <typename ThermalT, typename ElectricalT>
+ThermoElectricSolver<ThermalT, ElectricalT>::ThermoElectricSolver(const std::string& name):
+    Solver(name),
+    mixer(5, 1.),
+    terr(NAN),
+    verr(NAN),
+    iterations(0),
+    tfreq(6)
+{}
+
+template <typename ThermalT, typename ElectricalT>
+void ThermoElectricSolver<ThermalT, ElectricalT>::loadConfiguration(XMLReader& source, Manager& manager) {
+    while (source.requireTagOrEnd()) {
+        std::string param = source.getNodeName();
+
+        if (param == "solvers") {
+            setThermal(readSolver<ThermalT>(source, manager, "thermal"));
+            setElectrical(readSolver<ElectricalT>(source, manager, "electrical"));
+            source.requireTagEnd();
+        }
+
+        else if (param == "loop") {
+            tfreq = source.getAttribute<int>("tfreq", tfreq);
+            setDepth(source.getAttribute<unsigned>("depth", mixer.depth));
+            setMixing(source.getAttribute<double>("mixing", mixer.mixing));
+            source.requireTagEnd();
+        }
+
+        else
+            this->parseStandardConfiguration(source, manager, "<solvers> or <loop>");
+    }
+}
+
+template <typename ThermalT, typename ElectricalT>
+void ThermoElectricSolver<ThermalT, ElectricalT>::onInitialize() {
+    if (!thermal) throw BadInput(this->getId(), "no thermal solver set");
+    if (!electrical) throw BadInput(this->getId(), "no electrical solver set");
+    if (tfreq < 1) throw BadInput(this->getId(), "tfreq must be positive");
+
+    electrical->inTemperature.setProvider(thermal->outTemperature);
+    thermal->inHeat.setProvider(electrical->outHeat);
+
+    thermal->initCalculation();
+    electrical->initCalculation();
+}
+
+template <typename ThermalT, typename ElectricalT>
+void ThermoElectricSolver<ThermalT, ElectricalT>::onInvalidate() {
+    mixer.reset();
+    terr = verr = NAN;
+    iterations = 0;
+}
+
+template <typename ThermalT, typename ElectricalT>
+double ThermoElectricSolver<ThermalT, ElectricalT>::compute(unsigned loops) {
+    this->initCalculation();
+
+    this->writelog(LOG_INFO, "Running thermo-electric calculations");
+
+    // History from the previous computations was recorded for different conditions and it would spoil the acceleration
+    mixer.reset();
+    const bool accelerate = mixer.depth != 0 || mixer.mixing != 1.;
+
+    iterations = 0;
+    terr = 2. * thermal->maxerr;
+    verr = 2. * electrical->maxerr;
+
+    while (terr > thermal->maxerr || verr > electrical->maxerr) {
+        if (loops != 0 && iterations == loops) {
+            this->writelog(LOG_WARNING, "Thermo-electric calculations did not converge after {:d} iterations", iterations);
+            return terr;
+        }
+
+        DataVector<const Tensor2<double>> C0 = electrical->getCondJunc().copy();
+        verr = electrical->compute(tfreq);
+        DataVector<const double> T0 = thermal->getTemperatureVector();
+        terr = thermal->compute(1);
+        ++iterations;
+
+        if (accelerate && (terr > thermal->maxerr || verr > electrical->maxerr)) {
+            DataVector<const double> T1 = thermal->getTemperatureVector();
+            DataVector<const Tensor2<double>> C1 = electrical->getCondJunc();
+            if (T0.size() == T1.size() && C0.size() == C1.size()) {
+                // Junction conductivity changes exponentially with the voltage, so it is extrapolated in the log scale
+                const std::size_t nt = T0.size();
+                DataVector<double> x(nt + C0.size()), g(nt + C1.size());
+                std::copy(T0.begin(), T0.end(), x.begin());
+                std::copy(T1.begin(), T1.end(), g.begin());
+                for (std::size_t i = 0; i != C0.size(); ++i) {
+                    x[nt + i] = std::log(C0[i].c11);
+                    g[nt + i] = std::log(C1[i].c11);
+                }
+                DataVector<double> X = mixer(x, g);
+                if (std::all_of(X.begin(), X.begin() + nt, [](double t) { return t > 0.; }) &&
+                    std::all_of(X.begin() + nt, X.end(), [](double c) { return std::isfinite(c); })) {
+                    thermal->setTemperatureVector(DataVector<const double>(X.data(), nt));
+                    DataVector<Tensor2<double>> C = C1.copy();
+                    for (std::size_t i = 0; i != C.size(); ++i) C[i].c11 = std::exp(X[nt + i]);
+                    electrical->setCondJunc(C);
+                } else {
+                    this->writelog(LOG_DETAIL, "Extrapolated solution is not physical, restarting acceleration");
+                    mixer.reset();
+                }
+            } else {
+                mixer.reset();
+            }
+        }
+
+        this->writelog(LOG_RESULT, "Iteration {:d}: temperature error = {:g} K, current error = {:g}%, history = {:d}",
+                       iterations, terr, verr, mixer.size());
+    }
+
+    this->writelog(LOG_INFO, "Thermo-electric calculations converged after {:d} iterations", iterations);
+
+    return terr;
+}
+
+template <> std::string ThermoElectric2DSolver::getClassName() const { return "meta.ThermoElectricDriver2D"; }
+template <> std::string ThermoElectricCylSolver::getClassName() const { return "meta.ThermoElectricDriverCyl"; }
+template <> std::string ThermoElectric3DSolver::getClassName() const { return "meta.ThermoElectricDriver3D"; }
+
+template struct PLASK_SOLVER_API ThermoElectricSolver<thermal::tstatic::ThermalFem2DSolver<Geometry2DCartesian>,
+                                                      electrical::shockley::ElectricalFem2DSolver<Geometry2DCartesian>>;
+template struct PLASK_SOLVER_API ThermoElectricSolver<thermal::tstatic::ThermalFem2DSolver<Geometry2DCylindrical>,
+                                                      electrical::shockley::ElectricalFem2DSolver<Geometry2DCylindrical>>;
+template struct PLASK_SOLVER_API ThermoElectricSolver<thermal::tstatic::ThermalFem3DSolver,
+                                                      electrical::shockley::ElectricalFem3DSolver>;
+
+}}} // namespace plask::meta::thermoelectric
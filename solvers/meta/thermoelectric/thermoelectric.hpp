@@ -0,0 +1,129 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#ifndef PLASK__SOLVER__META_THERMOELECTRIC_H
+#define PLASK__SOLVER__META_THERMOELECTRIC_H
+
+#include <plask/plask.hpp>
+
+#include "../../thermal/static/therm2d.hpp"
+#include "../../thermal/static/therm3d.hpp"
+#include "../../electrical/shockley/electr2d.hpp"
+#include "../../electrical/shockley/electr3d.hpp"
+
+#include "anderson.hpp"
+
+namespace plask { namespace meta { namespace thermoelectric {
+
+/**
+ * Solver driving self-consistent thermo-electric calculations with existing thermal and electrical solvers.
+ *
+ * Each outer iteration runs several electrical loops and a single thermal loop. The temperature and the junction
+ * conductivity obtained from the solvers are treated as a fixed-point map of their previous values and accelerated
+ * with the Anderson mixing before they are given back to the solvers.
+ */
+template <typename ThermalT, typename ElectricalT>
+struct PLASK_SOLVER_API ThermoElectricSolver: public Solver {
+
+    typedef ThermalT ThermalSolverType;
+    typedef ElectricalT ElectricalSolverType;
+
+  protected:
+
+    shared_ptr<ThermalT> thermal;           ///< Thermal solver
+    shared_ptr<ElectricalT> electrical;     ///< Electrical solver
+
+    AndersonMixer mixer;                    ///< Accelerator of the temperature and junction conductivity updates
+
+    double terr;                            ///< Temperature error in the last iteration
+    double verr;                            ///< Current density error in the last iteration
+    unsigned iterations;                    ///< Number of outer iterations in the last computations
+
+    void onInitialize() override;
+
+    void onInvalidate() override;
+
+  public:
+
+    int tfreq;              ///< Number of electrical loops per single thermal loop
+
+    ThermoElectricSolver(const std::string& name = "");
+
+    std::string getClassName() const override;
+
+    void loadConfiguration(XMLReader& source, Manager& manager) override;
+
+    /// Get thermal solver
+    const shared_ptr<ThermalT>& getThermal() const { return thermal; }
+
+    /// Set thermal solver
+    void setThermal(const shared_ptr<ThermalT>& solver) {
+        if (solver == thermal) return;
+        thermal = solver;
+        this->invalidate();
+    }
+
+    /// Get electrical solver
+    const shared_ptr<ElectricalT>& getElectrical() const { return electrical; }
+
+    /// Set electrical solver
+    void setElectrical(const shared_ptr<ElectricalT>& solver) {
+        if (solver == electrical) return;
+        electrical = solver;
+        this->invalidate();
+    }
+
+    /// Get number of previous iterations used for the Anderson acceleration
+    unsigned getDepth() const { return mixer.depth; }
+
+    /// Set number of previous iterations used for the Anderson acceleration (0 disables it)
+    void setDepth(unsigned depth) { mixer.depth = depth; }
+
+    /// Get mixing parameter of the Anderson acceleration
+    double getMixing() const { return mixer.mixing; }
+
+    /// Set mixing parameter of the Anderson acceleration
+    void setMixing(double mixing) {
+        if (mixing <= 0. || mixing > 1.) throw BadInput(this->getId(), "mixing must be in range (0, 1]");
+        mixer.mixing = mixing;
+    }
+
+    /// Get maximum temperature update in the last iteration
+    double getTemperatureErr() const { return terr; }
+
+    /// Get maximum current density correction in the last iteration
+    double getCurrentErr() const { return verr; }
+
+    /// Get number of outer iterations performed in the last computations
+    unsigned getIterations() const { return iterations; }
+
+    /**
+     * Run self-consistent calculations until both solvers converge to their \c maxerr
+     * \param loops maximum number of outer iterations (0 for no limit)
+     * \return maximum temperature update in the last iteration
+     */
+    double compute(unsigned loops = 0);
+};
+
+typedef ThermoElectricSolver<thermal::tstatic::ThermalFem2DSolver<Geometry2DCartesian>,
+                             electrical::shockley::ElectricalFem2DSolver<Geometry2DCartesian>> ThermoElectric2DSolver;
+
+typedef ThermoElectricSolver<thermal::tstatic::ThermalFem2DSolver<Geometry2DCylindrical>,
+                             electrical::shockley::ElectricalFem2DSolver<Geometry2DCylindrical>> ThermoElectricCylSolver;
+
+typedef ThermoElectricSolver<thermal::tstatic::ThermalFem3DSolver,
+                             electrical::shockley::ElectricalFem3DSolver> ThermoElectric3DSolver;
+
+}}} // namespace plask::meta::thermoelectric
+
+#endif // PLASK__SOLVER__META_THERMOELECTRIC_H
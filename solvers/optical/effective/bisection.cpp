@@ -13,18 +13,41 @@
  */
 #include "bisection.hpp"
 
+#ifdef OPENMP_FOUND
+#   include <omp.h>
+#endif
+
 namespace plask { namespace optical { namespace effective {
 
-#define CALL_FUN(result, re, im) \
-    if (error) continue; \
-    try { \
-        result = fun(dcomplex(re, im)); \
-    } catch (...) { \
-        PLASK_PRAGMA(omp critical) \
-        error = std::current_exception();\
+namespace detail {
+
+    // Number of points passed to the function at once
+    constexpr size_t CONTOUR_BATCH = 8;
+
+    // Compute function values at given points, in parallel batches (smaller ones if there are too few points for all threads)
+    static void computeValues(const RootDigger::multi_function_type& fun, const dcomplex* points, dcomplex* values, size_t n) {
+        size_t batch = CONTOUR_BATCH;
+#       ifdef OPENMP_FOUND
+            batch = std::max(std::min(batch, n / size_t(omp_get_max_threads())), size_t(1));
+#       endif
+        std::exception_ptr error;
+        const openmp_size_t batches = (n + batch - 1) / batch;
+        #pragma omp parallel for
+        for (openmp_size_t b = 0; b < batches; ++b) {
+            if (error) continue;
+            const size_t i = size_t(b) * batch;
+            try {
+                fun(points + i, values + i, std::min(batch, n - i));
+            } catch (...) {
+                #pragma omp critical
+                error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
     }
+}
 
-Contour::Contour(const Solver* solver, const std::function<dcomplex(dcomplex)>& fun, dcomplex corner0, dcomplex corner1, size_t ren, size_t imn):
+Contour::Contour(const Solver* solver, const RootDigger::multi_function_type& fun, dcomplex corner0, dcomplex corner1, size_t ren, size_t imn):
     solver(solver), fun(fun), re0(real(corner0)), im0(imag(corner0)), re1(real(corner1)), im1(imag(corner1))
 {
     bottom.reset(ren+1);
@@ -35,27 +58,21 @@ Contour::Contour(const Solver* solver, const std::function<dcomplex(dcomplex)>&
     double dr = (re1 - re0) / double(ren);
     double di = (im1 - im0) / double(imn);
 
-    std::exception_ptr error;
-    #pragma omp parallel
-    {
-        #pragma omp for nowait
-        for (int i = 0; i < int(ren); ++i) {
-            CALL_FUN(bottom[i], re0+i*dr, im0)
-        }
-        #pragma omp for nowait
-        for (int i = 0; i < int(imn); ++i) {
-            CALL_FUN(right[i], re1, im0+i*di)
-        }
-        #pragma omp for nowait
-        for (int i = 1; i <= int(ren); ++i) {
-            CALL_FUN(top[i], re0+i*dr, im1)
-        }
-        #pragma omp for
-        for (int i = 1; i <= int(imn); ++i) {
-            CALL_FUN(left[i], re0, im0+i*di)
-        }
-    }
-    if (error) std::rethrow_exception(error);
+    // Compute all the points at once, so they can be split evenly between threads
+    std::vector<dcomplex> points, values(2 * (ren + imn));
+    points.reserve(values.size());
+    for (size_t i = 0; i < ren; ++i) points.emplace_back(re0+double(i)*dr, im0);
+    for (size_t i = 0; i < imn; ++i) points.emplace_back(re1, im0+double(i)*di);
+    for (size_t i = 1; i <= ren; ++i) points.emplace_back(re0+double(i)*dr, im1);
+    for (size_t i = 1; i <= imn; ++i) points.emplace_back(re0, im0+double(i)*di);
+    detail::computeValues(fun, points.data(), values.data(), values.size());
+
+    auto value = values.begin();
+    std::copy_n(value, ren, bottom.begin()); value += ren;
+    std::copy_n(value, imn, right.begin()); value += imn;
+    std::copy_n(value, ren, top.begin() + 1); value += ren;
+    std::copy_n(value, imn, left.begin() + 1);
+
     // Wrap values
     bottom[ren] = right[0];
     right[imn] = top[ren];
@@ -111,17 +128,9 @@ std::pair<Contour,Contour> Contour::divide(double reps, double ieps) const
         middle[0] = bottom[n]; middle[imn] = top[n];
         double di = (im1 - im0) / double(imn);
 
-        std::exception_ptr error;
-        #pragma omp parallel for
-        for (plask::openmp_size_t i = 1; i < imn; ++i) {
-            if (error) continue;
-            try {
-                middle[i] = fun(dcomplex(re, im0+double(i)*di));
-            } catch (...) {
-                error = std::current_exception();
-            }
-        }
-        if (error) std::rethrow_exception(error);
+        std::vector<dcomplex> points; points.reserve(imn-1);
+        for (size_t i = 1; i < imn; ++i) points.emplace_back(re, im0+double(i)*di);
+        detail::computeValues(fun, points.data(), &middle[1], points.size());
 
         contoura.left = left;
         contoura.right = middle;
@@ -144,8 +153,8 @@ std::pair<Contour,Contour> Contour::divide(double reps, double ieps) const
         DataVector<dcomplex> middle(ren+1);
         if (right.size() <= 2) {
             assert(ren == 1); // real axis also has only one segment
-            middle[0] = fun(dcomplex(re0, im));
-            middle[1] = fun(dcomplex(re1, im));
+            const dcomplex points[2] = { dcomplex(re0, im), dcomplex(re1, im) };
+            fun(points, middle.data(), 2);
             contoura.left = DataVector<dcomplex>({left[0], middle[0]});
             contoura.right = DataVector<dcomplex>({right[0], middle[1]});
             contourb.left = DataVector<dcomplex>({middle[0], left[1]});
@@ -155,16 +164,9 @@ std::pair<Contour,Contour> Contour::divide(double reps, double ieps) const
             middle[0] = left[n]; middle[ren] = right[n];
             double dr = (re1 - re0) / double(ren);
 
-            std::exception_ptr error;
-            #pragma omp parallel for
-            for (plask::openmp_size_t i = 1; i < ren; ++i) {
-                if (error) continue;
-                try {
-                    middle[i] = fun(dcomplex(re0+double(i)*dr, im));
-                } catch (...) {
-                    error = std::current_exception();
-                }
-            }
+            std::vector<dcomplex> points; points.reserve(ren-1);
+            for (size_t i = 1; i < ren; ++i) points.emplace_back(re0+double(i)*dr, im);
+            detail::computeValues(fun, points.data(), &middle[1], points.size());
 
             contoura.left = DataVector<dcomplex>(const_cast<dcomplex*>(&left[0]), n+1);
             contoura.right = DataVector<dcomplex>(const_cast<dcomplex*>(&right[0]), n+1);
@@ -213,6 +215,15 @@ namespace detail {
 
 std::vector<std::pair<dcomplex,dcomplex>> findZeros(const Solver* solver, const std::function<dcomplex(dcomplex)>& fun,
                                                     dcomplex corner0, dcomplex corner1, size_t resteps, size_t imsteps, dcomplex eps)
+{
+    RootDigger::multi_function_type multi_fun = [&fun](const dcomplex* points, dcomplex* values, size_t n) {
+        for (size_t i = 0; i < n; ++i) values[i] = fun(points[i]);
+    };
+    return findZeros(solver, multi_fun, corner0, corner1, resteps, imsteps, eps);
+}
+
+std::vector<std::pair<dcomplex,dcomplex>> findZeros(const Solver* solver, const RootDigger::multi_function_type& fun,
+                                                    dcomplex corner0, dcomplex corner1, size_t resteps, size_t imsteps, dcomplex eps)
 {
     // Find first power of 2 not smaller than range/precision
     size_t Nr = 1, Ni = 1;
@@ -16,13 +16,15 @@
 
 #include <plask/plask.hpp>
 
+#include "rootdigger.hpp"
+
 namespace plask { namespace optical { namespace effective {
 
 struct Contour {
 
     const Solver* solver;           ///< Solver that created this contour
 
-    const std::function<dcomplex(dcomplex)>& fun; ///< Function being investigated
+    const RootDigger::multi_function_type& fun; ///< Function being investigated (computing values at several points at once)
 
     double re0,                     ///< Real part of the lower left corner of the contour
            im0,                     ///< Real part of the lower left corner of the contour
@@ -34,7 +36,7 @@ struct Contour {
                          top,       ///< Vector of computed function values at top side of the contour
                          left;      ///< Vector of computed function values at left side of the contour
 
-    Contour(const Solver* solver, const std::function<dcomplex(dcomplex)>& fun): solver(solver), fun(fun) {};
+    Contour(const Solver* solver, const RootDigger::multi_function_type& fun): solver(solver), fun(fun) {};
 
     Contour(const Contour& src): solver(src.solver), fun(src.fun), re0(src.re0), im0(src.im0), re1(src.re1), im1(src.im1),
                                  bottom(src.bottom), right(src.right), top(src.top), left(src.left) {}
@@ -49,7 +51,7 @@ struct Contour {
      * \param corner0,corner1 corners of the integral
      * \param ren,imn number of contour points along each real and imaginary axis, respectively
      */
-    Contour(const Solver* solver, const std::function<dcomplex(dcomplex)>& fun, dcomplex corner0, dcomplex corner1, size_t ren, size_t imn);
+    Contour(const Solver* solver, const RootDigger::multi_function_type& fun, dcomplex corner0, dcomplex corner1, size_t ren, size_t imn);
 
     /**
      * Compute winding number of the contour
@@ -90,6 +92,18 @@ struct Contour {
 std::vector<std::pair<dcomplex,dcomplex>> findZeros(const Solver* solver, const std::function<dcomplex(dcomplex)>& fun,
                                                     dcomplex corner0, dcomplex corner1, size_t resteps, size_t imsteps, dcomplex eps);
 
+/**
+ * Global complex bisection algorithm
+ * \param solver solver that created this contour
+ * \param fun function computing values at several points at once
+ * \param corner0,corner1 corners of the integral
+ * \param resteps,imsteps number of contour points along each real and imaginary axis, respectively
+ * \param eps desired precision
+ * \return list of found ranges with zeros
+ */
+std::vector<std::pair<dcomplex,dcomplex>> findZeros(const Solver* solver, const RootDigger::multi_function_type& fun,
+                                                    dcomplex corner0, dcomplex corner1, size_t resteps, size_t imsteps, dcomplex eps);
+
 }}} // namespace plask::optical::effective
 
 #endif // PLASK__OPTICAL_EFFECTIVE_BISECTION_H
\ No newline at end of file
@@ -45,11 +45,14 @@ void RootBroyden::fdjac(dcomplex x, dcomplex F, dcomplex& Jr, dcomplex& Ji) cons
     hr = xr1 - xr0; hi = xi1 - xi0;             // trick to reduce finite precision error
 
     dcomplex xr = dcomplex(xr1, xi0), xi = dcomplex(xr0, xi1);
-    dcomplex Fr = valFunction(xr); log_value(xr, Fr);
-    dcomplex Fi = valFunction(xi); log_value(xi, Fi);
-
-    Jr = (Fr - F) / hr;
-    Ji = (Fi - F) / hi;
+    const dcomplex xs[2] = { xr, xi };
+    dcomplex Fs[2];
+    valFunctions(xs, Fs, 2);
+    log_value(xr, Fs[0]);
+    log_value(xi, Fs[1]);
+
+    Jr = (Fs[0] - F) / hr;
+    Ji = (Fs[1] - F) / hi;
 }
 
 //**************************************************************************
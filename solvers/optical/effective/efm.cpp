@@ -371,7 +371,10 @@ void EffectiveFrequencyCyl::stageOne()
                         nng[i] = same_nr * same_ng;
                     } else {
                         DataLog<dcomplex,dcomplex> log_stripe(getId(), format("stripe[{}]", i), "vlam", "det");
-                        auto rootdigger = RootDigger::get(this, [&](const dcomplex& x){return this->detS1(2. - 4e3*PI / x / k0, nrCache[i], ngCache[i]);}, log_stripe, stripe_root);
+                        auto rootdigger = RootDigger::get(this,
+                                              [&](const dcomplex& x){return this->detS1(2. - 4e3*PI / x / k0, nrCache[i], ngCache[i]);},
+                                              [&](const dcomplex* x, dcomplex* dets, size_t n){ this->detS1lam(x, dets, n, i); },
+                                              log_stripe, stripe_root);
                         dcomplex start = (vlam == 0.)? 2e3*PI / k0 : vlam;
                         veffs[i] = freqv(rootdigger->find(start));
                         computeStripeNNg(i, i==main_stripe);
@@ -398,6 +401,9 @@ void EffectiveFrequencyCyl::stageOne()
                                   [&](const dcomplex& x){
                                       return this->detS1(2. - 4e3*PI / x / k0, nrCache[rstripe], ngCache[rstripe]);
                                   },
+                                  [&](const dcomplex* x, dcomplex* dets, size_t n){
+                                      this->detS1lam(x, dets, n, rstripe);
+                                  },
                                   log_stripe,
                                   stripe_root
                                  );
@@ -435,71 +441,59 @@ void EffectiveFrequencyCyl::stageOne()
 dcomplex EffectiveFrequencyCyl::detS1(const dcomplex& v, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR,
                                             const std::vector<dcomplex,aligned_allocator<dcomplex>>& NG, std::vector<FieldZ>* saveto)
 {
+    dcomplex det;
+    detS1(&v, &det, 1, NR, NG, saveto);
+    return det;
+}
+
+void EffectiveFrequencyCyl::detS1(const dcomplex* v, dcomplex* dets, size_t n, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR,
+                                  const std::vector<dcomplex,aligned_allocator<dcomplex>>& NG, std::vector<FieldZ>* saveto)
+{
+    assert(!saveto || n == 1);
+
+    // Only the second column of the transfer matrix is needed, as F0 = 0 and B0 = 1.
+    // Trial values are processed in batches, each value in its own lane, so the layer data is read once per batch.
+    dcomplex kz0[DETS1_BATCH], F[DETS1_BATCH], B[DETS1_BATCH];
+
     if (saveto) (*saveto)[zbegin] = FieldZ(0., 1.);
 
-    std::vector<dcomplex> kz(zsize);
-    for (size_t i = zbegin; i < zsize; ++i) {
-        kz[i] = k0 * sqrt(NR[i]*NR[i] - v * NR[i]*NG[i]);
-        if (real(kz[i]) < 0.) kz[i] = -kz[i];
-    }
+    for (size_t b = 0; b < n; b += DETS1_BATCH) {
+        const size_t m = std::min(n - b, size_t(DETS1_BATCH));
+        const dcomplex* vb = v + b;
 
-    // dcomplex s1 = 1., s2 = 0., s3 = 0., s4 = 1.; // matrix S
-    //
-    // dcomplex phas = 1.;
-    // if (zbegin != 0)
-    //     phas = exp(I * kz[zbegin] * (mesh->axis[1]->at(zbegin)-mesh->axis[1]->at(zbegin-1)));
-    //
-    // for (size_t i = zbegin+1; i < zsize; ++i) {
-    //     // Compute shift inside one layer
-    //     s1 *= phas;
-    //     s3 *= phas * phas;
-    //     s4 *= phas;
-    //     // Compute matrix after boundary
-    //     dcomplex p = 0.5 + 0.5 * kz[i] / kz[i-1];
-    //     dcomplex m = 1.0 - p;
-    //     dcomplex chi = 1. / (p - m * s3);
-    //     // F0 = [ (-m*m + p*p)*chi*s1  m*s1*s4*chi + s2 ] [ F2 ]
-    //     // B2 = [ (-m + p*s3)*chi      s4*chi           ] [ B0 ]
-    //     s2 += s1*m*chi*s4;
-    //     s1 *= (p*p - m*m) * chi;
-    //     s3  = (p*s3-m) * chi;
-    //     s4 *= chi;
-    //     // Compute phase shift for the next step
-    //     if (i != mesh->axis[1]->size())
-    //         phas = exp(I * kz[i] * (mesh->axis[1]->at(i)-mesh->axis[1]->at(i-1)));
-    //
-    //     // Compute fields
-    //     if (saveto) {
-    //         dcomplex F = -s2/s1, B = (s1*s4-s2*s3)/s1;    // Assume  F0 = 0  B0 = 1
-    //         double aF = abs(F), aB = abs(B);
-    //         // zero very small fields to avoid errors in plotting for long layers
-    //         if (aF < 1e-8 * aB) F = 0.;
-    //         if (aB < 1e-8 * aF) B = 0.;
-    //         (*saveto)[i] = FieldZ(F, B);
-    //     }
-    // }
-
-    MatrixZ T = MatrixZ::eye();
-    for (size_t i = zbegin; i < zsize-1; ++i) {
-        double d;
-        if (i != zbegin || zbegin != 0) d = mesh->axis[1]->at(i) - mesh->axis[1]->at(i-1);
-        else d = 0.;
-        dcomplex phas = exp(- I * kz[i] * d);
-        // Transfer through boundary
-        dcomplex n = 0.5 * kz[i]/kz[i+1];
-        MatrixZ T1 = MatrixZ((0.5+n), (0.5-n),
-                             (0.5-n), (0.5+n));
-        T1.ff *= phas; T1.fb /= phas;
-        T1.bf *= phas; T1.bb /= phas;
-        T = T1 * T;
-        if (saveto) {
-            dcomplex F = T.fb, B = T.bb;    // Assume  F0 = 0  B0 = 1
-            double aF = abs(F), aB = abs(B);
-            // zero very small fields to avoid errors in plotting for long layers
-            if (aF < 1e-8 * aB) F = 0.;
-            if (aB < 1e-8 * aF) B = 0.;
-            (*saveto)[i+1] = FieldZ(F, B);
+        for (size_t j = 0; j < m; ++j) {
+            kz0[j] = k0 * sqrt(NR[zbegin]*NR[zbegin] - vb[j] * NR[zbegin]*NG[zbegin]);
+            if (real(kz0[j]) < 0.) kz0[j] = -kz0[j];
+            F[j] = 0.; B[j] = 1.;
         }
+
+        for (size_t i = zbegin; i < zsize-1; ++i) {
+            double d;
+            if (i != zbegin || zbegin != 0) d = mesh->axis[1]->at(i) - mesh->axis[1]->at(i-1);
+            else d = 0.;
+            const dcomplex nr = NR[i+1], ng = NG[i+1], nr2 = nr*nr;
+            for (size_t j = 0; j < m; ++j) {
+                dcomplex kz1 = k0 * sqrt(nr2 - vb[j] * nr*ng);
+                if (real(kz1) < 0.) kz1 = -kz1;
+                dcomplex phas = exp(- I * kz0[j] * d);
+                // Transfer through boundary
+                dcomplex n = 0.5 * kz0[j]/kz1;
+                dcomplex F1 = (0.5+n) * phas * F[j] + (0.5-n) / phas * B[j];
+                B[j] = (0.5-n) * phas * F[j] + (0.5+n) / phas * B[j];
+                F[j] = F1;
+                kz0[j] = kz1;
+            }
+            if (saveto) {
+                dcomplex F0 = F[0], B0 = B[0];
+                double aF = abs(F0), aB = abs(B0);
+                // zero very small fields to avoid errors in plotting for long layers
+                if (aF < 1e-8 * aB) F0 = 0.;
+                if (aB < 1e-8 * aF) B0 = 0.;
+                (*saveto)[i+1] = FieldZ(F0, B0);
+            }
+        }
+
+        for (size_t j = 0; j < m; ++j) dets[b+j] = B[j];    // F0 = 0    Bn = 0
     }
 
     if (saveto) {
@@ -519,11 +513,16 @@ dcomplex EffectiveFrequencyCyl::detS1(const dcomplex& v, const std::vector<dcomp
         writelog(LOG_DEBUG, "vertical fields = [{0}) ]", nrs.str().substr(2));
 #endif
     }
+}
 
-    // return s4 - s2*s3/s1;
-
-    return T.bb;    // F0 = 0    Bn = 0
-
+void EffectiveFrequencyCyl::detS1lam(const dcomplex* lam, dcomplex* dets, size_t n, size_t stripe)
+{
+    dcomplex v[DETS1_BATCH];
+    for (size_t b = 0; b < n; b += DETS1_BATCH) {
+        const size_t m = std::min(n - b, size_t(DETS1_BATCH));
+        for (size_t j = 0; j < m; ++j) v[j] = freqv(lam[b+j]);
+        detS1(v, dets + b, m, nrCache[stripe], ngCache[stripe]);
+    }
 }
 
 
@@ -730,7 +729,7 @@ dcomplex EffectiveFrequencyCyl::detS(const dcomplex& lam, Mode& mode, bool save)
         }
     } else if (determinant == DETERMINANT_INWARDS) {
         MatrixR T = MatrixR::eye();
-        mode.rfields[rsize-1] = FieldR(0., 1.);
+        if (save) mode.rfields[rsize-1] = FieldR(0., 1.);
         for (size_t i = rsize-1; i > 0; --i) {
             computeBessel(i, v, mode, J1, H1, J2, H2);
             MatrixR M1(  J1[0],           H1[0],
@@ -750,7 +749,7 @@ dcomplex EffectiveFrequencyCyl::detS(const dcomplex& lam, Mode& mode, bool save)
         return T.HH/T.JH * H1[0]/J1[0];
     } else {
         MatrixR T = MatrixR::eye();
-        mode.rfields[0] = FieldR(1., 0.);
+        if (save) mode.rfields[0] = FieldR(1., 0.);
         for (size_t i = 1; i < rsize; ++i) {
             computeBessel(i, v, mode, J1, H1, J2, H2);
             MatrixR M1(  J1[0],           H1[0],
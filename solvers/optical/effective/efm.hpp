@@ -432,6 +432,21 @@ struct PLASK_SOLVER_API EffectiveFrequencyCyl: public SolverWithMesh<Geometry2DC
         return det;
     }
 
+    /**
+     * Get function computing modal determinant for the whole matrix.
+     * Vertical computations are performed immediately and the returned function can be safely called
+     * from many threads concurrently, e.g. for computing determinant maps in parallel. It must not be
+     * used after any solver parameter is changed.
+     * \param m number of the LP_mn mode describing angular dependence
+     * \return function computing determinant for a given wavelength
+     */
+    std::function<dcomplex(dcomplex)> getDeterminantFunction(int m=0) {
+        if (isnan(k0.real())) throw BadInput(getId(), "No reference wavelength `lam0` specified");
+        stageOne();
+        auto mode = plask::make_shared<Mode>(this, m);
+        return [this,mode](dcomplex lambda) { return this->detS(lambda, *mode); };
+    }
+
     /**
      * Set particular value of the effective wavelength, e.g. to one of the values returned by findModes.
      * If it is not proper mode, exception is throw.
@@ -512,10 +527,27 @@ struct PLASK_SOLVER_API EffectiveFrequencyCyl: public SolverWithMesh<Geometry2DC
      */
     void stageOne();
 
+    /// Number of trial values processed together by the batched detS1
+    static constexpr size_t DETS1_BATCH = 4;
+
     /// Return S matrix determinant for one stripe
     dcomplex detS1(const dcomplex& v, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR,
                    const std::vector<dcomplex,aligned_allocator<dcomplex>>& NG, std::vector<FieldZ>* saveto=nullptr);
 
+    /**
+     * Compute S matrix determinants for one stripe for several frequency parameters at once
+     * \param v frequency parameters
+     * \param[out] dets computed determinants
+     * \param n number of frequency parameters
+     * \param NR,NG refractive and group indices in the stripe
+     * \param saveto vector to save the fields to (only if \a n is 1)
+     */
+    void detS1(const dcomplex* v, dcomplex* dets, size_t n, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR,
+               const std::vector<dcomplex,aligned_allocator<dcomplex>>& NG, std::vector<FieldZ>* saveto=nullptr);
+
+    /// Return S matrix determinants of the given stripe for several vertical wavelengths at once
+    void detS1lam(const dcomplex* lam, dcomplex* dets, size_t n, size_t stripe);
+
     /// Compute stripe averaged n ng
     void computeStripeNNg(size_t stripe, bool save_integrals=false);
 
@@ -138,7 +138,9 @@ std::vector<dcomplex> EffectiveIndex2D::searchVNeffs(dcomplex neff1, dcomplex ne
     neff1 = dcomplex(re0,im0);
     neff2 = dcomplex(re1,im1);
 
-    auto ranges = findZeros(this, [&](const dcomplex& z){return this->detS1(z,nrCache[stripe]);}, neff1, neff2, resteps, imsteps, eps);
+    auto ranges = findZeros(this,
+                            [&](const dcomplex* z, dcomplex* dets, size_t n){ this->detS1(z, dets, n, nrCache[stripe]); },
+                            neff1, neff2, resteps, imsteps, eps);
     std::vector<dcomplex> results; results.reserve(ranges.size());
     for (auto zz: ranges) results.push_back(0.5 * (zz.first+zz.second));
 
@@ -383,7 +385,10 @@ void EffectiveIndex2D::stageOne()
         }
 #endif
         DataLog<dcomplex,dcomplex> log_stripe(getId(), format("stripe[{0}]", stripe-xbegin), "neff", "det");
-        auto rootdigger = RootDigger::get(this, [&](const dcomplex& x){return this->detS1(x,nrCache[stripe]);}, log_stripe, stripe_root);
+        auto rootdigger = RootDigger::get(this,
+                                          [&](const dcomplex& x){ return this->detS1(x, nrCache[stripe]); },
+                                          [&](const dcomplex* x, dcomplex* dets, size_t n){ this->detS1(x, dets, n, nrCache[stripe]); },
+                                          log_stripe, stripe_root);
         if (vneff == 0.) {
             dcomplex maxn = *std::max_element(nrCache[stripe].begin(), nrCache[stripe].end(),
                                               [](const dcomplex& a, const dcomplex& b){return real(a) < real(b);} );
@@ -423,73 +428,59 @@ void EffectiveIndex2D::stageOne()
 
 dcomplex EffectiveIndex2D::detS1(const plask::dcomplex& x, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR, bool save)
 {
+    dcomplex det;
+    detS1(&x, &det, 1, NR, save);
+    return det;
+}
+
+void EffectiveIndex2D::detS1(const dcomplex* x, dcomplex* dets, size_t n, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR, bool save)
+{
+    assert(!save || n == 1);
+
+    // Only the second column of the transfer matrix is needed, as F0 = 0 and B0 = 1.
+    // Trial values are processed in batches, each value in its own lane, so the layer data is read once per batch.
+    dcomplex ky0[DETS1_BATCH], F[DETS1_BATCH], B[DETS1_BATCH];
+
     if (save) yfields[ybegin] = Field(0., 1.);
 
-    std::vector<dcomplex,aligned_allocator<dcomplex>> ky(yend);
-    for (size_t i = ybegin; i < yend; ++i) {
-        ky[i] = k0 * sqrt(NR[i]*NR[i] - x*x);
-        if (imag(ky[i]) > 0.) ky[i] = -ky[i];
-    }
+    for (size_t b = 0; b < n; b += DETS1_BATCH) {
+        const size_t m = std::min(n - b, size_t(DETS1_BATCH));
+        const dcomplex* xb = x + b;
 
-    // dcomplex s1 = 1., s2 = 0., s3 = 0., s4 = 1.; // matrix S
-    //
-    // dcomplex phas = 1.;
-    // if (ybegin != 0)
-    //     phas = exp(I * ky[ybegin] * (mesh->axis[1]->at(ybegin)-mesh->axis[1]->at(ybegin-1)));
-    //
-    // for (size_t i = ybegin+1; i < yend; ++i) {
-    //     // Compute shift inside one layer
-    //     s1 *= phas;
-    //     s3 *= phas * phas;
-    //     s4 *= phas;
-    //     // Compute matrix after boundary
-    //     dcomplex f = (polarization==TM)? NR[i-1]/NR[i] : 1.;
-    //     dcomplex p = 0.5 + 0.5 * ky[i] / ky[i-1] * f*f;
-    //     dcomplex m = 1.0 - p;
-    //     dcomplex chi = 1. / (p - m * s3);
-    //     // F0 = [ (-m*m + p*p)*chi*s1  m*s1*s4*chi + s2 ] [ F2 ]
-    //     // B2 = [ (-m + p*s3)*chi      s4*chi           ] [ B0 ]
-    //     s2 += s1*m*chi*s4;
-    //     s1 *= (p*p - m*m) * chi;
-    //     s3  = (p*s3-m) * chi;
-    //     s4 *= chi;
-    //     // Compute phase shift for the next step
-    //     if (i != mesh->axis[1]->size())
-    //         phas = exp(I * ky[i] * (mesh->axis[1]->at(i)-mesh->axis[1]->at(i-1)));
-    //
-    //     // Compute fields
-    //     if (save) {
-    //         dcomplex F = -s2/s1, B = (s1*s4-s2*s3)/s1;    // Assume  F0 = 0  B0 = 1
-    //         double aF = abs(F), aB = abs(B);
-    //         // zero very small fields to avoid errors in plotting for long layers
-    //         if (aF < 1e-8 * aB) F = 0.;
-    //         if (aB < 1e-8 * aF) B = 0.;
-    //         yfields[i] = Field(F, B);
-    //     }
-    // }
+        for (size_t j = 0; j < m; ++j) {
+            ky0[j] = k0 * sqrt(NR[ybegin]*NR[ybegin] - xb[j]*xb[j]);
+            if (imag(ky0[j]) > 0.) ky0[j] = -ky0[j];
+            F[j] = 0.; B[j] = 1.;
+        }
 
-    Matrix T = Matrix::eye();
-    for (size_t i = ybegin; i < yend-1; ++i) {
-        double d;
-        if (i != ybegin || ybegin != 0) d = mesh->axis[1]->at(i) - mesh->axis[1]->at(i-1);
-        else d = 0.;
-        dcomplex phas = exp(- I * ky[i] * d);
-        // Transfer through boundary
-        dcomplex f = (polarization==TM)? (NR[i+1]/NR[i]) : 1.;
-        dcomplex n = 0.5 * ky[i]/ky[i+1] * f*f;
-        Matrix T1 = Matrix( (0.5+n), (0.5-n),
-                            (0.5-n), (0.5+n) );
-        T1.ff *= phas; T1.fb /= phas;
-        T1.bf *= phas; T1.bb /= phas;
-        T = T1 * T;
-        if (save) {
-            dcomplex F = T.fb, B = T.bb;    // Assume  F0 = 0  B0 = 1
-            double aF = abs(F), aB = abs(B);
-            // zero very small fields to avoid errors in plotting for long layers
-            if (aF < 1e-8 * aB) F = 0.;
-            if (aB < 1e-8 * aF) B = 0.;
-            yfields[i+1] = Field(F, B);
+        for (size_t i = ybegin; i < yend-1; ++i) {
+            double d;
+            if (i != ybegin || ybegin != 0) d = mesh->axis[1]->at(i) - mesh->axis[1]->at(i-1);
+            else d = 0.;
+            const dcomplex f = (polarization==TM)? (NR[i+1]/NR[i]) : 1.;
+            const dcomplex nr2 = NR[i+1]*NR[i+1];
+            for (size_t j = 0; j < m; ++j) {
+                dcomplex ky1 = k0 * sqrt(nr2 - xb[j]*xb[j]);
+                if (imag(ky1) > 0.) ky1 = -ky1;
+                dcomplex phas = exp(- I * ky0[j] * d);
+                // Transfer through boundary
+                dcomplex n = 0.5 * ky0[j]/ky1 * f*f;
+                dcomplex F1 = (0.5+n) * phas * F[j] + (0.5-n) / phas * B[j];
+                B[j] = (0.5-n) * phas * F[j] + (0.5+n) / phas * B[j];
+                F[j] = F1;
+                ky0[j] = ky1;
+            }
+            if (save) {
+                dcomplex F0 = F[0], B0 = B[0];
+                double aF = abs(F0), aB = abs(B0);
+                // zero very small fields to avoid errors in plotting for long layers
+                if (aF < 1e-8 * aB) F0 = 0.;
+                if (aB < 1e-8 * aF) B0 = 0.;
+                yfields[i+1] = Field(F0, B0);
+            }
         }
+
+        for (size_t j = 0; j < m; ++j) dets[b+j] = B[j];    // F0 = 0    Bn = 0
     }
 
     if (save) {
@@ -500,10 +491,6 @@ dcomplex EffectiveIndex2D::detS1(const plask::dcomplex& x, const std::vector<dco
         writelog(LOG_DEBUG, "vertical fields = [{0}) ]", nrs.str().substr(2));
 #endif
     }
-
-    // return s1*s4 - s2*s3;
-
-    return T.bb;    // F0 = 0    Bn = 0
 }
 
 
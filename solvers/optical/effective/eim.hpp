@@ -315,6 +315,20 @@ struct PLASK_SOLVER_API EffectiveIndex2D: public SolverWithMesh<Geometry2DCartes
         return det;
     }
 
+    /**
+     * Get function computing modal determinant for the whole matrix.
+     * Vertical computations are performed immediately and the returned function can be safely called
+     * from many threads concurrently, e.g. for computing determinant maps in parallel. It must not be
+     * used after any solver parameter is changed.
+     * \param symmetry mode symmetry
+     * \return function computing determinant for a given effective index
+     */
+    std::function<dcomplex(dcomplex)> getDeterminantFunction(Symmetry sym=SYMMETRY_DEFAULT) {
+        stageOne();
+        auto mode = plask::make_shared<Mode>(this, sym);
+        return [this,mode](dcomplex neff) { return this->detS(neff, *mode); };
+    }
+
     /**
      * Set particular value of the effective index, e.g. to one of the values returned by findModes.
      * If it is not proper mode, exception is throw
@@ -419,6 +433,19 @@ struct PLASK_SOLVER_API EffectiveIndex2D: public SolverWithMesh<Geometry2DCartes
      */
     dcomplex detS1(const dcomplex& x, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR, bool save=false);
 
+    /// Number of trial values processed together by the batched detS1
+    static constexpr size_t DETS1_BATCH = 4;
+
+    /**
+     * Compute S matrix determinants for one stripe for several vertical effective indices at once
+     * \param x vertical effective indices
+     * \param[out] dets computed determinants
+     * \param n number of effective indices
+     * \param NR refractive indices
+     * \param save if \c true, the fields are saved to yfields (only if \a n is 1)
+     */
+    void detS1(const dcomplex* x, dcomplex* dets, size_t n, const std::vector<dcomplex,aligned_allocator<dcomplex>>& NR, bool save=false);
+
     /**
      * Return S matrix determinant for the whole structure
      * \param x effective index
@@ -32,9 +32,12 @@ dcomplex RootMuller::find(dcomplex start) const
 
     dcomplex x2 = first, x1 = second, x0 = start;
 
-    dcomplex f2 = valFunction(x2); log_value(x2, f2);
-    dcomplex f1 = valFunction(x1); log_value(x1, f1);
-    dcomplex f0 = valFunction(x0); log_value.count(x0, f0);
+    const dcomplex xs[3] = { x2, x1, x0 };
+    dcomplex fs[3];
+    valFunctions(xs, fs, 3);
+    dcomplex f2 = fs[0]; log_value(x2, f2);
+    dcomplex f1 = fs[1]; log_value(x1, f1);
+    dcomplex f0 = fs[2]; log_value.count(x0, f0);
 
     for (int i = 0; i < params.maxiter; ++i) {
         if (isnan(real(f0)) || isnan(imag(f0)))
@@ -104,7 +104,7 @@ static void EffectiveIndex2D_setPolarization(EffectiveIndex2D& self, std::string
 }
 
 static py::object EffectiveIndex2D_getDeterminant(EffectiveIndex2D& self, py::object val) {
-    return UFUNC<dcomplex>([&](dcomplex x) { return self.getDeterminant(x); }, val, "EffectiveIndex2D.get_determinant", "neff");
+    return PARALLEL_UFUNC<dcomplex>(self.getDeterminantFunction(), val, "EffectiveIndex2D.get_determinant", "neff");
 }
 py::object EffectiveIndex2D_getVertDeterminant(EffectiveIndex2D& self, py::object val) {
     return UFUNC<dcomplex>([&](dcomplex x) { return self.getVertDeterminant(x); }, val, "EffectiveIndex2D.get_vert_determinant",
@@ -112,8 +112,7 @@ py::object EffectiveIndex2D_getVertDeterminant(EffectiveIndex2D& self, py::objec
 }
 
 static py::object EffectiveFrequencyCyl_getDeterminant(EffectiveFrequencyCyl& self, py::object val, int m) {
-    return UFUNC<dcomplex>([&](dcomplex x) { return self.getDeterminant(x, m); }, val,
-                           "EffectiveFrequencyCyl.get_determinant", "lam");
+    return PARALLEL_UFUNC<dcomplex>(self.getDeterminantFunction(m), val, "EffectiveFrequencyCyl.get_determinant", "lam");
 }
 static py::object EffectiveFrequencyCyl_getVertDeterminant(EffectiveFrequencyCyl& self, py::object val) {
     return UFUNC<dcomplex>([&](dcomplex x) { return self.getVertDeterminant(x); }, val,
@@ -150,7 +149,10 @@ void EffectiveIndex2D_setMirrors(EffectiveIndex2D& self, py::object value) {
 }
 
 static size_t EffectiveIndex2D_findMode(EffectiveIndex2D& self, py::object neff, py::object symmetry) {
-    return self.findMode(py::extract<dcomplex>(neff), parseSymmetry(symmetry));
+    dcomplex start = py::extract<dcomplex>(neff);
+    EffectiveIndex2D::Symmetry sym = parseSymmetry(symmetry);
+    ReleaseGIL nogil;
+    return self.findMode(start, sym);
 }
 
 std::vector<size_t> EffectiveIndex2D_findModes(EffectiveIndex2D& self,
@@ -160,11 +162,16 @@ std::vector<size_t> EffectiveIndex2D_findModes(EffectiveIndex2D& self,
                                                size_t resteps,
                                                size_t imsteps,
                                                dcomplex eps) {
-    return self.findModes(neff1, neff2, parseSymmetry(symmetry), resteps, imsteps, eps);
+    EffectiveIndex2D::Symmetry sym = parseSymmetry(symmetry);
+    ReleaseGIL nogil;
+    return self.findModes(neff1, neff2, sym, resteps, imsteps, eps);
 }
 
 static size_t EffectiveIndex2D_setMode(EffectiveIndex2D& self, py::object neff, py::object symmetry) {
-    return self.setMode(py::extract<dcomplex>(neff), parseSymmetry(symmetry));
+    dcomplex value = py::extract<dcomplex>(neff);
+    EffectiveIndex2D::Symmetry sym = parseSymmetry(symmetry);
+    ReleaseGIL nogil;
+    return self.setMode(value, sym);
 }
 
 std::string EffectiveIndex2D_Mode_str(const EffectiveIndex2D::Mode& self) {
@@ -187,7 +194,19 @@ std::string EffectiveIndex2D_Mode_repr(const EffectiveIndex2D::Mode& self) {
 }
 
 static size_t EffectiveFrequencyCyl_findMode(EffectiveFrequencyCyl& self, py::object lam, int m) {
-    return self.findMode(py::extract<dcomplex>(lam), m);
+    dcomplex start = py::extract<dcomplex>(lam);
+    ReleaseGIL nogil;
+    return self.findMode(start, m);
+}
+
+static size_t EffectiveFrequencyCyl_setMode(EffectiveFrequencyCyl& self, dcomplex lam, int m) {
+    ReleaseGIL nogil;
+    return self.setMode(lam, m);
+}
+
+static size_t EffectiveFrequencyCyl_setModeLoss(EffectiveFrequencyCyl& self, double lam, double loss, int m) {
+    ReleaseGIL nogil;
+    return self.setMode(lam, loss, m);
 }
 
 double EffectiveFrequencyCyl_Mode_ModalLoss(const EffectiveFrequencyCyl::Mode& mode) { return imag(2e4 * 2e3 * PI / mode.lam); }
@@ -235,11 +254,21 @@ template <typename Solver> static double Mode_total_absorption(typename Solver::
 static double Mode_gain_integral(EffectiveFrequencyCyl::Mode& self) { return self.solver->getGainIntegral(self); }
 
 template <typename Solver> static py::object getDeltaNeff(Solver& self, py::object pos) {
-    return UFUNC<dcomplex, double>([&](double p) { return self.getDeltaNeff(p); }, pos, "EffectiveIndex2D.get_delta_neff", "pos");
+    return UFUNC<dcomplex, double>(
+        [&](double p) {
+            ReleaseGIL nogil;
+            return self.getDeltaNeff(p);
+        },
+        pos, "EffectiveIndex2D.get_delta_neff", "pos");
 }
 
 static py::object EffectiveFrequencyCyl_getNNg(EffectiveFrequencyCyl& self, py::object pos) {
-    return UFUNC<dcomplex, double>([&](double p) { return self.getNNg(p); }, pos, "EffectiveFrequencyCyl.get_nng", "pos");
+    return UFUNC<dcomplex, double>(
+        [&](double p) {
+            ReleaseGIL nogil;
+            return self.getNNg(p);
+        },
+        pos, "EffectiveFrequencyCyl.get_nng", "pos");
 }
 
 /**
@@ -269,15 +298,16 @@ BOOST_PYTHON_MODULE(effective) {
         METHOD(set_simple_mesh, setSimpleMesh, u8"Set simple mesh based on the geometry objects bounding boxes.");
         // METHOD(set_horizontal_mesh, setHorizontalMesh, "Set custom mesh in horizontal direction, vertical one is based on the
         // geometry objects bounding boxes", "points");
-        METHOD(search_vneff, searchVNeffs,
-               u8"Find the effective indices in the vertical direction within the specified range\n"
-               u8"using global method.\n\n"
-               u8"Args:\n" SEARCH_ARGS_DOC
-               "\n"
-               u8"Returns:\n"
-               u8"    list of floats: List of the found effective indices in the vertical\n"
-               u8"    direction.\n",
-               arg("start") = 0., arg("end") = 0., arg("resteps") = 256, arg("imsteps") = 64, arg("eps") = dcomplex(1e-6, 1e-9));
+        METHOD_RELEASING_GIL(search_vneff, searchVNeffs,
+                             u8"Find the effective indices in the vertical direction within the specified range\n"
+                             u8"using global method.\n\n"
+                             u8"Args:\n" SEARCH_ARGS_DOC
+                             "\n"
+                             u8"Returns:\n"
+                             u8"    list of floats: List of the found effective indices in the vertical\n"
+                             u8"    direction.\n",
+                             arg("start") = 0., arg("end") = 0., arg("resteps") = 256, arg("imsteps") = 64,
+                             arg("eps") = dcomplex(1e-6, 1e-9));
         solver.def("find_mode", &EffectiveIndex2D_findMode,
                    u8"Compute the mode near the specified effective index.\n\n"
                    u8"Args:\n"
@@ -421,16 +451,16 @@ BOOST_PYTHON_MODULE(effective) {
                    u8"Returns:\n"
                    u8"    integer: Index in the :attr:`modes` list of the found mode.\n",
                    (arg("lam"), arg("m") = 0));
-        METHOD(find_modes, findModes,
-               u8"Find the modes within the specified range using global method.\n\n"
-               u8"Args:\n"
-               u8"    m (int): Angular mode number (O for LP0x, 1 for LP1x, etc.).\n\n" SEARCH_ARGS_DOC
-               "\n"
-               u8"Returns:\n"
-               u8"    list of integers: List of the indices in the :attr:`modes` list of the found\n"
-               u8"    modes.\n",
-               arg("start") = 0., arg("end") = 0., arg("m") = 0, arg("resteps") = 256, arg("imsteps") = 64,
-               arg("eps") = dcomplex(1e-6, 1e-9));
+        METHOD_RELEASING_GIL(find_modes, findModes,
+                             u8"Find the modes within the specified range using global method.\n\n"
+                             u8"Args:\n"
+                             u8"    m (int): Angular mode number (O for LP0x, 1 for LP1x, etc.).\n\n" SEARCH_ARGS_DOC
+                             "\n"
+                             u8"Returns:\n"
+                             u8"    list of integers: List of the indices in the :attr:`modes` list of the found\n"
+                             u8"    modes.\n",
+                             arg("start") = 0., arg("end") = 0., arg("m") = 0, arg("resteps") = 256, arg("imsteps") = 64,
+                             arg("eps") = dcomplex(1e-6, 1e-9));
         solver.def("get_vert_determinant", &EffectiveFrequencyCyl_getVertDeterminant,
                    u8"Get vertical modal determinant for debugging purposes.\n\n"
                    u8"Args:\n"
@@ -450,9 +480,8 @@ BOOST_PYTHON_MODULE(effective) {
                    u8"    complex or list of complex: Determinant at the effective index *neff* or\n"
                    u8"    an array matching its size.\n",
                    (py::arg("lam"), py::arg("m") = 0));
-        solver.def("set_mode", (size_t(EffectiveFrequencyCyl::*)(dcomplex, int)) & EffectiveFrequencyCyl::setMode,
-                   (py::arg("lam"), py::arg("m") = 0));
-        solver.def("set_mode", (size_t(EffectiveFrequencyCyl::*)(double, double, int)) & EffectiveFrequencyCyl::setMode,
+        solver.def("set_mode", &EffectiveFrequencyCyl_setMode, (py::arg("lam"), py::arg("m") = 0));
+        solver.def("set_mode", &EffectiveFrequencyCyl_setModeLoss,
                    u8"Set the current mode the specified wavelength.\n\n"
                    u8"Args:\n"
                    u8"    lam (float of complex): Mode wavelength.\n"
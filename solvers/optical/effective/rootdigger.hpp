@@ -23,6 +23,9 @@ struct RootDigger {
 
     typedef std::function<dcomplex(dcomplex)> function_type;
 
+    /// Function computing values for several arguments at once: \c fun(arguments, values, count)
+    typedef std::function<void(const dcomplex*, dcomplex*, size_t)> multi_function_type;
+
     /// Root finding method
     enum Method {
         ROOT_MULLER,
@@ -64,6 +67,9 @@ struct RootDigger {
     // Solver method computing the value to zero
     function_type val_function;
 
+    // Optional solver method computing several values at once
+    multi_function_type multi_function;
+
     // Value writelog
     DataLog<dcomplex,dcomplex>& log_value;
 
@@ -76,6 +82,19 @@ struct RootDigger {
         return NAN;
     }
 
+    // Compute values for several independent arguments, at once if the solver provides such method
+    inline void valFunctions(const dcomplex* x, dcomplex* values, size_t n) const {
+        if (!multi_function) {
+            for (size_t i = 0; i < n; ++i) values[i] = valFunction(x[i]);
+            return;
+        }
+        try {
+            multi_function(x, values, n);
+        } catch (...) {
+            log_value.throwError(x[0]);
+        }
+    }
+
   public:
 
     // Rootdigger parameters
@@ -108,6 +127,21 @@ struct RootDigger {
      */
     static std::unique_ptr<RootDigger> get(Solver* solver, const function_type& func, DataLog<dcomplex,dcomplex>& detlog, const Params& params);
 
+    /**
+     * Get root digger for given function and params
+     * \param func function to find zero of
+     * \param multi_func function computing values for several arguments at once
+     * \param detlog output logger
+     * \param params rootdigger params
+     * \return unique pointer to rootdigger
+     */
+    static std::unique_ptr<RootDigger> get(Solver* solver, const function_type& func, const multi_function_type& multi_func,
+                                           DataLog<dcomplex,dcomplex>& detlog, const Params& params) {
+        auto result = get(solver, func, detlog, params);
+        result->multi_function = multi_func;
+        return result;
+    }
+
     /// Read configuration from xml
     static void readRootDiggerConfig(XMLReader& reader, Params& params);
 };
@@ -116,6 +116,18 @@ class EffectiveFrequency(unittest.TestCase):
         self.assertEqual(len(self.solver.modes), 1)
         self.assertAlmostEqual(self.solver.modes[m].lam, 979.702-0.021j, 3)
 
+    def testFindModesThreaded(self):
+        # Stripes are computed in parallel and log from worker threads, which hangs if find_modes keeps the GIL
+        level = config.log.level
+        config.log.level = 'detail'
+        plask._plask._set_thread_count(4)
+        try:
+            found = self.solver.find_modes(979.5-0.05j, 980.0+0.01j, resteps=32, imsteps=16)
+        finally:
+            config.log.level = level
+        self.assertNotEqual(len(found), 0)
+        self.assertAlmostEqual(self.solver.modes[found[0]].lam, 979.702-0.021j, 2)
+
     def testThreshold(self):
         try:
             from scipy.optimize import brentq
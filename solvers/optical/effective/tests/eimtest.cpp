@@ -1,7 +1,7 @@
-/* 
+/*
  * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
  * Copyright (c) 2022 Lodz University of Technology
- * 
+ *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation, version 3.
@@ -15,11 +15,156 @@
 #define BOOST_TEST_MODULE "plask.optical.effective solver test"
 #include <boost/test/unit_test.hpp>
 
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
 #include <plask/plask.hpp>
 #include "../eim.hpp"
+#include "../efm.hpp"
+#include "../bisection.hpp"
 using namespace plask;
 using namespace plask::optical::effective;
 
+typedef std::vector<dcomplex,aligned_allocator<dcomplex>> NVector;
+
+// Vertical layers: semi-infinite substrate, waveguide with a lossy core, and semi-infinite air
+static const std::initializer_list<double> LAYERS = {0., 0.5, 0.6, 0.7, 1.2};
+static const NVector NR = {3.2, 3.3, dcomplex(3.5, -0.002), 3.6, 3.3, 1.0};
+static const NVector NG = {3.5, 3.6, dcomplex(3.8, -0.002), 3.9, 3.6, 1.0};
+
+static shared_ptr<RectangularMesh<2>> layersMesh() {
+    return plask::make_shared<RectangularMesh<2>>(plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 1.}),
+                                                  plask::make_shared<OrderedAxis>(LAYERS));
+}
+
+// Determinant computed with the full transfer matrices, as before batching
+static dcomplex referenceDet(const std::vector<double>& d, const NVector& kz, const NVector& f) {
+    dcomplex Tff = 1., Tfb = 0., Tbf = 0., Tbb = 1.;
+    for (size_t i = 0; i < kz.size()-1; ++i) {
+        dcomplex phas = exp(- I * kz[i] * d[i]);
+        dcomplex n = 0.5 * kz[i]/kz[i+1] * f[i]*f[i];
+        dcomplex ff = (0.5+n) * phas, fb = (0.5-n) / phas,
+                 bf = (0.5-n) * phas, bb = (0.5+n) / phas;
+        dcomplex tff = ff * Tff + fb * Tbf, tfb = ff * Tfb + fb * Tbb,
+                 tbf = bf * Tff + bb * Tbf, tbb = bf * Tfb + bb * Tbb;
+        Tff = tff; Tfb = tfb; Tbf = tbf; Tbb = tbb;
+    }
+    return Tbb;    // F0 = 0    Bn = 0
+}
+
+// Layer thicknesses as used by detS1 (the first layer is semi-infinite)
+static std::vector<double> thicknesses() {
+    std::vector<double> layers(LAYERS), d(layers.size()+1, 0.);
+    for (size_t i = 1; i < layers.size(); ++i) d[i] = layers[i] - layers[i-1];
+    return d;
+}
+
+struct TestEIM: public EffectiveIndex2D {
+    TestEIM(Polarization pol) {
+        mesh = layersMesh();
+        ybegin = 0;
+        yend = mesh->axis[1]->size() + 1;
+        k0 = 2e3*PI / 980.;
+        polarization = pol;
+    }
+
+    using EffectiveIndex2D::detS1;
+    using EffectiveIndex2D::DETS1_BATCH;
+
+    dcomplex reference(dcomplex x) const {
+        NVector ky(NR.size()), f(NR.size(), 1.);
+        for (size_t i = 0; i < NR.size(); ++i) {
+            ky[i] = k0 * sqrt(NR[i]*NR[i] - x*x);
+            if (imag(ky[i]) > 0.) ky[i] = -ky[i];
+            if (polarization == TM && i+1 < NR.size()) f[i] = NR[i+1]/NR[i];
+        }
+        return referenceDet(thicknesses(), ky, f);
+    }
+};
+
+struct TestEFM: public EffectiveFrequencyCyl {
+    TestEFM() {
+        mesh = layersMesh();
+        zbegin = 0;
+        zsize = mesh->axis[1]->size() + 1;
+        k0 = 2e3*PI / 980.;
+    }
+
+    using EffectiveFrequencyCyl::detS1;
+    using EffectiveFrequencyCyl::DETS1_BATCH;
+
+    dcomplex reference(dcomplex v) const {
+        NVector kz(NR.size()), f(NR.size(), 1.);
+        for (size_t i = 0; i < NR.size(); ++i) {
+            kz[i] = k0 * sqrt(NR[i]*NR[i] - v * NR[i]*NG[i]);
+            if (real(kz[i]) < 0.) kz[i] = -kz[i];
+        }
+        return referenceDet(thicknesses(), kz, f);
+    }
+};
+
+// Trial points near the guided modes, different in each lane
+static std::vector<dcomplex> trialPoints(dcomplex start, dcomplex step, size_t n) {
+    std::vector<dcomplex> points(n);
+    for (size_t i = 0; i < n; ++i) points[i] = start + double(i) * step;
+    return points;
+}
+
 BOOST_AUTO_TEST_SUITE(eimtest)
 
+BOOST_AUTO_TEST_CASE(batched_dets1) {
+    for (auto pol: {EffectiveIndex2D::TE, EffectiveIndex2D::TM}) {
+        TestEIM solver(pol);
+        // Cross the batch size, so both full and partial batches are checked
+        for (size_t n = 1; n <= 2 * TestEIM::DETS1_BATCH + 1; ++n) {
+            auto x = trialPoints(dcomplex(3.25, -1e-3), dcomplex(0.04, 2e-4), n);
+            std::vector<dcomplex> dets(n);
+            solver.detS1(x.data(), dets.data(), n, NR);
+            for (size_t i = 0; i < n; ++i) {
+                dcomplex scalar = solver.detS1(x[i], NR), ref = solver.reference(x[i]);
+                BOOST_CHECK_SMALL(abs(dets[i] - scalar), 1e-14 * abs(scalar));
+                BOOST_CHECK_SMALL(abs(dets[i] - ref), 1e-12 * abs(ref));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batched_find_zeros) {
+    TestEIM solver(EffectiveIndex2D::TE);
+    dcomplex corner0(3.21, -0.01), corner1(3.59, 0.01);
+    auto ranges = findZeros(&solver, [&](const dcomplex* x, dcomplex* dets, size_t n) { solver.detS1(x, dets, n, NR); },
+                            corner0, corner1, 50, 4, dcomplex(1e-6, 1e-6));
+    auto reference = findZeros(&solver, [&](dcomplex x) { return solver.reference(x); },
+                               corner0, corner1, 50, 4, dcomplex(1e-6, 1e-6));
+    BOOST_REQUIRE(!reference.empty());
+    BOOST_REQUIRE_EQUAL(ranges.size(), reference.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        BOOST_CHECK_SMALL(abs(ranges[i].first - reference[i].first), 1e-9);
+        BOOST_CHECK_SMALL(abs(ranges[i].second - reference[i].second), 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(efmtest)
+
+BOOST_AUTO_TEST_CASE(batched_dets1) {
+    TestEFM solver;
+    for (size_t n = 1; n <= 2 * TestEFM::DETS1_BATCH + 1; ++n) {
+        auto v = trialPoints(dcomplex(-0.2, 1e-4), dcomplex(0.03, -2e-5), n);
+        std::vector<dcomplex> dets(n);
+        solver.detS1(v.data(), dets.data(), n, NR, NG);
+        for (size_t i = 0; i < n; ++i) {
+            dcomplex scalar = solver.detS1(v[i], NR, NG), ref = solver.reference(v[i]);
+            BOOST_CHECK_SMALL(abs(dets[i] - scalar), 1e-14 * abs(scalar));
+            BOOST_CHECK_SMALL(abs(dets[i] - ref), 1e-12 * abs(ref));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
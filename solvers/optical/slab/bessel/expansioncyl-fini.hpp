@@ -38,6 +38,8 @@ struct PLASK_SOLVER_API ExpansionBesselFini : public ExpansionBessel {
     /// Free allocated memory
     void reset() override;
 
+    std::uint64_t matricesKind() const override { return 3 | std::uint64_t(unsigned(m)) << 8; }
+
     void getMatrices(size_t layer, cmatrix& RE, cmatrix& RH) override;
 
   protected:
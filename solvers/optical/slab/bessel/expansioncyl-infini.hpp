@@ -36,6 +36,8 @@ struct PLASK_SOLVER_API ExpansionBesselInfini: public ExpansionBessel {
     /// Perform m-specific initialization
     void init2() override;
 
+    std::uint64_t matricesKind() const override { return 4 | std::uint64_t(unsigned(m)) << 8; }
+
     void getMatrices(size_t layer, cmatrix& RE, cmatrix& RH) override;
 
   protected:
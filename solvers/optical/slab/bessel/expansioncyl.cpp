@@ -61,6 +61,7 @@ void ExpansionBessel::init1() {
 }
 
 void ExpansionBessel::reset() {
+    clearSpectralCache();
     layers_integrals.clear();
     segments.clear();
     kpts.clear();
@@ -164,19 +165,26 @@ void ExpansionBessel::afterGetRefractiveIndex() {
 }
 
 
-Tensor3<dcomplex> ExpansionBessel::getEps(size_t layer, size_t ri, double r, double matz, double lam, double glam) {
-    Tensor3<dcomplex> eps;
-    {
-        OmpLockGuard<OmpNestLock> lock;  // this must be declared before `material` to guard its destruction
-        auto material = SOLVER->getGeometry()->getMaterial(vec(r, matz));
-        lock = material->lock();
-        double T, cc;
-        std::tie(T, cc) = getTC(layer, ri);
-        eps = material->NR(lam, T, cc);
-        if (isnan(eps.c00) || isnan(eps.c11) || isnan(eps.c22) || isnan(eps.c01))
-            throw BadInput(solver->getId(), "Complex refractive index (NR) for {} is NaN at lam={}nm, T={}K, n={}/cm3",
-                           material->name(), lam, T, cc);
+DataVector<Tensor3<dcomplex>> ExpansionBessel::getLayerNR(size_t layer, double matz, double lam, bool cached) {
+    auto geometry = SOLVER->getGeometry();
+    auto raxis = mesh->tran();
+    std::vector<shared_ptr<Material>> materials(raxis->size());
+    DataVector<double> T(raxis->size()), C(raxis->size());
+    for (size_t ri = 0; ri != raxis->size(); ++ri) {
+        std::tie(T[ri], C[ri]) = getTC(layer, ri);
+        materials[ri] = geometry->getMaterial(vec(raxis->at(ri), matz));
     }
+    return cached? getCachedNR(layer, 0, materials, lam, T, C) : getNR(materials, lam, T, C);
+}
+
+Tensor3<dcomplex> ExpansionBessel::getPointNR(size_t layer, size_t ri, double r, double matz, double lam) {
+    std::vector<shared_ptr<Material>> materials{SOLVER->getGeometry()->getMaterial(vec(r, matz))};
+    DataVector<double> T(1), C(1);
+    std::tie(T[0], C[0]) = getTC(layer, ri);
+    return getNR(materials, lam, T, C)[0];
+}
+
+Tensor3<dcomplex> ExpansionBessel::getEps(size_t layer, size_t ri, double r, double matz, double glam, Tensor3<dcomplex> eps) {
     if (!is_zero(eps.c00 - eps.c11) || eps.c01 != 0.)
         throw BadInput(solver->getId(), "Lateral anisotropy not allowed for this solver");
     if (gain_connected && solver->lgained[layer]) {
@@ -248,7 +256,9 @@ void ExpansionBessel::layerIntegrals(size_t layer, double lam, double glam) {
             pmlr = rbounds[pmlseg];
         }
     } else {
-        Tensor3<dcomplex> eps0 = getEps(layer, mesh->tran()->size() - 1, rbounds[rbounds.size() - 1] + 0.001, matz, lam, glam);
+        size_t ri0 = mesh->tran()->size() - 1;
+        double r0 = rbounds[rbounds.size() - 1] + 0.001;
+        Tensor3<dcomplex> eps0 = getEps(layer, ri0, r0, matz, glam, getPointNR(layer, ri0, r0, matz, lam));
         eps0.sqr_inplace();
         epsp0 = eps0.c00;
         if (SOLVER->rule != BesselSolverCyl::RULE_OLD) {
@@ -269,6 +279,8 @@ void ExpansionBessel::layerIntegrals(size_t layer, double lam, double glam) {
     aligned_unique_ptr<dcomplex> epsr_data(aligned_malloc<dcomplex>(nr));
     aligned_unique_ptr<dcomplex> epsz_data(aligned_malloc<dcomplex>(nr));
 
+    DataVector<Tensor3<dcomplex>> nrs = getLayerNR(layer, matz, lam, true);
+
     // Compute integrals
     for (size_t ri = 0, wi = 0, seg = 0, nw = segments[0].weights.size(); ri != nr; ++ri, ++wi) {
         if (wi == nw) {
@@ -278,7 +290,7 @@ void ExpansionBessel::layerIntegrals(size_t layer, double lam, double glam) {
         double r = raxis->at(ri);
         double w = segments[seg].weights[wi] * segments[seg].D;
 
-        Tensor3<dcomplex> eps = getEps(layer, ri, r, matz, lam, glam);
+        Tensor3<dcomplex> eps = getEps(layer, ri, r, matz, glam, nrs[ri]);
         if (ri >= pmli) {
             dcomplex f = 1. + (SOLVER->pml.factor - 1.) * pow((r - pmlr) / SOLVER->pml.size, SOLVER->pml.order);
             eps.c00 *= f;
@@ -460,9 +472,9 @@ LazyData<Tensor3<dcomplex>> ExpansionBessel::getMaterialNR(size_t layer,
 
     auto raxis = mesh->tran();
 
-    DataVector<Tensor3<dcomplex>> nrs(raxis->size());
+    DataVector<Tensor3<dcomplex>> nrs = getLayerNR(layer, level->vpos(), lam);
     for (size_t i = 0; i != nrs.size(); ++i) {
-        Tensor3<dcomplex> eps = getEps(layer, i, raxis->at(i), level->vpos(), lam, glam);
+        Tensor3<dcomplex> eps = getEps(layer, i, raxis->at(i), level->vpos(), glam, nrs[i]);
         nrs[i] = eps.sqrt();
     }
 
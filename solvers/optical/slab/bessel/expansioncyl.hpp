@@ -147,7 +147,26 @@ struct PLASK_SOLVER_API ExpansionBessel : public Expansion {
 
     void beforeLayersIntegrals(double lam, double glam) override;
 
-    Tensor3<dcomplex> getEps(size_t layer, size_t ri, double r, double matz, double lam, double glam);
+    /**
+     * Get refractive indices in all radial points of the layer
+     * \param layer layer number
+     * \param matz vertical position of the layer
+     * \param lam wavelength
+     * \param cached use the spectral cache (only if \a matz is the position of the layer)
+     */
+    DataVector<Tensor3<dcomplex>> getLayerNR(size_t layer, double matz, double lam, bool cached = false);
+
+    /**
+     * Get refractive index in a single point of the layer
+     * \param layer layer number
+     * \param ri index of the radial mesh point used for temperature and carriers concentration
+     * \param r radial position
+     * \param matz vertical position of the layer
+     * \param lam wavelength
+     */
+    Tensor3<dcomplex> getPointNR(size_t layer, size_t ri, double r, double matz, double lam);
+
+    Tensor3<dcomplex> getEps(size_t layer, size_t ri, double r, double matz, double glam, Tensor3<dcomplex> eps);
 
     void layerIntegrals(size_t layer, double lam, double glam) override;
 
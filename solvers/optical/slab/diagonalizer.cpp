@@ -18,6 +18,10 @@
 
 #include <algorithm>
 #include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
 
 #ifdef OPENMP_FOUND
 #   include <omp.h>
@@ -31,6 +35,182 @@ Diagonalizer::Diagonalizer(Expansion* src) :
 Diagonalizer::~Diagonalizer() {}
 
 
+namespace {
+    const char DIAGONALIZATION_FILE_MAGIC[8] = {'P', 'L', 'a', 'S', 'K', 'D', 'G', '3'};
+
+    inline void hashWord(std::uint64_t& h0, std::uint64_t& h1, std::uint64_t word) {
+        h0 = (h0 ^ word) * 0x100000001b3ull;
+        h1 = (h1 + word) * 0x9e3779b97f4a7c15ull;
+        h1 ^= h1 >> 29;
+    }
+
+    inline void hashData(std::uint64_t& h0, std::uint64_t& h1, const dcomplex* data, std::size_t n) {
+        const std::uint64_t* words = reinterpret_cast<const std::uint64_t*>(data);
+        for (std::size_t i = 0, end = 2*n; i != end; ++i) hashWord(h0, h1, words[i]);
+    }
+
+    inline std::size_t count(const cdiagonal& matrix) { return matrix.size(); }
+    inline std::size_t count(const cmatrix& matrix) { return matrix.rows() * matrix.cols(); }
+
+    inline bool equal(const cmatrix& a, const cmatrix& b) {
+        return a.rows() == b.rows() && a.cols() == b.cols() &&
+               std::memcmp(a.data(), b.data(), count(a) * sizeof(dcomplex)) == 0;
+    }
+
+    template <typename EntryT>
+    inline void copyEntry(EntryT& dst, const EntryT& src) {
+        std::copy_n(src.gamma.data(), src.gamma.size(), dst.gamma.data());
+        std::copy_n(src.Te.data(), count(src.Te), dst.Te.data());
+        std::copy_n(src.Th.data(), count(src.Th), dst.Th.data());
+        std::copy_n(src.Te1.data(), count(src.Te1), dst.Te1.data());
+        std::copy_n(src.Th1.data(), count(src.Th1), dst.Th1.data());
+    }
+
+    template <typename EntryT>
+    inline EntryT copyEntry(const EntryT& src) {
+        return EntryT { src.gamma.copy(), src.Te.copy(), src.Th.copy(), src.Te1.copy(), src.Th1.copy() };
+    }
+}
+
+bool DiagonalizationCache::Key::matches(const Key& other) const {
+    return hash[0] == other.hash[0] && hash[1] == other.hash[1] && kind == other.kind && diagonal == other.diagonal &&
+           equal(RE, other.RE) && equal(RH, other.RH);
+}
+
+std::string DiagonalizationCache::Key::str() const {
+    return format("{:016x}{:016x}", hash[0], hash[1]);
+}
+
+DiagonalizationCache::DiagonalizationCache(std::size_t capacity, const std::string& directory):
+    capacity(capacity), directory(directory)
+{
+    if (!directory.empty()) {
+        boost::system::error_code err;
+        boost::filesystem::create_directories(directory, err);
+        if (err) throw BadInput("DiagonalizationCache", "cannot create directory '{}': {}", directory, err.message());
+    }
+}
+
+DiagonalizationCache::Key DiagonalizationCache::key(std::uint64_t kind, const cmatrix& RE, const cmatrix& RH,
+                                                    bool diagonal) {
+    std::uint64_t h0 = 0xcbf29ce484222325ull, h1 = 0x84222325cbf29ce4ull;
+    hashWord(h0, h1, kind);
+    hashWord(h0, h1, RE.rows());
+    hashWord(h0, h1, diagonal? 1 : 0);
+    hashData(h0, h1, RE.data(), count(RE));
+    hashData(h0, h1, RH.data(), count(RH));
+    return Key{{h0, h1}, kind, diagonal, RE.copy(), RH.copy()};
+}
+
+bool DiagonalizationCache::load(const Key& key, Entry& result) {
+    {
+        OmpLockGuard<OmpLock> guard(lock);
+        auto found = entries.find(key);
+        if (found != entries.end() && found->first.matches(key)) {
+            const Entry& entry = found->second.first;
+            if (entry.gamma.size() == result.gamma.size()) {
+                copyEntry(result, entry);
+                order.splice(order.begin(), order, found->second.second);
+                return true;
+            }
+        }
+    }
+    if (directory.empty() || !read(key, result)) return false;
+    if (capacity != 0) insert(key, copyEntry(result));
+    return true;
+}
+
+void DiagonalizationCache::store(const Key& key, const Entry& entry) {
+    if (capacity != 0) insert(key, copyEntry(entry));
+    if (!directory.empty()) write(key, entry);
+}
+
+void DiagonalizationCache::clear() {
+    OmpLockGuard<OmpLock> guard(lock);
+    entries.clear();
+    order.clear();
+}
+
+void DiagonalizationCache::insert(const Key& key, Entry&& entry) {
+    OmpLockGuard<OmpLock> guard(lock);
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        // Replace the entry also if it has been made for other matrices with the same hash
+        order.erase(found->second.second);
+        entries.erase(found);
+    }
+    while (entries.size() >= capacity) {
+        entries.erase(order.back());
+        order.pop_back();
+    }
+    order.push_front(key);
+    entries.emplace(key, std::make_pair(std::move(entry), order.begin()));
+}
+
+bool DiagonalizationCache::read(const Key& key, Entry& entry) const {
+    std::ifstream file((boost::filesystem::path(directory) / (key.str() + ".diag")).string(), std::ios::binary);
+    if (!file) return false;
+    char magic[sizeof(DIAGONALIZATION_FILE_MAGIC)];
+    std::uint64_t N, kind, diagonal;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&N), sizeof(N));
+    file.read(reinterpret_cast<char*>(&kind), sizeof(kind));
+    file.read(reinterpret_cast<char*>(&diagonal), sizeof(diagonal));
+    if (!file || !std::equal(magic, magic + sizeof(magic), DIAGONALIZATION_FILE_MAGIC) || N != entry.gamma.size() ||
+        N != key.RE.rows() || kind != key.kind || diagonal != std::uint64_t(key.diagonal))
+        return false;
+    // Read to the temporary storage, so the result is not modified if the file is truncated or made for other matrices
+    Key stored { {key.hash[0], key.hash[1]}, key.kind, key.diagonal, cmatrix(N, N), cmatrix(N, N) };
+    file.read(reinterpret_cast<char*>(stored.RE.data()), N * N * sizeof(dcomplex));
+    file.read(reinterpret_cast<char*>(stored.RH.data()), N * N * sizeof(dcomplex));
+    if (file && !stored.matches(key)) {
+        writelog(LOG_DEBUG, "Ignoring diagonalization cache file for {} made for other matrices", key.str());
+        return false;
+    }
+    Entry data { cdiagonal(N), cmatrix(N, N), cmatrix(N, N), cmatrix(N, N), cmatrix(N, N) };
+    file.read(reinterpret_cast<char*>(data.gamma.data()), N * sizeof(dcomplex));
+    for (cmatrix* matrix: {&data.Te, &data.Th, &data.Te1, &data.Th1})
+        file.read(reinterpret_cast<char*>(matrix->data()), count(*matrix) * sizeof(dcomplex));
+    if (!file) {
+        writelog(LOG_WARNING, "Ignoring corrupted diagonalization cache file for {}", key.str());
+        return false;
+    }
+    copyEntry(entry, data);
+    return true;
+}
+
+void DiagonalizationCache::write(const Key& key, const Entry& entry) const {
+    boost::filesystem::path path = boost::filesystem::path(directory) / (key.str() + ".diag");
+    if (boost::filesystem::exists(path)) return;
+    // Write to a unique temporary file and rename it, so concurrent jobs never see partially written entries
+    boost::filesystem::path temp = path;
+    temp += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+    {
+        std::ofstream file(temp.string(), std::ios::binary);
+        std::uint64_t N = entry.gamma.size(), diagonal = key.diagonal;
+        file.write(DIAGONALIZATION_FILE_MAGIC, sizeof(DIAGONALIZATION_FILE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&N), sizeof(N));
+        file.write(reinterpret_cast<const char*>(&key.kind), sizeof(key.kind));
+        file.write(reinterpret_cast<const char*>(&diagonal), sizeof(diagonal));
+        file.write(reinterpret_cast<const char*>(key.RE.data()), count(key.RE) * sizeof(dcomplex));
+        file.write(reinterpret_cast<const char*>(key.RH.data()), count(key.RH) * sizeof(dcomplex));
+        file.write(reinterpret_cast<const char*>(entry.gamma.data()), N * sizeof(dcomplex));
+        for (const cmatrix* matrix: {&entry.Te, &entry.Th, &entry.Te1, &entry.Th1})
+            file.write(reinterpret_cast<const char*>(matrix->data()), count(*matrix) * sizeof(dcomplex));
+        if (!file) {
+            file.close();
+            boost::system::error_code err;
+            boost::filesystem::remove(temp, err);
+            writelog(LOG_WARNING, "Cannot write diagonalization cache file '{}'", path.string());
+            return;
+        }
+    }
+    boost::system::error_code err;
+    boost::filesystem::rename(temp, path, err);
+    if (err) boost::filesystem::remove(temp, err);
+}
+
+
 SimpleDiagonalizer::SimpleDiagonalizer(Expansion* g) :
     Diagonalizer(g),  gamma(lcount), Te(lcount), Th(lcount), Te1(lcount), Th1(lcount)
 {
@@ -99,6 +279,19 @@ bool SimpleDiagonalizer::diagonalizeLayer(size_t layer)
     assert(!RE.isnan());
     assert(!RH.isnan());
 
+    // Reuse diagonalization of identical matrices if it has been already computed
+    DiagonalizationCache* cache = src->solver->diagonalization_cache.get();
+    DiagonalizationCache::Key key;
+    if (cache) {
+        key = DiagonalizationCache::key(src->matricesKind(), RE, RH, src->diagonalQE(layer));
+        DiagonalizationCache::Entry cached { gam, Te[layer], Th[layer], Te1[layer], Th1[layer] };
+        if (cache->load(key, cached)) {
+            writelog(LOG_DEBUG, "{}: Using cached diagonalization for layer {:d}", src->solver->getId(), layer);
+            diagonalized[layer] = true;
+            return true;
+        }
+    }
+
     TempMatrix temp = src->getTempMatrix();
     cmatrix QE(temp);
 
@@ -176,11 +369,12 @@ bool SimpleDiagonalizer::diagonalizeLayer(size_t layer)
             QE(i,j) = Te1[layer](j,i);
     // LU factorization of RE
     int ierr;
-    std::unique_ptr<int[]> ipiv(new int[N]);
-    zgetrf(int(N), int(N), RE.data(), int(N), ipiv.get(), ierr);
+    MatrixArena::Scope scope;
+    int* ipiv = MatrixArena::array<int>(N);
+    zgetrf(int(N), int(N), RE.data(), int(N), ipiv, ierr);
     if (ierr != 0) throw ComputationError(src->solver->getId(), "SimpleDiagonalizer: RE matrix singular");
     // the QE will contain inv(RE)^T * Te1^T
-    zgetrs('t', int(N), int(N), RE.data(), int(N), ipiv.get(), QE.data(), int(N), ierr);
+    zgetrs('t', int(N), int(N), RE.data(), int(N), ipiv, QE.data(), int(N), ierr);
     if (ierr != 0) throw ComputationError(src->solver->getId(), "SimpleDiagonalizer: Could not compute inv(RE)");
     // compute QE^T and store it in Th1
     for (std::size_t j = 0; j < N; j++) {
@@ -190,10 +384,56 @@ bool SimpleDiagonalizer::diagonalizeLayer(size_t layer)
     }
     assert(!Th1[layer].isnan());
 
+    if (cache) cache->store(key, DiagonalizationCache::Entry { gam, Te[layer], Th[layer], Te1[layer], Th1[layer] });
+
     // Mark that layer has been diagonalized
     diagonalized[layer] = true;
 
     return true;
 }
 
+
+
+DiagonalizationPipeline::DiagonalizationPipeline(Diagonalizer* diagonalizer, const std::vector<std::size_t>& stack,
+                                                 std::size_t start, std::size_t end):
+    diagonalizer(diagonalizer), next(0), ready(new std::atomic<bool>[diagonalizer->lcount]), failed(false)
+{
+    const std::size_t lcount = diagonalizer->lcount;
+    for (std::size_t l = 0; l != lcount; ++l) ready[l].store(diagonalizer->isDiagonalized(l), std::memory_order_relaxed);
+    std::vector<bool> queued(lcount, false);
+    auto enqueue = [&](std::size_t l) {
+        if (queued[l] || ready[l].load(std::memory_order_relaxed)) return;
+        queued[l] = true;
+        order.push_back(l);
+    };
+    // First layers needed by the transfer, in the order they are visited, and then all the remaining ones
+    const std::ptrdiff_t inc = (start <= end)? 1 : -1;
+    for (std::size_t n = start; n != end + inc; n += inc) enqueue(stack[n]);
+    for (std::size_t l = 0; l != lcount; ++l) enqueue(l);
+}
+
+bool DiagonalizationPipeline::work() {
+    if (failed.load(std::memory_order_acquire)) return false;
+    std::size_t i = next.fetch_add(1);
+    if (i >= order.size()) return false;
+    try {
+        diagonalizer->diagonalizeLayer(order[i]);
+    } catch(...) {
+        #pragma omp critical (DiagonalizationPipeline)
+        if (!error) error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+        return false;
+    }
+    ready[order[i]].store(true, std::memory_order_release);
+    return true;
+}
+
+void DiagonalizationPipeline::wait(std::size_t layer) {
+    while (!ready[layer].load(std::memory_order_acquire)) {
+        if (failed.load(std::memory_order_acquire))
+            throw ComputationError(diagonalizer->source()->solver->getId(), "Diagonalization of some layer failed");
+        if (!work()) std::this_thread::yield();
+    }
+}
+
 }}} // namespace plask::optical::slab
@@ -17,6 +17,11 @@
 #ifndef PLASK__SOLVER_SLAB_DIAGONALIZER_H
 #define PLASK__SOLVER_SLAB_DIAGONALIZER_H
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <map>
 #include <utility>
 
 #ifdef OPENMP_FOUND
@@ -30,6 +35,91 @@
 
 namespace plask { namespace optical { namespace slab {
 
+/**
+ * Cache of computed layer diagonalizations.
+ * Entries are addressed by the hash of the layer matrices RE and RH and of the expansion kind, which together
+ * fully determine the diagonalization. Hence an entry can be reused by any layer with identical matrices expanded
+ * in the same way, regardless of the solver or the computation it was created in. The cache is held in memory and optionally mirrored in a disk directory, so it can be
+ * reused by subsequent jobs. As the hash is not unique, each entry keeps a copy of its RE and RH matrices, which
+ * are compared with the requested ones on every lookup.
+ */
+class PLASK_SOLVER_API DiagonalizationCache
+{
+  public:
+    /// Content-based key of the diagonalization
+    struct Key {
+        std::uint64_t hash[2];      ///< Hash of the matrices used to address the entries
+        std::uint64_t kind;         ///< Expansion class and state determining the meaning of the matrices
+        bool diagonal;              ///< Is the layer QE matrix diagonal
+        cmatrix RE, RH;             ///< Copies of the layer matrices used to verify the entries
+        /// Order by the hash only
+        bool operator<(const Key& other) const {
+            return hash[0] < other.hash[0] || (hash[0] == other.hash[0] && hash[1] < other.hash[1]);
+        }
+        /// Check if the other key is made for exactly the same layer matrices
+        bool matches(const Key& other) const;
+        /// Hexadecimal representation of the hash used as a file name
+        std::string str() const;
+    };
+
+    /// Cached diagonalization
+    struct Entry {
+        cdiagonal gamma;            ///< Diagonal matrix Gamma
+        cmatrix Te, Th;             ///< Matrices TE and TH
+        cmatrix Te1, Th1;           ///< Matrices TE^-1 and TH^-1
+    };
+
+    /// Maximum number of entries held in memory
+    const std::size_t capacity;
+
+    /// Directory for on-disk entries (empty if the cache is held only in memory)
+    const std::string directory;
+
+    /**
+     * Create the cache
+     * \param capacity maximum number of entries held in memory
+     * \param directory directory for on-disk entries (empty for memory-only cache)
+     */
+    DiagonalizationCache(std::size_t capacity, const std::string& directory = "");
+
+    /**
+     * Compute the key of the layer
+     * \param kind expansion kind as returned by Expansion::matricesKind()
+     * \param RE, RH layer matrices (they are copied)
+     * \param diagonal \c true if the layer QE matrix is diagonal
+     */
+    static Key key(std::uint64_t kind, const cmatrix& RE, const cmatrix& RH, bool diagonal);
+
+    /**
+     * Find the cached diagonalization and copy it to the provided matrices
+     * \param key layer key
+     * \param[out] result matrices to fill; they must have the proper size
+     * \return \c true if the diagonalization was found
+     */
+    bool load(const Key& key, Entry& result);
+
+    /**
+     * Store the diagonalization in the cache
+     * \param key layer key
+     * \param entry computed matrices (they are copied)
+     */
+    void store(const Key& key, const Entry& entry);
+
+    /// Remove all entries from memory (on-disk entries are kept)
+    void clear();
+
+  private:
+    typedef std::list<Key> Order;
+    Order order;                                        ///< Keys in the order of use (most recent first)
+    std::map<Key, std::pair<Entry, Order::iterator>> entries;
+    OmpLock lock;
+
+    void insert(const Key& key, Entry&& entry);
+    bool read(const Key& key, Entry& entry) const;
+    void write(const Key& key, const Entry& entry) const;
+};
+
+
 /**
  * Base for the class determining and holding the necessary matrices
  * This is the abstract base class for all diagonalizers (multi-threaded,
@@ -43,7 +133,7 @@ class Diagonalizer
 {
   protected:
     Expansion* src;                     ///< Information about the matrices to diagonalize
-    std::vector<bool> diagonalized;     ///< True if the given layer was diagonalized
+    std::vector<char> diagonalized;     ///< True if the given layer was diagonalized (not packed, as it is written concurrently)
 
   public:
     const std::size_t lcount;           ///< Number of distinct layers
@@ -136,5 +226,71 @@ class SimpleDiagonalizer : public Diagonalizer
     const cmatrix& invTH(size_t layer) const override { return Th1[layer]; }
 };
 
+
+/**
+ * Parallel diagonalization of layers overlapped with the serial transfer through the stack.
+ *
+ * Layers are diagonalized by all available threads in the order, in which they are needed by the transfer.
+ * One of the threads performs the transfer and before using any layer it waits only for this particular layer,
+ * helping with the diagonalization of the others in the meantime. After the transfer is finished, the remaining
+ * layers are diagonalized as well.
+ */
+class PLASK_SOLVER_API DiagonalizationPipeline
+{
+    Diagonalizer* diagonalizer;
+
+    std::vector<std::size_t> order;                 ///< Layers in the order of diagonalization
+    std::atomic<std::size_t> next;                  ///< Position in \a order of the next layer to diagonalize
+    std::unique_ptr<std::atomic<bool>[]> ready;     ///< Flags indicating diagonalized layers
+    std::atomic<bool> failed;                       ///< Flag indicating that diagonalization of some layer failed
+    std::exception_ptr error;                       ///< Exception thrown by the failed diagonalization
+
+    /// Diagonalize the next layer
+    /// \return \c false if there are no more layers to diagonalize
+    bool work();
+
+  public:
+
+    /**
+     * Prepare the pipeline
+     * \param diagonalizer diagonalizer used to diagonalize layers
+     * \param stack layers stack
+     * \param start, end first and last stack position visited by the transfer
+     */
+    DiagonalizationPipeline(Diagonalizer* diagonalizer, const std::vector<std::size_t>& stack,
+                            std::size_t start, std::size_t end);
+
+    /**
+     * Wait until the layer is diagonalized.
+     * This must be called by the transfer before accessing any layer.
+     * \param layer layer index
+     */
+    void wait(std::size_t layer);
+
+    /**
+     * Run the transfer concurrently with the diagonalization
+     * \param transfer function performing the transfer through the stack
+     */
+    template <typename F>
+    void run(F transfer) {
+        std::exception_ptr transfer_error;
+        #pragma omp parallel
+        {
+            #pragma omp single nowait
+            {
+                try {
+                    transfer();
+                } catch(...) {
+                    transfer_error = std::current_exception();
+                    failed.store(true);
+                }
+            }
+            while (work());
+        }
+        if (error) std::rethrow_exception(error);  // more relevant than the error reported by wait
+        if (transfer_error) std::rethrow_exception(transfer_error);
+    }
+};
+
 }}} // namespace plask::optical::slab
 #endif // PLASK__SOLVER_SLAB_DIAGONALIZER_H
@@ -15,6 +15,20 @@
 
 namespace plask { namespace optical { namespace slab {
 
+namespace {
+
+    /// Release materials, each of them under its lock
+    void releaseMaterials(std::vector<shared_ptr<Material>>& materials) {
+        std::map<const Material*, std::vector<size_t>> groups;
+        for (size_t i = 0; i != materials.size(); ++i) groups[materials[i].get()].push_back(i);
+        for (const auto& group: groups) {
+            if (!group.first) continue;
+            OmpLockGuard<OmpNestLock> lock = group.first->lock();
+            for (size_t i: group.second) materials[i].reset();
+        }
+    }
+}
+
 void Expansion::getDiagonalEigenvectors(cmatrix& Te, cmatrix& Te1, const cmatrix&, const cdiagonal&)
 {
     size_t nr = Te.rows(), nc = Te.cols();
@@ -25,4 +39,103 @@ void Expansion::getDiagonalEigenvectors(cmatrix& Te, cmatrix& Te1, const cmatrix
         Te(i,i) = Te1(i,i) = 1.;
 }
 
+std::vector<DataVector<Tensor3<dcomplex>>> Expansion::evaluateNR(std::vector<shared_ptr<Material>>& materials,
+                                                                 const std::vector<double>& lams,
+                                                                 const DataVector<const double>& T,
+                                                                 const DataVector<const double>& n) const {
+    assert(T.size() == materials.size() && n.size() == materials.size());
+
+    std::map<const Material*, std::vector<size_t>> groups;
+    for (size_t i = 0; i != materials.size(); ++i) groups[materials[i].get()].push_back(i);
+
+    DataVector<double> wavelengths(lams.size());
+    std::copy(lams.begin(), lams.end(), wavelengths.begin());
+    std::vector<DataVector<Tensor3<dcomplex>>> result(lams.size());
+    for (auto& nrs: result) nrs.reset(materials.size());
+
+    auto check = [&](const Material* material, const Tensor3<dcomplex>& val, double lam, double Tk, double nk) {
+        if (isnan(val.c00) || isnan(val.c11) || isnan(val.c22) || isnan(val.c01))
+            throw BadInput(solver->getId(), "Complex refractive index (NR) for {} is NaN at lam={}nm, T={}K, n={}/cm3",
+                           material->name(), lam, Tk, nk);
+    };
+
+    try {
+        for (const auto& group: groups) {
+            const std::vector<size_t>& indices = group.second;
+            OmpLockGuard<OmpNestLock> lock = group.first->lock();  // this also guards destruction of the material
+            if (lams.size() == 1) {
+                DataVector<double> gT(indices.size()), gn(indices.size());
+                for (size_t k = 0; k != indices.size(); ++k) {
+                    gT[k] = T[indices[k]];
+                    gn[k] = n[indices[k]];
+                }
+                DataVector<Tensor3<dcomplex>> nr = group.first->batchNR(lams[0], gT, gn);
+                for (size_t k = 0; k != indices.size(); ++k) {
+                    check(group.first, nr[k], lams[0], gT[k], gn[k]);
+                    result[0][indices[k]] = nr[k];
+                }
+            } else {
+                for (size_t i: indices) {
+                    DataVector<Tensor3<dcomplex>> nr = group.first->spectralNR(wavelengths, T[i], n[i]);
+                    for (size_t w = 0; w != lams.size(); ++w) {
+                        check(group.first, nr[w], lams[w], T[i], n[i]);
+                        result[w][i] = nr[w];
+                    }
+                }
+            }
+            for (size_t i: indices) materials[i].reset();
+        }
+    } catch (...) {
+        releaseMaterials(materials);
+        throw;
+    }
+
+    return result;
+}
+
+DataVector<Tensor3<dcomplex>> Expansion::getNR(std::vector<shared_ptr<Material>>& materials, double lam,
+                                               const DataVector<const double>& T, const DataVector<const double>& n) const {
+    return std::move(evaluateNR(materials, std::vector<double>{lam}, T, n)[0]);
+}
+
+DataVector<Tensor3<dcomplex>> Expansion::getCachedNR(size_t layer, size_t part, std::vector<shared_ptr<Material>>& materials,
+                                                     double lam, const DataVector<const double>& T,
+                                                     const DataVector<const double>& n) const {
+    DataVector<Tensor3<dcomplex>> result;
+    std::vector<double> lams, sweep;
+    size_t w = 0, first = 0;
+    {
+        OmpLockGuard<OmpLock> lock(spectral_lock);
+        // Wavelength is recomputed from k0, so it may differ from the sweep one by a rounding error
+        auto found = std::lower_bound(spectral_wavelengths.begin(), spectral_wavelengths.end(), lam * (1. - 1e-9));
+        if (found != spectral_wavelengths.end() && *found <= lam * (1. + 1e-9)) {
+            w = found - spectral_wavelengths.begin();
+            auto entry = spectral_cache.find(std::make_pair(layer, part));
+            if (entry != spectral_cache.end() && entry->second.T == T && entry->second.n == n &&
+                entry->second.first <= w && w < entry->second.first + entry->second.nr.size()) {
+                result = entry->second.nr[w - entry->second.first];
+            } else {
+                size_t chunk = solver->spectral_chunk? solver->spectral_chunk : spectral_wavelengths.size();
+                first = w - w % chunk;
+                lams.assign(spectral_wavelengths.begin() + first,
+                            spectral_wavelengths.begin() + std::min(first + chunk, spectral_wavelengths.size()));
+                sweep = spectral_wavelengths;
+            }
+        }
+    }
+
+    if (result) {
+        releaseMaterials(materials);
+        return result;
+    }
+    if (lams.empty()) return getNR(materials, lam, T, n);
+
+    std::vector<DataVector<Tensor3<dcomplex>>> nrs = evaluateNR(materials, lams, T, n);
+    result = nrs[w - first];
+    OmpLockGuard<OmpLock> lock(spectral_lock);
+    if (spectral_wavelengths == sweep)
+        spectral_cache[std::make_pair(layer, part)] = SpectralEntry{first, T.copy(), n.copy(), std::move(nrs)};
+    return result;
+}
+
 }}} // namespace
@@ -72,6 +72,36 @@ struct PLASK_SOLVER_API Expansion {
   private:
     double glambda;
 
+    /// Refractive indices at some part of a layer for a chunk of wavelengths of the spectral sweep
+    struct SpectralEntry {
+        size_t first;                                       ///< Index of the first sweep wavelength in the chunk
+        DataVector<const double> T;                         ///< Temperatures for which the indices were computed
+        DataVector<const double> n;                         ///< Carriers concentrations for which the indices were computed
+        std::vector<DataVector<Tensor3<dcomplex>>> nr;      ///< Refractive indices at subsequent wavelengths of the chunk
+    };
+
+    /// Wavelengths of the spectral sweep (sorted)
+    std::vector<double> spectral_wavelengths;
+
+    /// Cached refractive indices for the spectral sweep, for subsequent layers and their parts (one chunk for each)
+    mutable std::map<std::pair<size_t,size_t>, SpectralEntry> spectral_cache;
+
+    /// Lock guarding the spectral cache
+    mutable OmpLock spectral_lock;
+
+    /**
+     * Evaluate refractive index tensors at multiple points for multiple wavelengths.
+     * \param[in,out] materials materials at subsequent points; they are released under the material lock
+     * \param lams wavelengths
+     * \param T temperatures at subsequent points
+     * \param n carriers concentrations at subsequent points
+     * \return refractive index tensors at subsequent points for each wavelength
+     */
+    std::vector<DataVector<Tensor3<dcomplex>>> evaluateNR(std::vector<shared_ptr<Material>>& materials,
+                                                          const std::vector<double>& lams,
+                                                          const DataVector<const double>& T,
+                                                          const DataVector<const double>& n) const;
+
   protected:
 
     TempMatrixPool temporary;
@@ -98,6 +128,37 @@ struct PLASK_SOLVER_API Expansion {
      */
     virtual void layerIntegrals(size_t layer, double lam, double glam) = 0;
 
+    /**
+     * Get refractive index tensors at multiple points.
+     * The points are grouped by their materials and each material is evaluated for all its points in a single batch,
+     * so it is locked only once instead of for every point.
+     * \param[in,out] materials materials at subsequent points; they are released under the material lock
+     * \param lam wavelength
+     * \param T temperatures at subsequent points
+     * \param n carriers concentrations at subsequent points
+     * \return refractive index tensors at subsequent points
+     */
+    DataVector<Tensor3<dcomplex>> getNR(std::vector<shared_ptr<Material>>& materials, double lam,
+                                        const DataVector<const double>& T, const DataVector<const double>& n) const;
+
+    /**
+     * Get refractive index tensors at multiple points of the layer, using the spectral cache.
+     * If \a lam is one of the wavelengths of the spectral sweep, the refractive indices are computed at once for
+     * the chunk of at most SlabBase::spectral_chunk sweep wavelengths containing it and cached, so the subsequent
+     * wavelengths of the chunk do not need to evaluate the materials again. Only one chunk is kept for each part
+     * of the layer, which bounds the memory used by the cache. Otherwise this is the same as getNR.
+     * \param layer layer number
+     * \param part part of the layer (if the points of the layer are obtained in several calls)
+     * \param[in,out] materials materials at subsequent points; they are released under the material lock
+     * \param lam wavelength
+     * \param T temperatures at subsequent points
+     * \param n carriers concentrations at subsequent points
+     * \return refractive index tensors at subsequent points
+     */
+    DataVector<Tensor3<dcomplex>> getCachedNR(size_t layer, size_t part, std::vector<shared_ptr<Material>>& materials,
+                                              double lam, const DataVector<const double>& T,
+                                              const DataVector<const double>& n) const;
+
   public:
 
     /// Prepare retrieval of refractive index
@@ -118,6 +179,44 @@ struct PLASK_SOLVER_API Expansion {
             solver->clearFields();
         }
     }
+    /**
+     * Set wavelengths of the spectral sweep.
+     * Refractive indices of the materials are computed at once for chunks of these wavelengths (see
+     * SlabBase::spectral_chunk), when the integrals are computed for any wavelength of the chunk, and are kept
+     * until the next chunk is needed or \ref clearSpectralWavelengths is called.
+     * \param wavelengths wavelengths of the sweep
+     */
+    void setSpectralWavelengths(std::vector<double> wavelengths) {
+        std::sort(wavelengths.begin(), wavelengths.end());
+        wavelengths.erase(std::unique(wavelengths.begin(), wavelengths.end()), wavelengths.end());
+        OmpLockGuard<OmpLock> lock(spectral_lock);
+        spectral_wavelengths = std::move(wavelengths);
+        spectral_cache.clear();
+    }
+
+    /// Finish the spectral sweep and release the cached refractive indices
+    void clearSpectralWavelengths() {
+        OmpLockGuard<OmpLock> lock(spectral_lock);
+        spectral_wavelengths.clear();
+        spectral_cache.clear();
+    }
+
+    /// Release refractive indices cached for the spectral sweep, which are no longer valid (wavelengths are kept)
+    void clearSpectralCache() {
+        OmpLockGuard<OmpLock> lock(spectral_lock);
+        spectral_cache.clear();
+    }
+
+    /**
+     * Release refractive indices cached for the spectral sweep in one layer, e.g. if its materials have changed
+     * \param layer layer number
+     */
+    void clearSpectralCache(size_t layer) {
+        OmpLockGuard<OmpLock> lock(spectral_lock);
+        spectral_cache.erase(spectral_cache.lower_bound(std::make_pair(layer, size_t(0))),
+                             spectral_cache.lower_bound(std::make_pair(layer + 1, size_t(0))));
+    }
+
     /// Clear lam0
     void clearLam0() {
         if (!isnan(lam0)) {
@@ -167,29 +266,36 @@ struct PLASK_SOLVER_API Expansion {
             if (error) std::rethrow_exception(error);
             solver->recompute_integrals = false;
             solver->recompute_gain_integrals = false;
-        } else if (solver->recompute_gain_integrals ||
-                   (solver->always_recompute_gain && !is_zero(lambda - glambda))) {
-            double lam = isnan(lam0)? lambda : solver->lam0;
-            glambda = (solver->always_recompute_gain)? lambda : lam;
-            std::vector<size_t> glayers;
+            solver->lchanged.clear();
+        } else {
+            bool gain = solver->recompute_gain_integrals ||
+                        (solver->always_recompute_gain && !is_zero(lambda - glambda));
+            std::vector<size_t> layers;
             size_t nlayers = solver->lcount;
-            glayers.reserve(nlayers);
-            for (size_t l = 0; l != nlayers; ++l) if (solver->lgained[l]) glayers.push_back(l);
-            std::exception_ptr error;
-            beforeLayersIntegrals(lam, glambda);
-            #pragma omp parallel for
-            for (plask::openmp_size_t l = 0; l < glayers.size(); ++l) {
-                if (error) continue;
-                try {
-                    layerIntegrals(glayers[l], lam, glambda);
-                } catch(...) {
-                    #pragma omp critical
-                    error = std::current_exception();
+            for (size_t l = 0; l != nlayers; ++l) {
+                if ((gain && solver->lgained[l]) || (l < solver->lchanged.size() && solver->lchanged[l]))
+                    layers.push_back(l);
+            }
+            double lam = isnan(lam0)? lambda : solver->lam0;
+            if (gain) glambda = (solver->always_recompute_gain)? lambda : lam;
+            if (!layers.empty()) {
+                std::exception_ptr error;
+                beforeLayersIntegrals(lam, glambda);
+                #pragma omp parallel for
+                for (plask::openmp_size_t l = 0; l < layers.size(); ++l) {
+                    if (error) continue;
+                    try {
+                        layerIntegrals(layers[l], lam, glambda);
+                    } catch(...) {
+                        #pragma omp critical
+                        error = std::current_exception();
+                    }
                 }
+                afterLayersIntegrals();
+                if (error) std::rethrow_exception(error);
             }
-            afterLayersIntegrals();
-            if (error) std::rethrow_exception(error);
             solver->recompute_gain_integrals = false;
+            solver->lchanged.clear();
         }
     }
 
@@ -200,6 +306,13 @@ struct PLASK_SOLVER_API Expansion {
      */
     virtual bool diagonalQE(size_t PLASK_UNUSED(l)) const { return false; }
 
+    /**
+     * Return the code of the expansion class and of its state (symmetry, polarization etc.) determining
+     * the meaning of the layer matrices. Cached diagonalizations are shared only between equal codes.
+     * \return expansion kind code
+     */
+    virtual std::uint64_t matricesKind() const = 0;
+
     /**
      * Return size of the expansion matrix (equal to the number of expansion coefficients)
      * \return size of the expansion matrix
@@ -218,6 +218,7 @@ void ExpansionPW2D::init()
 }
 
 void ExpansionPW2D::reset() {
+    clearSpectralCache();
     coeffs.clear();
     coeff_matrices.clear();
     coeff_matrix_mxx.reset();
@@ -311,10 +312,12 @@ void ExpansionPW2D::layerIntegrals(size_t layer, double lam, double glam)
             coeffs[layer].yy.reset(nN, 0.);
         }
 
+        DataVector<Tensor3<dcomplex>> nrs = getLayerNR(geometry, layer, maty, lam, true);
+
         // Average material parameters
         for (size_t i = 0; i != nN; ++i) {
             for (size_t j = refine*i, end = refine*(i+1); j != end; ++j) {
-                Tensor3<dcomplex> eps = getEpsilon(geometry, layer, maty, lam, glam, j);
+                Tensor3<dcomplex> eps = getEpsilon(geometry, layer, maty, glam, j, nrs[j]);
 
                 // Add PMLs
                 if (!periodic) {
@@ -474,7 +477,8 @@ void ExpansionPW2D::layerIntegrals(size_t layer, double lam, double glam)
         }
 
         size_t mn = mesh->tran()->size();
-        const Tensor3<dcomplex> eps0 = getEpsilon(geometry, layer, maty, lam, glam, mn-1);
+        DataVector<Tensor3<dcomplex>> nrs = getLayerNR(geometry, layer, maty, lam, true);
+        const Tensor3<dcomplex> eps0 = getEpsilon(geometry, layer, maty, glam, mn-1, nrs[mn-1]);
         bool nd = eps0.c01 != 0.;
         dcomplex rm;
         if (nd) {
@@ -501,14 +505,14 @@ void ExpansionPW2D::layerIntegrals(size_t layer, double lam, double glam)
 
         diagonals[layer] = true;
 
-        Tensor3<dcomplex> eps = getEpsilon(geometry, layer, maty, lam, glam, 0), reps;
+        Tensor3<dcomplex> eps = getEpsilon(geometry, layer, maty, glam, 0, nrs[0]), reps;
 
         double l, r = 0.;
         const ptrdiff_t di = (mesh->tran()->size() == original_mesh->size()+1)? 1 : 0;
         const int start = symmetric()? 0 : -int(nN)/2, end = symmetric()? nN : int(nN+1)/2;
         const double b = 2*PI / L;
         for (size_t i = 1; i < mn; ++i) {
-            Tensor3<dcomplex> eps1 = getEpsilon(geometry, layer, maty, lam, glam, i);
+            Tensor3<dcomplex> eps1 = getEpsilon(geometry, layer, maty, glam, i, nrs[i]);
             if (!eps1.equals(eps)) {
                 nd = eps.c01 != 0.;
                 if (nd) {
@@ -91,6 +91,8 @@ struct PLASK_SOLVER_API ExpansionPW2D: public Expansion {
         return diagonals[l];
     }
 
+    std::uint64_t matricesKind() const override { return 1 | unsigned(symmetry) << 8 | unsigned(polarization) << 16; }
+
     size_t matrixSize() const override { return separated()? N : 2*N; }
 
     void getMatrices(size_t l, cmatrix& RE, cmatrix& RH) override;
@@ -140,27 +142,36 @@ struct PLASK_SOLVER_API ExpansionPW2D: public Expansion {
 
     void layerIntegrals(size_t layer, double lam, double glam) override;
 
-    Tensor3<dcomplex> getEpsilon(const shared_ptr<GeometryD<2>>& geometry, size_t layer, double maty,
-                                 double lam, double glam, size_t j) {
-        double T = 0., W = 0., C = 0.;
-        for (size_t k = 0, v = j * solver->verts->size(); k != mesh->vert()->size(); ++v, ++k) {
-            if (solver->stack[k] == layer) {
-                double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
-                T += w * temperature[v]; C += w * carriers[v]; W += w;
+    /**
+     * Get refractive indices in all transverse points of the layer
+     * \param geometry geometry of the solver
+     * \param layer layer number
+     * \param maty vertical position of the layer
+     * \param lam wavelength
+     * \param cached use the spectral cache (only if \a maty is the position of the layer)
+     */
+    DataVector<Tensor3<dcomplex>> getLayerNR(const shared_ptr<GeometryD<2>>& geometry, size_t layer, double maty,
+                                             double lam, bool cached = false) {
+        size_t nM = mesh->tran()->size();
+        std::vector<shared_ptr<Material>> materials(nM);
+        DataVector<double> T(nM), C(nM);
+        for (size_t j = 0; j != nM; ++j) {
+            double Tj = 0., W = 0., Cj = 0.;
+            for (size_t k = 0, v = j * solver->verts->size(); k != mesh->vert()->size(); ++v, ++k) {
+                if (solver->stack[k] == layer) {
+                    double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
+                    Tj += w * temperature[v]; Cj += w * carriers[v]; W += w;
+                }
             }
+            T[j] = Tj / W;
+            C[j] = Cj / W;
+            materials[j] = geometry->getMaterial(vec(mesh->tran()->at(j),maty));
         }
-        T /= W;
-        C /= W;
-        Tensor3<dcomplex> nr;
-        {
-            OmpLockGuard<OmpNestLock> lock; // this must be declared before `material` to guard its destruction
-            auto material = geometry->getMaterial(vec(mesh->tran()->at(j),maty));
-            lock = material->lock();
-            nr = material->NR(lam, T, C);
-            if (isnan(nr.c00) || isnan(nr.c11) || isnan(nr.c22) || isnan(nr.c01))
-                throw BadInput(solver->getId(), "Complex refractive index (NR) for {} is NaN at lam={}nm, T={}K, n={}/cm3",
-                               material->name(), lam, T, C);
-        }
+        return cached? getCachedNR(layer, 0, materials, lam, T, C) : getNR(materials, lam, T, C);
+    }
+
+    Tensor3<dcomplex> getEpsilon(const shared_ptr<GeometryD<2>>& geometry, size_t layer, double maty,
+                                 double glam, size_t j, Tensor3<dcomplex> nr) {
         if (nr.c01 != 0.) {
             if (symmetric()) throw BadInput(solver->getId(), "Symmetry not allowed for structure with non-diagonal NR tensor");
             if (separated()) throw BadInput(solver->getId(), "Single polarization not allowed for structure with non-diagonal NR tensor");
@@ -168,7 +179,7 @@ struct PLASK_SOLVER_API ExpansionPW2D: public Expansion {
         if (gain_connected && solver->lgained[layer]) {
             auto roles = geometry->getRolesAt(vec(mesh->tran()->at(j),maty));
             if (roles.find("QW") != roles.end() || roles.find("QD") != roles.end() || roles.find("gain") != roles.end()) {
-                Tensor2<double> g = 0.; W = 0.;
+                Tensor2<double> g = 0.; double W = 0.;
                 for (size_t k = 0, v = j * solver->verts->size(); k != mesh->vert()->size(); ++v, ++k) {
                     if (solver->stack[k] == layer) {
                         double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
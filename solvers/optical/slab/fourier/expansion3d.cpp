@@ -250,6 +250,7 @@ void ExpansionPW3D::init()
 }
 
 void ExpansionPW3D::reset() {
+    clearSpectralCache();
     coeffs.clear();
     coeffs_ezz.clear();
     coeffs_dexx.clear();
@@ -374,6 +375,28 @@ void ExpansionPW3D::layerIntegrals(size_t layer, double lam, double glam) {
 
         size_t cto = nNl * it;
 
+        // Get refractive indices for the whole row of cells at once
+        DataVector<Tensor3<dcomplex>> nrs;
+        {
+            std::vector<shared_ptr<Material>> materials(reft * nMl);
+            DataVector<double> T(reft * nMl), C(reft * nMl);
+            for (size_t t = tbegin, j = 0; t != tend; ++t) {
+                for (size_t l = 0; l != nMl; ++l, ++j) {
+                    double Tj = 0., W = 0., Cj = 0.;
+                    for (size_t k = 0, v = mesh->index(l, t, 0); k != mesh->vert()->size(); ++v, ++k) {
+                        if (solver->stack[k] == layer) {
+                            double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
+                            Tj += w * temperature[v]; Cj += w * carriers[v]; W += w;
+                        }
+                    }
+                    T[j] = Tj / W;
+                    C[j] = Cj / W;
+                    materials[j] = geometry->getMaterial(vec(long_mesh->at(l), tran_mesh->at(t), matv));
+                }
+            }
+            nrs = getCachedNR(layer, it, materials, lam, T, C);
+        }
+
         for (size_t il = 0; il != nNl; ++il) {
             size_t lbegin = refl * il; size_t lend = lbegin + refl;
             double long0 = 0.5 * (long_mesh->at(lbegin) + long_mesh->at(lend-1));
@@ -382,28 +405,11 @@ void ExpansionPW3D::layerIntegrals(size_t layer, double lam, double glam) {
             Vec<2> norm(0.,0.);
             for (size_t t = tbegin, j = 0; t != tend; ++t) {
                 for (size_t l = lbegin; l != lend; ++l, ++j) {
-                    double T = 0., W = 0., C = 0.;
-                    for (size_t k = 0, v = mesh->index(l, t, 0); k != mesh->vert()->size(); ++v, ++k) {
-                        if (solver->stack[k] == layer) {
-                            double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
-                            T += w * temperature[v]; C += w * carriers[v]; W += w;
-                        }
-                    }
-                    T /= W;
-                    C /= W;
-                    {
-                        OmpLockGuard<OmpNestLock> lock; // this must be declared before `material` to guard its destruction
-                        auto material = geometry->getMaterial(vec(long_mesh->at(l), tran_mesh->at(t), matv));
-                        lock = material->lock();
-                        cell[j] = material->NR(lam, T, C);
-                        if (isnan(cell[j].c00) || isnan(cell[j].c11) || isnan(cell[j].c22) || isnan(cell[j].c01))
-                            throw BadInput(solver->getId(), "Complex refractive index (NR) for {} is NaN at lam={}nm, T={}K n={}/cm3",
-                             material->name(), lam, T, C);
-                    }
+                    cell[j] = nrs[nMl * (t - tbegin) + l];
                     if (gain_connected && solver->lgained[layer]) {
                         auto roles = geometry->getRolesAt(vec(long_mesh->at(l), tran_mesh->at(t), matv));
                         if (roles.find("QW") != roles.end() || roles.find("QD") != roles.end() || roles.find("gain") != roles.end()) {
-                            Tensor2<double> g = 0.; W = 0.;
+                            Tensor2<double> g = 0.; double W = 0.;
                             for (size_t k = 0, v = mesh->index(l, t, 0); k != mesh->vert()->size(); ++v, ++k) {
                                 if (solver->stack[k] == layer) {
                                     double w = (k == 0 || k == mesh->vert()->size()-1)? 1e-6 : solver->vbounds->at(k) - solver->vbounds->at(k-1);
@@ -155,6 +155,10 @@ struct PLASK_SOLVER_API ExpansionPW3D: public Expansion {
         return diagonals[l];
     }
 
+    std::uint64_t matricesKind() const override {
+        return 2 | unsigned(symmetry_long) << 8 | unsigned(symmetry_tran) << 16;
+    }
+
     size_t matrixSize() const override { return 2*Nl*Nt; }
 
     void getMatrices(size_t l, cmatrix& RE, cmatrix& RH) override;
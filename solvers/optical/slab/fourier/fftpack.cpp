@@ -12,6 +12,7 @@
  * GNU General Public License for more details.
  */
 #include "fft.hpp"
+#include "../temp_matrix.hpp"
 
 #ifndef USE_FFTW // use fftpacx instead of fftw
 
@@ -65,32 +66,33 @@ void Forward1D::execute(dcomplex* data, int lot) {
     if (lot == 0) lot = strid;
     try {
         int ier;
-        std::unique_ptr<double[]> work(new double[(symmetry != SYMMETRY_ODD_1)? 2*lot*(n+1) : 2*lot*(2*n+4)]);
+        MatrixArena::Scope scope;
+        double* work = MatrixArena::array<double>((symmetry != SYMMETRY_ODD_1)? 2*lot*(n+1) : 2*lot*(2*n+4));
         double factor;
         switch (symmetry) {
             case SYMMETRY_NONE:
-                cfftmf_(lot, 1, n, strid, data, strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                cfftmf_(lot, 1, n, strid, data, strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 break;
             case SYMMETRY_EVEN_2:
-                cosqmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                cosqmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 factor = 1./n;
                 for (int i = 0, N = strid*n; i < N; i += strid)
                     for (int j = 0; j < lot; ++j)
                         data[i+j] *= factor;
                 break;
             case SYMMETRY_EVEN_1:
-                costmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*(n+1), ier);
+                costmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*(n+1), ier);
                 for (int i = lot, end = n*lot; i < end; ++i) *(data+i) *= 0.5;
                 break;
             case SYMMETRY_ODD_2:
-                sinqmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                sinqmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 factor = 1./n;
                 for (int i = 0, N = strid*n; i < N; i += strid)
                     for (int j = 0; j < lot; ++j)
                         data[i+j] *= factor;
                 break;
             case SYMMETRY_ODD_1:
-                sintmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*(2*n+4), ier);
+                sintmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*(2*n+4), ier);
                 for (int i = lot, end = n*lot; i < end; ++i) *(data+i) *= 0.5;
                 break;
         }
@@ -150,24 +152,25 @@ void Backward1D::execute(dcomplex* data, int lot) {
     if (lot == 0) lot = strid;
     try {
         int ier;
-        std::unique_ptr<double[]> work(new double[(symmetry != SYMMETRY_ODD_1)? 2*lot*(n+1) : 2*lot*(2*n+4)]);
+        MatrixArena::Scope scope;
+        double* work = MatrixArena::array<double>((symmetry != SYMMETRY_ODD_1)? 2*lot*(n+1) : 2*lot*(2*n+4));
         switch (symmetry) {
             case SYMMETRY_NONE:
-                cfftmb_(lot, 1, n, strid, data, strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                cfftmb_(lot, 1, n, strid, data, strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 return;
             case SYMMETRY_EVEN_2:
-                cosqmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                cosqmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 break;
             case SYMMETRY_ODD_2:
-                sinqmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*n, ier);
+                sinqmf_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*n, ier);
                 break;
             case SYMMETRY_EVEN_1:
                 for (int i = lot, end = n*lot; i < end; ++i) *(data+i) *= 2.;
-                costmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*(n+1), ier);
+                costmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*(n+1), ier);
                 return;
             case SYMMETRY_ODD_1:
                 for (int i = lot, end = n*lot; i < end; ++i) *(data+i) *= 2.;
-                sintmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work.get(), 2*lot*(2*n+4), ier);
+                sintmb_(2*lot, 1, n, 2*strid, (double*)data, 2*strid*n, wsave, lensav(n), work, 2*lot*(2*n+4), ier);
                 return;
         }
         double factor = n;
@@ -247,18 +250,19 @@ void Forward2D::execute(dcomplex* data, int lot) {
     if (lot == 0) lot = strid1;
     try {
         int ier;
-		std::unique_ptr<double[]> work(new double[symmetry1 != SYMMETRY_ODD_1 || symmetry2 != SYMMETRY_ODD_1?
-                                                  2*lot*(max(n1,n2)+1) : 2*lot*(2*max(n1,n2)+4)]);
+        MatrixArena::Scope scope;
+        double* work = MatrixArena::array<double>(symmetry1 != SYMMETRY_ODD_1 || symmetry2 != SYMMETRY_ODD_1?
+                                                  2*lot*(max(n1,n2)+1) : 2*lot*(2*max(n1,n2)+4));
         // n1 is changing faster than n2
         double factor1 = 1./n1;
         switch (symmetry1) {
             case SYMMETRY_NONE:
                 for (int i = 0; i != n2; ++i)
-                    cfftmf_(lot, 1, n1, strid1, data+strid2*i, strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    cfftmf_(lot, 1, n1, strid1, data+strid2*i, strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                 break;
             case SYMMETRY_EVEN_2:
                 for (int i = 0; i != n2; ++i) {
-                    cosqmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    cosqmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                     for (int j = 0, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor1;
@@ -266,7 +270,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_EVEN_1:
                 for (int i = 0; i != n2; ++i) {
-                    costmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*(n1+1), ier);
+                    costmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*(n1+1), ier);
                     for (int j = strid1, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 0.5;
@@ -274,7 +278,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_2:
                 for (int i = 0; i != n2; ++i) {
-                    sinqmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    sinqmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                     for (int j = 0, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor1;
@@ -282,7 +286,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_1:
                 for (int i = 0; i != n2; ++i) {
-                    sintmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*(2*n1+4), ier);
+                    sintmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*(2*n1+4), ier);
                     for (int j = strid1, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 0.5;
@@ -293,11 +297,11 @@ void Forward2D::execute(dcomplex* data, int lot) {
         switch (symmetry2) {
             case SYMMETRY_NONE:
                 for (int i = 0; i != n1; ++i)
-                    cfftmf_(lot, 1, n2, strid2, data+strid1*i, strid1+strid2*(n2-1), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    cfftmf_(lot, 1, n2, strid2, data+strid1*i, strid1+strid2*(n2-1), wsave2, lensav(n2), work, 2*lot*n2, ier);
                 break;
             case SYMMETRY_EVEN_2:
                 for (int i = 0; i != n1; ++i) {
-                    cosqmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    cosqmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*n2, ier);
                     for (int j = 0, dist = strid1*i, end = n2*strid2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor2;
@@ -305,7 +309,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_EVEN_1:
                 for (int i = 0; i != n1; ++i) {
-                    costmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*(n2+1), ier);
+                    costmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*(n2+1), ier);
                     for (int j = strid2, dist = strid1*i, end = strid2*n2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 0.5;
@@ -313,7 +317,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_2:
                 for (int i = 0; i != n1; ++i) {
-                    sinqmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    sinqmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*n2, ier);
                     for (int j = 0, dist = strid1*i, end = n2*strid2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor2;
@@ -321,7 +325,7 @@ void Forward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_1:
                 for (int i = 0; i != n1; ++i) {
-                    sintmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*(2*n2+4), ier);
+                    sintmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*(2*n2+4), ier);
                     for (int j = strid2, dist = strid1*i, end = strid2*n2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 0.5;
@@ -403,18 +407,19 @@ void Backward2D::execute(dcomplex* data, int lot) {
     if (lot == 0) lot = strid1;
     try {
         int ier;
-		std::unique_ptr<double[]> work(new double[symmetry1 != SYMMETRY_ODD_1 || symmetry2 != SYMMETRY_ODD_1?
-                                                  2*lot*(max(n1,n2)+1) : 2*lot*(2*max(n1,n2)+4)]);
+        MatrixArena::Scope scope;
+        double* work = MatrixArena::array<double>(symmetry1 != SYMMETRY_ODD_1 || symmetry2 != SYMMETRY_ODD_1?
+                                                  2*lot*(max(n1,n2)+1) : 2*lot*(2*max(n1,n2)+4));
         // n1 is changing faster than n2
         double factor1 = n1;
         switch (symmetry1) {
             case SYMMETRY_NONE:
                 for (int i = 0; i != n2; ++i)
-                    cfftmb_(lot, 1, n1, strid1, data+strid2*i, strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    cfftmb_(lot, 1, n1, strid1, data+strid2*i, strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                 break;
             case SYMMETRY_EVEN_2:
                 for (int i = 0; i != n2; ++i) {
-                    cosqmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    cosqmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                     for (int j = 0, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[j+l+dist] *= factor1;
@@ -422,7 +427,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_2:
                 for (int i = 0; i != n2; ++i) {
-                    sinqmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*n1, ier);
+                    sinqmf_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*n1, ier);
                     for (int j = 0, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[j+l+dist] *= factor1;
@@ -433,7 +438,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                     for (int j = strid1, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[j+l+dist] *= 2.;
-                    costmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*(n1+1), ier);
+                    costmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*(n1+1), ier);
                 }
                 break;
             case SYMMETRY_ODD_1:
@@ -441,7 +446,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                     for (int j = strid1, dist = strid2*i, end = strid1*n1; j < end; j += strid1)
                         for (int l = 0; l < lot; ++l)
                             data[j+l+dist] *= 2.;
-                    sintmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work.get(), 2*lot*(2*n1+4), ier);
+                    sintmb_(2*lot, 1, n1, 2*strid1, (double*)data+2*strid2*i, 2*strid2, wsave1, lensav(n1), work, 2*lot*(2*n1+4), ier);
                 }
                 break;
         }
@@ -449,11 +454,11 @@ void Backward2D::execute(dcomplex* data, int lot) {
         switch (symmetry2) {
             case SYMMETRY_NONE:
                 for (int i = 0; i != n1; ++i)
-                    cfftmb_(lot, 1, n2, strid2, data+strid1*i, strid1+strid2*(n2-1), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    cfftmb_(lot, 1, n2, strid2, data+strid1*i, strid1+strid2*(n2-1), wsave2, lensav(n2), work, 2*lot*n2, ier);
                 break;
             case SYMMETRY_EVEN_2:
                 for (int i = 0; i != n1; ++i) {
-                    cosqmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    cosqmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*n2, ier);
                     for (int j = 0, dist = strid1*i, N = n2*strid2; j < N; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor2;
@@ -461,7 +466,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                 break;
             case SYMMETRY_ODD_2:
                 for (int i = 0; i != n1; ++i) {
-                    sinqmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*n2, ier);
+                    sinqmf_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*n2, ier);
                     for (int j = 0, dist = strid1*i, N = n2*strid2; j < N; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= factor2;
@@ -472,7 +477,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                     for (int j = strid2, dist = strid1*i, end = n2*strid2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 2.;
-                    costmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*(n2+1), ier);
+                    costmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*(n2+1), ier);
                 }
                 break;
             case SYMMETRY_ODD_1:
@@ -480,7 +485,7 @@ void Backward2D::execute(dcomplex* data, int lot) {
                     for (int j = strid2, dist = strid1*i, end = n2*strid2; j < end; j += strid2)
                         for (int l = 0; l < lot; ++l)
                             data[dist+j+l] *= 2.;
-                    sintmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work.get(), 2*lot*(2*n2+4), ier);
+                    sintmb_(2*lot, 1, n2, 2*strid2, (double*)data+2*strid1*i, 2*(strid1+strid2*(n2-1)), wsave2, lensav(n2), work, 2*lot*(2*n2+4), ier);
                 }
                 break;
         }
@@ -59,84 +59,77 @@ void ImpedanceTransfer::findImpedance(std::ptrdiff_t start, std::ptrdiff_t end)
     // Some temporary variables
     cdiagonal gamma, y1(N), y2(N);
 
-    std::exception_ptr error;
-
-    #pragma omp parallel for schedule(dynamic,1)
-    for (int l = 0; l < int(diagonalizer->lcount); ++l) {
-        try {
-            if (!error) diagonalizer->diagonalizeLayer(l);
-        } catch(...) {
-            error = std::current_exception();
+    // Diagonalize layers in parallel and find matrices Y[i] for each layer as soon as it is ready
+    DiagonalizationPipeline pipeline(diagonalizer.get(), solver->stack, start, end);
+
+    pipeline.run([&]() {
+        // PML layer
+        #ifdef OPENMP_FOUND
+            write_debug("{}: Entering into single region of admittance search", solver->getId());
+        #endif
+        pipeline.wait(solver->stack[start]);
+        gamma = diagonalizer->Gamma(solver->stack[start]);
+        std::fill_n(y2.data(), N, dcomplex(1.));                    // we use y2 for tracking sign changes
+        for (std::size_t i = 0; i < N; i++) {
+            y1[i] = gamma[i] * solver->vpml.factor;
+            if (real(y1[i]) < -SMALL) { y1[i] = -y1[i]; y2[i] = -y2[i]; }
+            if (imag(y1[i]) > SMALL) { y1[i] = -y1[i]; y2[i] = -y2[i]; }
         }
-    }
-    if (error) std::rethrow_exception(error);
-
-    // Now iteratively we find matrices Y[i]
-
-    // PML layer
-    #ifdef OPENMP_FOUND
-        write_debug("{}: Entering into single region of admittance search", solver->getId());
-    #endif
-    gamma = diagonalizer->Gamma(solver->stack[start]);
-    std::fill_n(y2.data(), N, dcomplex(1.));                    // we use y2 for tracking sign changes
-    for (std::size_t i = 0; i < N; i++) {
-        y1[i] = gamma[i] * solver->vpml.factor;
-        if (real(y1[i]) < -SMALL) { y1[i] = -y1[i]; y2[i] = -y2[i]; }
-        if (imag(y1[i]) > SMALL) { y1[i] = -y1[i]; y2[i] = -y2[i]; }
-    }
-    get_y1(y1, solver->vpml.size, y1);
-    std::fill_n(Y.data(), NN, dcomplex(0.));
-    for (std::size_t i = 0; i < N; i++) Y(i,i) = - y2[i] / y1[i];
+        get_y1(y1, solver->vpml.size, y1);
+        std::fill_n(Y.data(), NN, dcomplex(0.));
+        for (std::size_t i = 0; i < N; i++) Y(i,i) = - y2[i] / y1[i];
 
-    // First layer
-    double h = solver->vpml.dist;
-    gamma = diagonalizer->Gamma(solver->stack[start]);
-    get_y1(gamma, h, y1);
-    get_y2(gamma, h, y2);
-    // off-diagonal elements of Y are 0
-    for (std::size_t i = 0; i < N; i++) Y(i,i) = y2[i] * y2[i] / (y1[i] - Y(i,i)) - y1[i]; // Y = y2 * inv(y1-Y) * y2 - y1
+        // First layer
+        double h = solver->vpml.dist;
+        gamma = diagonalizer->Gamma(solver->stack[start]);
+        get_y1(gamma, h, y1);
+        get_y2(gamma, h, y2);
+        // off-diagonal elements of Y are 0
+        for (std::size_t i = 0; i < N; i++) Y(i,i) = y2[i] * y2[i] / (y1[i] - Y(i,i)) - y1[i]; // Y = y2 * inv(y1-Y) * y2 - y1
 
-    // save the Y matrix for 1-st layer
-    storeY(start);
+        // save the Y matrix for 1-st layer
+        storeY(start);
 
-    if (start == end) return;
+        if (start == end) return;
 
-    // Declare temporary matrixH) on 'wrk' array
-    cmatrix work(N, N, wrk);
+        // Declare temporary matrixH) on 'wrk' array
+        cmatrix work(N, N, wrk);
 
-    for (std::ptrdiff_t n = start+inc; n != end; n += inc)
-    {
-        gamma = diagonalizer->Gamma(solver->stack[n]);
+        for (std::ptrdiff_t n = start+inc; n != end; n += inc)
+        {
+            pipeline.wait(solver->stack[n]);
+            gamma = diagonalizer->Gamma(solver->stack[n]);
 
-        h = solver->vbounds->at(n) - solver->vbounds->at(n-1);
-        get_y1(gamma, h, y1);
-        get_y2(gamma, h, y2);
+            h = solver->vbounds->at(n) - solver->vbounds->at(n-1);
+            get_y1(gamma, h, y1);
+            get_y2(gamma, h, y2);
 
-        // The main equation
-        // Y[n] = y2 * tH * inv(y1*tH - tE*Y[n-1]) * y2  -  y1
+            // The main equation
+            // Y[n] = y2 * tH * inv(y1*tH - tE*Y[n-1]) * y2  -  y1
 
-        mult_matrix_by_matrix(diagonalizer->TE(solver->stack[n-inc]), Y, temp);         // work = tE * Y[n-1]
-        mult_matrix_by_matrix(diagonalizer->invTE(solver->stack[n]), temp, work);       // ...
+            mult_matrix_by_matrix(diagonalizer->TE(solver->stack[n-inc]), Y, temp);         // work = tE * Y[n-1]
+            mult_matrix_by_matrix(diagonalizer->invTE(solver->stack[n]), temp, work);       // ...
 
-        mult_matrix_by_matrix(diagonalizer->invTH(solver->stack[n]), diagonalizer->TH(solver->stack[n-inc]), temp); // compute tH
+            mult_matrix_by_matrix(diagonalizer->invTH(solver->stack[n]), diagonalizer->TH(solver->stack[n-inc]), temp); // compute tH
 
-        for (std::size_t j = 0; j < N; j++)
-            for (std::size_t i = 0; i < N; i++) Y(i,j) = y1[i]*temp(i,j) - work(i,j);   // Y[n] = y1 * tH - work
+            for (std::size_t j = 0; j < N; j++)
+                for (std::size_t i = 0; i < N; i++) Y(i,j) = y1[i]*temp(i,j) - work(i,j);   // Y[n] = y1 * tH - work
 
-        for (std::size_t i = 0; i < NN; i++) work[i] = 0.;
-        for (std::size_t j = 0, i = 0; j < N; j++, i += N+1) work[i] = y2[j];           // work = y2
+            for (std::size_t i = 0; i < NN; i++) work[i] = 0.;
+            for (std::size_t j = 0, i = 0; j < N; j++, i += N+1) work[i] = y2[j];           // work = y2
 
-        invmult(Y, work);                                                               // work = inv(Y[n]) * (work = y2)
-        mult_matrix_by_matrix(temp, work, Y);                                           // Y[n] = tH * work
+            invmult(Y, work);                                                               // work = inv(Y[n]) * (work = y2)
+            mult_matrix_by_matrix(temp, work, Y);                                           // Y[n] = tH * work
 
-        for (std::size_t j = 0; j < N; j++)
-            for (std::size_t i = 0; i < N; i++) Y(i,j) *= y2[i];                        // Y[n] = y2 * Y[n]
+            for (std::size_t j = 0; j < N; j++)
+                for (std::size_t i = 0; i < N; i++) Y(i,j) *= y2[i];                        // Y[n] = y2 * Y[n]
 
-        for (std::size_t j = 0, i = 0; j < N; j++, i += N+1) Y[i] -= y1[j];             // Y[n] = Y[n] - y1
+            for (std::size_t j = 0, i = 0; j < N; j++, i += N+1) Y[i] -= y1[j];             // Y[n] = Y[n] - y1
 
-        // Save the Y matrix for n-th layer
-        storeY(n);
-    }
+            // Save the Y matrix for n-th layer
+            storeY(n);
+        }
+    });
 }
 
 
@@ -12,6 +12,7 @@
  * GNU General Public License for more details.
  */
 #include "matrices.hpp"
+#include "temp_matrix.hpp"
 
 namespace plask { namespace optical { namespace slab {
 
@@ -26,10 +27,11 @@ cmatrix invmult(cmatrix& A, cmatrix& B)
         throw ComputationError("invmult", "Cannot multiply matrices because of the dimensions mismatch");
     const std::size_t nrhs = B.cols();
     // Needed variables
-    std::unique_ptr<int[]> ipiv(new int[N]);
+    MatrixArena::Scope scope;
+    int* ipiv = MatrixArena::array<int>(N);
     int info;
     // Perform the calculation
-    zgesv(int(N), int(nrhs), A.data(), int(N), ipiv.get(), B.data(), int(N), info);
+    zgesv(int(N), int(nrhs), A.data(), int(N), ipiv, B.data(), int(N), info);
     // Return the result
     if (info > 0) throw ComputationError("invmult", "Matrix is singular");
     return B;
@@ -46,10 +48,11 @@ cvector invmult(cmatrix& A, cvector& B)
     if (B.size() != N)
         throw ComputationError("invmult", "Cannot multiply matrix by vector because of the dimensions mismatch");
     // Needed variables
-    std::unique_ptr<int[]> ipiv(new int[N]);
+    MatrixArena::Scope scope;
+    int* ipiv = MatrixArena::array<int>(N);
     int info;
     // Perform the calculation
-    zgesv(int(N), 1, A.data(), int(N), ipiv.get(), B.data(), int(N), info);
+    zgesv(int(N), 1, A.data(), int(N), ipiv, B.data(), int(N), info);
     // Return the result
     if (info > 0) throw ComputationError("invmult", "Matrix is singular");
     return B;
@@ -80,10 +83,11 @@ dcomplex det(cmatrix& A)
         throw ComputationError("det", "Cannot find the determinant of rectangular matrix");
     const std::size_t N = A.rows();
     // Needed variables
-    std::unique_ptr<int[]> ipiv(new int[N]);
+    MatrixArena::Scope scope;
+    int* ipiv = MatrixArena::array<int>(N);
     int info;
     // Find the LU factorization
-    zgetrf(int(N), int(N), A.data(), int(N), ipiv.get(), info);
+    zgetrf(int(N), int(N), A.data(), int(N), ipiv, info);
     // Ok, now compute the determinant
     dcomplex det = 1.; int p = 1;
     for (std::size_t i = 0; i < N; i++) {
@@ -120,12 +124,13 @@ int eigenv(cmatrix& A, cdiagonal& vals, cmatrix* rightv, cmatrix* leftv)
     // Create the workplace
     const std::size_t lwork = 2*N+1;
     //int lwork = N*N;
-    aligned_unique_ptr<dcomplex[]> work(aligned_malloc<dcomplex>(lwork));
-    aligned_unique_ptr<double[]> rwork(aligned_malloc<double>(2*N));
+    MatrixArena::Scope scope;
+    dcomplex* work = MatrixArena::array<dcomplex>(lwork);
+    double* rwork = MatrixArena::array<double>(2*N);
 
     // Call the lapack subroutine
     int info;
-    zgeev(jobvl, jobvr, int(N), A.data(), int(N), vals.data(), vl, int(N), vr, int(N), work.get(), int(lwork), rwork.get(), info);
+    zgeev(jobvl, jobvr, int(N), A.data(), int(N), vals.data(), vl, int(N), vr, int(N), work, int(lwork), rwork, info);
 
     return info;
 }
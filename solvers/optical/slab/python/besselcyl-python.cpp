@@ -95,17 +95,17 @@ py::object BesselSolverCyl_getDeterminant(py::tuple args, py::dict kwargs) {
     switch (what) {
         case WHAT_NOTHING:
             if (!k0) expansion->setK0(self->getK0());
-            return py::object(self->getDeterminant());
+            return py::object(SlabSolver_getDeterminant(self));
         case WHAT_WAVELENGTH:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion->setK0(2e3*PI / x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion->setK0(2e3*PI / x); return SlabSolver_getDeterminant(self); },
                 array,
                 "BesselCyl.get_determinant",
                 "lam"
             );
         case WHAT_K0:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion->setK0(x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion->setK0(x); return SlabSolver_getDeterminant(self); },
                 array,
                 "BesselCyl.get_determinant",
                 "k0"
@@ -121,6 +121,7 @@ static size_t BesselSolverCyl_findMode(BesselSolverCyl& self, dcomplex start, co
     } else {
         m = py::extract<int>(pym);
     }
+    ReleaseGIL nogil;
     return self.findMode(start, m);
 }
 
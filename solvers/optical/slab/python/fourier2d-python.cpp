@@ -169,13 +169,13 @@ static py::object FourierSolver2D_getDeterminant(py::tuple args, py::dict kwargs
     expansion->setPolarization(self->getPolarization());
 
     switch (what) {
-        case WHAT_NOTHING: return py::object(self->getDeterminant());
+        case WHAT_NOTHING: return py::object(SlabSolver_getDeterminant(self));
         case WHAT_WAVELENGTH:
             return UFUNC<dcomplex>(
                 [self, neff](dcomplex x) -> dcomplex {
                     self->expansion.setK0(2e3 * PI / x);
                     if (neff) self->expansion.setBeta(*neff * self->expansion.k0);
-                    return self->getDeterminant();
+                    return SlabSolver_getDeterminant(self);
                 },
                 array,
                 "Fourier2D.get_determinant",
@@ -185,7 +185,7 @@ static py::object FourierSolver2D_getDeterminant(py::tuple args, py::dict kwargs
                 [self, neff](dcomplex x) -> dcomplex {
                     self->expansion.setK0(x);
                     if (neff) self->expansion.setBeta(*neff * x);
-                    return self->getDeterminant();
+                    return SlabSolver_getDeterminant(self);
                 },
                 array,
                 "Fourier2D.get_determinant",
@@ -194,7 +194,7 @@ static py::object FourierSolver2D_getDeterminant(py::tuple args, py::dict kwargs
             return UFUNC<dcomplex>(
                 [self](dcomplex x) -> dcomplex {
                     self->expansion.setBeta(x * self->getK0());
-                    return self->getDeterminant();
+                    return SlabSolver_getDeterminant(self);
                 },
                 array,
                 "Fourier2D.get_determinant",
@@ -203,7 +203,7 @@ static py::object FourierSolver2D_getDeterminant(py::tuple args, py::dict kwargs
             return UFUNC<dcomplex>(
                 [self](dcomplex x) -> dcomplex {
                     self->expansion.setKtran(x);
-                    return self->getDeterminant();
+                    return SlabSolver_getDeterminant(self);
                 },
                 array,
                 "Fourier2D.get_determinant",
@@ -212,7 +212,7 @@ static py::object FourierSolver2D_getDeterminant(py::tuple args, py::dict kwargs
             return UFUNC<dcomplex>(
                 [self](dcomplex x) -> dcomplex {
                     self->expansion.setBeta(x);
-                    return self->getDeterminant();
+                    return SlabSolver_getDeterminant(self);
                 },
                 array,
                 "Fourier2D.get_determinant",
@@ -288,6 +288,7 @@ static size_t FourierSolver2D_findMode(py::tuple args, py::dict kwargs) {
     else
         throw TypeError(u8"find_mode() got unexpected keyword argument '{0}'", key);
 
+    ReleaseGIL nogil;
     return self->findMode(what, value);
 }
 
@@ -353,25 +353,25 @@ py::object FourierSolver3D_getDeterminant(py::tuple args, py::dict kwargs) {
 
     switch (what) {
         case WHAT_NOTHING:
-            return py::object(self->getDeterminant());
+            return py::object(SlabSolver_getDeterminant(self));
         case WHAT_WAVELENGTH:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion.setK0(2e3*PI/x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion.setK0(2e3*PI/x); return SlabSolver_getDeterminant(self); },
                 array, "Fourier3D.get_determinant", "lam"
             );
         case WHAT_K0:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion.setK0(x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion.setK0(x); return SlabSolver_getDeterminant(self); },
                 array, "Fourier3D.get_determinant", "k0"
             );
         case WHAT_KLONG:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion.setKlong(x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion.setKlong(x); return SlabSolver_getDeterminant(self); },
                 array, "Fourier3D.get_determinant", "klong"
             );
         case WHAT_KTRAN:
             return UFUNC<dcomplex>(
-                [self](dcomplex x) -> dcomplex { self->expansion.setKtran(x); return self->getDeterminant(); },
+                [self](dcomplex x) -> dcomplex { self->expansion.setKtran(x); return SlabSolver_getDeterminant(self); },
                 array, "Fourier3D.get_determinant", "ktran"
             );
     }
@@ -443,6 +443,7 @@ size_t FourierSolver3D_findMode(py::tuple args, py::dict kwargs) {
     else
         throw TypeError(u8"find_mode() got unexpected keyword argument '{0}'", key);
 
+    ReleaseGIL nogil;
     return self->findMode(what, value);
 }
 
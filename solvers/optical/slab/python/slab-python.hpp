@@ -112,6 +112,24 @@ static void Solver_setLam0(SolverT& self, py::object value) {
     else self.setLam0(py::extract<double>(value));
 }
 
+template <typename SolverT>
+static void Solver_setDiagonalizationCacheSize(SolverT& self, size_t size) {
+    self.setDiagonalizationCache(size, self.getDiagonalizationCacheDir());
+}
+
+template <typename SolverT>
+static py::object Solver_getDiagonalizationCacheDir(const SolverT& self) {
+    std::string dir = self.getDiagonalizationCacheDir();
+    if (dir.empty()) return py::object();
+    return py::object(dir);
+}
+
+template <typename SolverT>
+static void Solver_setDiagonalizationCacheDir(SolverT& self, py::object value) {
+    self.setDiagonalizationCache(self.getDiagonalizationCacheSize(),
+                                 value.is_none()? std::string() : py::extract<std::string>(py::str(value))());
+}
+
 template <typename SolverT>
 static py::tuple SlabSolver_getStack(SolverT& self) {
     self.Solver::initCalculation();
@@ -134,6 +152,13 @@ static shared_ptr<OrderedAxis> SlabSolver_getLayerCenters(SolverT& self) {
     return make_shared<OrderedAxis>(*self.verts);
 }
 
+/// Compute the determinant with the GIL released, as it runs OpenMP threads that may call Python materials
+template <typename SolverT>
+inline dcomplex SlabSolver_getDeterminant(SolverT* self) {
+    ReleaseGIL nogil;
+    return self->getDeterminant();
+}
+
 // template <typename SolverT>
 // static py::tuple SlabSolver_getLayerSets(const SolverT& self) {
 //     py::list result;
@@ -306,19 +331,25 @@ static double getModeLoss(const Mode& mode) {
 template <typename Solver>
 py::tuple Solver_getMatrices(Solver& self, size_t layer) {
     cmatrix RE, RH;
-    self.getMatrices(layer, RE, RH);
+    {
+        ReleaseGIL nogil;
+        self.getMatrices(layer, RE, RH);
+    }
     return py::make_tuple(py::object(RE), py::object(RH));
 }
 
 template <typename Solver>
 py::tuple Solver_getDiagonalized(Solver& self, size_t layer) {
-    self.Solver::initCalculation();
-    if (!self.transfer) {
-        self.initTransfer(self.getExpansion(), false);
-        self.transfer->initDiagonalization();
-        self.transfer->diagonalizer->diagonalizeLayer(layer);
-    } else if (!self.transfer->diagonalizer->isDiagonalized(layer)) {
-        self.transfer->diagonalizer->diagonalizeLayer(layer);
+    {
+        ReleaseGIL nogil;
+        self.Solver::initCalculation();
+        if (!self.transfer) {
+            self.initTransfer(self.getExpansion(), false);
+            self.transfer->initDiagonalization();
+            self.transfer->diagonalizer->diagonalizeLayer(layer);
+        } else if (!self.transfer->diagonalizer->isDiagonalized(layer)) {
+            self.transfer->diagonalizer->diagonalizeLayer(layer);
+        }
     }
     cdiagonal gamma = self.transfer->diagonalizer->Gamma(layer);
     cmatrix TE = self.transfer->diagonalizer->TE(layer),
@@ -349,6 +380,7 @@ struct Eigenmodes {
                outLightMagnitude(this, &Eigenmodes::getLightMagnitude, &Eigenmodes::size),
                outLightE(this, &Eigenmodes::getLightE, &Eigenmodes::size),
                outLightH(this, &Eigenmodes::getLightH, &Eigenmodes::size) {
+        ReleaseGIL nogil;
         bool changed = solver.Solver::initCalculation() || solver.setExpansionDefaults(true);
         if (!solver.transfer) {
             solver.initTransfer(solver.getExpansion(), false);
@@ -553,21 +585,25 @@ struct Scattering {
 
 
     double reflectivity() {
+        ReleaseGIL nogil;
         if (!solver->initCalculation()) solver->setExpansionDefaults();
         return solver->getReflection(incident, side);
     }
 
     double transmittivity() {
+        ReleaseGIL nogil;
         if (!solver->initCalculation()) solver->setExpansionDefaults();
         return solver->getTransmission(incident, side);
     }
 
     double reflectivity100() {
+        ReleaseGIL nogil;
         if (!solver->initCalculation()) solver->setExpansionDefaults();
         return 100. * solver->getReflection(incident, side);
     }
 
     double transmittivity100() {
+        ReleaseGIL nogil;
         if (!solver->initCalculation()) solver->setExpansionDefaults();
         return 100. * solver->getTransmission(incident, side);
     }
@@ -947,6 +983,29 @@ struct Scattering {
     }
 };
 
+/**
+ * Spectral sweep over the wavelengths given as Python array.
+ * Refractive indices of the materials are computed for all the wavelengths at once and are released at the end
+ * of the sweep.
+ */
+struct SpectralSweep {
+    Expansion& expansion;
+
+    SpectralSweep(Expansion& expansion, const py::object& wavelength): expansion(expansion) {
+        if (py::extract<double>(wavelength).check()) return;
+        PyArrayObject* arr = (PyArrayObject*)PyArray_FROM_OTF(wavelength.ptr(), NPY_DOUBLE, NPY_ARRAY_IN_ARRAY);
+        if (!arr) {
+            PyErr_Clear();  // UFUNC reports the error
+            return;
+        }
+        const double* data = (const double*)PyArray_DATA(arr);
+        expansion.setSpectralWavelengths(std::vector<double>(data, data + PyArray_SIZE(arr)));
+        Py_DECREF(arr);
+    }
+
+    ~SpectralSweep() { expansion.clearSpectralWavelengths(); }
+};
+
 template <typename SolverT> inline const char* solver_compute_reflectivity_name() { return "compute_reflectivity"; }
 template <typename SolverT> inline const char* solver_compute_transmittivity_name() { return "compute_transmittivity"; }
 
@@ -960,7 +1019,9 @@ py::object Solver_computeReflectivity_polarization(SolverT* self,
 {
     if (!self->Solver::initCalculation())
         self->setExpansionDefaults(false);
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([=](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         cvector incident = self->incidentVector(side, polarization, lam);
         self->getExpansion().setK0(k0);
@@ -977,7 +1038,9 @@ py::object Solver_computeTransmittivity_polarization(SolverT* self,
 {
     if (!self->Solver::initCalculation())
         self->setExpansionDefaults(false);
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([=](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         cvector incident = self->incidentVector(side, polarization, lam);
         self->getExpansion().setK0(k0);
@@ -994,7 +1057,9 @@ py::object Solver_computeReflectivity_index(SolverT* self,
 {
     if (!self->Solver::initCalculation())
         self->setExpansionDefaults(false);
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([=](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         cvector incident = self->incidentVector(side, index, lam);
         self->getExpansion().setK0(k0);
@@ -1011,7 +1076,9 @@ py::object Solver_computeTransmittivity_index(SolverT* self,
 {
     if (!self->Solver::initCalculation())
         self->setExpansionDefaults(false);
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([=](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         cvector incident = self->incidentVector(side, index, lam);
         self->getExpansion().setK0(k0);
@@ -1036,7 +1103,9 @@ py::object Solver_computeReflectivity_array(SolverT* self,
 
     cvector incident((dcomplex*)PyArray_DATA(arr), size_t(PyArray_DIMS(arr)[0]), plask::python::detail::NumpyDataDeleter(arr));
 
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([self, incident, side](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         self->getExpansion().setK0(k0);
         return 100. * self->getReflection(self->incidentVector(side, incident, lam), side);
@@ -1060,7 +1129,9 @@ py::object Solver_computeTransmittivity_array(SolverT* self,
 
     cvector incident((dcomplex*)PyArray_DATA(arr), size_t(PyArray_DIMS(arr)[0]), plask::python::detail::NumpyDataDeleter(arr));
 
+    SpectralSweep sweep(self->getExpansion(), wavelength);
     return UFUNC<double>([self, incident, side](double lam)->double {
+        ReleaseGIL nogil;
         double k0 = 2e3*PI/lam;
         self->getExpansion().setK0(k0);
         return 100. * self->getTransmission(self->incidentVector(side, incident, lam), side);
@@ -1086,12 +1157,14 @@ void set_max_temp_diff(SolverT* self, py::object value) {
 template <typename SolverT>
 static double getIntegralEE_0(SolverT& self, double z1, double z2) {
     if (self.modes.size() == 0) throw IndexError(u8"No mode computed");
+    ReleaseGIL nogil;
     return self.getIntegralEE(0, z1, z2);
 }
 
 template <typename SolverT>
 static double getIntegralHH_0(SolverT& self, double z1, double z2) {
     if (self.modes.size() == 0) throw IndexError(u8"No mode computed");
+    ReleaseGIL nogil;
     return self.getIntegralHH(0, z1, z2);
 }
 
@@ -1099,6 +1172,7 @@ template <typename SolverT>
 static double getIntegralEE(SolverT& self, int num, double z1, double z2) {
     if (num < 0) num += int(self.modes.size());
     if (std::size_t(num) >= self.modes.size()) throw IndexError(u8"Bad mode number {:d}", num);
+    ReleaseGIL nogil;
     return self.getIntegralEE(num, z1, z2);
 }
 
@@ -1106,6 +1180,7 @@ template <typename SolverT>
 static double getIntegralHH(SolverT& self, int num, double z1, double z2) {
     if (num < 0) num += int(self.modes.size());
     if (std::size_t(num) >= self.modes.size()) throw IndexError(u8"Bad mode number {:d}", num);
+    ReleaseGIL nogil;
     return self.getIntegralHH(num, z1, z2);
 }
 
@@ -1200,6 +1275,27 @@ inline void export_base(Class solver) {
                          "*full*       Determinant of the matrix\n"
                          "============ ======================================\n"
                         );
+    solver.add_property("diagonalization_cache_size", &Solver::getDiagonalizationCacheSize,
+                        &Solver_setDiagonalizationCacheSize<Solver>,
+                        "Maximum number of layer diagonalizations cached in memory.\n\n"
+                        "Cached diagonalizations are identified by the content of the layer matrices,\n"
+                        "so they are reused by any layer with identical parameters, also in subsequent\n"
+                        "computations. If this is zero and :attr:`diagonalization_cache_dir` is None,\n"
+                        "the cache is disabled.\n"
+                       );
+    solver.add_property("diagonalization_cache_dir", &Solver_getDiagonalizationCacheDir<Solver>,
+                        &Solver_setDiagonalizationCacheDir<Solver>,
+                        "Directory of the on-disk cache of layer diagonalizations.\n\n"
+                        "If set, computed diagonalizations are stored in this directory and can be reused\n"
+                        "by subsequent jobs. None means that diagonalizations are cached only in memory.\n"
+                       );
+    solver.def_readwrite("spectral_chunk", &Solver::spectral_chunk,
+                         "Number of wavelengths for which refractive indices are computed at once.\n\n"
+                         "When reflectivity or transmittivity is computed for an array of wavelengths,\n"
+                         "material parameters are evaluated in chunks of this many wavelengths and only\n"
+                         "the current chunk is kept in memory. Zero means that all the wavelengths are\n"
+                         "evaluated at once.\n"
+                        );
     solver.add_property("lam0", Solver_getLam0<Solver>, Solver_setLam0<Solver>,
                         "Reference wavelength.\n\n"
                         "This is a wavelength at which refractive index is retrieved from the structure.\n"
@@ -119,108 +119,105 @@ void ReflectionTransfer::findReflection(std::size_t start, std::size_t end, bool
     // in the beginning the P matrix is zero
     std::fill_n(P.data(), NN, dcomplex(0.0));
 
-    std::exception_ptr error;
-
-    #pragma omp parallel for schedule(dynamic,1)
-    for (int l = 0; l < int(diagonalizer->lcount); ++l) {
-        try {
-            if (!error) diagonalizer->diagonalizeLayer(l);
-        } catch(...) {
-            error = std::current_exception();
-        }
-    }
-    if (error) std::rethrow_exception(error);
-
-    #ifdef OPENMP_FOUND
-        write_debug("{}: Entering into single region of reflection search", solver->getId());
-    #endif
+    // Diagonalize layers in parallel and propagate the reflection matrix through each layer as soon as it is ready
+    DiagonalizationPipeline pipeline(diagonalizer.get(), solver->stack, start, end);
 
-    // If we do not use emitting, we have to set field at the edge to 0 and the apply PML
-    if (!emitting) {
-        gamma = diagonalizer->Gamma(solver->stack[start]);
-        // Apply PML
-        // F(0) + B(0) = 0 ==> P(0) = -I
-        for (std::size_t i = 0; i < N; i++) {
-            dcomplex g = gamma[i] * solver->vpml.factor;
-            P(i,i) = - exp(-2. * I * g * solver->vpml.size);                // P = phas * (-I) * phas
-        }
-        assert(!P.isnan());
+    pipeline.run([&]() {
+        #ifdef OPENMP_FOUND
+            write_debug("{}: Entering into single region of reflection search", solver->getId());
+        #endif
 
-        // Shift matrix by `pmldist`
-        for (std::size_t i = 0; i < N; i++) phas[i] = exp(-I*gamma[i]*solver->vpml.dist);
-        assert(!phas.isnan());
-        mult_diagonal_by_matrix(phas, P); mult_matrix_by_diagonal(P, phas); // P = phas * P * phas
-    }
-
-    if (storeP == STORE_ALL) saveP(start);
-
-    for (std::size_t n = start; n != end; n += inc) {
-        gamma = diagonalizer->Gamma(solver->stack[n]);
-        assert(!gamma.isnan());
+        pipeline.wait(solver->stack[start]);
 
-        assert(!P.isnan());
+        // If we do not use emitting, we have to set field at the edge to 0 and the apply PML
+        if (!emitting) {
+            gamma = diagonalizer->Gamma(solver->stack[start]);
+            // Apply PML
+            // F(0) + B(0) = 0 ==> P(0) = -I
+            for (std::size_t i = 0; i < N; i++) {
+                dcomplex g = gamma[i] * solver->vpml.factor;
+                P(i,i) = - exp(-2. * I * g * solver->vpml.size);                // P = phas * (-I) * phas
+            }
+            assert(!P.isnan());
 
-        if (n != start) {
-            double H = solver->vbounds->at(n) - solver->vbounds->at(n-1);
-            for (std::size_t i = 0; i < N; i++) phas[i] = exp(-I*gamma[i]*H);
+            // Shift matrix by `pmldist`
+            for (std::size_t i = 0; i < N; i++) phas[i] = exp(-I*gamma[i]*solver->vpml.dist);
             assert(!phas.isnan());
-            mult_diagonal_by_matrix(phas, P); mult_matrix_by_diagonal(P, phas);         // P = phas * P * phas
+            mult_diagonal_by_matrix(phas, P); mult_matrix_by_diagonal(P, phas); // P = phas * P * phas
         }
 
-        // Further calculations must be done only if the adjacent layers are not the same
-        if (solver->stack[n] != solver->stack[n+inc] || (emitting && n == start)) {
-            // temp = invTE(n+1)*TE(n) * [ phas*P*phas + I ]
-            assert(!diagonalizer->TE(solver->stack[n]).isnan());
-            assert(!diagonalizer->invTE(solver->stack[n]).isnan());
-            for (std::size_t i = 0, ii = 0; i < N; i++, ii += (N+1)) P[ii] += 1.;       // P = P + I
-            if (solver->stack[n] != solver->stack[n+inc]) {
-                mult_matrix_by_matrix(diagonalizer->TE(solver->stack[n]), P, work);     // work = TE[n] * P
-                mult_matrix_by_matrix(diagonalizer->invTE(solver->stack[n+inc]), work, temp);// temp = invTE[n+1] * work (= A)
-            } else {
-                std::copy_n(P.data(), NN, temp.data());
-            }
+        if (storeP == STORE_ALL) saveP(start);
 
-            // P = invTH(n+1)*TH(n) * [ phas*P*phas - I ]
-            assert(!diagonalizer->TH(solver->stack[n]).isnan());
-            assert(!diagonalizer->invTH(solver->stack[n+inc]).isnan());
-            for (std::size_t i = 0, ii = 0; i < N; i++, ii += (N+1)) P[ii] -= 2.;       // P = P - I
+        for (std::size_t n = start; n != end; n += inc) {
+            pipeline.wait(solver->stack[n+inc]);
+            gamma = diagonalizer->Gamma(solver->stack[n]);
+            assert(!gamma.isnan());
 
-            // multiply rows of P by -1 where necessary for properly outgoing wave
-            if (emitting && n == start) {
-                for (std::size_t i = 0; i < N; i++)
-                    if (real(gamma[i]) < -SMALL)
-                        for(std::size_t j = 0; j < N; j++) P(i,j) = -P(i,j);
-            }
+            assert(!P.isnan());
 
-            if (solver->stack[n] != solver->stack[n+inc]) {
-                mult_matrix_by_matrix(diagonalizer->TH(solver->stack[n]), P, work);     // work = TH[n] * P
-                mult_matrix_by_matrix(diagonalizer->invTH(solver->stack[n+inc]), work, P);// P = invTH[n+1] * work (= P)
+            if (n != start) {
+                double H = solver->vbounds->at(n) - solver->vbounds->at(n-1);
+                for (std::size_t i = 0; i < N; i++) phas[i] = exp(-I*gamma[i]*H);
+                assert(!phas.isnan());
+                mult_diagonal_by_matrix(phas, P); mult_matrix_by_diagonal(P, phas);         // P = phas * P * phas
             }
 
-            // temp := temp-P, P := temp+P
-            for (std::size_t i = 0; i < NN; i++) {
-                dcomplex e = temp[i], h = P[i];
-                temp[i] = e - h;
-                P[i] = e + h;
+            // Further calculations must be done only if the adjacent layers are not the same
+            if (solver->stack[n] != solver->stack[n+inc] || (emitting && n == start)) {
+                // temp = invTE(n+1)*TE(n) * [ phas*P*phas + I ]
+                assert(!diagonalizer->TE(solver->stack[n]).isnan());
+                assert(!diagonalizer->invTE(solver->stack[n]).isnan());
+                for (std::size_t i = 0, ii = 0; i < N; i++, ii += (N+1)) P[ii] += 1.;       // P = P + I
+                if (solver->stack[n] != solver->stack[n+inc]) {
+                    mult_matrix_by_matrix(diagonalizer->TE(solver->stack[n]), P, work);     // work = TE[n] * P
+                    mult_matrix_by_matrix(diagonalizer->invTE(solver->stack[n+inc]), work, temp);// temp = invTE[n+1] * work (= A)
+                } else {
+                    std::copy_n(P.data(), NN, temp.data());
+                }
+
+                // P = invTH(n+1)*TH(n) * [ phas*P*phas - I ]
+                assert(!diagonalizer->TH(solver->stack[n]).isnan());
+                assert(!diagonalizer->invTH(solver->stack[n+inc]).isnan());
+                for (std::size_t i = 0, ii = 0; i < N; i++, ii += (N+1)) P[ii] -= 2.;       // P = P - I
+
+                // multiply rows of P by -1 where necessary for properly outgoing wave
+                if (emitting && n == start) {
+                    for (std::size_t i = 0; i < N; i++)
+                        if (real(gamma[i]) < -SMALL)
+                            for(std::size_t j = 0; j < N; j++) P(i,j) = -P(i,j);
+                }
+
+                if (solver->stack[n] != solver->stack[n+inc]) {
+                    mult_matrix_by_matrix(diagonalizer->TH(solver->stack[n]), P, work);     // work = TH[n] * P
+                    mult_matrix_by_matrix(diagonalizer->invTH(solver->stack[n+inc]), work, P);// P = invTH[n+1] * work (= P)
+                }
+
+                // temp := temp-P, P := temp+P
+                for (std::size_t i = 0; i < NN; i++) {
+                    dcomplex e = temp[i], h = P[i];
+                    temp[i] = e - h;
+                    P[i] = e + h;
+                }
+
+                // P = P * inv(temp)
+                int info;
+                zgetrf(int(N), int(N), temp.data(), int(N), ipiv, info);                                   // temp = LU(temp)
+                if (info > 0) throw ComputationError(solver->getId(), "findReflection: Matrix [e(n) - h(n)] is singular");
+                assert(info == 0);
+                ztrsm('R', 'U', 'N', 'N', int(N), int(N), 1., temp.data(), int(N), P.data(), int(N));    // P = P * U^{-1}
+                ztrsm('R', 'L', 'N', 'U', int(N), int(N), 1., temp.data(), int(N), P.data(), int(N));           // P = P * L^{-1}
+                if (P.isnan()) throw ComputationError(solver->getId(), "findReflection: NaN in reflection matrix");
+                // reorder columns (there is no such function in LAPACK)
+                for (std::ptrdiff_t j = N-1; j >= 0; j--) {
+                    int jp = ipiv[j]-1;
+                    for (std::size_t i = 0; i < N; i++) std::swap(P(i,j), P(i,jp));
+                }
             }
 
-            // P = P * inv(temp)
-            int info;
-            zgetrf(int(N), int(N), temp.data(), int(N), ipiv, info);                                   // temp = LU(temp)
-            if (info > 0) throw ComputationError(solver->getId(), "findReflection: Matrix [e(n) - h(n)] is singular");
-            assert(info == 0);
-            ztrsm('R', 'U', 'N', 'N', int(N), int(N), 1., temp.data(), int(N), P.data(), int(N));    // P = P * U^{-1}
-            ztrsm('R', 'L', 'N', 'U', int(N), int(N), 1., temp.data(), int(N), P.data(), int(N));           // P = P * L^{-1}
-            if (P.isnan()) throw ComputationError(solver->getId(), "findReflection: NaN in reflection matrix");
-            // reorder columns (there is no such function in LAPACK)
-            for (std::ptrdiff_t j = N-1; j >= 0; j--) {
-                int jp = ipiv[j]-1;
-                for (std::size_t i = 0; i < N; i++) std::swap(P(i,j), P(i,jp));
-            }
+            if (storeP == STORE_ALL) saveP(n+inc);
         }
+    });
 
-        if (storeP == STORE_ALL) saveP(n+inc);
-    }
     if (storeP == STORE_LAST) saveP(store);
 }
 
@@ -526,7 +523,8 @@ cvector ReflectionTransfer::getFieldVectorE(double z, std::size_t n, Propagation
     cdiagonal gamma = diagonalizer->Gamma(solver->stack[n]);
 
     const std::size_t N = gamma.size();
-    cvector E(N);
+    MatrixArena::Scope scope;
+    cvector E = MatrixArena::vector(N);
 
     for (std::size_t i = 0; i < N; i++) {
         dcomplex phi = - I * gamma[i] * z;
@@ -553,7 +551,8 @@ cvector ReflectionTransfer::getFieldVectorH(double z, std::size_t n, Propagation
     cdiagonal gamma = diagonalizer->Gamma(solver->stack[n]);
 
     const std::size_t N = gamma.size();
-    cvector H(N);
+    MatrixArena::Scope scope;
+    cvector H = MatrixArena::vector(N);
 
     for (std::size_t i = 0; i < N; i++) {
         dcomplex phi = - I * gamma[i] * z;
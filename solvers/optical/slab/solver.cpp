@@ -61,6 +61,21 @@ void SlabBase::initTransfer(Expansion& expansion, bool reflection) {
     }
 }
 
+void SlabBase::setDiagonalizationCache(size_t size, const std::string& dir) {
+    if (size == 0 && dir.empty())
+        diagonalization_cache.reset();
+    else if (!diagonalization_cache || diagonalization_cache->capacity != size || diagonalization_cache->directory != dir)
+        diagonalization_cache = plask::make_shared<DiagonalizationCache>(size, dir);
+}
+
+size_t SlabBase::getDiagonalizationCacheSize() const {
+    return diagonalization_cache? diagonalization_cache->capacity : 0;
+}
+
+std::string SlabBase::getDiagonalizationCacheDir() const {
+    return diagonalization_cache? diagonalization_cache->directory : std::string();
+}
+
 
 template <typename BaseT>
 SlabSolver<BaseT>::SlabSolver(const std::string& name): BaseT(name),
@@ -271,6 +286,10 @@ void SlabSolver<BaseT>::parseCommonSlabConfiguration(XMLReader& reader, Manager&
             .value("full", Transfer::DETERMINANT_FULL)
             .get(determinant_type);
         reader.requireTagEnd();
+    } else if (param == "diagonalization") {
+        setDiagonalizationCache(reader.getAttribute<size_t>("cache-size", getDiagonalizationCacheSize()),
+                                reader.getAttribute<std::string>("cache-dir", getDiagonalizationCacheDir()));
+        reader.requireTagEnd();
     } else if (param == "root") {
         readRootDiggerConfig(reader);
     } else {
@@ -515,6 +534,52 @@ void SlabSolver<BaseT>::setupLayers()
 }
 
 
+template <typename BaseT>
+bool SlabSolver<BaseT>::updateChangedLayers(const Geometry::Event& evt)
+{
+    // Layers are grouped by their materials, so the new materials can change the layers structure
+    shared_ptr<OrderedAxis> old_vbounds = vbounds, old_verts = verts;
+    std::vector<std::size_t> old_stack = stack;
+    std::vector<bool> old_lgained = lgained;
+    std::ptrdiff_t old_interface = interface;
+    setupLayers();
+    if (stack != old_stack || lgained != old_lgained || interface != old_interface ||
+        vbounds->size() != old_vbounds->size() || !std::equal(vbounds->begin(), vbounds->end(), old_vbounds->begin()))
+        return false;
+    vbounds = old_vbounds;
+    verts = old_verts;
+
+    // Find layers in the changed region; the outermost ones extend to infinity and they can take the material
+    // of the object at the edge of the structure, so they are changed if the region only touches them
+    const size_t nb = vbounds->size();
+    const bool symmetric = this->geometry->isSymmetric(Geometry::DIRECTION_VERT);
+    lchanged.resize(lcount, false);
+    size_t nchanged = 0;
+    for (const auto& box: this->geometry->getChangedBoundingBoxes(evt)) {
+        for (int mirror = 0; mirror != (symmetric? 2 : 1); ++mirror) {
+            double lower = mirror? -box.upper.vert() : box.lower.vert(),
+                   upper = mirror? -box.lower.vert() : box.upper.vert();
+            for (size_t i = 0; i <= nb; ++i) {
+                double bottom = (i == 0)? -INFINITY : vbounds->at(i-1),
+                       top = (i == nb)? INFINITY : vbounds->at(i);
+                if ((i == 0)? lower > top : lower >= top) continue;
+                if ((i == nb)? upper < bottom : upper <= bottom) continue;
+                size_t l = stack[i];
+                if (lchanged[l]) continue;
+                lchanged[l] = true;
+                getExpansion().clearSpectralCache(l);
+                ++nchanged;
+            }
+        }
+    }
+
+    Solver::writelog(LOG_DETAIL, "Materials changed in {0} of {1} distinct layers", nchanged, lcount);
+    this->clearModes();
+    this->clearFields();
+    return true;
+}
+
+
 template <typename BaseT>
 DataVector<const Tensor3<dcomplex>> SlabSolver<BaseT>::getRefractiveIndexProfile
                                         (const shared_ptr<const MeshD<BaseT::SpaceType::DIM>>& dst_mesh,
@@ -48,6 +48,9 @@ template <typename BaseT> class PLASK_SOLVER_API SlabSolver : public BaseT, publ
     void onInitialize() override { setupLayers(); }
 
     void onGeometryChange(const Geometry::Event& evt) override {
+        // Resizing can move other objects in the containers and the event does not tell their old positions,
+        // so the changed layers cannot be determined and such events always invalidate the solver
+        if (evt.isMaterialOnly() && this->geometry && this->isInitialized() && updateChangedLayers(evt)) return;
         BaseT::onGeometryChange(evt);
         if (this->geometry) {
             if (evt.flags() == 0) {
@@ -69,6 +72,15 @@ template <typename BaseT> class PLASK_SOLVER_API SlabSolver : public BaseT, publ
     /// Compute layer boundaries and detect layer sets
     void setupLayers();
 
+    /**
+     * Update layers after the change of materials.
+     * If the layers are not changed, the integrals are recomputed only for the layers containing the changed objects
+     * and the rest of the solver state is kept.
+     * \param evt information about geometry changes
+     * \return \c true if the layers have been updated or \c false if the solver must be invalidated
+     */
+    bool updateChangedLayers(const Geometry::Event& evt);
+
     /// Smoothing coefficient
     double smooth;
 
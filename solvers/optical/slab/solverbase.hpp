@@ -22,6 +22,8 @@
 
 namespace plask { namespace optical { namespace slab {
 
+class DiagonalizationCache;
+
 /// Information about lateral PMLs
 struct PML {
     dcomplex factor;  ///< PML factor
@@ -86,6 +88,23 @@ struct PLASK_SOLVER_API SlabBase {
     /// Initialize transfer class
     void initTransfer(Expansion& expansion, bool reflection);
 
+    /// Cache of layer diagonalizations (null if disabled)
+    shared_ptr<DiagonalizationCache> diagonalization_cache;
+
+    /**
+     * Enable or disable cache of layer diagonalizations
+     * \param size maximum number of diagonalizations kept in memory
+     * \param dir directory for the on-disk cache (empty for memory-only cache)
+     * The cache is disabled if \a size is zero and \a dir is empty.
+     */
+    void setDiagonalizationCache(size_t size, const std::string& dir = "");
+
+    /// Get maximum number of diagonalizations cached in memory
+    size_t getDiagonalizationCacheSize() const;
+
+    /// Get directory of the on-disk diagonalizations cache
+    std::string getDiagonalizationCacheDir() const;
+
     /// Layer boundaries
     shared_ptr<OrderedAxis> vbounds;
 
@@ -98,6 +117,9 @@ struct PLASK_SOLVER_API SlabBase {
     /// Information if the layer has gain
     std::vector<bool> lgained;
 
+    /// Information if the layer materials have changed since its integrals were computed
+    std::vector<bool> lchanged;
+
     /// Organization of layers in the stack
     std::vector<std::size_t> stack;
 
@@ -128,6 +150,9 @@ struct PLASK_SOLVER_API SlabBase {
     /// Always compute material coefficients/integrals for gained layers for current wavelength
     bool always_recompute_gain;
 
+    /// Maximum number of wavelengths of the spectral sweep for which refractive indices are computed at once (0 means all)
+    size_t spectral_chunk;
+
   protected:
     /// Can layers be automatically grouped
     bool group_layers;
@@ -156,6 +181,7 @@ struct PLASK_SOLVER_API SlabBase {
           vpml(dcomplex(1., -2.), 2.0, 10., 0),
           recompute_integrals(true),
           always_recompute_gain(false),
+          spectral_chunk(32),
           group_layers(true),
           max_temp_diff(NAN),
           temp_dist(0.5),
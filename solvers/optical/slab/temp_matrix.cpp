@@ -0,0 +1,55 @@
+/* 
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#include "temp_matrix.hpp"
+
+namespace plask { namespace optical { namespace slab {
+
+constexpr size_t MatrixArena::ALIGNMENT;
+constexpr size_t MatrixArena::BLOCK_SIZE;
+
+MatrixArena::~MatrixArena() {
+    for (Block& block: blocks) aligned_free<char>(block.data);
+}
+
+MatrixArena& MatrixArena::local() {
+    static thread_local MatrixArena arena;
+    return arena;
+}
+
+void* MatrixArena::allocate(size_t bytes) {
+    assert(scopes != 0);    // memory allocated outside of any scope would never be released
+    bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (current < blocks.size()) {
+        if (used + bytes <= blocks[current].size) {
+            void* result = blocks[current].data + used;
+            used += bytes;
+            return result;
+        }
+        // Blocks following the current one are free, so they can be reused or replaced
+        if (used != 0) ++current;
+    }
+    if (current == blocks.size()) blocks.push_back(Block{nullptr, 0});
+    Block& block = blocks[current];
+    if (block.size < bytes) {
+        aligned_free<char>(block.data);
+        block.data = nullptr; block.size = 0;
+        size_t size = std::max(bytes, BLOCK_SIZE);
+        block.data = aligned_malloc<char>(size);
+        block.size = size;
+    }
+    used = bytes;
+    return block.data;
+}
+
+}}} // namespace plask::optical::slab
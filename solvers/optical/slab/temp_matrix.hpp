@@ -154,6 +154,86 @@ inline TempMatrix TempMatrixPool::get(size_t rows, size_t cols) {
 }
 
 
+/**
+ * Per-thread arena for short-lived work arrays, matrices, and vectors.
+ *
+ * Memory is carved from large aligned blocks by bumping a pointer and it is released at once when the innermost
+ * MatrixArena::Scope is closed. The blocks are kept for the whole life of the thread, so repeated computations
+ * (e.g. consecutive determinant evaluations) do not touch the heap after the first one. Matrices and vectors obtained
+ * from the arena do not own their data and must not be used after the scope they were created in is closed.
+ */
+class PLASK_SOLVER_API MatrixArena {
+
+    /// Alignment of the allocated arrays (the same as provided by aligned_malloc)
+    static constexpr size_t ALIGNMENT = PLASK_MEMORY_ALIGNMENT;
+
+    /// Minimum size of a single block
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;  ///< Allocated blocks
+    size_t current;             ///< Index of the current block
+    size_t used;                ///< Number of bytes used in the current block
+    unsigned scopes;            ///< Number of open scopes
+
+    MatrixArena(): current(0), used(0), scopes(0) {}
+
+    void* allocate(size_t bytes);
+
+  public:
+
+    MatrixArena(const MatrixArena&) = delete;
+    MatrixArena& operator=(const MatrixArena&) = delete;
+
+    ~MatrixArena();
+
+    /// Get the arena of the current thread
+    static MatrixArena& local();
+
+    /**
+     * Allocate uninitialized array in the arena of the current thread
+     * \param n number of elements
+     */
+    template <typename T>
+    static T* array(size_t n) {
+        return static_cast<T*>(local().allocate(n * sizeof(T)));
+    }
+
+    /// Allocate uninitialized temporary matrix in the arena of the current thread
+    static cmatrix matrix(size_t rows, size_t cols) {
+        return cmatrix(rows, cols, array<dcomplex>(rows * cols));
+    }
+
+    /// Allocate uninitialized temporary vector in the arena of the current thread
+    static cvector vector(size_t n) {
+        return cvector(array<dcomplex>(n), n);
+    }
+
+    /**
+     * Scope of temporary allocations.
+     * All the memory allocated from the arena of the current thread while the scope is open is released
+     * when it is closed. Scopes may be nested.
+     */
+    class Scope {
+        MatrixArena& arena;
+        size_t current, used;
+      public:
+        Scope(): arena(local()), current(arena.current), used(arena.used) { ++arena.scopes; }
+        ~Scope() {
+            arena.current = current;
+            arena.used = used;
+            --arena.scopes;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+
 }}} // namespace plask
 
 #endif // PLASK__SOLVER_SLAB_TEMPMATRIX_H
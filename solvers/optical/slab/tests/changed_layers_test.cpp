@@ -0,0 +1,85 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Changed layers test"
+#include <boost/test/unit_test.hpp>
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
+#include "../fourier/solver2d.hpp"
+
+using namespace plask;
+using namespace plask::optical::slab;
+
+struct TestMaterial: public Material {
+    std::string nm;
+    TestMaterial(const std::string& name): nm(name) {}
+    std::string name() const override { return nm; }
+    Kind kind() const override { return Material::DIELECTRIC; }
+};
+
+// Stack of layers: substrate, cladding, core, cladding, and cap
+struct LayersFixture {
+    shared_ptr<Material> A = plask::make_shared<TestMaterial>("A"), B = plask::make_shared<TestMaterial>("B"),
+                         C = plask::make_shared<TestMaterial>("C"), D = plask::make_shared<TestMaterial>("D"),
+                         E = plask::make_shared<TestMaterial>("E");
+    shared_ptr<Block<2>> core;
+    FourierSolver2D solver;
+
+    LayersFixture(): solver("fourier2d") {
+        auto stack = plask::make_shared<StackContainer<2>>();
+        stack->add(plask::make_shared<Block<2>>(vec(1., 1.0), A));
+        stack->add(plask::make_shared<Block<2>>(vec(1., 0.1), B));
+        stack->add(core = plask::make_shared<Block<2>>(vec(1., 0.2), C));
+        stack->add(plask::make_shared<Block<2>>(vec(1., 0.1), B));
+        stack->add(plask::make_shared<Block<2>>(vec(1., 0.5), D));
+        solver.setGeometry(plask::make_shared<Geometry2DCartesian>(stack, 1.));
+        solver.initCalculation();
+    }
+
+    size_t coreLayer() const { return solver.stack[solver.verts->findNearestIndex(1.2)]; }
+};
+
+BOOST_AUTO_TEST_SUITE(changed_layers)
+
+BOOST_FIXTURE_TEST_CASE(material_only, LayersFixture) {
+    const auto stack = solver.stack;
+    const size_t lcount = solver.lcount;
+    BOOST_REQUIRE(solver.isInitialized());
+
+    // New material keeps the layers structure, so only the core layer is marked for recomputation
+    core->setMaterial(E);
+    BOOST_CHECK(solver.isInitialized());
+    BOOST_CHECK(solver.stack == stack);
+    BOOST_CHECK_EQUAL(solver.lcount, lcount);
+    BOOST_REQUIRE_EQUAL(solver.lchanged.size(), lcount);
+    for (size_t l = 0; l != lcount; ++l) BOOST_CHECK_EQUAL(solver.lchanged[l], l == coreLayer());
+}
+
+BOOST_FIXTURE_TEST_CASE(structure_change, LayersFixture) {
+    // Core of the cladding material merges three layers into one, so the solver must be initialized anew
+    core->setMaterial(B);
+    BOOST_CHECK(!solver.isInitialized());
+    solver.initCalculation();
+    BOOST_CHECK_EQUAL(solver.stack[solver.verts->findNearestIndex(1.05)], coreLayer());
+    BOOST_CHECK_EQUAL(solver.stack[solver.verts->findNearestIndex(1.35)], coreLayer());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
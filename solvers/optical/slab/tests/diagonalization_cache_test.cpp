@@ -0,0 +1,154 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Diagonalization cache test"
+#include <boost/test/unit_test.hpp>
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include "../diagonalizer.hpp"
+
+using namespace plask;
+using namespace plask::optical::slab;
+
+const size_t N = 3;
+
+static cmatrix makeMatrix(double value) {
+    cmatrix matrix(N, N);
+    for (size_t r = 0; r != N; ++r)
+        for (size_t c = 0; c != N; ++c) matrix(r,c) = dcomplex(value + double(r), double(c));
+    return matrix;
+}
+
+// Entry with all values equal to the given one
+static DiagonalizationCache::Entry makeEntry(double value) {
+    DiagonalizationCache::Entry entry { cdiagonal(N, value), cmatrix(N, N, value), cmatrix(N, N, value),
+                                        cmatrix(N, N, value), cmatrix(N, N, value) };
+    return entry;
+}
+
+static DiagonalizationCache::Entry emptyEntry() {
+    return DiagonalizationCache::Entry { cdiagonal(N, 0.), cmatrix(N, N, 0.), cmatrix(N, N, 0.),
+                                         cmatrix(N, N, 0.), cmatrix(N, N, 0.) };
+}
+
+static void checkEntry(const DiagonalizationCache::Entry& entry, double value) {
+    for (size_t i = 0; i != N; ++i) BOOST_CHECK_EQUAL(entry.gamma[i], dcomplex(value));
+    for (const cmatrix* matrix: {&entry.Te, &entry.Th, &entry.Te1, &entry.Th1})
+        for (size_t i = 0; i != N*N; ++i) BOOST_CHECK_EQUAL(matrix->data()[i], dcomplex(value));
+}
+
+struct TempDirectory {
+    boost::filesystem::path path;
+    TempDirectory(): path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("plask-diag-%%%%-%%%%")) {}
+    ~TempDirectory() { boost::system::error_code err; boost::filesystem::remove_all(path, err); }
+};
+
+BOOST_AUTO_TEST_SUITE(diagonalization_cache)
+
+BOOST_AUTO_TEST_CASE(lru_eviction) {
+    DiagonalizationCache cache(2);
+    auto key1 = DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(1.), false),
+         key2 = DiagonalizationCache::key(1, makeMatrix(2.), makeMatrix(2.), false),
+         key3 = DiagonalizationCache::key(1, makeMatrix(3.), makeMatrix(3.), false);
+    cache.store(key1, makeEntry(1.));
+    cache.store(key2, makeEntry(2.));
+
+    // Use the first entry, so the second one is the least recently used and is evicted by the third one
+    auto result = emptyEntry();
+    BOOST_CHECK(cache.load(key1, result));
+    checkEntry(result, 1.);
+    cache.store(key3, makeEntry(3.));
+
+    BOOST_CHECK(!cache.load(key2, result));
+    BOOST_CHECK(cache.load(key1, result));
+    checkEntry(result, 1.);
+    BOOST_CHECK(cache.load(key3, result));
+    checkEntry(result, 3.);
+}
+
+BOOST_AUTO_TEST_CASE(disk_round_trip) {
+    TempDirectory dir;
+    auto key = DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(2.), true);
+    {
+        DiagonalizationCache cache(0, dir.path.string());
+        cache.store(key, makeEntry(5.));
+    }
+    BOOST_CHECK(boost::filesystem::exists(dir.path / (key.str() + ".diag")));
+
+    // New cache (as in other job) finds the entry on disk
+    DiagonalizationCache cache(2, dir.path.string());
+    auto result = emptyEntry();
+    BOOST_CHECK(cache.load(DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(2.), true), result));
+    checkEntry(result, 5.);
+    BOOST_CHECK(!cache.load(DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(2.), false), result));
+}
+
+BOOST_AUTO_TEST_CASE(expansion_kind) {
+    TempDirectory dir;
+    auto key = DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(2.), false);
+    DiagonalizationCache cache(2, dir.path.string());
+    cache.store(key, makeEntry(4.));
+
+    // Identical matrices of an expansion of other kind (e.g. other symmetry) must not use the entry
+    auto other = DiagonalizationCache::key(2, makeMatrix(1.), makeMatrix(2.), false);
+    auto result = emptyEntry();
+    BOOST_CHECK(!cache.load(other, result));
+    checkEntry(result, 0.);
+
+    // Not even if the hashes collide
+    other.hash[0] = key.hash[0]; other.hash[1] = key.hash[1];
+    BOOST_CHECK(!cache.load(other, result));
+    cache.clear();
+    BOOST_CHECK(!cache.load(other, result));
+    checkEntry(result, 0.);
+}
+
+BOOST_AUTO_TEST_CASE(mismatched_entry) {
+    TempDirectory dir;
+    auto key = DiagonalizationCache::key(1, makeMatrix(1.), makeMatrix(2.), false);
+
+    // Forge a key with the same hash but different matrices
+    auto other = DiagonalizationCache::key(1, makeMatrix(3.), makeMatrix(2.), false);
+    other.hash[0] = key.hash[0]; other.hash[1] = key.hash[1];
+
+    DiagonalizationCache cache(2, dir.path.string());
+    cache.store(other, makeEntry(7.));
+    auto result = emptyEntry();
+    BOOST_CHECK(!cache.load(key, result));
+    checkEntry(result, 0.);
+
+    // Entry on disk is rejected as well
+    cache.clear();
+    BOOST_CHECK(boost::filesystem::exists(dir.path / (key.str() + ".diag")));
+    BOOST_CHECK(!cache.load(key, result));
+    checkEntry(result, 0.);
+    BOOST_CHECK(cache.load(other, result));
+    checkEntry(result, 7.);
+
+    // Storing the correct entry replaces the colliding one in memory
+    cache.store(key, makeEntry(8.));
+    BOOST_CHECK(cache.load(key, result));
+    checkEntry(result, 8.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
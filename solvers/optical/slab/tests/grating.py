@@ -45,6 +45,11 @@ class Hi(material.Material):
 class Lo(material.Material):
     nr = nl
 
+@material.simple()
+class Disp(material.Material):
+    def nr(self, lam, temp, conc):
+        return 1.5 + 1e-3 * (lam - 1500.)
+
 
 class GratingTest(unittest.TestCase):
 
@@ -72,6 +77,19 @@ class GratingTest(unittest.TestCase):
         self.assertAlmostEqual(r_tm[0], 98.529, 2)
         self.assertAlmostEqual(r_tm[1], 28.296, 2)
 
+    def testSpectralSweep(self):
+        self.stack.prepend(geometry.Block2D(L, 0.3, 'Disp'))
+        self.solver.lam0 = None
+        lams = linspace(1450., 1650., 9)
+        sweep = self.solver.compute_reflectivity(lams, 'top', 'El')
+        for lam, r in zip(lams, sweep):
+            self.assertAlmostEqual(r, self.solver.compute_reflectivity(lam, 'top', 'El'), 6)
+        for chunk in 0, 4:
+            self.solver.spectral_chunk = chunk
+            chunked = self.solver.compute_reflectivity(lams[::-1], 'top', 'El')
+            for r0, r in zip(sweep[::-1], chunked):
+                self.assertAlmostEqual(r, r0, 6)
+
     def testIntegrals(self):
         self.solver.lam = self.solver.lam0 = 1500.
         scattering = self.solver.scattering('top', 'El')
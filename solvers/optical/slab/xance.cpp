@@ -59,7 +59,8 @@ cvector XanceTransfer::getFieldVectorE(double z, std::size_t n, PropagationDirec
         return cvector(diagonalizer->source()->matrixSize(), NAN);
 
     const std::size_t N = gamma.size();
-    cvector E(N);
+    MatrixArena::Scope scope;
+    cvector E = MatrixArena::vector(N);
 
     switch (part) {
         case PROPAGATION_TOTAL:
@@ -115,7 +116,8 @@ cvector XanceTransfer::getFieldVectorH(double z, std::size_t n, PropagationDirec
         return cvector(diagonalizer->source()->matrixSize(), NAN);
 
     const std::size_t N = gamma.size();
-    cvector H(N);
+    MatrixArena::Scope scope;
+    cvector H = MatrixArena::vector(N);
 
     switch (part) {
         case PROPAGATION_TOTAL:
@@ -11,6 +11,8 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU General Public License for more details.
  */
+#include <plask/checkpoint.hpp>
+
 #include "femT2d.hpp"
 
 namespace plask { namespace thermal { namespace dynamic {
@@ -450,6 +452,37 @@ double DynamicThermalFem2DSolver<Geometry2DType>::compute(double time)
     return 0.;
 }
 
+template<typename Geometry2DType>
+void DynamicThermalFem2DSolver<Geometry2DType>::saveCheckpoint(const std::string& filename) const
+{
+    if (!temperatures) throw NoValue(Temperature::NAME);
+    this->writelog(LOG_INFO, "Saving checkpoint to '{}'", filename);
+    CheckpointWriter checkpoint(filename);
+    checkpoint.writeMesh("mesh", *this->mesh);
+    checkpoint.write("temperatures", temperatures);
+    checkpoint.writeValue("elapstime", elapstime);
+    checkpoint.close();
+}
+
+template<typename Geometry2DType>
+void DynamicThermalFem2DSolver<Geometry2DType>::loadCheckpoint(const std::string& filename)
+{
+    this->writelog(LOG_INFO, "Loading checkpoint from '{}'", filename);
+    CheckpointReader checkpoint(filename);
+    this->initCalculation();
+    if (*checkpoint.readMesh<2>("mesh") != *this->mesh)
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different mesh", filename);
+    DataVector<double> temps = checkpoint.read<double>("temperatures");
+    if (temps.size() != this->maskedMesh->size())
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different geometry", filename);
+    temperatures = temps;
+    elapstime = checkpoint.readValue<double>("elapstime");
+    maxT = *std::max_element(temperatures.begin(), temperatures.end());
+    fluxes.reset();
+    outTemperature.fireChanged();
+    outHeatFlux.fireChanged();
+}
+
 template<typename Geometry2DType>
 void DynamicThermalFem2DSolver<Geometry2DType>::saveHeatFluxes()
 {
@@ -80,6 +80,19 @@ struct PLASK_SOLVER_API DynamicThermalFem2DSolver: public FemSolverWithMaskedMes
     /// Get calculations elapsed time
     double getElapsTime() const { return elapstime; }
 
+    /**
+     * Save computed temperatures and elapsed time to the checkpoint file
+     * \param filename name of the checkpoint file
+     */
+    void saveCheckpoint(const std::string& filename) const;
+
+    /**
+     * Restore computed temperatures and elapsed time from the checkpoint file.
+     * Temperatures are mapped from the file directly, so the calculations can be quickly resumed.
+     * \param filename name of the checkpoint file
+     */
+    void loadCheckpoint(const std::string& filename);
+
     void loadConfiguration(XMLReader& source, Manager& manager) override; // for solver configuration (see: *.xpl file with structures)
 
     DynamicThermalFem2DSolver(const std::string& name="");
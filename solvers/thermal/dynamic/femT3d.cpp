@@ -12,6 +12,7 @@
  * GNU General Public License for more details.
  */
 #include <type_traits>
+#include <plask/checkpoint.hpp>
 
 #include "femT3d.hpp"
 
@@ -21,6 +22,7 @@ const double BIG = 1e16;
 
 DynamicThermalFem3DSolver::DynamicThermalFem3DSolver(const std::string& name) :
     FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>(name),
+    prevstep(0.),
     outTemperature(this, &DynamicThermalFem3DSolver::getTemperatures),
     outHeatFlux(this, &DynamicThermalFem3DSolver::getHeatFluxes),
     outThermalConductivity(this, &DynamicThermalFem3DSolver::getThermalConductivity),
@@ -30,7 +32,12 @@ DynamicThermalFem3DSolver::DynamicThermalFem3DSolver(const std::string& name) :
     elapstime(0.),
     lumping(true),
     rebuildfreq(0),
-    logfreq(500)
+    logfreq(500),
+    adaptive(false),
+    tolerance(0.01),
+    mintimestep(1e-3),
+    maxtimestep(1e3),
+    stepchange(2.)
 {
     temperatures.reset();
     fluxes.reset();
@@ -57,6 +64,11 @@ void DynamicThermalFem3DSolver::loadConfiguration(XMLReader &source, Manager &ma
             timestep = source.getAttribute<double>("timestep", timestep);
             rebuildfreq = source.getAttribute<size_t>("rebuildfreq", rebuildfreq);
             logfreq = source.getAttribute<size_t>("logfreq", logfreq);
+            adaptive = source.getAttribute<bool>("adaptive", adaptive);
+            tolerance = source.getAttribute<double>("tolerance", tolerance);
+            mintimestep = source.getAttribute<double>("mintimestep", mintimestep);
+            maxtimestep = source.getAttribute<double>("maxtimestep", maxtimestep);
+            stepchange = source.getAttribute<double>("stepchange", stepchange);
             source.requireTagEnd();
         }
 
@@ -79,29 +91,33 @@ void DynamicThermalFem3DSolver::onInitialize() {
     FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>::onInitialize();
 
     temperatures.reset(this->maskedMesh->size(), inittemp);
+    prevtemps.reset();
 
     thickness.reset(this->maskedMesh->getElementsCount(), NAN);
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
     // Set stiffness matrix and load vector
     for (auto elem: this->maskedMesh->elements())
     {
         if (!isnan(thickness[elem.getIndex()])) continue;
-        auto material = this->geometry->getMaterial(elem.getMidpoint());
+        const auto& material = (*materials)[elem.getIndex()];
         double top = elem.getUpper2(), bottom = elem.getLower2();
         size_t row = elem.getIndex2();
         size_t itop = row+1, ibottom = row;
         for (size_t r = row; r > 0; r--) {
-            auto e = this->mesh->element(elem.getIndex0(), elem.getIndex1(), r-1);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
+            auto e = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r-1);
+            if (e.getIndex() == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) break;  // empty element ends the layer
+            const auto& m = (*materials)[e.getIndex()];
+            if (*m == *material) {                          //TODO ignore doping
                 bottom = e.getLower2();
                 ibottom = r-1;
             }
             else break;
         }
         for (size_t r = elem.getIndex2()+1; r < this->mesh->axis[2]->size()-1; r++) {
-            auto e = this->mesh->element(elem.getIndex0(), elem.getIndex1(), r);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
+            auto e = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r);
+            if (e.getIndex() == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) break;  // empty element ends the layer
+            const auto& m = (*materials)[e.getIndex()];
+            if (*m == *material) {                          //TODO ignore doping
                 top = e.getUpper2();
                 itop = r+1;
             }
@@ -119,25 +135,27 @@ void DynamicThermalFem3DSolver::onInitialize() {
 
 void DynamicThermalFem3DSolver::onInvalidate() {
     temperatures.reset();
+    prevtemps.reset();
     fluxes.reset();
     thickness.reset();
 }
 
 
 void DynamicThermalFem3DSolver::setMatrix(FemMatrix& A, FemMatrix& B, DataVector<double>& F,
-        const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature)
+        const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature, double step)
 {
-    this->writelog(LOG_DETAIL, "Setting up matrix system ({})", A.describe());
+    this->writelog(LOG_DETAIL, "Setting up matrix system ({}) for time step {:g} ns", A.describe(), step);
 
     auto heats = inHeat(maskedMesh->getElementMesh()/*, INTERPOLATION_NEAREST*/);
+    auto materials = geometry->getMaterialRaster(maskedMesh->getElementMesh());
 
     // zero the matrices A, B and the load vector F
     A.clear();
     B.clear();
     F.fill(0.);
 
-    // Set stiffness matrix and load vector
-    for (auto elem: this->maskedMesh->elements())
+    // Set stiffness matrix and load vector (A and B are of the same type, so it is enough to check A for concurrency)
+    assembleElements(*this->maskedMesh, A, this->elementColoring, [&](const RectangularMaskedMesh3D::Element& elem)
     {
         // nodes numbers for the current element
         size_t idx[8];
@@ -155,16 +173,19 @@ void DynamicThermalFem3DSolver::setMatrix(FemMatrix& A, FemMatrix& B, DataVector
         double dy = elem.getUpper1() - elem.getLower1();
         double dz = elem.getUpper2() - elem.getLower2();
 
-        // point and material in the middle of the element
-        Vec<3> middle = elem.getMidpoint();
-        auto material = geometry->getMaterial(middle);
+        // material in the middle of the element
+        const auto& material = (*materials)[elem.getIndex()];
 
         // average temperature on the element
         double temp = 0.; for (int i = 0; i < 8; ++i) temp += temperatures[idx[i]]; temp *= 0.125;
 
-        // thermal conductivity
-        double kx, ky, kz;
-        std::tie(ky,kz) = std::tuple<double,double>(material->thermk(temp, thickness[elem.getIndex()]));
+        // thermal conductivity and heat capacity
+        double kx, ky, kz, cp;
+        {
+            OmpLockGuard<OmpNestLock> lock = material->lock();
+            std::tie(ky,kz) = std::tuple<double,double>(material->thermk(temp, thickness[elem.getIndex()]));
+            cp = material->cp(temp) * material->dens(temp);
+        }
 
         ky *= 1e-6; kz *= 1e-6;                                         // W/m -> W/µm
         kx = ky;
@@ -174,7 +195,7 @@ void DynamicThermalFem3DSolver::setMatrix(FemMatrix& A, FemMatrix& B, DataVector
         kz *= dx; kz *= dy; kz /= dz;
 
         // element of heat capacity matrix
-        double c = material->cp(temp) * material->dens(temp) * 0.125e-9 * dx * dy * dz / timestep;  //0.125e-9 = 0.5*0.5*0.5*1e-18/1E-9
+        double c = cp * 0.125e-9 * dx * dy * dz / step;  //0.125e-9 = 0.5*0.5*0.5*1e-18/1E-9
 
         // load vector: heat densities
         double f = 0.125e-18 * dx * dy * dz * heats[elem.getIndex()];   // 1e-18 -> to transform µm³ into m³
@@ -228,7 +249,7 @@ void DynamicThermalFem3DSolver::setMatrix(FemMatrix& A, FemMatrix& B, DataVector
             }
         }
 
-    }
+    });
 
     //boundary conditions of the first kind
     A.applyBC(btemperature, F);
@@ -247,6 +268,23 @@ void DynamicThermalFem3DSolver::setMatrix(FemMatrix& A, FemMatrix& B, DataVector
 }
 
 
+void DynamicThermalFem3DSolver::advance(FemMatrix& A, FemMatrix& B, const DataVector<double>& F,
+        const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature,
+        const DataVector<double>& start, DataVector<double>& result)
+{
+    DataVector<double> X(F.size());
+    B.mult(start, X);
+    for (std::size_t i = 0; i < X.size(); ++i) X[i] += F[i];
+    // rows of the boundary nodes in A are replaced with identity, so the right-hand side must contain just the value
+    for (auto cond: btemperature)
+        for (auto r: cond.place) X[r] = cond.value;
+
+    result.reset(start.size());
+    std::copy(start.begin(), start.end(), result.begin());  // initial guess for iterative algorithms
+    A.solverhs(X, result);
+}
+
+
 double DynamicThermalFem3DSolver::compute(double time)
 {
     this->initCalculation();
@@ -266,48 +304,123 @@ double DynamicThermalFem3DSolver::compute(double time)
     this->writelog(LOG_INFO, "Running thermal calculations");
     maxT = *std::max_element(temperatures.begin(), temperatures.end());
 
-#   ifndef NDEBUG
-        if (!temperatures.unique()) this->writelog(LOG_DEBUG, "Temperature data held by something else...");
-#   endif
-    temperatures = temperatures.claim();
-    DataVector<double> F(size), X(size);
-
-    setMatrix(A, B, F, btemperature);
+    DataVector<double> F(size), T;
 
     size_t r = rebuildfreq,
            l = logfreq;
 
-    time += timestep/2.;
-    for (double t = 0.; t < time; t += timestep) {
+    if (!adaptive) {
+        setMatrix(A, B, F, btemperature, timestep);
 
-        if (rebuildfreq && r == 0)
-        {
-            setMatrix(A, B, F, btemperature);
-            r = rebuildfreq;
-        }
+        for (double t = timestep/2.; t < time; t += timestep) {
 
-        B.mult(temperatures, X);
-        for (std::size_t i = 0; i < X.size(); ++i) X[i] += F[i];
+            if (rebuildfreq && r == 0)
+            {
+                setMatrix(A, B, F, btemperature, timestep);
+                r = rebuildfreq;
+            }
 
-        DataVector<double> T(X);
+            advance(A, B, F, btemperature, temperatures, T);
+            std::swap(prevtemps, temperatures);
+            std::swap(temperatures, T);
+            prevstep = timestep;
+
+            if (logfreq && l == 0)
+            {
+                maxT = *std::max_element(temperatures.begin(), temperatures.end());
+                this->writelog(LOG_RESULT, "Time {:.2f} ns: max(T) = {:.3f} K", elapstime, maxT);
+                l = logfreq;
+            }
 
-        A.solverhs(T, temperatures);
+            r--;
+            l--;
+            elapstime += timestep;
+        }
 
-        std::swap(temperatures, X);
+    } else {
+        if (tolerance <= 0.) throw BadInput(this->getId(), "tolerance must be positive");
+        if (mintimestep <= 0. || maxtimestep < mintimestep)
+            throw BadInput(this->getId(), "wrong time step limits [{0}, {1}] ns", mintimestep, maxtimestep);
+        if (stepchange < 1.) throw BadInput(this->getId(), "stepchange must not be smaller than 1");
+
+        double step = std::min(std::max(timestep, mintimestep), maxtimestep),
+               factorized = 0.;     // time step for which the matrices were factorized
+        size_t steps = 0, rejected = 0, factorizations = 0;
+
+        while (time > 1e-6 * step) {
+            // the last step is shortened to end exactly at the requested time
+            double dt = std::min(step, time);
+
+            if (dt != factorized || (rebuildfreq && r == 0)) {
+                setMatrix(A, B, F, btemperature, dt);
+                factorized = dt;
+                r = rebuildfreq;
+                ++factorizations;
+            }
 
-        if (logfreq && l == 0)
-        {
-            maxT = *std::max_element(temperatures.begin(), temperatures.end());
-            this->writelog(LOG_RESULT, "Time {:.2f} ns: max(T) = {:.3f} K", elapstime, maxT);
-            l = logfreq;
+            advance(A, B, F, btemperature, temperatures, T);
+
+            double err = 0.;
+            DataVector<double> H;   // temperatures in the middle of the step (only at startup)
+            if (prevtemps) {
+                // Local error is estimated as the difference between the computed temperatures and their linear
+                // extrapolation from the two previous steps, scaled to the error of the first-order implicit method
+                double ratio = dt / prevstep;
+                for (size_t i = 0; i < size; ++i) {
+                    double predicted = temperatures[i] + ratio * (temperatures[i] - prevtemps[i]);
+                    err = std::max(err, std::abs(T[i] - predicted));
+                }
+                err *= dt / (dt + prevstep);
+            } else {
+                // There is no history after initialization, so the error is estimated by repeating the step
+                // as two half steps; the more accurate result of the half steps is kept
+                setMatrix(A, B, F, btemperature, 0.5 * dt);
+                factorized = 0.5 * dt;
+                ++factorizations;
+                DataVector<double> T2;
+                advance(A, B, F, btemperature, temperatures, H);
+                advance(A, B, F, btemperature, H, T2);
+                for (size_t i = 0; i < size; ++i) err = std::max(err, std::abs(T2[i] - T[i]));
+                std::swap(T, T2);
+            }
+
+            double allowed = dt * std::min(3., 0.9 * std::sqrt(tolerance / std::max(err, 1e-12 * tolerance)));
+            allowed = std::min(std::max(allowed, mintimestep), maxtimestep);
+
+            if (err > tolerance && dt > mintimestep) {
+                step = std::max(allowed, 0.2 * dt);
+                ++rejected;
+                this->writelog(LOG_DETAIL, "Rejected time step {:g} ns (estimated error {:g} K)", dt, err);
+                continue;
+            }
+            if (dt == step && allowed >= stepchange * step) step = allowed;
+
+            if (H) {
+                prevtemps = H;
+                prevstep = 0.5 * dt;
+            } else {
+                std::swap(prevtemps, temperatures);
+                prevstep = dt;
+            }
+            std::swap(temperatures, T);
+            elapstime += dt;
+            time -= dt;
+            ++steps;
+
+            if (logfreq && steps % logfreq == 0)
+            {
+                maxT = *std::max_element(temperatures.begin(), temperatures.end());
+                this->writelog(LOG_RESULT, "Time {:.2f} ns: max(T) = {:.3f} K, time step = {:g} ns", elapstime, maxT, dt);
+            }
+            r--;
         }
 
-        r--;
-        l--;
-        elapstime += timestep;
+        timestep = step;
+        this->writelog(LOG_DETAIL, "Made {} time steps ({} rejected) with {} matrix factorizations",
+                       steps, rejected, factorizations);
     }
 
-    elapstime -= timestep;
+    maxT = *std::max_element(temperatures.begin(), temperatures.end());
     outTemperature.fireChanged();
     outHeatFlux.fireChanged();
 
@@ -315,16 +428,62 @@ double DynamicThermalFem3DSolver::compute(double time)
 }
 
 
+void DynamicThermalFem3DSolver::saveCheckpoint(const std::string& filename) const
+{
+    if (!temperatures) throw NoValue(Temperature::NAME);
+    this->writelog(LOG_INFO, "Saving checkpoint to '{}'", filename);
+    CheckpointWriter checkpoint(filename);
+    checkpoint.writeMesh("mesh", *this->mesh);
+    checkpoint.write("temperatures", temperatures);
+    checkpoint.writeValue("elapstime", elapstime);
+    // State of the adaptive stepping, so the resumed run does not start the error estimation anew
+    checkpoint.writeValue("timestep", timestep);
+    if (prevtemps) {
+        checkpoint.write("prevtemps", prevtemps);
+        checkpoint.writeValue("prevstep", prevstep);
+    }
+    checkpoint.close();
+}
+
+
+void DynamicThermalFem3DSolver::loadCheckpoint(const std::string& filename)
+{
+    this->writelog(LOG_INFO, "Loading checkpoint from '{}'", filename);
+    CheckpointReader checkpoint(filename);
+    this->initCalculation();
+    if (*checkpoint.readMesh<3>("mesh") != *this->mesh)
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different mesh", filename);
+    DataVector<double> temps = checkpoint.read<double>("temperatures");
+    if (temps.size() != this->maskedMesh->size())
+        throw BadInput(this->getId(), "checkpoint '{0}' was saved with a different geometry", filename);
+    temperatures = temps;
+    elapstime = checkpoint.readValue<double>("elapstime");
+    timestep = checkpoint.readValue<double>("timestep", timestep);
+    if (checkpoint.has("prevtemps")) {
+        prevtemps = checkpoint.read<double>("prevtemps");
+        if (prevtemps.size() != temperatures.size())
+            throw BadInput(this->getId(), "checkpoint '{0}' has wrong number of previous temperatures", filename);
+        prevstep = checkpoint.readValue<double>("prevstep");
+    } else
+        prevtemps.reset();
+    maxT = *std::max_element(temperatures.begin(), temperatures.end());
+    fluxes.reset();
+    outTemperature.fireChanged();
+    outHeatFlux.fireChanged();
+}
+
+
 void DynamicThermalFem3DSolver::saveHeatFluxes()
 {
     this->writelog(LOG_DETAIL, "Computing heat fluxes");
 
     fluxes.reset(this->maskedMesh->getElementsCount());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
 
     for (auto el: this->maskedMesh->elements())
     {
         Vec<3,double> midpoint = el.getMidpoint();
-        auto material = this->geometry->getMaterial(midpoint);
+        const auto& material = (*materials)[el.getIndex()];
 
         size_t lll = el.getLoLoLoIndex();
         size_t llu = el.getLoLoUpIndex();
@@ -389,7 +548,8 @@ const LazyData<Vec<3>> DynamicThermalFem3DSolver::getHeatFluxes(const shared_ptr
 
 DynamicThermalFem3DSolver::
 ThermalConductivityData::ThermalConductivityData(const DynamicThermalFem3DSolver* solver, const shared_ptr<const MeshD<3>>& dst_mesh):
-    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry)
+    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry),
+    materials(solver->geometry->getMaterialRaster(solver->maskedMesh->getElementMesh()))
 {
     if (solver->temperatures) temps = interpolate(solver->maskedMesh, solver->temperatures, solver->maskedMesh->getElementMesh(), INTERPOLATION_LINEAR);
     else temps = LazyData<double>(solver->mesh->getElementsCount(), solver->inittemp);
@@ -403,10 +563,9 @@ Tensor2<double> DynamicThermalFem3DSolver::ThermalConductivityData::at(std::size
         return Tensor2<double>(NAN);
     else {
         auto elem = solver->maskedMesh->element(x-1, y-1, z-1);
-        auto material = solver->geometry->getMaterial(elem.getMidpoint());
         size_t idx = elem.getIndex();
         if (idx == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) return Tensor2<double>(NAN);
-        return material->thermk(temps[idx], solver->thickness[idx]);
+        return (*materials)[idx]->thermk(temps[idx], solver->thickness[idx]);
     }
 }
 std::size_t DynamicThermalFem3DSolver::ThermalConductivityData::size() const { return dest_mesh->size(); }
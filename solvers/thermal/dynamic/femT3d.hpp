@@ -34,11 +34,27 @@ struct PLASK_SOLVER_API DynamicThermalFem3DSolver: public FemSolverWithMaskedMes
 
     DataVector<Vec<3,double>> fluxes;      ///< Computed (only when needed) heat fluxes on our own mesh
 
-    /// Set stiffness matrix + load vector
+    DataVector<double> prevtemps;               ///< Temperatures before the last time step (used for error estimation)
+
+    double prevstep;                            ///< Length of the last time step (ns)
+
+    /// Set stiffness matrix + load vector for the time step \p step (ns)
     void setMatrix(FemMatrix& A, FemMatrix& B, DataVector<double>& F,
-                   const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature
+                   const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature,
+                   double step
                   );
 
+    /**
+     * Make single time step with the factorized matrices
+     * \param A, B, F system matrices and the load vector
+     * \param btemperature boundary conditions
+     * \param start temperatures at the beginning of the step
+     * \param[out] result new temperatures
+     */
+    void advance(FemMatrix& A, FemMatrix& B, const DataVector<double>& F,
+                 const BoundaryConditionsWithMesh<RectangularMesh<3>::Boundary,double>& btemperature,
+                 const DataVector<double>& start, DataVector<double>& result);
+
     /// Create 3D-vector with calculated heat fluxes
     void saveHeatFluxes(); // [W/m^2]
 
@@ -63,14 +79,25 @@ struct PLASK_SOLVER_API DynamicThermalFem3DSolver: public FemSolverWithMaskedMes
 
     double inittemp;       ///< Initial temperature
     double methodparam;   ///< Initial parameter determining the calculation method (0.5 - Crank-Nicolson, 0 - explicit, 1 - implicit)
-    double timestep;       ///< Time step in nanoseconds
+    double timestep;       ///< Time step in nanoseconds (in the adaptive mode updated after each computation)
     double elapstime;    ///< Calculations elapsed time
     bool lumping;          ///< Wheter use lumping for matrices?
     size_t rebuildfreq;    ///< Frequency of mass matrix rebuilding
     size_t logfreq;        ///< Frequency of iteration progress reporting
 
+    bool adaptive;         ///< Should the time step be adjusted to the estimated error?
+    double tolerance;      ///< Maximum estimated temperature error in a single time step in the adaptive mode (K)
+    double mintimestep;    ///< Minimum time step in the adaptive mode (ns)
+    double maxtimestep;    ///< Maximum time step in the adaptive mode (ns)
+    double stepchange;     ///< Minimum ratio of the allowed and current time step, for which the step is increased
+
     /**
      * Run temperature calculations
+     *
+     * In the adaptive mode the time step is chosen to keep the local error estimate below \ref tolerance.
+     * The step is changed (and the matrix factorized again) only if a step is rejected or it can be increased
+     * at least \ref stepchange times, so most steps reuse the existing factorization.
+     * \param time time to advance the temperatures by (ns)
      * \return max correction of temperature against the last call
      **/
     double compute(double time);
@@ -78,6 +105,19 @@ struct PLASK_SOLVER_API DynamicThermalFem3DSolver: public FemSolverWithMaskedMes
     /// Get calculations elapsed time
     double getElapsTime() const { return elapstime; }
 
+    /**
+     * Save computed temperatures, elapsed time, and the state of the adaptive time stepping to the checkpoint file
+     * \param filename name of the checkpoint file
+     */
+    void saveCheckpoint(const std::string& filename) const;
+
+    /**
+     * Restore computed temperatures, elapsed time, and the state of the adaptive time stepping from the checkpoint file.
+     * Temperatures are mapped from the file directly, so the calculations can be quickly resumed.
+     * \param filename name of the checkpoint file
+     */
+    void loadCheckpoint(const std::string& filename);
+
     void loadConfiguration(XMLReader& source, Manager& manager) override; // for solver configuration (see: *.xpl file with structures)
 
     DynamicThermalFem3DSolver(const std::string& name="");
@@ -92,6 +132,7 @@ struct PLASK_SOLVER_API DynamicThermalFem3DSolver: public FemSolverWithMaskedMes
         const DynamicThermalFem3DSolver* solver;
         shared_ptr<const MeshD<3>> dest_mesh;
         InterpolationFlags flags;
+        shared_ptr<const MaterialRaster> materials;
         LazyData<double> temps;
         ThermalConductivityData(const DynamicThermalFem3DSolver* solver, const shared_ptr<const MeshD<3>>& dst_mesh);
         Tensor2<double> at(std::size_t i) const override;
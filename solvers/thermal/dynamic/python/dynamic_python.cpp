@@ -31,7 +31,7 @@ BOOST_PYTHON_MODULE(dynamic)
 {
     {CLASS(DynamicThermalFem2DSolver<Geometry2DCartesian>, "Dynamic2D",
         u8"Finite element thermal solver for 2D Cartesian geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("time"));
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("time"));
         RECEIVER(inHeat, "");
         PROVIDER(outTemperature, "");
         PROVIDER(outHeatFlux, "");
@@ -45,12 +45,24 @@ BOOST_PYTHON_MODULE(dynamic)
         RW_FIELD(logfreq, u8"Frequency of iteration progress reporting");
         RO_PROPERTY(time, getElapsTime, u8"Time of calculations performed so far since the last solver invalidation.");
         RO_PROPERTY(elapsed_time, getElapsTime, u8"Alias for :attr:`time` (obsolete).");
+        METHOD(save_checkpoint, saveCheckpoint,
+               u8"Save computed temperatures and elapsed time to the checkpoint file.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
+        METHOD(load_checkpoint, loadCheckpoint,
+               u8"Restore computed temperatures and elapsed time from the checkpoint file.\n\n"
+               u8"The solver must have the same geometry and mesh as the one used to save the checkpoint.\n"
+               u8"The temperatures are memory-mapped from the file, so resuming the calculations is instant.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
         registerFemSolverWithMaskedMesh(solver);
     }
 
     {CLASS(DynamicThermalFem2DSolver<Geometry2DCylindrical>, "DynamicCyl",
         u8"Finite element thermal solver for 2D cylindrical geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("time"));
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("time"));
         RECEIVER(inHeat, "");
         PROVIDER(outTemperature, "");
         PROVIDER(outHeatFlux, "");
@@ -64,12 +76,24 @@ BOOST_PYTHON_MODULE(dynamic)
         RW_FIELD(logfreq, u8"Frequency of iteration progress reporting");
         RO_PROPERTY(time, getElapsTime, u8"Time of calculations performed so far since the last solver invalidation.");
         RO_PROPERTY(elapsed_time, getElapsTime, u8"Alias for :attr:`time` (obsolete).");
+        METHOD(save_checkpoint, saveCheckpoint,
+               u8"Save computed temperatures and elapsed time to the checkpoint file.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
+        METHOD(load_checkpoint, loadCheckpoint,
+               u8"Restore computed temperatures and elapsed time from the checkpoint file.\n\n"
+               u8"The solver must have the same geometry and mesh as the one used to save the checkpoint.\n"
+               u8"The temperatures are memory-mapped from the file, so resuming the calculations is instant.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
         registerFemSolverWithMaskedMesh(solver);
     }
 
     {CLASS(DynamicThermalFem3DSolver, "Dynamic3D",
         u8"Finite element thermal solver for 3D Cartesian geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("time"));
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("time"));
         RECEIVER(inHeat, "");
         PROVIDER(outTemperature, "");
         PROVIDER(outHeatFlux, "");
@@ -82,8 +106,25 @@ BOOST_PYTHON_MODULE(dynamic)
         RW_FIELD(rebuildfreq, u8"Frequency of rebuild mass");
         solver.def_readwrite("algorithm", &__Class__::algorithm, u8"Chosen matrix factorization algorithm");
         solver.def_readwrite("logfreq", &__Class__::logfreq, u8"Frequency of iteration progress reporting");
+        RW_FIELD(adaptive, u8"Adjust the time step to the estimated error");
+        RW_FIELD(tolerance, u8"Maximum estimated temperature error in a single time step in the adaptive mode (K)");
+        RW_FIELD(mintimestep, u8"Minimum time step in the adaptive mode (ns)");
+        RW_FIELD(maxtimestep, u8"Maximum time step in the adaptive mode (ns)");
+        RW_FIELD(stepchange, u8"Minimum ratio by which the time step must be allowed to grow before it is increased");
         RO_PROPERTY(time, getElapsTime, u8"Time of calculations performed so far since the last solver invalidation.");
         RO_PROPERTY(elapsed_time, getElapsTime, u8"Alias for :attr:`time` (obsolete).");
+        METHOD(save_checkpoint, saveCheckpoint,
+               u8"Save computed temperatures and elapsed time to the checkpoint file.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
+        METHOD(load_checkpoint, loadCheckpoint,
+               u8"Restore computed temperatures and elapsed time from the checkpoint file.\n\n"
+               u8"The solver must have the same geometry and mesh as the one used to save the checkpoint.\n"
+               u8"The temperatures are memory-mapped from the file, so resuming the calculations is instant.\n\n"
+               u8"Args:\n"
+               u8"    filename (str): Name of the checkpoint file.\n",
+               py::arg("filename"));
         registerFemSolverWithMaskedMesh(solver);
     }
 
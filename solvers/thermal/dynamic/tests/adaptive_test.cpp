@@ -0,0 +1,133 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Adaptive time step test"
+#include <boost/test/unit_test.hpp>
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
+#include "../femT3d.hpp"
+
+using namespace plask;
+using namespace plask::thermal::dynamic;
+
+// Material with constant thermal properties
+struct ColumnMaterial: public Material {
+    std::string name() const override { return "Const"; }
+    Kind kind() const override { return Material::DIELECTRIC; }
+    Tensor2<double> thermk(double, double) const override { return Tensor2<double>(K); }
+    double cp(double) const override { return CP; }
+    double dens(double) const override { return DENS; }
+
+    static constexpr double K = 1.;         // W/(m K)
+    static constexpr double CP = 1000.;     // J/(kg K)
+    static constexpr double DENS = 1000.;   // kg/m³
+};
+constexpr double ColumnMaterial::K, ColumnMaterial::CP, ColumnMaterial::DENS;
+
+// Column of two elements with the fixed temperature at its ends and insulated sides.
+// With the lumped heat capacity the temperature of the middle plane decays exactly exponentially.
+struct ColumnFixture {
+    static constexpr double H = 10.;     // height of the element (µm)
+    static constexpr double T0 = 400.;   // initial temperature
+    static constexpr double T1 = 300.;   // boundary temperature
+
+    // decay time (ns): half of the heat capacity of two elements over the conductance of both of them
+    const double tau = ColumnMaterial::CP * ColumnMaterial::DENS * (H * 1e-6) * (H * 1e-6) / (2. * ColumnMaterial::K) * 1e9;
+
+    shared_ptr<RectangularMesh<3>> mesh;
+    DynamicThermalFem3DSolver solver;
+
+    ColumnFixture(): solver("dynamic") {
+        auto block = plask::make_shared<Block<3>>(vec(1., 1., 2. * H), plask::make_shared<ColumnMaterial>());
+        solver.setGeometry(plask::make_shared<Geometry3D>(block));
+        mesh = plask::make_shared<RectangularMesh<3>>(
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 1.}),
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 1.}),
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., H, 2. * H}));
+        solver.setMesh(mesh);
+        solver.temperature_boundary.add(RectangularMesh<3>::getBottomBoundary(), T1);
+        solver.temperature_boundary.add(RectangularMesh<3>::getTopBoundary(), T1);
+        solver.inittemp = T0;
+        solver.algorithm = ALGORITHM_CHOLESKY;
+        solver.adaptive = true;
+        solver.tolerance = 0.01;
+        solver.maxtimestep = 10. * tau;
+    }
+
+    double middle() {
+        auto temps = solver.outTemperature(mesh, INTERPOLATION_LINEAR);
+        return temps[mesh->index(0, 0, 1)];
+    }
+
+    double exact(double time) { return T1 + (T0 - T1) * std::exp(-time / tau); }
+};
+constexpr double ColumnFixture::H, ColumnFixture::T0, ColumnFixture::T1;
+
+BOOST_AUTO_TEST_SUITE(adaptive)
+
+BOOST_FIXTURE_TEST_CASE(exponential_decay, ColumnFixture) {
+    solver.timestep = 1e-3 * tau;
+
+    // Steps grow as the transient decays
+    double time = 0.;
+    double prev = solver.timestep;
+    for (double span: {0.5, 1.5, 4.}) {
+        solver.compute(span * tau);
+        time += span * tau;
+        BOOST_CHECK_CLOSE(solver.getElapsTime(), time, 1e-9);
+        BOOST_CHECK_SMALL(middle() - exact(time), 10. * solver.tolerance);
+        BOOST_CHECK_GT(solver.timestep, prev);
+        prev = solver.timestep;
+    }
+    BOOST_CHECK_GT(solver.timestep, 100. * 1e-3 * tau);
+}
+
+BOOST_FIXTURE_TEST_CASE(rejected_step, ColumnFixture) {
+    // The first step is far too long and must be rejected: with the Crank-Nicolson scheme a single step
+    // of 2τ leaves 0 instead of exp(-2) of the initial difference
+    solver.timestep = 2. * tau;
+    solver.compute(2. * tau);
+    BOOST_CHECK_LT(solver.timestep, 2. * tau);
+    BOOST_CHECK_CLOSE(solver.getElapsTime(), 2. * tau, 1e-9);
+    BOOST_CHECK_SMALL(middle() - exact(2. * tau), 10. * solver.tolerance);
+}
+
+BOOST_FIXTURE_TEST_CASE(checkpoint_resume, ColumnFixture) {
+    const std::string filename = "test_adaptive_checkpoint.ckp";
+    solver.timestep = 1e-3 * tau;
+    solver.compute(0.5 * tau);
+    solver.saveCheckpoint(filename);
+
+    // Resumed run must continue with the same step and error estimate as the uninterrupted one
+    ColumnFixture resumed;
+    resumed.solver.loadCheckpoint(filename);
+    BOOST_CHECK_EQUAL(resumed.solver.timestep, solver.timestep);
+    BOOST_CHECK_EQUAL(resumed.solver.getElapsTime(), solver.getElapsTime());
+
+    solver.compute(tau);
+    resumed.solver.compute(tau);
+    BOOST_CHECK_EQUAL(resumed.solver.timestep, solver.timestep);
+    BOOST_CHECK_CLOSE(resumed.middle(), middle(), 1e-12);
+
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -101,7 +101,7 @@ BOOST_PYTHON_MODULE(static)
 
     {CLASS(ThermalFem2DSolver<Geometry2DCartesian>, "Static2D",
         u8"Finite element thermal solver for 2D Cartesian Geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
         RO_PROPERTY(err, getErr, u8"Maximum estimated error");
         RECEIVER(inHeat, "");
         PROVIDER(outTemperature, "");
@@ -118,7 +118,7 @@ BOOST_PYTHON_MODULE(static)
 
     {CLASS(ThermalFem2DSolver<Geometry2DCylindrical>, "StaticCyl",
         u8"Finite element thermal solver for 2D cylindrical Geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
         RO_PROPERTY(err, getErr, u8"Maximum estimated error");
         RECEIVER(inHeat, "");
         PROVIDER(outTemperature, "");
@@ -134,7 +134,7 @@ BOOST_PYTHON_MODULE(static)
     }
 
     {CLASS(ThermalFem3DSolver, "Static3D", u8"Finite element thermal solver for 3D Geometry.")
-        METHOD(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
+        METHOD_RELEASING_GIL(compute, compute, u8"Run thermal calculations", py::arg("loops")=0);
         RO_PROPERTY(err, getErr, u8"Maximum estimated error");
         RECEIVER(inHeat, "");
         solver.setattr("inHeatDensity", solver.attr("inHeat"));
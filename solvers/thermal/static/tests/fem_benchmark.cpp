@@ -0,0 +1,114 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+
+// Throughput of the banded Cholesky factorization and matrix-vector multiplication used by the FEM solvers.
+// Usage: fem_benchmark [nx [ny [nz [repeats]]]]
+// Run it with different OMP_NUM_THREADS, OMP_PROC_BIND, and numactl settings to compare memory placement.
+
+#include <chrono>
+#include <cstdlib>
+
+#include <plask/plask.hpp>
+#include <plask/common/fem/cholesky_matrix.hpp>
+
+using namespace plask;
+
+struct BenchmarkSolver: public Solver {
+    BenchmarkSolver(): Solver("benchmark") {}
+    std::string getClassName() const override { return "FemBenchmark"; }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, const char* argv[]) {
+    const size_t nx = (argc > 1) ? std::atoi(argv[1]) : 40,
+                 ny = (argc > 2) ? std::atoi(argv[2]) : 40,
+                 nz = (argc > 3) ? std::atoi(argv[3]) : 40;
+    const int repeats = (argc > 4) ? std::atoi(argv[4]) : 10;
+
+    maxLoglevel = LOG_WARNING;
+    BenchmarkSolver solver;
+
+    const size_t rank = nx * ny * nz, band = nx * ny;
+
+    // Allocation and (parallel) zeroing of the matrix
+    auto start = Clock::now();
+    DpbMatrix A(&solver, rank, band);
+    double time_alloc = seconds(start);
+
+    // 7-point Laplacian with a small shift, so the matrix is positive definite
+    for (size_t k = 0, i = 0; k < nz; ++k) {
+        for (size_t j = 0; j < ny; ++j) {
+            for (size_t l = 0; l < nx; ++l, ++i) {
+                A(i, i) = 6.01;
+                if (l + 1 < nx) A(i, i + 1) = -1.;
+                if (j + 1 < ny) A(i, i + nx) = -1.;
+                if (k + 1 < nz) A(i, i + band) = -1.;
+            }
+        }
+    }
+
+    DataVector<double> X(rank, 1.), Y(rank);
+
+    start = Clock::now();
+    for (int r = 0; r < repeats; ++r) A.mult(X, Y);
+    double time_mult = seconds(start) / repeats;
+
+    start = Clock::now();
+    A.factorize();
+    double time_factor = seconds(start);
+
+    start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        DataVector<double> B = Y.copy();
+        A.solverhs(B, X);
+    }
+    double time_solve = seconds(start) / repeats;
+
+    // Floating point operation counts for a band matrix with kd sub-diagonals
+    const double n = double(rank), kd = double(A.kd);
+    const double flops_mult = 2. * n * (2. * kd + 1.),
+                 flops_factor = n * kd * (kd + 3.),
+                 flops_solve = 4. * n * (kd + 1.);
+    const double bytes = double(A.size) * sizeof(double);
+
+    double err = 0.;
+    for (double x : X) err = std::max(err, std::abs(x - 1.));
+
+#ifdef PLASK_HUGE_PAGES
+    const char* huge_pages = "on";
+#else
+    const char* huge_pages = "off";
+#endif
+#ifdef OPENMP_FOUND
+    const int threads = omp_get_max_threads();
+#else
+    const int threads = 1;
+#endif
+
+    std::cout << format("matrix: {} ({:.1f} MiB), alignment: {} B, huge pages: {}, threads: {}\n",
+                        A.describe(), bytes / 1048576., PLASK_MEMORY_ALIGNMENT, huge_pages, threads);
+    std::cout << format("allocate+clear: {:9.4f} s  {:8.2f} GB/s\n", time_alloc, 1e-9 * bytes / time_alloc);
+    std::cout << format("matvec:         {:9.4f} s  {:8.2f} GFlop/s  {:8.2f} GB/s\n",
+                        time_mult, 1e-9 * flops_mult / time_mult, 1e-9 * bytes / time_mult);
+    std::cout << format("factorize:      {:9.4f} s  {:8.2f} GFlop/s\n", time_factor, 1e-9 * flops_factor / time_factor);
+    std::cout << format("solve:          {:9.4f} s  {:8.2f} GFlop/s\n", time_solve, 1e-9 * flops_solve / time_solve);
+    std::cout << format("max error:      {:g}\n", err);
+
+    return (err < 1e-6) ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+ * Copyright (c) 2022 Lodz University of Technology
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Material change test"
+#include <boost/test/unit_test.hpp>
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32)
+namespace boost { namespace unit_test { namespace ut_detail {
+std::string normalize_test_case_name(const_string name) {
+    return ( name[0] == '&' ? std::string(name.begin()+1, name.size()-1) : std::string(name.begin(), name.size() ));
+}
+}}}
+#endif
+
+#include "../therm3d.hpp"
+
+using namespace plask;
+using namespace plask::thermal::tstatic;
+
+struct TestMaterial: public Material {
+    std::string nm;
+    Kind knd;
+    TestMaterial(const std::string& name, Kind kind = Material::DIELECTRIC): nm(name), knd(kind) {}
+    std::string name() const override { return nm; }
+    Kind kind() const override { return knd; }
+    Tensor2<double> thermk(double, double) const override { return Tensor2<double>(1.); }
+};
+
+struct TestSolver: public ThermalFem3DSolver {
+    TestSolver(): ThermalFem3DSolver("therm3d") {}
+    using ThermalFem3DSolver::thickness;
+    using ThermalFem3DSolver::temperatures;
+    using ThermalFem3DSolver::maskedMesh;
+};
+
+// Column of three blocks of the same material on a wider substrate
+struct StackFixture {
+    shared_ptr<Material> material = plask::make_shared<TestMaterial>("A"),
+                         other = plask::make_shared<TestMaterial>("B"),
+                         empty = plask::make_shared<TestMaterial>("air", Material::EMPTY);
+    shared_ptr<Block<3>> substrate, bottom, middle, top;
+    shared_ptr<Geometry3D> geometry;
+    shared_ptr<RectangularMesh<3>> mesh;
+
+    StackFixture() {
+        substrate = plask::make_shared<Block<3>>(vec(2., 1., 1.), material);
+        bottom = plask::make_shared<Block<3>>(vec(1., 1., 2.), material);
+        middle = plask::make_shared<Block<3>>(vec(1., 1., 3.), material);
+        top = plask::make_shared<Block<3>>(vec(1., 1., 1.), material);
+        auto stack = plask::make_shared<StackContainer<3>>();
+        stack->add(substrate);
+        stack->add(bottom);
+        stack->add(middle);
+        stack->add(top);
+        geometry = plask::make_shared<Geometry3D>(stack);
+        mesh = plask::make_shared<RectangularMesh<3>>(
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 0.5, 1., 1.5, 2.}),
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 1.}),
+            plask::make_shared<OrderedAxis>(std::initializer_list<double>{0., 1., 2., 3., 4., 5., 6., 7.}));
+    }
+
+    void setup(TestSolver& solver) {
+        solver.setGeometry(geometry);
+        solver.setMesh(mesh);
+        solver.setEmptyElements(EMPTY_ELEMENTS_EXCLUDED);
+        solver.initCalculation();
+    }
+
+    // Compare layer thicknesses with a solver initialized from scratch
+    void checkThickness(const TestSolver& solver) {
+        TestSolver fresh;
+        setup(fresh);
+        BOOST_REQUIRE_EQUAL(solver.thickness.size(), fresh.thickness.size());
+        for (size_t i = 0; i != fresh.thickness.size(); ++i)
+            BOOST_CHECK_EQUAL(solver.thickness[i], fresh.thickness[i]);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(material_change)
+
+BOOST_FIXTURE_TEST_CASE(thickness_refresh, StackFixture) {
+    TestSolver solver;
+    setup(solver);
+    std::fill(solver.temperatures.begin(), solver.temperatures.end(), 350.);
+    checkThickness(solver);
+
+    // Changing the middle block splits the layer, so thicknesses change in its column only
+    middle->setMaterial(other);
+    BOOST_CHECK(solver.isInitialized());
+    checkThickness(solver);
+    for (double T: solver.temperatures) BOOST_CHECK_EQUAL(T, 350.);
+
+    // Changing it back merges the layers again
+    middle->setMaterial(material);
+    BOOST_CHECK(solver.isInitialized());
+    checkThickness(solver);
+    for (double T: solver.temperatures) BOOST_CHECK_EQUAL(T, 350.);
+}
+
+BOOST_FIXTURE_TEST_CASE(empty_material, StackFixture) {
+    TestSolver solver;
+    setup(solver);
+
+    // Empty material removes elements from the masked mesh, so the solver must be initialized anew
+    top->setMaterial(empty);
+    BOOST_CHECK(!solver.isInitialized());
+    solver.initCalculation();
+    checkThickness(solver);
+}
+
+BOOST_FIXTURE_TEST_CASE(interpolation_after_reinit, StackFixture) {
+    TestSolver solver;
+    setup(solver);
+    auto dst_mesh = plask::make_shared<RectangularMesh<3>>(
+        plask::make_shared<OrderedAxis>(std::initializer_list<double>{0.25, 0.75}),
+        plask::make_shared<OrderedAxis>(std::initializer_list<double>{0.5}),
+        plask::make_shared<OrderedAxis>(std::initializer_list<double>{0.5, 2.5, 5.5}));
+
+    auto field = [](const Vec<3>& p) { return 300. + 10. * p.c2 + p.c0; };
+    // Interpolated output is read repeatedly, so the cached interpolation plan is used
+    auto check = [&]() {
+        BOOST_REQUIRE_EQUAL(solver.temperatures.size(), solver.maskedMesh->size());
+        for (size_t i = 0; i != solver.temperatures.size(); ++i) solver.temperatures[i] = field(solver.maskedMesh->at(i));
+        for (int n = 0; n != 3; ++n) {
+            LazyData<double> temps = solver.outTemperature(dst_mesh, INTERPOLATION_LINEAR);
+            BOOST_REQUIRE_EQUAL(temps.size(), dst_mesh->size());
+            for (size_t i = 0; i != temps.size(); ++i) BOOST_CHECK_CLOSE(temps[i], field(dst_mesh->at(i)), 1e-9);
+        }
+    };
+    check();
+
+    // The same masked mesh object is set up anew with a different set of nodes
+    top->setMaterial(empty);
+    BOOST_CHECK(!solver.isInitialized());
+    solver.initCalculation();
+    check();
+
+    top->setMaterial(material);
+    if (!solver.isInitialized()) solver.initCalculation();
+    check();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
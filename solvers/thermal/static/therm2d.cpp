@@ -79,27 +79,30 @@ void ThermalFem2DSolver<Geometry2DType>::onInitialize() {
     temperatures.reset(this->maskedMesh->size(), inittemp);
 
     thickness.reset(this->maskedMesh->getElementsCount(), NAN);
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
     // Set stiffness matrix and load vector
     for (auto elem: this->maskedMesh->elements())
     {
         if (!isnan(thickness[elem.getIndex()])) continue;
-        auto material = this->geometry->getMaterial(elem.getMidpoint());
+        const auto& material = (*materials)[elem.getIndex()];
         double top = elem.getUpper1(), bottom = elem.getLower1();
         size_t row = elem.getIndex1();
         size_t itop = row+1, ibottom = row;
         size_t c = elem.getIndex0();
         for (size_t r = row; r > 0; r--) {
-            auto e = this->mesh->element(c, r-1);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
+            auto e = this->maskedMesh->element(c, r-1);
+            if (e.getIndex() == RectangularMaskedMesh2D::Element::UNKNOWN_ELEMENT_INDEX) break;  // empty element ends the layer
+            const auto& m = (*materials)[e.getIndex()];
+            if (*m == *material) {                          //TODO ignore doping
                 bottom = e.getLower1();
                 ibottom = r-1;
             } else break;
         }
         for (size_t r = elem.getIndex1()+1; r < this->mesh->axis[1]->size()-1; r++) {
-            auto e = this->mesh->element(c, r);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
+            auto e = this->maskedMesh->element(c, r);
+            if (e.getIndex() == RectangularMaskedMesh2D::Element::UNKNOWN_ELEMENT_INDEX) break;  // empty element ends the layer
+            const auto& m = (*materials)[e.getIndex()];
+            if (*m == *material) {                          //TODO ignore doping
                 top = e.getUpper1();
                 itop = r+1;
             } else break;
@@ -185,6 +188,7 @@ void ThermalFem2DSolver<Geometry2DCartesian>::setMatrix(FemMatrix& A, DataVector
 
     auto iMesh = (this->maskedMesh)->getElementMesh();
     auto heatdensities = inHeat(iMesh);
+    auto materials = this->geometry->getMaterialRaster(iMesh);
 
     A.clear();
     B.fill(0.);
@@ -204,7 +208,7 @@ void ThermalFem2DSolver<Geometry2DCartesian>::setMatrix(FemMatrix& A, DataVector
 
         // point and material in the middle of the element
         Vec<2,double> midpoint = elem.getMidpoint();
-        auto material = this->geometry->getMaterial(midpoint);
+        const auto& material = (*materials)[elem.getIndex()];
 
         // average temperature on the element
         double temp = 0.25 * (temperatures[loleftno] + temperatures[lorghtno] + temperatures[upleftno] + temperatures[uprghtno]);
@@ -310,6 +314,7 @@ void ThermalFem2DSolver<Geometry2DCylindrical>::setMatrix(FemMatrix& A, DataVect
 
     auto iMesh = (this->maskedMesh)->getElementMesh();
     auto heatdensities = inHeat(iMesh);
+    auto materials = this->geometry->getMaterialRaster(iMesh);
 
     A.clear();
     B.fill(0.);
@@ -329,7 +334,7 @@ void ThermalFem2DSolver<Geometry2DCylindrical>::setMatrix(FemMatrix& A, DataVect
 
         // point and material in the middle of the element
         Vec<2,double> midpoint = elem.getMidpoint();
-        auto material = geometry->getMaterial(midpoint);
+        const auto& material = (*materials)[elem.getIndex()];
         double r = midpoint.rad_r();
 
         // average temperature on the element
@@ -457,8 +462,7 @@ double ThermalFem2DSolver<Geometry2DType>::compute(int loops){
     int loop = 0;
     size_t size = this->maskedMesh->size();
 
-    std::unique_ptr<FemMatrix> pA(this->getMatrix());
-    FemMatrix& A = *pA.get();
+    FemMatrix& A = this->getReusableMatrix();
 
     double err;
     toterr = 0.;
@@ -495,23 +499,38 @@ double ThermalFem2DSolver<Geometry2DType>::compute(int loops){
 
     } while ((!this->iter_params.converged || err > maxerr) && (loops == 0 || loop < loops));
 
+    this->releaseMatrix();
+
     outTemperature.fireChanged();
     outHeatFlux.fireChanged();
 
     return toterr;
 }
 
+template<typename Geometry2DType>
+void ThermalFem2DSolver<Geometry2DType>::setTemperatureVector(const DataVector<const double>& temps) {
+    this->initCalculation();
+    if (temps.size() != this->maskedMesh->size())
+        throw BadInput(this->getId(), "wrong number of temperatures ({0} instead of {1})", temps.size(), this->maskedMesh->size());
+    temperatures = temps.copy();
+    maxT = *std::max_element(temperatures.begin(), temperatures.end());
+    fluxes.reset();
+    outTemperature.fireChanged();
+    outHeatFlux.fireChanged();
+}
+
 template<typename Geometry2DType>
 void ThermalFem2DSolver<Geometry2DType>::saveHeatFluxes()
 {
     this->writelog(LOG_DETAIL, "Computing heat fluxes");
 
     fluxes.reset(this->maskedMesh->getElementsCount());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
 
     for (auto e: this->maskedMesh->elements())
     {
         Vec<2,double> midpoint = e.getMidpoint();
-        auto material = this->geometry->getMaterial(midpoint);
+        const auto& material = (*materials)[e.getIndex()];
 
         size_t loleftno = e.getLoLoIndex();
         size_t lorghtno = e.getUpLoIndex();
@@ -571,7 +590,8 @@ const LazyData<Vec<2>> ThermalFem2DSolver<Geometry2DType>::getHeatFluxes(const s
 
 template<typename Geometry2DType> ThermalFem2DSolver<Geometry2DType>::
 ThermalConductivityData::ThermalConductivityData(const ThermalFem2DSolver<Geometry2DType>* solver, const shared_ptr<const MeshD<2>>& dst_mesh):
-    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry)
+    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry),
+    materials(solver->geometry->getMaterialRaster(solver->maskedMesh->getElementMesh()))
 {
     if (solver->temperatures) temps = interpolate(solver->maskedMesh, solver->temperatures, solver->maskedMesh->getElementMesh(), INTERPOLATION_LINEAR);
     else temps = LazyData<double>(solver->maskedMesh->getElementsCount(), solver->inittemp);
@@ -588,8 +608,7 @@ ThermalConductivityData::at(std::size_t i) const {
         auto elem = solver->maskedMesh->element(x-1, y-1);
         size_t idx = elem.getIndex();
         if (idx == RectangularMaskedMesh2D::Element::UNKNOWN_ELEMENT_INDEX) return Tensor2<double>(NAN);
-        auto material = solver->geometry->getMaterial(elem.getMidpoint());
-        return material->thermk(temps[idx], solver->thickness[idx]);
+        return (*materials)[idx]->thermk(temps[idx], solver->thickness[idx]);
     }
 }
 
@@ -88,6 +88,17 @@ struct PLASK_SOLVER_API ThermalFem2DSolver : public FemSolverWithMaskedMesh<Geom
     /// Get max absolute correction for temperature
     double getErr() const { return toterr; }
 
+    /// Get temperatures in the mesh nodes (empty if they have not been computed yet)
+    DataVector<const double> getTemperatureVector() const { return temperatures; }
+
+    /**
+     * Replace temperatures in the mesh nodes.
+     * This is intended for external drivers of self-consistent loops, which modify the temperatures between
+     * subsequent calls to \ref compute.
+     * \param temps new temperatures in the nodes of the masked mesh
+     */
+    void setTemperatureVector(const DataVector<const double>& temps);
+
     void loadConfiguration(XMLReader& source,
                            Manager& manager) override;  // for solver configuration (see: *.xpl file with structures)
 
@@ -102,6 +113,7 @@ struct PLASK_SOLVER_API ThermalFem2DSolver : public FemSolverWithMaskedMesh<Geom
         const ThermalFem2DSolver* solver;
         shared_ptr<const MeshD<2>> dest_mesh;
         InterpolationFlags flags;
+        shared_ptr<const MaterialRaster> materials;
         LazyData<double> temps;
         ThermalConductivityData(const ThermalFem2DSolver* solver, const shared_ptr<const MeshD<2>>& dst_mesh);
         Tensor2<double> at(std::size_t i) const override;
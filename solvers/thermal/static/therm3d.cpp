@@ -79,39 +79,115 @@ void ThermalFem3DSolver::onInitialize() {
     temperatures.reset(this->maskedMesh->size(), inittemp);
 
     thickness.reset(this->maskedMesh->getElementsCount(), NAN);
-    // Set stiffness matrix and load vector
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
     for (auto elem: this->maskedMesh->elements())
-    {
-        if (!isnan(thickness[elem.getIndex()])) continue;
-        auto material = this->geometry->getMaterial(elem.getMidpoint());
-        double top = elem.getUpper2(), bottom = elem.getLower2();
-        size_t row = elem.getIndex2();
-        size_t itop = row+1, ibottom = row;
-        for (size_t r = row; r > 0; r--) {
-            auto e = this->mesh->element(elem.getIndex0(), elem.getIndex1(), r-1);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
-                bottom = e.getLower2();
-                ibottom = r-1;
+        if (isnan(thickness[elem.getIndex()])) setLayerThickness(elem, *materials);
+}
+
+
+void ThermalFem3DSolver::setLayerThickness(const RectangularMaskedMesh3D::Element& elem, const MaterialRaster& materials) {
+    // Elements excluded from the masked mesh are empty, so they always end the layer
+    const auto& material = materials[elem.getIndex()];
+    double top = elem.getUpper2(), bottom = elem.getLower2();
+    size_t row = elem.getIndex2();
+    size_t itop = row+1, ibottom = row;
+    for (size_t r = row; r > 0; r--) {
+        auto e = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r-1);
+        if (e.getIndex() == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) break;
+        const auto& m = materials[e.getIndex()];
+        if (*m == *material) {                          //TODO ignore doping
+            bottom = e.getLower2();
+            ibottom = r-1;
+        }
+        else break;
+    }
+    for (size_t r = elem.getIndex2()+1; r < this->mesh->axis[2]->size()-1; r++) {
+        auto e = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r);
+        if (e.getIndex() == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) break;
+        const auto& m = materials[e.getIndex()];
+        if (*m == *material) {                          //TODO ignore doping
+            top = e.getUpper2();
+            itop = r+1;
+        }
+        else break;
+    }
+    double h = top - bottom;
+    for (size_t r = ibottom; r < itop; ++r) {
+        size_t idx = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r).getIndex();
+        if (idx != RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX)
+            thickness[idx] = h;
+    }
+}
+
+
+void ThermalFem3DSolver::onGeometryChange(const Geometry::Event& evt) {
+    // Other changes (e.g. resizing) move object edges, so the generated mesh changes and everything must be rebuilt
+    if (!evt.isMaterialOnly() || !this->isInitialized()) {
+        FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>::onGeometryChange(evt);
+        return;
+    }
+
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
+    const size_t n0 = this->mesh->axis[0]->size() - 1, n1 = this->mesh->axis[1]->size() - 1,
+                 n2 = this->mesh->axis[2]->size() - 1;
+
+    // Find columns of elements with midpoints in the changed region
+    std::vector<bool> columns(n0 * n1, false);
+    size_t changed = 0;
+    for (const auto& box: this->geometry->getChangedBoundingBoxes(evt)) {
+        size_t lo[3], hi[3];
+        for (int a = 0; a != 3; ++a) {
+            const auto& axis = this->mesh->axis[a];
+            lo[a] = axis->size(); hi[a] = 0;
+            for (size_t i = 0; i < axis->size() - 1; ++i) {
+                double mid = 0.5 * (axis->at(i) + axis->at(i+1));
+                if (box.lower[a] <= mid && mid <= box.upper[a]) {
+                    if (i < lo[a]) lo[a] = i;
+                    hi[a] = i + 1;
+                }
             }
-            else break;
         }
-        for (size_t r = elem.getIndex2()+1; r < this->mesh->axis[2]->size()-1; r++) {
-            auto e = this->mesh->element(elem.getIndex0(), elem.getIndex1(), r);
-            auto m = this->geometry->getMaterial(e.getMidpoint());
-            if (m == material) {                            //TODO ignore doping
-                top = e.getUpper2();
-                itop = r+1;
+        for (size_t i0 = lo[0]; i0 < hi[0]; ++i0) {
+            for (size_t i1 = lo[1]; i1 < hi[1]; ++i1) {
+                for (size_t i2 = lo[2]; i2 < hi[2]; ++i2) {
+                    if (!includesEmptyElements()) {
+                        // Masked mesh must be rebuilt if any element becomes empty or non-empty
+                        size_t idx = this->maskedMesh->element(i0, i1, i2).getIndex();
+                        bool included = idx != RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX;
+                        auto material = included ? (*materials)[idx]
+                                                 : this->geometry->getMaterial(this->mesh->element(i0, i1, i2).getMidpoint());
+                        bool nonempty = (material->kind() & ~plask::Material::EMPTY) != 0;
+                        if (nonempty != included) {
+                            FemSolverWithMaskedMesh<Geometry3D, RectangularMesh<3>>::onGeometryChange(evt);
+                            return;
+                        }
+                    }
+                    ++changed;
+                }
+                columns[i1 * n0 + i0] = true;
             }
-            else break;
         }
-        double h = top - bottom;
-        for (size_t r = ibottom; r < itop; ++r) {
-            size_t idx = this->maskedMesh->element(elem.getIndex0(), elem.getIndex1(), r).getIndex();
-            if (idx != RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX)
-                thickness[idx] = h;
+    }
+
+    // Thickness of the layers could change only in the affected columns
+    for (size_t i1 = 0; i1 != n1; ++i1) {
+        for (size_t i0 = 0; i0 != n0; ++i0) {
+            if (!columns[i1 * n0 + i0]) continue;
+            for (size_t i2 = 0; i2 != n2; ++i2) {
+                size_t idx = this->maskedMesh->element(i0, i1, i2).getIndex();
+                if (idx != RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) thickness[idx] = NAN;
+            }
+            for (size_t i2 = 0; i2 != n2; ++i2) {
+                auto elem = this->maskedMesh->element(i0, i1, i2);
+                size_t idx = elem.getIndex();
+                if (idx != RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX && isnan(thickness[idx]))
+                    setLayerThickness(elem, *materials);
+            }
         }
     }
+    fluxes.reset();
+
+    this->writelog(LOG_DETAIL, "Material changed in {:d} elements: keeping mesh and temperatures", changed);
 }
 
 
@@ -177,13 +253,14 @@ void ThermalFem3DSolver::setMatrix(FemMatrix& A, DataVector<double>& B,
     this->writelog(LOG_DETAIL, "Setting up matrix system ({})", A.describe());
 
     auto heats = inHeat(maskedMesh->getElementMesh()/*, INTERPOLATION_NEAREST*/);
+    auto materials = geometry->getMaterialRaster(maskedMesh->getElementMesh());
 
     // zero the matrix and the load vector
     A.clear();
     B.fill(0.);
 
     // Set stiffness matrix and load vector
-    for (auto elem: maskedMesh->elements())
+    assembleElements(*maskedMesh, A, elementColoring, [&](const RectangularMaskedMesh3D::Element& elem)
     {
         // nodes numbers for the current element
         size_t idx[8];
@@ -201,16 +278,18 @@ void ThermalFem3DSolver::setMatrix(FemMatrix& A, DataVector<double>& B,
         double dy = elem.getUpper1() - elem.getLower1();
         double dz = elem.getUpper2() - elem.getLower2();
 
-        // point and material in the middle of the element
-        Vec<3> middle = elem.getMidpoint();
-        auto material = geometry->getMaterial(middle);
+        // material in the middle of the element
+        const auto& material = (*materials)[elem.getIndex()];
 
         // average temperature on the element
         double temp = 0.; for (int i = 0; i < 8; ++i) temp += temperatures[idx[i]]; temp *= 0.125;
 
         // thermal conductivity
         double kx, ky, kz;
-        std::tie(ky,kz) = std::tuple<double,double>(material->thermk(temp, thickness[elem.getIndex()]));
+        {
+            OmpLockGuard<OmpNestLock> lock = material->lock();
+            std::tie(ky,kz) = std::tuple<double,double>(material->thermk(temp, thickness[elem.getIndex()]));
+        }
 
         ky *= 1e-6; kz *= 1e-6;                                         // W/m -> W/µm
         kx = ky;
@@ -273,7 +352,7 @@ void ThermalFem3DSolver::setMatrix(FemMatrix& A, DataVector<double>& B,
             }
             B[idx[i]] += F[i];
         }
-    }
+    });
 
     A.applyBC(btemperature, B);
 }
@@ -295,8 +374,7 @@ double ThermalFem3DSolver::compute(int loops)
     int loop = 0;
     size_t size = maskedMesh->size();
 
-    std::unique_ptr<FemMatrix> pA(getMatrix());
-    FemMatrix& A = *pA.get();
+    FemMatrix& A = this->getReusableMatrix();
 
     double err = 0.;
     toterr = 0.;
@@ -333,22 +411,36 @@ double ThermalFem3DSolver::compute(int loops)
 
     } while ((!iter_params.converged || err > maxerr) && (loops == 0 || loop < loops));
 
+    this->releaseMatrix();
+
     outTemperature.fireChanged();
     outHeatFlux.fireChanged();
 
     return toterr;
 }
 
+void ThermalFem3DSolver::setTemperatureVector(const DataVector<const double>& temps) {
+    this->initCalculation();
+    if (temps.size() != this->maskedMesh->size())
+        throw BadInput(this->getId(), "wrong number of temperatures ({0} instead of {1})", temps.size(), this->maskedMesh->size());
+    temperatures = temps.copy();
+    maxT = *std::max_element(temperatures.begin(), temperatures.end());
+    fluxes.reset();
+    outTemperature.fireChanged();
+    outHeatFlux.fireChanged();
+}
+
 void ThermalFem3DSolver::saveHeatFluxes()
 {
     this->writelog(LOG_DETAIL, "Computing heat fluxes");
 
     fluxes.reset(this->maskedMesh->getElementsCount());
+    auto materials = this->geometry->getMaterialRaster(this->maskedMesh->getElementMesh());
 
     for (auto el: this->maskedMesh->elements())
     {
         Vec<3,double> midpoint = el.getMidpoint();
-        auto material = this->geometry->getMaterial(midpoint);
+        const auto& material = (*materials)[el.getIndex()];
 
         size_t lll = el.getLoLoLoIndex();
         size_t llu = el.getLoLoUpIndex();
@@ -413,7 +505,8 @@ const LazyData<Vec<3>> ThermalFem3DSolver::getHeatFluxes(const shared_ptr<const
 
 ThermalFem3DSolver::
 ThermalConductivityData::ThermalConductivityData(const ThermalFem3DSolver* solver, const shared_ptr<const MeshD<3>>& dst_mesh):
-    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry)
+    solver(solver), dest_mesh(dst_mesh), flags(solver->geometry),
+    materials(solver->geometry->getMaterialRaster(solver->maskedMesh->getElementMesh()))
 {
     if (solver->temperatures) temps = interpolate(solver->maskedMesh, solver->temperatures, solver->maskedMesh->getElementMesh(), INTERPOLATION_LINEAR);
     else temps = LazyData<double>(solver->maskedMesh->getElementsCount(), solver->inittemp);
@@ -429,8 +522,7 @@ Tensor2<double> ThermalFem3DSolver::ThermalConductivityData::at(std::size_t i) c
         auto elem = solver->maskedMesh->element(x-1, y-1, z-1);
         size_t idx = elem.getIndex();
         if (idx == RectangularMaskedMesh3D::Element::UNKNOWN_ELEMENT_INDEX) return Tensor2<double>(NAN);
-        auto material = solver->geometry->getMaterial(elem.getMidpoint());
-        return material->thermk(temps[idx], solver->thickness[idx]);
+        return (*materials)[idx]->thermk(temps[idx], solver->thickness[idx]);
     }
 }
 std::size_t ThermalFem3DSolver::ThermalConductivityData::size() const { return dest_mesh->size(); }
@@ -67,12 +67,28 @@ struct PLASK_SOLVER_API ThermalFem3DSolver: public FemSolverWithMaskedMesh<Geome
     /// Create 3D-vector with calculated heat fluxes
     void saveHeatFluxes(); // [W/m^2]
 
+    /**
+     * Set thickness of the layer containing the element, i.e. of its vertical run of elements with the same material
+     * \param elem element to set thickness for
+     * \param materials materials in the elements of the masked mesh
+     */
+    void setLayerThickness(const RectangularMaskedMesh3D::Element& elem, const MaterialRaster& materials);
+
     /// Initialize the solver
     void onInitialize() override;
 
     /// Invalidate the data
     void onInvalidate() override;
 
+    /**
+     * Update the solver after the geometry change.
+     * If only materials have changed and no element becomes empty or non-empty, the mesh and computed temperatures
+     * are kept (the latter as the initial guess for the next computations) and only the layer thicknesses in the
+     * affected columns of elements are updated. Otherwise the solver is invalidated.
+     * \param evt information about geometry changes
+     */
+    void onGeometryChange(const Geometry::Event& evt) override;
+
   public:
 
     double inittemp;    ///< Initial temperature
@@ -110,6 +126,17 @@ struct PLASK_SOLVER_API ThermalFem3DSolver: public FemSolverWithMaskedMesh<Geome
     /// Get max absolute correction for temperature
     double getErr() const { return toterr; }
 
+    /// Get temperatures in the mesh nodes (empty if they have not been computed yet)
+    DataVector<const double> getTemperatureVector() const { return temperatures; }
+
+    /**
+     * Replace temperatures in the mesh nodes.
+     * This is intended for external drivers of self-consistent loops, which modify the temperatures between
+     * subsequent calls to \ref compute.
+     * \param temps new temperatures in the nodes of the masked mesh
+     */
+    void setTemperatureVector(const DataVector<const double>& temps);
+
     /// \return current algorithm
     FemMatrixAlgorithm getAlgorithm() const { return algorithm; }
 
@@ -125,6 +152,7 @@ struct PLASK_SOLVER_API ThermalFem3DSolver: public FemSolverWithMaskedMesh<Geome
         const ThermalFem3DSolver* solver;
         shared_ptr<const MeshD<3>> dest_mesh;
         InterpolationFlags flags;
+        shared_ptr<const MaterialRaster> materials;
         LazyData<double> temps;
         ThermalConductivityData(const ThermalFem3DSolver* solver, const shared_ptr<const MeshD<3>>& dst_mesh);
         Tensor2<double> at(std::size_t i) const override;
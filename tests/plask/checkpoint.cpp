@@ -0,0 +1,75 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include "plask/checkpoint.hpp"
+
+BOOST_AUTO_TEST_SUITE(checkpoint) // MUST be the same as the file name
+
+    BOOST_AUTO_TEST_CASE(checkpoint_data) {
+        const std::string filename = "test_checkpoint.ckp";
+
+        plask::DataVector<double> values(1000);
+        for (std::size_t i = 0; i != values.size(); ++i) values[i] = 0.5 * double(i);
+        plask::DataVector<plask::Tensor2<double>> tensors(7, plask::Tensor2<double>(1., 2.));
+
+        {
+            plask::CheckpointWriter writer(filename);
+            writer.write("values", values);
+            writer.write("tensors", tensors);
+            writer.writeValue("time", 12.5);
+            BOOST_CHECK_THROW(writer.writeValue("time", 1.), plask::Exception);
+            writer.close();
+        }
+
+        plask::DataVector<double> restored;
+        {
+            plask::CheckpointReader reader(filename);
+            BOOST_CHECK(reader.has("values"));
+            BOOST_CHECK(!reader.has("missing"));
+            BOOST_CHECK_EQUAL(reader.readValue<double>("time"), 12.5);
+            BOOST_CHECK_EQUAL(reader.readValue<double>("missing", 3.), 3.);
+            BOOST_CHECK_EQUAL(reader.read<plask::Tensor2<double>>("tensors")[6], tensors[6]);
+            BOOST_CHECK_THROW(reader.read<plask::dcomplex>("values"), plask::DataError);
+            restored = reader.read<double>("values");
+        }
+        // data outlive the reader and are aligned
+        BOOST_CHECK_EQUAL(restored, values);
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(restored.data()) % plask::CHECKPOINT_ALIGNMENT, 0);
+
+        // modification of the restored data must not change the file
+        restored[3] = -1.;
+        BOOST_CHECK_EQUAL(plask::CheckpointReader(filename).read<double>("values")[3], 1.5);
+
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(checkpoint_mesh) {
+        const std::string filename = "test_checkpoint_mesh.ckp";
+
+        plask::RectangularMesh<3> mesh(plask::make_shared<plask::OrderedAxis>(std::vector<double>{0., 1., 2.}),
+                                       plask::make_shared<plask::RegularAxis>(0., 3., 4),
+                                       plask::make_shared<plask::OrderedAxis>(std::vector<double>{0., 1., 5., 7.}),
+                                       plask::RectangularMesh<3>::ORDER_210);
+        {
+            plask::CheckpointWriter writer(filename);
+            writer.writeMesh("mesh", mesh);
+            writer.close();
+        }
+        auto restored = plask::CheckpointReader(filename).readMesh<3>("mesh");
+        BOOST_CHECK(*restored == mesh);
+        BOOST_CHECK_EQUAL(restored->getIterationOrder(), plask::RectangularMesh<3>::ORDER_210);
+
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(checkpoint_bad_file) {
+        const std::string filename = "test_checkpoint_bad.ckp";
+        {
+            std::ofstream file(filename);
+            file << "This is not a checkpoint file, but it is long enough to contain the whole header ..........";
+        }
+        BOOST_CHECK_THROW(plask::CheckpointReader reader(filename), plask::Exception);
+        std::remove(filename.c_str());
+        BOOST_CHECK_THROW(plask::CheckpointReader reader(filename), plask::Exception);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
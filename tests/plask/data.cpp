@@ -1,6 +1,8 @@
 #include <boost/test/unit_test.hpp>
 #include "plask/data.hpp"
 
+#include <cstdint>
+
 BOOST_AUTO_TEST_SUITE(data) // MUST be the same as the file name
 
     BOOST_AUTO_TEST_CASE(const_datavector) {
@@ -49,4 +51,30 @@ BOOST_AUTO_TEST_SUITE(data) // MUST be the same as the file name
 
     }
 
+    BOOST_AUTO_TEST_CASE(aligned_datavector) {
+        auto is_aligned = [](const void* ptr) { return reinterpret_cast<std::uintptr_t>(ptr) % PLASK_MEMORY_ALIGNMENT == 0; };
+
+        plask::DataVector<double> small(3);
+        BOOST_CHECK(is_aligned(small.data()));
+
+        // large enough to be filled in parallel
+        const std::size_t n = 2 * plask::PARALLEL_FILL_MIN_SIZE / sizeof(double) + 3;
+        plask::DataVector<double> large(n, 1.5);
+        BOOST_CHECK(is_aligned(large.data()));
+        BOOST_CHECK_EQUAL(std::count(large.begin(), large.end(), 1.5), n);
+
+        large.reset(n, 2.5);
+        BOOST_CHECK(is_aligned(large.data()));
+        BOOST_CHECK_EQUAL(std::count(large.begin(), large.end(), 2.5), n);
+
+        int* data = plask::aligned_malloc<int>(5);
+        for (int i = 0; i != 5; ++i) data[i] = i;
+        for (std::size_t size: {7, 100000, 3}) {
+            data = reinterpret_cast<int*>(plask::aligned_realloc(data, size * sizeof(int)));
+            BOOST_CHECK(is_aligned(data));
+            for (int i = 0; i != 3; ++i) BOOST_CHECK_EQUAL(data[i], i);
+        }
+        plask::aligned_free(data);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,240 @@
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+#include "plask/mesh/rectangular_masked.hpp"
+#include "plask/common/fem/coloring.hpp"
+#include "plask/common/fem/cholesky_matrix.hpp"
+#include "plask/common/fem/csr_matrix.hpp"
+
+namespace {
+
+struct TestSolver: public plask::Solver {
+    plask::IterativeMatrixParams iter_params;
+    TestSolver(): plask::Solver("test") {}
+    std::string getClassName() const override { return "Test"; }
+};
+
+/// Band matrix counting its factorizations
+struct CountingDpbMatrix: public plask::DpbMatrix {
+    int factorizations = 0;
+    CountingDpbMatrix(const plask::Solver* solver, size_t rank, size_t band): plask::DpbMatrix(solver, rank, band) {}
+    void factorize() override {
+        ++factorizations;
+        plask::DpbMatrix::factorize();
+    }
+};
+
+/// Fill the matrix with 7-point Laplacian on n×n×n grid with Neumann boundaries and the diagonal increased by \p shift
+template <typename MatrixT> void setLaplacian(MatrixT& A, size_t n, double shift) {
+    A.clear();
+    for (size_t k = 0, i = 0; k < n; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t l = 0; l < n; ++l, ++i) {
+                A(i, i) += shift;
+                for (size_t d: {size_t(1), n, n * n}) {
+                    bool inside = (d == 1) ? l + 1 < n : (d == n) ? j + 1 < n : k + 1 < n;
+                    if (!inside) continue;
+                    A(i, i) += 1.;
+                    A(i + d, i + d) += 1.;
+                    A(i, i + d) = -1.;
+                }
+            }
+        }
+    }
+}
+
+template <typename MeshT>
+void checkColors(const MeshT& mesh, const std::vector<std::vector<size_t>>& colors) {
+    size_t count = 0;
+    for (const auto& indices: colors) {
+        std::set<size_t> nodes;
+        for (size_t i: indices) {
+            auto elem = mesh.element(i);
+            for (size_t node: {elem.getLoLoLoIndex(), elem.getUpLoLoIndex(), elem.getLoUpLoIndex(), elem.getUpUpLoIndex(),
+                               elem.getLoLoUpIndex(), elem.getUpLoUpIndex(), elem.getLoUpUpIndex(), elem.getUpUpUpIndex()})
+                BOOST_CHECK_MESSAGE(nodes.insert(node).second, "node " << node << " shared by elements of one color");
+        }
+        count += indices.size();
+    }
+    BOOST_CHECK_EQUAL(count, mesh.getElementsCount());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(fem) // MUST be the same as the file name
+
+    BOOST_AUTO_TEST_CASE(element_coloring) {
+        auto axis0 = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{0., 1., 2., 3., 4., 5.});
+        auto axis1 = plask::make_shared<plask::RegularAxis>(0., 3., 4);
+        auto axis2 = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{0., 1., 3., 4., 5.});
+        plask::RectangularMesh<3> fullMesh(axis0, axis1, axis2);
+
+        checkColors(fullMesh, plask::colorElements(fullMesh));
+
+        plask::RectangularMaskedMesh3D maskedMesh(fullMesh, [](const plask::RectangularMesh<3>::Element& e) {
+            return e.getIndex0() != 2 && (e.getIndex1() != 1 || e.getIndex2() == 3);
+        });
+        BOOST_REQUIRE_LT(maskedMesh.getElementsCount(), fullMesh.getElementsCount());
+        checkColors(maskedMesh, plask::colorElements(maskedMesh));
+
+        plask::FemElementColoring coloring;
+        checkColors(maskedMesh, coloring(maskedMesh));
+        checkColors(fullMesh, coloring(fullMesh));
+
+        // Colors must be recomputed after the mesh changes or is reset
+        axis0->addPoint(6.);
+        checkColors(fullMesh, coloring(fullMesh));
+        maskedMesh.reset(fullMesh, [](const plask::RectangularMesh<3>::Element& e) { return e.getIndex0() != 1; });
+        checkColors(maskedMesh, coloring(maskedMesh));
+        coloring.reset();
+        maskedMesh.reset(fullMesh, [](const plask::RectangularMesh<3>::Element& e) { return e.getIndex2() != 0; });
+        checkColors(maskedMesh, coloring(maskedMesh));
+    }
+
+    BOOST_AUTO_TEST_CASE(factorization_reuse) {
+        TestSolver solver;
+        const size_t n = 6, rank = n * n * n;
+        CountingDpbMatrix A(&solver, rank, n * n);
+        A.reuse_tolerance = 1e-10;
+
+        auto solve = [&](CountingDpbMatrix& A) {
+            plask::DataVector<double> B(rank, 1.), X(rank, 0.);
+            A.solve(B, X);
+            return X;
+        };
+
+        setLaplacian(A, n, 0.1);
+        auto X0 = solve(A);
+        BOOST_CHECK_EQUAL(A.factorizations, 1);
+
+        // Unchanged matrix is not factorized again
+        setLaplacian(A, n, 0.1);
+        auto X1 = solve(A);
+        BOOST_CHECK_EQUAL(A.factorizations, 1);
+        for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(X1[i], X0[i], 1e-10);
+
+        // Slightly changed matrix is solved with iterative refinement using the previous factorization
+        setLaplacian(A, n, 0.1 + 1e-9);
+        auto X2 = solve(A);
+        BOOST_CHECK_EQUAL(A.factorizations, 1);
+        CountingDpbMatrix F(&solver, rank, n * n);
+        setLaplacian(F, n, 0.1 + 1e-9);
+        auto Xf = solve(F);
+        for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(X2[i], Xf[i], 1e-7);
+
+        // Significantly changed matrix is factorized anew
+        setLaplacian(A, n, 1.0);
+        auto X3 = solve(A);
+        BOOST_CHECK_EQUAL(A.factorizations, 2);
+        for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(X3[i], 1.0, 1e-8);
+    }
+
+    BOOST_AUTO_TEST_CASE(sparse_matrix) {
+        TestSolver solver;
+        solver.iter_params.maxerr = 1e-12;
+        const size_t n = 10, rank = n * n * n;  // large enough for more than one multigrid level
+
+        // Pattern of the 7-point stencil, given as two-node "elements"
+        std::vector<std::pair<size_t, size_t>> links;
+        for (size_t i = 0; i != rank; ++i)
+            for (size_t d: {size_t(1), n, n * n})
+                if (i + d < rank && (d != 1 || (i + 1) % n != 0) && (d != n || (i / n + 1) % n != 0)) links.emplace_back(i, i + d);
+        auto nodes = [](const std::pair<size_t, size_t>& link, size_t* idx) {
+            idx[0] = link.first; idx[1] = link.second;
+            return size_t(2);
+        };
+
+        auto compare = [&](plask::CsrMatrix& S, plask::DpbMatrix& D, plask::DataVector<double> B, size_t zero_row) {
+            plask::DataVector<double> BS = B.copy(), XS(rank, 0.), BD = B.copy(), XD(rank, 0.);
+            for (size_t i = 0; i != n * n; ++i) {  // constant temperature at the bottom face
+                S.setBC(BS, i, 300.);
+                D.setBC(BD, i, 300.);
+            }
+            S.solve(BS, XS);
+            D.solve(BD, XD);
+            BOOST_CHECK(solver.iter_params.converged);
+            for (size_t i = 0; i != rank; ++i)
+                if (i != zero_row) BOOST_CHECK_CLOSE(XS[i], XD[i], 1e-6);
+        };
+
+        // Singular Laplacian with Neumann boundaries made definite by the boundary conditions
+        {
+            plask::CsrMatrix S(&solver, rank, plask::CsrPattern(rank, links, nodes));
+            plask::DpbMatrix D(&solver, rank, n * n);
+            setLaplacian(S, n, 0.);
+            setLaplacian(D, n, 0.);
+            compare(S, D, plask::DataVector<double>(rank, 1.), rank);
+            BOOST_CHECK_GT(solver.iter_params.iters, 0);
+        }
+
+        // Node detached from the others leaves zero row (e.g. unused node of the mesh)
+        {
+            const size_t zero_row = (n / 2) * (n * n + n + 1);  // inner node, so it has all six neighbours
+            plask::CsrMatrix S(&solver, rank, plask::CsrPattern(rank, links, nodes));
+            plask::DpbMatrix D(&solver, rank, n * n);
+            setLaplacian(S, n, 0.);
+            setLaplacian(D, n, 0.);
+            for (auto A: std::initializer_list<plask::FemMatrix*>{&S, &D}) {
+                for (size_t d: {size_t(1), n, n * n}) {
+                    (*A)(zero_row, zero_row + d) = 0.; (*A)(zero_row + d, zero_row + d) -= 1.;
+                    (*A)(zero_row - d, zero_row) = 0.; (*A)(zero_row - d, zero_row - d) -= 1.;
+                }
+                (*A)(zero_row, zero_row) = 0.;
+            }
+            D(zero_row, zero_row) = 1.;
+            plask::DataVector<double> B(rank, 1.);
+            B[zero_row] = 0.;
+            compare(S, D, B, zero_row);
+        }
+
+        // Matrix modified after solving without clearing it must be prepared anew
+        {
+            plask::CsrMatrix S(&solver, rank, plask::CsrPattern(rank, links, nodes));
+            plask::DpbMatrix D(&solver, rank, n * n);
+            setLaplacian(S, n, 0.5);
+            setLaplacian(D, n, 1.0);
+            plask::DataVector<double> B(rank, 1.), XS(rank, 0.), XD(rank, 0.);
+            S.solve(B, XS);
+            for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(XS[i], 2.0, 1e-6);
+            for (size_t i = 0; i != rank; ++i) S(i, i) += 0.5;
+            B.fill(1.);
+            S.solve(B, XS);
+            B.fill(1.);
+            D.solve(B, XD);
+            for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(XS[i], XD[i], 1e-6);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(sparse_matrix_stalled_coarsening) {
+        TestSolver solver;
+        solver.iter_params.maxerr = 1e-12;
+        const size_t rank = 4 * plask::detail::AmgPreconditioner::COARSE_SIZE;
+
+        // Weak off-diagonal couplings give no aggregates, so the only level is larger than the direct solve limit
+        std::vector<std::pair<size_t, size_t>> links;
+        for (size_t i = 0; i + 1 < rank; ++i) links.emplace_back(i, i + 1);
+        auto nodes = [](const std::pair<size_t, size_t>& link, size_t* idx) {
+            idx[0] = link.first; idx[1] = link.second;
+            return size_t(2);
+        };
+        plask::CsrMatrix S(&solver, rank, plask::CsrPattern(rank, links, nodes));
+        for (size_t i = 0; i != rank; ++i) {
+            S(i, i) = 1. + 0.001 * double(i % 7);
+            if (i + 1 < rank) S(i, i + 1) = -0.01;
+        }
+
+        plask::DataVector<double> B(rank, 1.), X(rank, 0.), AX(rank);
+        S.solve(B, X);
+        BOOST_CHECK(solver.iter_params.converged);
+        S.mult(X, AX);
+        for (size_t i = 0; i != rank; ++i) BOOST_CHECK_CLOSE(AX[i], 1., 1e-8);
+
+        plask::detail::AmgPreconditioner amg;
+        amg.build(rank, S.rows.data(), S.cols.data(), S.data);
+        BOOST_CHECK_EQUAL(amg.size(), 1);
+        BOOST_CHECK(!amg.coarse_direct);
+        BOOST_CHECK(amg.coarse.empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
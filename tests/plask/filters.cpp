@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include "plask/filters/filter.hpp"
 #include "plask/mesh/basic.hpp"
+#include "plask/mesh/rectangular2d.hpp"
 #include "plask/geometry/geometry.hpp"
 #include "common/dumb_material.hpp"
 
@@ -75,6 +76,89 @@ BOOST_AUTO_TEST_SUITE(filters) // MUST be the same as the file name
         BOOST_CHECK_EQUAL(filter2D.out(plask::toMesh(plask::vec(0.5, 0.5)), plask::INTERPOLATION_DEFAULT), plask::DataVector<double>{ 3.0 });
     }
 
+    BOOST_AUTO_TEST_CASE(cartesian2D_geometry_change) {
+        struct DoubleField: public plask::FieldProperty<double> {};
+
+        TestEnvGeom2D g;
+
+        plask::Filter<DoubleField, plask::Geometry2DCartesian> filter2D(plask::make_shared<plask::Geometry2DCartesian>(g.extrusion));
+
+        filter2D.setDefault(1.0);
+        filter2D.appendInner(g.block11) = 2.0;
+        auto axis = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{0.5, 1.5, 2.25, 3.25});
+        auto mesh = plask::make_shared<plask::RectangularMesh2D>(axis, axis);
+        {
+            auto data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+            BOOST_CHECK_EQUAL(data[mesh->index(0, 0)], 1.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(1, 1)], 2.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(2, 2)], 2.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(3, 3)], 1.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(1, 2)], 1.0);
+        }
+        g.block11->setSize(plask::vec(1.5, 1.5));   // second block now reaches (3.5, 3.5)
+        {
+            auto data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+            BOOST_CHECK_EQUAL(data[mesh->index(3, 3)], 2.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(1, 2)], 2.0);
+        }
+        axis->addPoint(4.0);    // the same mesh with more points
+        {
+            auto data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+            BOOST_CHECK_EQUAL(data.size(), 25);
+            BOOST_CHECK_EQUAL(data[mesh->index(4, 4)], 1.0);
+            BOOST_CHECK_EQUAL(data[mesh->index(3, 3)], 2.0);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(cartesian2D_all_values) {
+        struct DoubleField: public plask::FieldProperty<double> {};
+
+        TestEnvGeom2DCyl g;
+        auto extrusion = plask::make_shared<plask::Extrusion>(g.container, 10.0);
+
+        plask::Filter<DoubleField, plask::Geometry2DCartesian> filter2D(plask::make_shared<plask::Geometry2DCartesian>(extrusion));
+
+        filter2D.setDefault(1.0);
+        filter2D.appendInner(g.blockLower) = 2.0;
+        filter2D.appendInner(g.blockUpper) = 3.0;
+        auto axis0 = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{-0.25, 0.25, 0.75, 1.25});
+        auto axis1 = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{-0.5, 0.25, 0.5, 1.5, 2.25, 2.5, 3.5});
+        auto mesh = plask::make_shared<plask::RectangularMesh2D>(axis0, axis1);
+        auto data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+        plask::DataVector<const double> all = data.nonLazy();
+        BOOST_REQUIRE_EQUAL(all.size(), mesh->size());
+        for (std::size_t i = 0; i < mesh->size(); ++i) {
+            auto p = mesh->at(i);
+            double expected = (p.c0 < 0. || p.c0 > 1.) ? 1.0 : (0. < p.c1 && p.c1 < 1.) ? 2.0 : (2. < p.c1 && p.c1 < 3.) ? 3.0 : 1.0;
+            BOOST_CHECK_EQUAL(data[i], all[i]);
+            BOOST_CHECK_EQUAL(all[i], expected);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(cartesian2D_data_outlives_filter) {
+        struct DoubleField: public plask::FieldProperty<double> {};
+
+        TestEnvGeom2D g;
+        auto axis = plask::make_shared<plask::OrderedAxis>(std::initializer_list<double>{0.5, 1.5});
+        auto mesh = plask::make_shared<plask::RectangularMesh2D>(axis, axis);
+
+        plask::LazyData<double> data, all_data;
+        {
+            plask::Filter<DoubleField, plask::Geometry2DCartesian> filter2D(plask::make_shared<plask::Geometry2DCartesian>(g.extrusion));
+            filter2D.setDefault(1.0);
+            filter2D.appendInner(g.block11) = 2.0;
+            data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+            all_data = filter2D.out(mesh, plask::INTERPOLATION_DEFAULT);
+            filter2D.setDefault(3.0);   // replaces the outer source used by the data
+        }
+        BOOST_CHECK_EQUAL(data[mesh->index(0, 0)], 1.0);
+        BOOST_CHECK_EQUAL(data[mesh->index(1, 1)], 2.0);
+        plask::DataVector<const double> all = all_data.nonLazy();
+        BOOST_CHECK_EQUAL(all[mesh->index(0, 0)], 1.0);
+        BOOST_CHECK_EQUAL(all[mesh->index(1, 0)], 1.0);
+        BOOST_CHECK_EQUAL(all[mesh->index(1, 1)], 2.0);
+    }
+
     BOOST_AUTO_TEST_CASE(cylindrical2D) {
         struct DoubleField: public plask::FieldProperty<double> {};
 
@@ -1,8 +1,12 @@
 #include <boost/test/unit_test.hpp>
 
+#include "plask/geometry/clip.hpp"
 #include "plask/geometry/geometry.hpp"
 #include "plask/geometry/stack.hpp"
 #include "plask/geometry/transform_space_cartesian.hpp"
+#include "plask/geometry/space.hpp"
+#include "plask/mesh/rectangular.hpp"
+#include "plask/material/air.hpp"
 
 #include "common/dumb_material.hpp"
 
@@ -167,4 +171,184 @@ BOOST_AUTO_TEST_SUITE(geometry) // MUST be the same as the file name
         BOOST_CHECK_EQUAL(lattice->getChildrenCount(), 3*5 - 1);
     }
 
+    BOOST_AUTO_TEST_CASE(material_raster) {
+        Leafs2D leafs;
+        auto stack = plask::make_shared<plask::StackContainer<2>>();
+        stack->push_back(leafs.block_5_3);
+        auto geometry = plask::make_shared<plask::Geometry2DCartesian>(stack, 1.0);
+        auto yaxis = plask::make_shared<plask::OrderedAxis>(std::vector<double>{1., 4., 6.});
+        auto mesh = plask::make_shared<plask::RectangularMesh2D>(plask::make_shared<plask::RegularAxis>(1., 4., 3), yaxis);
+
+        auto raster = geometry->getMaterialRaster(mesh);
+        BOOST_REQUIRE_EQUAL(raster->size(), mesh->size());
+        BOOST_CHECK(raster->isCompact());
+        BOOST_CHECK_EQUAL(raster->getMaterials().size(), 2);
+        for (std::size_t i = 0; i != mesh->size(); ++i) {
+            BOOST_CHECK((*raster)[i] == geometry->getMaterial(mesh->at(i)));
+            BOOST_CHECK_EQUAL(raster->getId(i), raster->getId(mesh->index(0, mesh->index1(i))));
+        }
+        BOOST_CHECK(raster->getId(mesh->index(0, 0)) != raster->getId(mesh->index(0, 1)));
+        BOOST_CHECK_EQUAL(raster->getId(mesh->index(0, 1)), raster->getId(mesh->index(0, 2)));
+
+        // cached raster is returned until the geometry or the mesh changes
+        BOOST_CHECK_EQUAL(geometry->getMaterialRaster(mesh), raster);
+
+        stack->push_back(leafs.block_5_4);
+        auto changed = geometry->getMaterialRaster(mesh);
+        BOOST_CHECK(changed != raster);
+        BOOST_CHECK((*changed)[mesh->index(0, 1)] == leafs.dumbMaterial);
+        BOOST_CHECK((*changed)[mesh->index(0, 2)] == leafs.dumbMaterial);
+
+        yaxis->addPoint(8.);
+        raster = geometry->getMaterialRaster(mesh);
+        BOOST_CHECK(changed != raster);
+        BOOST_CHECK_EQUAL(raster->size(), mesh->size());
+        BOOST_CHECK((*raster)[mesh->index(0, 3)] == geometry->defaultMaterial);
+
+        geometry->defaultMaterial = plask::make_shared<plask::materials::Air>();
+        BOOST_CHECK((*geometry->getMaterialRaster(mesh))[mesh->index(0, 3)] == geometry->defaultMaterial);
+    }
+
+    BOOST_AUTO_TEST_CASE(material_change_event) {
+        Leafs2D leafs;
+        auto stack = plask::make_shared<plask::StackContainer<2>>();
+        stack->push_back(leafs.block_5_3);
+        stack->push_back(leafs.block_5_4);
+        auto geometry = plask::make_shared<plask::Geometry2DCartesian>(stack, 1.0);
+        auto mesh = plask::make_shared<plask::RectangularMesh2D>(plask::make_shared<plask::RegularAxis>(1., 4., 3),
+                                                                 plask::make_shared<plask::RegularAxis>(1., 6., 6));
+        auto raster = geometry->getMaterialRaster(mesh);
+
+        bool material_only = false;
+        std::vector<plask::Box2D> boxes;
+        auto connection = geometry->changed.connect([&](plask::GeometryObject::Event& evt) {
+            material_only = evt.isMaterialOnly();
+            boxes = geometry->getChangedBoundingBoxes(evt);
+        });
+
+        auto air = plask::make_shared<plask::materials::Air>();
+        leafs.block_5_4->setMaterial(air);
+        BOOST_CHECK(material_only);
+        BOOST_REQUIRE_EQUAL(boxes.size(), 1);
+        BOOST_CHECK_EQUAL(boxes[0], plask::Box2D(0., 3., 5., 7.));
+        // cached raster is updated in the changed region
+        auto updated = geometry->getMaterialRaster(mesh);
+        BOOST_CHECK(updated != raster);
+        for (std::size_t i = 0; i != mesh->size(); ++i)
+            BOOST_CHECK((*updated)[i] == geometry->getMaterial(mesh->at(i)));
+        BOOST_CHECK(geometry->getMaterial(plask::vec(2., 5.)) == air);
+        BOOST_CHECK(geometry->getMaterial(plask::vec(2., 2.)) == leafs.dumbMaterial);
+
+        leafs.block_5_3->setSize(plask::vec(5., 4.));
+        BOOST_CHECK(!material_only);
+        BOOST_REQUIRE_EQUAL(boxes.size(), 1);
+        BOOST_CHECK_EQUAL(boxes[0], plask::Box2D(0., 0., 5., 8.));
+        BOOST_CHECK(geometry->getMaterial(plask::vec(2., 3.5)) == leafs.dumbMaterial);
+
+        connection.disconnect();
+    }
+
+    static bool same_subtree(const plask::GeometryObject::Subtree& a, const plask::GeometryObject::Subtree& b) {
+        if (a.object != b.object || a.children.size() != b.children.size()) return false;
+        for (std::size_t i = 0; i != a.children.size(); ++i)
+            if (!same_subtree(a.children[i], b.children[i])) return false;
+        return true;
+    }
+
+    BOOST_AUTO_TEST_CASE(geometry_tree_index) {
+        // Overlapping rows of cylinders with distinct materials, partially clipped, mirrored, and in nested containers
+        auto root = plask::make_shared<plask::TranslationContainer<3>>();
+        auto nested = plask::make_shared<plask::TranslationContainer<3>>();
+        std::vector<plask::shared_ptr<plask::Material>> materials;
+        for (int i = 0; i != 40; ++i) {
+            materials.emplace_back(new DumbMaterial());
+            auto cylinder = plask::make_shared<plask::Cylinder>(0.8, 1.0 + 0.1 * (i % 3), materials.back());
+            plask::Vec<3> position(0.7 * (i % 8), 0.9 * (i / 8), 0.3 * (i % 5));
+            if (i % 7 == 3)
+                root->add(plask::make_shared<plask::Clip<3>>(cylinder,
+                    plask::Box3D(-0.5, -1., 0., 1., 0.5, 0.6)), position);
+            else if (i % 7 == 5)
+                root->add(plask::make_shared<plask::Mirror<3>>(plask::Primitive<3>::DIRECTION_TRAN, cylinder), position);
+            else if (i % 2)
+                nested->add(cylinder, position);
+            else
+                root->add(cylinder, position);
+        }
+        root->add(plask::make_shared<plask::Intersection<3>>(nested,
+            plask::make_shared<plask::Block<3>>(plask::vec(4., 3., 1.), materials[0])), plask::vec(0.2, -0.4, 0.1));
+
+        auto geometry = plask::make_shared<plask::Geometry3D>(root);
+        for (double x = -1.2; x < 6.5; x += 0.23)
+            for (double y = -1.1; y < 5.2; y += 0.19)
+                for (double z = -0.1; z < 2.6; z += 0.31) {
+                    plask::Vec<3> p(x, y, z);
+                    auto material = root->getMaterial(p);
+                    BOOST_CHECK(geometry->getMaterial(p) == (material ? material : geometry->defaultMaterial));
+                    BOOST_CHECK_EQUAL(geometry->contains(p), root->contains(p));
+                    BOOST_CHECK(same_subtree(geometry->getPathsAt(p), root->getPathsAt(p)));
+                    BOOST_CHECK(same_subtree(geometry->getPathsAt(p, true), root->getPathsAt(p, true)));
+                }
+
+        // index is rebuilt when the geometry changes
+        auto top = plask::make_shared<plask::Block<3>>(plask::vec(1., 1., 1.), materials[1]);
+        root->add(top, plask::vec(0.1, 0.1, 0.1));
+        BOOST_CHECK(geometry->getMaterial(plask::vec(0.5, 0.5, 0.5)) == materials[1]);
+        BOOST_CHECK(same_subtree(geometry->getPathsAt(plask::vec(0.5, 0.5, 0.5)), root->getPathsAt(plask::vec(0.5, 0.5, 0.5))));
+
+        // index built concurrently by many threads is the same for all of them
+        root->add(plask::make_shared<plask::Block<3>>(plask::vec(1., 1., 1.), materials[2]), plask::vec(0.1, 0.1, 0.1));
+        int wrong = 0;
+        #pragma omp parallel for reduction(+:wrong)
+        for (int i = 0; i < 1000; ++i) {
+            plask::Vec<3> p(0.007 * i - 1., 0.5, 0.5);
+            auto material = root->getMaterial(p);
+            if (geometry->getMaterial(p) != (material ? material : geometry->defaultMaterial)) ++wrong;
+        }
+        BOOST_CHECK_EQUAL(wrong, 0);
+
+        // new child without hierarchy replaces the index
+        auto small = plask::make_shared<plask::Block<3>>(plask::vec(1., 1., 1.), materials[3]);
+        geometry->setChild(small);
+        BOOST_CHECK(geometry->getMaterial(plask::vec(0.5, 0.5, 0.5)) == materials[3]);
+        BOOST_CHECK(geometry->getMaterial(plask::vec(1.5, 0.5, 0.5)) == geometry->defaultMaterial);
+        BOOST_CHECK(geometry->contains(plask::vec(0.5, 0.5, 0.5)));
+    }
+
+    BOOST_AUTO_TEST_CASE(geometry_tree_index_lattice) {
+        // Lattice of cylinders with the hole in the middle, overlapped by a block in a translation container
+        plask::shared_ptr<plask::Material> material1(new DumbMaterial()), material2(new DumbMaterial());
+        auto lattice = plask::make_shared<plask::Lattice>(plask::make_shared<plask::Cylinder>(0.4, 1.0, material1),
+                                                          plask::vec(1.0, 0.0, 0.0), plask::vec(0.5, 1.0, 0.0));
+        lattice->segments.push_back(std::vector<plask::Vec<2, int>>{plask::vec(-3,-3), plask::vec(-3,3), plask::vec(3,3), plask::vec(3,-3)});
+        lattice->segments.push_back(std::vector<plask::Vec<2, int>>{plask::vec(-1,-1), plask::vec(-1,1), plask::vec(1,1), plask::vec(1,-1)});
+        lattice->refillContainer();
+        auto root = plask::make_shared<plask::TranslationContainer<3>>();
+        root->add(lattice);
+        root->add(plask::make_shared<plask::Block<3>>(plask::vec(1.5, 2., 0.5), material2), plask::vec(1.2, -0.7, 0.3));
+
+        auto geometry = plask::make_shared<plask::Geometry3D>(root);
+        auto check = [&] {
+            int wrong = 0;
+            for (double x = -5.3; x < 5.3; x += 0.17)
+                for (double y = -3.6; y < 3.6; y += 0.13)
+                    for (double z = -0.1; z < 1.2; z += 0.4) {
+                        plask::Vec<3> p(x, y, z);
+                        auto material = root->getMaterial(p);
+                        if (geometry->getMaterial(p) != (material ? material : geometry->defaultMaterial) ||
+                            geometry->contains(p) != root->contains(p) ||
+                            !same_subtree(geometry->getPathsAt(p), root->getPathsAt(p)))
+                            ++wrong;
+                    }
+            return wrong;
+        };
+        BOOST_CHECK_EQUAL(check(), 0);
+        BOOST_CHECK(geometry->getMaterial(plask::vec(-3., 0., 0.5)) == material1);
+        BOOST_CHECK(geometry->getMaterial(plask::vec(0., 0., 0.5)) == geometry->defaultMaterial);
+
+        // index is rebuilt when the lattice is refilled
+        lattice->setSegments({{plask::vec(-3,-3), plask::vec(-3,3), plask::vec(3,3), plask::vec(3,-3)}});
+        BOOST_CHECK(geometry->getMaterial(plask::vec(0., 0., 0.5)) == material1);
+        BOOST_CHECK_EQUAL(check(), 0);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
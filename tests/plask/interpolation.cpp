@@ -3,6 +3,7 @@
 #include "plask/mesh/interpolation.hpp"
 #include "plask/mesh/mesh.hpp"
 #include "plask/mesh/rectangular.hpp"
+#include "plask/mesh/rectangular_masked2d.hpp"
 #include "plask/mesh/ordered1d.hpp"
 #include "plask/mesh/rectangular_spline.hpp"
 
@@ -132,4 +133,76 @@ BOOST_AUTO_TEST_SUITE(interpolation) // MUST be the same as the file name
                    );
     }
 
+    BOOST_AUTO_TEST_CASE(linear_plan_cache) {
+        plask::shared_ptr<plask::OrderedAxis> sa(new plask::OrderedAxis({0., 1., 2., 4.})),
+                                              sb(new plask::OrderedAxis({0., 1., 3.})),
+                                              da(new plask::OrderedAxis({0.5, 1.5, 3.0})),
+                                              db(new plask::OrderedAxis({0.2, 2.5}));
+        auto src_mesh = plask::make_shared<plask::RectangularMesh<2>>(sa, sb);
+        auto dst_mesh = plask::make_shared<plask::RectangularMesh<2>>(da, db);
+
+        auto values = [](const plask::shared_ptr<plask::RectangularMesh<2>>& mesh, double cx, double cy) {
+            plask::DataVector<double> result(mesh->size());
+            for (size_t i = 0; i != mesh->size(); ++i) result[i] = cx * mesh->at(i).c0 + cy * mesh->at(i).c1 + 1.;
+            return plask::DataVector<const double>(result);
+        };
+        auto check = [&](const plask::DataVector<const double>& dst, double cx, double cy) {
+            BOOST_REQUIRE_EQUAL(dst.size(), dst_mesh->size());
+            for (size_t i = 0; i != dst.size(); ++i)
+                BOOST_CHECK_CLOSE(dst[i], cx * dst_mesh->at(i).c0 + cy * dst_mesh->at(i).c1 + 1., 1e-12);
+        };
+
+        // The first interpolation is direct, the following ones use the cached plan
+        plask::DataVector<const double> src = values(src_mesh, 1., 2.);
+        plask::DataVector<const double> direct = plask::interpolate(src_mesh, src, dst_mesh, plask::INTERPOLATION_LINEAR);
+        check(direct, 1., 2.);
+        for (int n = 0; n != 2; ++n) {
+            plask::DataVector<const double> planned = plask::interpolate(src_mesh, src, dst_mesh, plask::INTERPOLATION_LINEAR);
+            BOOST_REQUIRE_EQUAL(planned.size(), direct.size());
+            for (size_t i = 0; i != direct.size(); ++i) BOOST_CHECK_CLOSE(planned[i], direct[i], 1e-12);
+        }
+        check(plask::interpolate(src_mesh, values(src_mesh, 3., -1.), dst_mesh, plask::INTERPOLATION_LINEAR), 3., -1.);
+
+        // Changing any of the meshes must drop the plan
+        da->addPoint(3.5);
+        for (int n = 0; n != 3; ++n)
+            check(plask::interpolate(src_mesh, values(src_mesh, 1., 2.), dst_mesh, plask::INTERPOLATION_LINEAR), 1., 2.);
+        sb->addPoint(2.);
+        for (int n = 0; n != 3; ++n)
+            check(plask::interpolate(src_mesh, values(src_mesh, -2., 1.), dst_mesh, plask::INTERPOLATION_LINEAR), -2., 1.);
+    }
+
+    BOOST_AUTO_TEST_CASE(linear_plan_cache_masked) {
+        plask::RectangularMesh<2> full(plask::shared_ptr<plask::OrderedAxis>(new plask::OrderedAxis({0., 1., 2., 3.})),
+                                       plask::shared_ptr<plask::OrderedAxis>(new plask::OrderedAxis({0., 1.})));
+        auto src_mesh = plask::make_shared<plask::RectangularMaskedMesh2D>();
+        auto dst_mesh = plask::make_shared<plask::RectangularMesh<2>>(
+            plask::shared_ptr<plask::OrderedAxis>(new plask::OrderedAxis({1.25, 1.75})),
+            plask::shared_ptr<plask::OrderedAxis>(new plask::OrderedAxis({0.5})));
+
+        auto values = [&]() {
+            plask::DataVector<double> result(src_mesh->size());
+            for (size_t i = 0; i != src_mesh->size(); ++i) result[i] = 2. * src_mesh->at(i).c0 + src_mesh->at(i).c1;
+            return plask::DataVector<const double>(result);
+        };
+        auto check = [&]() {
+            for (int n = 0; n != 3; ++n) {
+                plask::DataVector<const double> dst = plask::interpolate(src_mesh, values(), dst_mesh, plask::INTERPOLATION_LINEAR);
+                BOOST_REQUIRE_EQUAL(dst.size(), dst_mesh->size());
+                for (size_t i = 0; i != dst.size(); ++i)
+                    BOOST_CHECK_CLOSE(dst[i], 2. * dst_mesh->at(i).c0 + dst_mesh->at(i).c1, 1e-12);
+            }
+        };
+
+        // Reselecting elements of the same masked mesh keeps the number of nodes, but must drop the plan
+        src_mesh->reset(full, [](const plask::RectangularMesh2D::Element& el) { return el.getIndex0() < 2; });
+        BOOST_REQUIRE_EQUAL(src_mesh->size(), 6);
+        check();
+        src_mesh->reset(full, [](const plask::RectangularMesh2D::Element& el) { return el.getIndex0() > 0; });
+        BOOST_REQUIRE_EQUAL(src_mesh->size(), 6);
+        check();
+        src_mesh->selectAll(full);
+        check();
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
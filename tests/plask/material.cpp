@@ -1,7 +1,27 @@
 #include <boost/test/unit_test.hpp>
 #include "plask/material/db.hpp"
+#include "plask/material/cached_material.hpp"
 #include "common/dumb_material.hpp"
 
+#include <atomic>
+#include <thread>
+
+// Material with smooth temperature dependence of its parameters, which counts the calls of nr
+struct TemperatureMaterial: public DumbMaterial {
+    mutable std::atomic<int> nr_calls{0};
+    double nr(double lam, double T, double) const override {
+        ++nr_calls;
+        return 3.0 + 2e-4 * T + 1e-5 * lam;
+    }
+    plask::Tensor2<double> thermk(double T, double) const override {
+        return plask::Tensor2<double>(50. * std::pow(300. / T, 1.3), 40. * std::pow(300. / T, 1.2));
+    }
+    plask::Tensor3<plask::dcomplex> NR(double lam, double T, double) const override {
+        plask::dcomplex n(3.0 + 2e-4 * T + 1e-5 * lam, 1e-6 * T * T);
+        return plask::Tensor3<plask::dcomplex>(n, n, 1.01 * n, 0.);
+    }
+};
+
 BOOST_AUTO_TEST_SUITE(material) // MUST be the same as the file name
 
     BOOST_AUTO_TEST_CASE(materialDB) {
@@ -63,4 +83,79 @@ BOOST_AUTO_TEST_SUITE(material) // MUST be the same as the file name
         BOOST_CHECK_EQUAL(links[0].str(), "GaN.Mh my note");
     }
 
+    BOOST_AUTO_TEST_CASE(cached_material_values) {
+        auto base = plask::make_shared<TemperatureMaterial>();
+        const double tolerance = 1e-4;
+        plask::CachedMaterial cached(base, plask::CachedMaterial::Settings(
+            plask::CachedMaterial::PARAM_NR | plask::CachedMaterial::PARAM_THERMK | plask::CachedMaterial::PARAM_NR_TENSOR,
+            250., 400., 10., tolerance));
+        for (double T = 250.; T <= 400.; T += 3.7) {
+            BOOST_CHECK_CLOSE_FRACTION(cached.nr(1000., T), base->nr(1000., T, 0.), tolerance);
+            BOOST_CHECK_CLOSE_FRACTION(cached.thermk(T).c00, base->thermk(T, INFINITY).c00, tolerance);
+            BOOST_CHECK_CLOSE_FRACTION(cached.thermk(T).c11, base->thermk(T, INFINITY).c11, tolerance);
+            auto NR = cached.NR(1000., T), NR0 = base->NR(1000., T, 0.);
+            BOOST_CHECK_SMALL(std::abs(NR.c00 - NR0.c00), tolerance * std::abs(NR0.c00));
+            BOOST_CHECK_SMALL(std::abs(NR.c22 - NR0.c22), tolerance * std::abs(NR0.c22));
+        }
+        // Temperatures outside of the grid are passed to the base material
+        for (double T: {100., 249.9, 400.1, 1200.}) {
+            BOOST_CHECK_EQUAL(cached.nr(1000., T), base->nr(1000., T, 0.));
+            BOOST_CHECK_EQUAL(cached.thermk(T).c00, base->thermk(T, INFINITY).c00);
+            BOOST_CHECK_EQUAL(cached.NR(1000., T).c00, base->NR(1000., T, 0.).c00);
+        }
+        BOOST_CHECK(plask::isnan(cached.nr(1000., NAN)));
+    }
+
+    BOOST_AUTO_TEST_CASE(cached_material_off_diagonal) {
+        // Only the off-diagonal component varies strongly, so it alone decides which intervals are tabulated
+        struct OffDiagonalMaterial: public DumbMaterial {
+            plask::Tensor3<plask::dcomplex> NR(double, double T, double) const override {
+                return plask::Tensor3<plask::dcomplex>(3.5, 3.5, 3.5, 0.01 * std::exp(T / 20.));
+            }
+        };
+        auto base = plask::make_shared<OffDiagonalMaterial>();
+        const double tolerance = 1e-4;
+        plask::CachedMaterial cached(base, plask::CachedMaterial::Settings(plask::CachedMaterial::PARAM_NR_TENSOR,
+                                                                            250., 400., 10., tolerance));
+        for (double T = 250.; T <= 400.; T += 3.7) {
+            auto NR = cached.NR(1000., T), NR0 = base->NR(1000., T, 0.);
+            BOOST_CHECK_SMALL(std::abs(NR.c01 - NR0.c01), tolerance * std::abs(NR0.c01));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(cached_material_maxkeys) {
+        auto base = plask::make_shared<TemperatureMaterial>();
+        plask::CachedMaterial cached(base, plask::CachedMaterial::Settings(plask::CachedMaterial::PARAM_NR,
+                                                                            250., 400., 10., 1e-4, 2));
+        // Two wavelengths are tabulated, so repeated calls do not reach the base material
+        for (double lam: {1000., 1100.}) cached.nr(lam, 300.);
+        int calls = base->nr_calls;
+        for (double lam: {1000., 1100.}) BOOST_CHECK_CLOSE_FRACTION(cached.nr(lam, 300.), base->nr(lam, 300., 0.), 1e-4);
+        BOOST_CHECK_EQUAL(base->nr_calls, calls + 2);
+        // The third one is not tabulated any more, so each call is passed to the base material
+        calls = base->nr_calls;
+        BOOST_CHECK_EQUAL(cached.nr(1200., 303.), base->nr(1200., 303., 0.));
+        BOOST_CHECK_EQUAL(cached.nr(1200., 303.), base->nr(1200., 303., 0.));
+        BOOST_CHECK_EQUAL(base->nr_calls, calls + 4);
+    }
+
+    BOOST_AUTO_TEST_CASE(cached_material_concurrent_invalidate) {
+        auto base = plask::make_shared<TemperatureMaterial>();
+        plask::CachedMaterial cached(base, plask::CachedMaterial::Settings(plask::CachedMaterial::PARAM_NR,
+                                                                            250., 400., 1., 1e-4));
+        std::atomic<bool> done{false};
+        int errors = 0;
+        std::thread reader([&] {
+            for (int n = 0; n != 200; ++n)
+                for (double T = 250.; T < 400.; T += 0.7) {
+                    double exact = base->nr(1000., T, 0.);
+                    if (std::abs(cached.nr(1000., T) - exact) > 1e-4 * exact) ++errors;
+                }
+            done = true;
+        });
+        while (!done) cached.invalidate();
+        reader.join();
+        BOOST_CHECK_EQUAL(errors, 0);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -80,6 +80,27 @@ void checkBoundary(const plask::BoundaryNodeSet& b, std::vector<std::size_t> exp
     BOOST_CHECK(!b.contains(expected.empty() ? 0 : expected.back()+1));
 }
 
+// compare index lookups with numbering given by iterators
+void checkIndexLookups(const plask::RectangularMaskedMesh2D& maskedMesh) {
+    const auto& fullMesh = maskedMesh.fullMesh;
+    std::vector<std::size_t> nodes(fullMesh.size(), plask::RectangularMaskedMesh2D::NOT_INCLUDED);
+    for (auto it = maskedMesh.begin(); it != maskedMesh.end(); ++it) nodes[it.getNumber()] = it.getIndex();
+    for (std::size_t n = 0; n != nodes.size(); ++n) {
+        BOOST_CHECK_EQUAL(maskedMesh.index(fullMesh.index0(n), fullMesh.index1(n)), nodes[n]);
+        BOOST_CHECK_EQUAL(maskedMesh.index(fullMesh.indexes(n)), nodes[n]);
+    }
+    std::vector<std::size_t> elements(fullMesh.getElementsCount(), plask::RectangularMaskedMesh2D::NOT_INCLUDED);
+    for (auto it = maskedMesh.elements().begin(); it != maskedMesh.elements().end(); ++it) elements[it.getNumber()] = it.getIndex();
+    for (std::size_t i1 = 0; i1 != fullMesh.getElementsCount1(); ++i1)
+        for (std::size_t i0 = 0; i0 != fullMesh.getElementsCount0(); ++i0)
+            BOOST_CHECK_EQUAL(maskedMesh.getElementIndexFromLowIndexes(i0, i1),
+                              elements[fullMesh.getElementIndexFromLowIndexes(i0, i1)]);
+    auto elementMesh = maskedMesh.getElementMesh();
+    for (std::size_t i1 = 0; i1 != fullMesh.getElementsCount1(); ++i1)
+        for (std::size_t i0 = 0; i0 != fullMesh.getElementsCount0(); ++i0)
+            BOOST_CHECK_EQUAL(elementMesh->index(i0, i1), elements[fullMesh.getElementIndexFromLowIndexes(i0, i1)]);
+}
+
 BOOST_AUTO_TEST_SUITE(rectangular_masked) // MUST be the same as the file name
 
 BOOST_AUTO_TEST_CASE(rectangular_masked_2D) {
@@ -196,6 +217,34 @@ BOOST_AUTO_TEST_CASE(rectangular_masked_2D) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(rectangular_masked_2D_index_lookup) {
+    auto axis0 = plask::make_shared<plask::RegularAxis>(0.0, 10.0, 11);
+    auto axis1 = plask::make_shared<plask::RegularAxis>(0.0, 10.0, 11);
+    plask::RectangularMesh2D fullMesh(axis0, axis1);   // 11x11 nodes, 10x10 elements
+
+    // most of the elements selected: dense index tables are used
+    plask::RectangularMaskedMesh2D denseMesh(fullMesh, [] (const plask::RectangularMesh<2>::Element& e) {
+        return !(e.getIndex0() == 3 && e.getIndex1() == 4) && !(e.getIndex0() == 7 && e.getIndex1() == 2) && e.getIndex1() != 8;
+    });
+    BOOST_CHECK_EQUAL(denseMesh.getElementsCount(), 88);
+    checkIndexLookups(denseMesh);
+
+    // only the diagonal selected: binary search over segments is used
+    plask::RectangularMaskedMesh2D sparseMesh(fullMesh, [] (const plask::RectangularMesh<2>::Element& e) {
+        return e.getIndex0() == e.getIndex1();
+    });
+    BOOST_CHECK_EQUAL(sparseMesh.getElementsCount(), 10);
+    checkIndexLookups(sparseMesh);
+
+    // lookup tables must be dropped when the mesh is reselected
+    denseMesh.reset([] (const plask::RectangularMesh<2>::Element& e) { return e.getIndex0() != 5; });
+    BOOST_CHECK_EQUAL(denseMesh.getElementsCount(), 90);
+    checkIndexLookups(denseMesh);
+    denseMesh.selectAll();
+    BOOST_CHECK_EQUAL(denseMesh.size(), 121);
+    checkIndexLookups(denseMesh);
+}
+
 BOOST_AUTO_TEST_CASE(rectangular_masked_2D_order10) {
     plask::RectangularMaskedMesh2D maskedMesh = constructMesh(plask::RectangularMesh2D::ORDER_10);
     BOOST_REQUIRE_EQUAL(maskedMesh.size(), 2 + 5 + 5 + 4);
@@ -0,0 +1,103 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <cstdio>
+#include "plask/sweep.hpp"
+
+BOOST_AUTO_TEST_SUITE(sweep) // MUST be the same as the file name
+
+    BOOST_AUTO_TEST_CASE(sweep_results) {
+        const std::string filename = "test_sweep.sweep";
+        std::remove(filename.c_str());
+
+        plask::DataVector<double> field(100);
+        for (std::size_t i = 0; i != field.size(); ++i) field[i] = 0.25 * double(i);
+
+        {
+            plask::SweepWriter writer(filename);
+            BOOST_CHECK(writer.getDone().empty());
+            plask::SweepRecord first(2);
+            first.values["threshold"] = plask::DataVector<double>{1.5};
+            first.values["temperature"] = field;
+            writer.append(first);
+            writer.append(plask::SweepRecord(0, 3));
+            BOOST_CHECK_THROW(writer.append(plask::SweepRecord(2)), plask::Exception);
+        }
+
+        // simulate a sweep interrupted while writing a record
+        std::uint64_t valid_size;
+        plask::readSweepResults(filename, &valid_size);
+        {
+            std::ofstream file(filename, std::ios::binary | std::ios::app);
+            const char tail[] = "\x40\0\0\0\0\0\0\0incomplete";
+            file.write(tail, sizeof(tail) - 1);
+        }
+        BOOST_CHECK_EQUAL(plask::readSweepResults(filename).size(), 2);
+
+        {
+            plask::SweepWriter writer(filename);
+            BOOST_CHECK_EQUAL(boost::filesystem::file_size(filename), valid_size);
+            BOOST_CHECK(writer.isDone(0));
+            BOOST_CHECK(!writer.isDone(1));
+            BOOST_CHECK(writer.isDone(2));
+            plask::SweepRecord last(1);
+            last.values["threshold"] = plask::DataVector<double>{2.5};
+            writer.append(last);
+        }
+
+        auto records = plask::readSweepResults(filename);
+        BOOST_REQUIRE_EQUAL(records.size(), 3);
+        BOOST_CHECK_EQUAL(records[0].run, 2);
+        BOOST_CHECK_EQUAL(records[0].status, 0);
+        BOOST_CHECK_EQUAL(records[0].values["threshold"][0], 1.5);
+        BOOST_CHECK(records[0].values["temperature"] == field);
+        BOOST_CHECK_EQUAL(records[1].run, 0);
+        BOOST_CHECK_EQUAL(records[1].status, 3);
+        BOOST_CHECK(records[1].values.empty());
+        BOOST_CHECK_EQUAL(records[2].run, 1);
+        BOOST_CHECK_EQUAL(records[2].values["threshold"][0], 2.5);
+
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(sweep_modified_params) {
+        const std::string filename = "test_sweep_params.sweep";
+        std::remove(filename.c_str());
+
+        plask::SweepRecord::Params params0 = {{"aperture", "2.0"}, {"current", "1e-3"}},
+                                   params1 = {{"aperture", "4.0"}, {"current", "1e-3"}};
+        {
+            plask::SweepWriter writer(filename);
+            plask::SweepRecord record(0);
+            record.params = params0;
+            record.values["threshold"] = plask::DataVector<double>{1.5};
+            writer.append(record);
+        }
+
+        auto records = plask::readSweepResults(filename);
+        BOOST_REQUIRE_EQUAL(records.size(), 1);
+        BOOST_CHECK(records[0].params == params0);
+
+        {
+            plask::SweepWriter writer(filename);
+            BOOST_CHECK(writer.isDone(0, params0));
+            BOOST_CHECK(!writer.isDone(1, params1));
+            // The row of the finished run has been changed, inserted before it, or the rows are reordered
+            BOOST_CHECK_THROW(writer.isDone(0, params1), plask::Exception);
+            BOOST_CHECK_THROW(writer.isDone(0, {{"aperture", "2.0"}}), plask::Exception);
+            BOOST_CHECK_THROW(writer.isDone(0, {{"current", "1e-3"}, {"aperture", "2.0"}}), plask::Exception);
+        }
+
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(sweep_bad_file) {
+        const std::string filename = "test_sweep_bad.sweep";
+        {
+            std::ofstream file(filename);
+            file << "This is not a sweep results file";
+        }
+        BOOST_CHECK_THROW(plask::SweepWriter writer(filename), plask::Exception);
+        std::remove(filename.c_str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+#!/usr/bin/env plask
+# This file is part of PLaSK (https://plask.app) by Photonics Group at TUL
+# Copyright (c) 2022 Lodz University of Technology
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+import unittest
+
+import sys
+import threading
+
+import plask
+import plask.concurrent
+from plask import material, geometry, mesh
+import plasktest
+
+
+class Concurrent(unittest.TestCase):
+
+    @material.simple()
+    class ConcurrentGood(material.Material):
+        def nr(self, lam, T=300., n=0.):
+            return lam / 1000.
+
+    @material.simple()
+    class ConcurrentBad(material.Material):
+        def nr(self, lam, T=300., n=0.):
+            raise ValueError("bad material in thread {}".format(threading.current_thread().name))
+
+    def create_solver(self, mat):
+        solver = plasktest.SpaceTest()
+        solver.geometry = geometry.Cartesian2D(geometry.Rectangle(1., 1., mat))
+        solver.mesh = mesh.Rectangular2D(mesh.Regular(0., 1., 41), mesh.Regular(0., 1., 41))
+        return solver
+
+    def testMap(self):
+        solvers = [self.create_solver('ConcurrentGood') for _ in range(4)]
+        wavelengths = [1000., 1100., 1200., 1300.]
+        with plask.concurrent.Executor(max_workers=2, threads=2) as executor:
+            results = list(executor.map(lambda s, lam: s.compute(lam), solvers, wavelengths))
+        for result, lam in zip(results, wavelengths):
+            self.assertAlmostEqual(result, 41 * 41 * lam / 1000., 9)
+
+    def testError(self):
+        solver = self.create_solver('ConcurrentBad')
+        with self.assertRaises(ValueError):
+            solver.compute(1000.)
+        solvers = [self.create_solver('ConcurrentBad'), self.create_solver('ConcurrentGood')]
+        with plask.concurrent.Executor(max_workers=2, threads=2) as executor:
+            futures = [executor.submit(s.compute, 1000.) for s in solvers]
+            with self.assertRaises(ValueError):
+                futures[0].result()
+            self.assertAlmostEqual(futures[1].result(), 41 * 41, 9)
+
+
+if __name__ == '__main__':
+    test = unittest.main(exit=False)
+    sys.exit(not test.result.wasSuccessful())
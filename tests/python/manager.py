@@ -230,6 +230,48 @@ class ManagerTest(unittest.TestCase):
         self.assertEqual(manager.geo.block2.dims[1], 1)
 
 
+    def testCache(self):
+        source = '''
+        <plask>
+          <defines>
+            <define name="h" value="1"/>
+            <define name="T" value="300"/>
+          </defines>
+          <geometry>
+            <cartesian2d name="main" axes="xy">
+              <rectangle name="block" dx="5" dy="{h}" material="GaAs"/>
+            </cartesian2d>
+          </geometry>
+          <script>
+print(T)
+          </script>
+        </plask>
+        '''
+        plask.Manager.clear_cache()
+        manager1 = plask.Manager()
+        manager1.load(source, {'T': 310}, cache=True)
+        # define not used in geometry does not matter
+        manager2 = plask.Manager()
+        manager2.load(source, {'T': 320}, cache=True)
+        self.assertEqual(manager2.geo.block, manager1.geo.block)
+        # define used in geometry does
+        manager3 = plask.Manager()
+        manager3.load(source, {'h': 2}, cache=True)
+        self.assertNotEqual(manager3.geo.block, manager1.geo.block)
+        self.assertEqual(manager3.geo.block.dims[1], 2)
+        # modified objects are not reused
+        manager1.geo.block.height = 3
+        manager4 = plask.Manager()
+        manager4.load(source, cache=True)
+        self.assertNotEqual(manager4.geo.block, manager1.geo.block)
+        self.assertEqual(manager4.geo.block.dims[1], 1)
+        # cache is not used by default
+        manager5 = plask.Manager()
+        manager5.load(source)
+        self.assertNotEqual(manager5.geo.block, manager4.geo.block)
+        plask.Manager.clear_cache()
+
+
 class FakeModule:
 
     class CustomSolver(Solver):
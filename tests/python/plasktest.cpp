@@ -120,6 +120,23 @@ struct SpaceTest : plask::SolverWithMesh<plask::Geometry2DCartesian, plask::Rect
         mesh_changed = false;
         return result;
     }
+    /// Sum refractive indices of the materials in all mesh points, evaluated in parallel
+    double compute(double lam) {
+        initCalculation();
+        double result = 0.;
+        std::exception_ptr error;
+        #pragma omp parallel for reduction(+:result)
+        for (plask::openmp_size_t i = 0; i < plask::openmp_size_t(mesh->size()); ++i) {
+            try {
+                result += geometry->getMaterial(mesh->at(i))->nr(lam, 300.);
+            } catch (...) {
+                #pragma omp critical
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        return result;
+    }
 };
 
 
@@ -282,6 +299,7 @@ BOOST_PYTHON_MODULE(plasktest)
 
     plask::python::ExportSolver<SpaceTest>("SpaceTest")
         .def("initialize", &SpaceTest::initialize)
+        .def("compute", &plask::python::detail::MethodReleasingGIL<SpaceTest, decltype(&SpaceTest::compute)>::call<&SpaceTest::compute>)
         .add_property("mesh_changed", &SpaceTest::getMeshChanged)
     ;
 